@@ -0,0 +1,1440 @@
+/**
+ * @file css-selector.c
+ * @date 2026/10/16
+ * @brief The CSS selector engine of target documents.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The selectors of CSS Selectors Level 3 are compiled to a tree of
+ * compound selectors and matched from right to left against the element,
+ * through the operations of the document only:
+ *
+ *  - type selectors and the universal selector (no namespaces);
+ *  - id, class and attribute selectors (`=`, `~=`, `|=`, `^=`, `$=`, `*=`);
+ *  - the descendant, child, next-sibling and subsequent-sibling combinators;
+ *  - the structural pseudo-classes, `:not()`, and `:checked`, `:enabled`,
+ *    `:disabled` by the attributes.
+ *
+ * Pseudo-elements and the dynamic pseudo-classes are rejected.
+ */
+
+#include "config.h"
+
+#include "purc-document.h"
+#include "purc-errors.h"
+#include "purc-utils.h"
+
+#include "private/document.h"
+#include "private/list.h"
+#include "private/tls.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum css_combinator {
+    COMB_NONE = 0,
+    COMB_DESCENDANT,        /* A B */
+    COMB_CHILD,             /* A > B */
+    COMB_NEXT_SIBLING,      /* A + B */
+    COMB_SUBSEQUENT,        /* A ~ B */
+};
+
+/* in the order of evaluation: the cheap ones first */
+enum css_simple_kind {
+    SIMPLE_ID = 0,
+    SIMPLE_CLASS,
+    SIMPLE_ATTR_EXISTS,
+    SIMPLE_ATTR_EQUALS,
+    SIMPLE_ATTR_INCLUDES,
+    SIMPLE_ATTR_DASHMATCH,
+    SIMPLE_ATTR_PREFIX,
+    SIMPLE_ATTR_SUFFIX,
+    SIMPLE_ATTR_SUBSTRING,
+    SIMPLE_CHECKED,
+    SIMPLE_DISABLED,
+    SIMPLE_ENABLED,
+    SIMPLE_ROOT,
+    SIMPLE_EMPTY,
+    SIMPLE_FIRST_CHILD,
+    SIMPLE_LAST_CHILD,
+    SIMPLE_ONLY_CHILD,
+    SIMPLE_FIRST_OF_TYPE,
+    SIMPLE_LAST_OF_TYPE,
+    SIMPLE_ONLY_OF_TYPE,
+    SIMPLE_NTH_CHILD,
+    SIMPLE_NTH_LAST_CHILD,
+    SIMPLE_NTH_OF_TYPE,
+    SIMPLE_NTH_LAST_OF_TYPE,
+    SIMPLE_NOT,
+};
+
+struct css_compound;
+
+struct css_simple {
+    enum css_simple_kind    kind;
+
+    /* the id, the class name, or the attribute name in lower case */
+    char                   *name;
+    char                   *value;
+    size_t                  value_len;
+
+    /* for :nth-*(an+b) */
+    int                     a, b;
+
+    /* for :not() */
+    struct css_compound    *negation;
+};
+
+struct css_compound {
+    /* the combinator between this compound and the one on its left */
+    enum css_combinator     comb;
+
+    /* the type selector in lower case; NULL for the universal one */
+    char                   *tag;
+    size_t                  tag_len;
+
+    size_t                  nr_simples;
+    struct css_simple      *simples;
+};
+
+struct css_complex {
+    /* from left to right */
+    size_t                  nr_compounds;
+    struct css_compound    *compounds;
+};
+
+struct pcdoc_selector {
+    unsigned                refc;
+
+    size_t                  nr_complexes;
+    struct css_complex     *complexes;
+};
+
+/* The parser */
+
+struct css_parser {
+    const char             *p;
+
+    char                   *buf;
+    size_t                  len;
+    size_t                  sz;
+};
+
+static inline bool is_css_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+static inline bool is_ident_start(char c)
+{
+    return purc_isalpha(c) || c == '_' || c == '\\' || (c & 0x80);
+}
+
+static inline bool is_ident_char(char c)
+{
+    return is_ident_start(c) || purc_isdigit(c) || c == '-';
+}
+
+static inline bool skip_ws(struct css_parser *ps)
+{
+    const char *start = ps->p;
+    while (is_css_ws(*ps->p))
+        ps->p++;
+    return ps->p != start;
+}
+
+static bool buf_append(struct css_parser *ps, const char *s, size_t n)
+{
+    if (ps->len + n + 1 > ps->sz) {
+        size_t sz = ps->sz ? ps->sz * 2 : 32;
+        while (sz < ps->len + n + 1)
+            sz *= 2;
+
+        char *buf = realloc(ps->buf, sz);
+        if (buf == NULL)
+            return false;
+        ps->buf = buf;
+        ps->sz = sz;
+    }
+
+    memcpy(ps->buf + ps->len, s, n);
+    ps->len += n;
+    ps->buf[ps->len] = 0;
+    return true;
+}
+
+/* consumes an escape after the backslash */
+static bool parse_escape(struct css_parser *ps)
+{
+    const char *p = ps->p;
+
+    if (*p == 0 || *p == '\n' || *p == '\r' || *p == '\f')
+        return false;
+
+    if (!purc_isxdigit(*p)) {
+        ps->p++;
+        return buf_append(ps, p, 1);
+    }
+
+    uint32_t uc = 0;
+    int n = 0;
+    while (n < 6 && purc_isxdigit(*p)) {
+        uc = (uc << 4) | (uint32_t)(purc_isdigit(*p) ? *p - '0' :
+                (purc_tolower(*p) - 'a' + 10));
+        p++;
+        n++;
+    }
+    if (is_css_ws(*p))
+        p++;
+    ps->p = p;
+
+    if (uc == 0 || uc > 0x10FFFF || (uc >= 0xD800 && uc <= 0xDFFF))
+        uc = 0xFFFD;
+
+    char utf8[4];
+    size_t len;
+    if (uc < 0x80) {
+        utf8[0] = (char)uc;
+        len = 1;
+    }
+    else if (uc < 0x800) {
+        utf8[0] = (char)(0xC0 | (uc >> 6));
+        utf8[1] = (char)(0x80 | (uc & 0x3F));
+        len = 2;
+    }
+    else if (uc < 0x10000) {
+        utf8[0] = (char)(0xE0 | (uc >> 12));
+        utf8[1] = (char)(0x80 | ((uc >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (uc & 0x3F));
+        len = 3;
+    }
+    else {
+        utf8[0] = (char)(0xF0 | (uc >> 18));
+        utf8[1] = (char)(0x80 | ((uc >> 12) & 0x3F));
+        utf8[2] = (char)(0x80 | ((uc >> 6) & 0x3F));
+        utf8[3] = (char)(0x80 | (uc & 0x3F));
+        len = 4;
+    }
+
+    return buf_append(ps, utf8, len);
+}
+
+/* parses an identifier into ps->buf */
+static bool parse_ident(struct css_parser *ps, bool to_lower)
+{
+    ps->len = 0;
+
+    const char *p = ps->p;
+    if (*p == '-')
+        p++;
+    if (!is_ident_start(*p) && *p != '-')
+        return false;
+
+    if (!buf_append(ps, ps->p, p - ps->p))
+        return false;
+    ps->p = p;
+
+    while (is_ident_char(*ps->p)) {
+        char c = *ps->p;
+        if (c == '\\') {
+            ps->p++;
+            if (!parse_escape(ps))
+                return false;
+            continue;
+        }
+
+        if (to_lower)
+            c = (char)purc_tolower(c);
+        if (!buf_append(ps, &c, 1))
+            return false;
+        ps->p++;
+    }
+
+    return ps->len > 0;
+}
+
+/* parses a quoted string into ps->buf */
+static bool parse_string(struct css_parser *ps)
+{
+    char quote = *ps->p++;
+
+    ps->len = 0;
+    if (!buf_append(ps, "", 0))
+        return false;
+
+    for (;;) {
+        char c = *ps->p;
+        if (c == 0 || c == '\n')
+            return false;
+
+        ps->p++;
+        if (c == quote)
+            return true;
+
+        if (c == '\\') {
+            if (*ps->p == '\n') {
+                ps->p++;
+                continue;
+            }
+            if (!parse_escape(ps))
+                return false;
+            continue;
+        }
+
+        if (!buf_append(ps, &c, 1))
+            return false;
+    }
+}
+
+static inline char *buf_dup(struct css_parser *ps)
+{
+    char *s = malloc(ps->len + 1);
+    if (s) {
+        memcpy(s, ps->buf, ps->len);
+        s[ps->len] = 0;
+    }
+    return s;
+}
+
+static void compound_release(struct css_compound *compound);
+
+static void simple_release(struct css_simple *simple)
+{
+    free(simple->name);
+    free(simple->value);
+    if (simple->negation) {
+        compound_release(simple->negation);
+        free(simple->negation);
+    }
+}
+
+static void compound_release(struct css_compound *compound)
+{
+    free(compound->tag);
+    for (size_t i = 0; i < compound->nr_simples; i++)
+        simple_release(compound->simples + i);
+    free(compound->simples);
+}
+
+static struct css_simple *compound_add_simple(struct css_compound *compound,
+        enum css_simple_kind kind)
+{
+    struct css_simple *simples = realloc(compound->simples,
+            sizeof(*simples) * (compound->nr_simples + 1));
+    if (simples == NULL)
+        return NULL;
+
+    compound->simples = simples;
+    struct css_simple *simple = simples + compound->nr_simples++;
+    memset(simple, 0, sizeof(*simple));
+    simple->kind = kind;
+    return simple;
+}
+
+static bool parse_attribute(struct css_parser *ps,
+        struct css_compound *compound)
+{
+    /* after `[` */
+    skip_ws(ps);
+    if (!parse_ident(ps, true))
+        return false;
+
+    char *name = buf_dup(ps);
+    if (name == NULL)
+        return false;
+
+    enum css_simple_kind kind;
+    skip_ws(ps);
+    switch (*ps->p) {
+    case ']':
+        kind = SIMPLE_ATTR_EXISTS;
+        break;
+    case '=':
+        kind = SIMPLE_ATTR_EQUALS;
+        break;
+    case '~':
+        kind = SIMPLE_ATTR_INCLUDES;
+        break;
+    case '|':
+        kind = SIMPLE_ATTR_DASHMATCH;
+        break;
+    case '^':
+        kind = SIMPLE_ATTR_PREFIX;
+        break;
+    case '$':
+        kind = SIMPLE_ATTR_SUFFIX;
+        break;
+    case '*':
+        kind = SIMPLE_ATTR_SUBSTRING;
+        break;
+    default:
+        goto failed;
+    }
+
+    char *value = NULL;
+    size_t value_len = 0;
+    if (kind != SIMPLE_ATTR_EXISTS) {
+        if (kind != SIMPLE_ATTR_EQUALS) {
+            ps->p++;
+            if (*ps->p != '=')
+                goto failed;
+        }
+        ps->p++;
+        skip_ws(ps);
+
+        if (*ps->p == '"' || *ps->p == '\'') {
+            if (!parse_string(ps))
+                goto failed;
+        }
+        else if (!parse_ident(ps, false)) {
+            goto failed;
+        }
+
+        value = buf_dup(ps);
+        if (value == NULL)
+            goto failed;
+        value_len = ps->len;
+        skip_ws(ps);
+    }
+
+    if (*ps->p != ']') {
+        free(value);
+        goto failed;
+    }
+    ps->p++;
+
+    struct css_simple *simple = compound_add_simple(compound, kind);
+    if (simple == NULL) {
+        free(value);
+        goto failed;
+    }
+
+    simple->name = name;
+    simple->value = value;
+    simple->value_len = value_len;
+    return true;
+
+failed:
+    free(name);
+    return false;
+}
+
+static bool parse_int(const char **pp, int *v)
+{
+    const char *p = *pp;
+    long l = 0;
+
+    if (!purc_isdigit(*p))
+        return false;
+
+    while (purc_isdigit(*p)) {
+        l = l * 10 + (*p - '0');
+        if (l > INT32_MAX)
+            return false;
+        p++;
+    }
+
+    *v = (int)l;
+    *pp = p;
+    return true;
+}
+
+/* parses `an+b`, `odd` or `even` and the closing parenthesis */
+static bool parse_nth(struct css_parser *ps, int *a, int *b)
+{
+    skip_ws(ps);
+
+    const char *p = ps->p;
+    if (pcutils_strncasecmp(p, "odd", 3) == 0 && !is_ident_char(p[3])) {
+        *a = 2;
+        *b = 1;
+        p += 3;
+    }
+    else if (pcutils_strncasecmp(p, "even", 4) == 0 &&
+            !is_ident_char(p[4])) {
+        *a = 2;
+        *b = 0;
+        p += 4;
+    }
+    else {
+        int sign = 1;
+        if (*p == '+' || *p == '-') {
+            sign = (*p == '-') ? -1 : 1;
+            p++;
+        }
+
+        int num = 1;
+        bool has_num = parse_int(&p, &num);
+
+        if (*p == 'n' || *p == 'N') {
+            *a = sign * num;
+            *b = 0;
+            p++;
+
+            while (is_css_ws(*p))
+                p++;
+            if (*p == '+' || *p == '-') {
+                int bsign = (*p == '-') ? -1 : 1;
+                p++;
+                while (is_css_ws(*p))
+                    p++;
+                if (!parse_int(&p, &num))
+                    return false;
+                *b = bsign * num;
+            }
+        }
+        else if (has_num) {
+            *a = 0;
+            *b = sign * num;
+        }
+        else {
+            return false;
+        }
+    }
+
+    ps->p = p;
+    skip_ws(ps);
+    if (*ps->p != ')')
+        return false;
+    ps->p++;
+    return true;
+}
+
+static bool parse_compound(struct css_parser *ps,
+        struct css_compound *compound, bool negation);
+
+static const struct {
+    const char             *name;
+    enum css_simple_kind    kind;
+} pseudo_classes[] = {
+    { "root",               SIMPLE_ROOT },
+    { "empty",              SIMPLE_EMPTY },
+    { "first-child",        SIMPLE_FIRST_CHILD },
+    { "last-child",         SIMPLE_LAST_CHILD },
+    { "only-child",         SIMPLE_ONLY_CHILD },
+    { "first-of-type",      SIMPLE_FIRST_OF_TYPE },
+    { "last-of-type",       SIMPLE_LAST_OF_TYPE },
+    { "only-of-type",       SIMPLE_ONLY_OF_TYPE },
+    { "checked",            SIMPLE_CHECKED },
+    { "disabled",           SIMPLE_DISABLED },
+    { "enabled",            SIMPLE_ENABLED },
+};
+
+static const struct {
+    const char             *name;
+    enum css_simple_kind    kind;
+} functional_pseudo_classes[] = {
+    { "nth-child",          SIMPLE_NTH_CHILD },
+    { "nth-last-child",     SIMPLE_NTH_LAST_CHILD },
+    { "nth-of-type",        SIMPLE_NTH_OF_TYPE },
+    { "nth-last-of-type",   SIMPLE_NTH_LAST_OF_TYPE },
+    { "not",                SIMPLE_NOT },
+};
+
+static bool parse_pseudo_class(struct css_parser *ps,
+        struct css_compound *compound, bool negation)
+{
+    /* after `:`; pseudo-elements are not supported */
+    if (*ps->p == ':' || !parse_ident(ps, true))
+        return false;
+
+    if (*ps->p != '(') {
+        for (size_t i = 0; i < PCA_TABLESIZE(pseudo_classes); i++) {
+            if (strcmp(ps->buf, pseudo_classes[i].name) == 0)
+                return compound_add_simple(compound,
+                        pseudo_classes[i].kind) != NULL;
+        }
+        return false;
+    }
+
+    ps->p++;
+    for (size_t i = 0; i < PCA_TABLESIZE(functional_pseudo_classes); i++) {
+        if (strcmp(ps->buf, functional_pseudo_classes[i].name))
+            continue;
+
+        enum css_simple_kind kind = functional_pseudo_classes[i].kind;
+        if (kind != SIMPLE_NOT) {
+            int a, b;
+            if (!parse_nth(ps, &a, &b))
+                return false;
+
+            struct css_simple *simple = compound_add_simple(compound, kind);
+            if (simple == NULL)
+                return false;
+            simple->a = a;
+            simple->b = b;
+            return true;
+        }
+
+        /* :not() does not nest */
+        if (negation)
+            return false;
+
+        struct css_compound *inner = calloc(1, sizeof(*inner));
+        if (inner == NULL)
+            return false;
+
+        skip_ws(ps);
+        if (!parse_compound(ps, inner, true)) {
+            compound_release(inner);
+            free(inner);
+            return false;
+        }
+
+        skip_ws(ps);
+        struct css_simple *simple = NULL;
+        if (*ps->p == ')')
+            simple = compound_add_simple(compound, kind);
+        if (simple == NULL) {
+            compound_release(inner);
+            free(inner);
+            return false;
+        }
+
+        ps->p++;
+        simple->negation = inner;
+        return true;
+    }
+
+    return false;
+}
+
+static int simple_cmp(const void *a, const void *b)
+{
+    const struct css_simple *sa = a;
+    const struct css_simple *sb = b;
+    return (int)sa->kind - (int)sb->kind;
+}
+
+static bool parse_compound(struct css_parser *ps,
+        struct css_compound *compound, bool negation)
+{
+    bool empty = true;
+
+    if (*ps->p == '*') {
+        ps->p++;
+        empty = false;
+    }
+    else if (is_ident_start(*ps->p) || *ps->p == '-') {
+        if (!parse_ident(ps, true))
+            return false;
+        compound->tag = buf_dup(ps);
+        if (compound->tag == NULL)
+            return false;
+        compound->tag_len = ps->len;
+        empty = false;
+    }
+
+    if (*ps->p == '|')      /* namespaces are not supported */
+        return false;
+
+    for (;;) {
+        struct css_simple *simple;
+
+        switch (*ps->p) {
+        case '#':
+            ps->p++;
+            if (!parse_ident(ps, false))
+                return false;
+            simple = compound_add_simple(compound, SIMPLE_ID);
+            if (simple == NULL || (simple->name = buf_dup(ps)) == NULL)
+                return false;
+            simple->value_len = ps->len;
+            break;
+
+        case '.':
+            ps->p++;
+            if (!parse_ident(ps, false))
+                return false;
+            simple = compound_add_simple(compound, SIMPLE_CLASS);
+            if (simple == NULL || (simple->name = buf_dup(ps)) == NULL)
+                return false;
+            simple->value_len = ps->len;
+            break;
+
+        case '[':
+            ps->p++;
+            if (!parse_attribute(ps, compound))
+                return false;
+            break;
+
+        case ':':
+            ps->p++;
+            if (!parse_pseudo_class(ps, compound, negation))
+                return false;
+            break;
+
+        default:
+            goto done;
+        }
+
+        empty = false;
+    }
+
+done:
+    if (compound->nr_simples > 1)
+        qsort(compound->simples, compound->nr_simples,
+                sizeof(struct css_simple), simple_cmp);
+    return !empty;
+}
+
+static void complex_release(struct css_complex *complex)
+{
+    for (size_t i = 0; i < complex->nr_compounds; i++)
+        compound_release(complex->compounds + i);
+    free(complex->compounds);
+}
+
+static bool parse_complex(struct css_parser *ps, struct css_complex *complex)
+{
+    enum css_combinator comb = COMB_NONE;
+
+    for (;;) {
+        struct css_compound *compounds = realloc(complex->compounds,
+                sizeof(*compounds) * (complex->nr_compounds + 1));
+        if (compounds == NULL)
+            return false;
+        complex->compounds = compounds;
+
+        struct css_compound *compound = compounds + complex->nr_compounds++;
+        memset(compound, 0, sizeof(*compound));
+        compound->comb = comb;
+        if (!parse_compound(ps, compound, false))
+            return false;
+
+        bool ws = skip_ws(ps);
+        switch (*ps->p) {
+        case '>':
+            comb = COMB_CHILD;
+            break;
+        case '+':
+            comb = COMB_NEXT_SIBLING;
+            break;
+        case '~':
+            comb = COMB_SUBSEQUENT;
+            break;
+        case ',':
+        case 0:
+            return true;
+        default:
+            if (!ws)
+                return false;
+            comb = COMB_DESCENDANT;
+            break;
+        }
+
+        if (comb != COMB_DESCENDANT) {
+            ps->p++;
+            skip_ws(ps);
+        }
+    }
+}
+
+static void selector_destroy(struct pcdoc_selector *selector)
+{
+    for (size_t i = 0; i < selector->nr_complexes; i++)
+        complex_release(selector->complexes + i);
+    free(selector->complexes);
+    free(selector);
+}
+
+static struct pcdoc_selector *selector_compile(const char *text)
+{
+    struct pcdoc_selector *selector = calloc(1, sizeof(*selector));
+    if (selector == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+    selector->refc = 1;
+
+    struct css_parser ps = { text, NULL, 0, 0 };
+    skip_ws(&ps);
+    for (;;) {
+        struct css_complex *complexes = realloc(selector->complexes,
+                sizeof(*complexes) * (selector->nr_complexes + 1));
+        if (complexes == NULL)
+            goto failed;
+        selector->complexes = complexes;
+
+        struct css_complex *complex = complexes + selector->nr_complexes++;
+        memset(complex, 0, sizeof(*complex));
+        if (!parse_complex(&ps, complex))
+            goto failed;
+
+        if (*ps.p == 0)
+            break;
+
+        /* a comma */
+        ps.p++;
+        skip_ws(&ps);
+    }
+
+    free(ps.buf);
+    return selector;
+
+failed:
+    free(ps.buf);
+    selector_destroy(selector);
+    purc_set_error_with_info(PURC_ERROR_INVALID_VALUE,
+            "bad CSS selector: %s", text);
+    return NULL;
+}
+
+/* The cache of compiled selectors */
+
+/* number of compiled selectors kept by every thread */
+#define SELECTOR_CACHE_SIZE     32
+
+struct selector_cache_entry {
+    struct list_head        node;
+    uint64_t                hash;
+    char                   *text;
+    struct pcdoc_selector  *selector;
+};
+
+struct selector_cache {
+    /* the most recently used entry first */
+    struct list_head        lru;
+    size_t                  nr_entries;
+};
+
+PURC_DEFINE_THREAD_LOCAL(struct selector_cache, selector_cache);
+
+static inline uint64_t selector_hash(const char *text)
+{
+    /* 64-bit FNV-1a */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    while (*text) {
+        hash ^= (unsigned char)*text++;
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+pcdoc_selector_t
+pcdoc_selector_new(const char *text)
+{
+    if (text == NULL) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    struct selector_cache *cache = PURC_GET_THREAD_LOCAL(selector_cache);
+    if (cache == NULL)
+        return selector_compile(text);
+
+    if (cache->lru.next == NULL)
+        list_head_init(&cache->lru);
+
+    uint64_t hash = selector_hash(text);
+    struct selector_cache_entry *entry;
+    list_for_each_entry(entry, &cache->lru, node) {
+        if (entry->hash == hash && strcmp(entry->text, text) == 0) {
+            if (!list_is_first(&entry->node, &cache->lru))
+                list_move(&entry->node, &cache->lru);
+            entry->selector->refc++;
+            return entry->selector;
+        }
+    }
+
+    struct pcdoc_selector *selector = selector_compile(text);
+    if (selector == NULL)
+        return NULL;
+
+    char *dup = strdup(text);
+    if (dup == NULL)
+        return selector;
+
+    if (cache->nr_entries < SELECTOR_CACHE_SIZE) {
+        entry = malloc(sizeof(*entry));
+        if (entry == NULL) {
+            free(dup);
+            return selector;
+        }
+        cache->nr_entries++;
+    }
+    else {
+        entry = list_last_entry(&cache->lru, struct selector_cache_entry,
+                node);
+        list_del(&entry->node);
+        pcdoc_selector_delete(entry->selector);
+        free(entry->text);
+    }
+
+    entry->hash = hash;
+    entry->text = dup;
+    entry->selector = selector;
+    selector->refc++;
+    list_add(&entry->node, &cache->lru);
+    return selector;
+}
+
+void
+pcdoc_selector_delete(pcdoc_selector_t selector)
+{
+    if (selector && --selector->refc == 0)
+        selector_destroy(selector);
+}
+
+void
+pcdoc_selector_cache_cleanup(void)
+{
+    struct selector_cache *cache = PURC_GET_THREAD_LOCAL(selector_cache);
+    if (cache == NULL || cache->lru.next == NULL)
+        return;
+
+    struct selector_cache_entry *entry, *tmp;
+    list_for_each_entry_safe(entry, tmp, &cache->lru, node) {
+        list_del(&entry->node);
+        pcdoc_selector_delete(entry->selector);
+        free(entry->text);
+        free(entry);
+    }
+    cache->nr_entries = 0;
+}
+
+/* The matcher */
+
+static inline pcdoc_element_t
+parent_elem(purc_document_t doc, pcdoc_element_t elem)
+{
+    pcdoc_node node;
+    node.type = PCDOC_NODE_ELEMENT;
+    node.elem = elem;
+    return doc->ops->get_parent(doc, node);
+}
+
+static inline pcdoc_element_t
+sibling_elem(purc_document_t doc, pcdoc_element_t elem, bool next)
+{
+    if (doc->ops->get_sibling_elem)
+        return doc->ops->get_sibling_elem(doc, elem, next);
+    return NULL;
+}
+
+static inline const char *
+tag_name(purc_document_t doc, pcdoc_element_t elem, size_t *len)
+{
+    const char *name;
+    if (doc->ops->get_tag_name &&
+            doc->ops->get_tag_name(doc, elem, &name, len) == 0)
+        return name;
+    return NULL;
+}
+
+static inline bool
+same_type(purc_document_t doc, pcdoc_element_t elem,
+        const char *name, size_t len)
+{
+    size_t l;
+    const char *n = tag_name(doc, elem, &l);
+    return n && l == len && memcmp(n, name, len) == 0;
+}
+
+static const char *
+attr_value(purc_document_t doc, pcdoc_element_t elem, const char *name,
+        size_t *len)
+{
+    const char *val;
+    if (doc->ops->get_attribute &&
+            doc->ops->get_attribute(doc, elem, name, &val, len) == 0)
+        return val ? val : "";      /* an attribute without value */
+    return NULL;
+}
+
+static const char *
+special_attr_value(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_special_attr which, size_t *len)
+{
+    const char *val;
+    if (doc->ops->get_special_attr) {
+        if (doc->ops->get_special_attr(doc, elem, which, &val, len) == 0)
+            return val ? val : "";
+        return NULL;
+    }
+
+    return attr_value(doc, elem, which == PCDOC_ATTR_ID ? "id" : "class",
+            len);
+}
+
+static bool
+has_token(const char *s, size_t len, const char *token, size_t token_len)
+{
+    const char *end = s + len;
+
+    while (s < end) {
+        while (s < end && is_css_ws(*s))
+            s++;
+
+        const char *start = s;
+        while (s < end && !is_css_ws(*s))
+            s++;
+
+        if ((size_t)(s - start) == token_len &&
+                memcmp(start, token, token_len) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static bool
+has_substring(const char *s, size_t len, const char *sub, size_t sub_len)
+{
+    if (sub_len > len)
+        return false;
+
+    for (size_t i = 0; i <= len - sub_len; i++) {
+        if (s[i] == sub[0] && memcmp(s + i, sub, sub_len) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static bool
+match_attribute(const struct css_simple *simple, const char *val, size_t len)
+{
+    const char *v = simple->value;
+    size_t vlen = simple->value_len;
+
+    switch (simple->kind) {
+    case SIMPLE_ATTR_EXISTS:
+        return true;
+    case SIMPLE_ATTR_EQUALS:
+        return len == vlen && memcmp(val, v, vlen) == 0;
+    case SIMPLE_ATTR_INCLUDES:
+        if (vlen == 0 || has_substring(v, vlen, " ", 1))
+            return false;
+        return has_token(val, len, v, vlen);
+    case SIMPLE_ATTR_DASHMATCH:
+        return len >= vlen && memcmp(val, v, vlen) == 0 &&
+            (len == vlen || val[vlen] == '-');
+    case SIMPLE_ATTR_PREFIX:
+        return vlen > 0 && len >= vlen && memcmp(val, v, vlen) == 0;
+    case SIMPLE_ATTR_SUFFIX:
+        return vlen > 0 && len >= vlen &&
+            memcmp(val + len - vlen, v, vlen) == 0;
+    case SIMPLE_ATTR_SUBSTRING:
+        return vlen > 0 && has_substring(val, len, v, vlen);
+    default:
+        break;
+    }
+
+    return false;
+}
+
+static inline bool match_nth(int a, int b, int idx)
+{
+    if (a == 0)
+        return idx == b;
+
+    int diff = idx - b;
+    return (diff / a) >= 0 && (diff % a) == 0;
+}
+
+/* the 1-based position of the element among its (typed) siblings */
+static int
+sibling_index(purc_document_t doc, pcdoc_element_t elem, bool from_end,
+        bool of_type)
+{
+    const char *name = NULL;
+    size_t len = 0;
+
+    if (of_type) {
+        name = tag_name(doc, elem, &len);
+        if (name == NULL)
+            return 0;
+    }
+
+    int idx = 1;
+    pcdoc_element_t sibling = sibling_elem(doc, elem, from_end);
+    while (sibling) {
+        if (!of_type || same_type(doc, sibling, name, len))
+            idx++;
+        sibling = sibling_elem(doc, sibling, from_end);
+    }
+
+    return idx;
+}
+
+static bool
+is_form_control(purc_document_t doc, pcdoc_element_t elem)
+{
+    static const char *controls[] = {
+        "button", "input", "select", "textarea",
+        "optgroup", "option", "fieldset",
+    };
+
+    size_t len;
+    const char *name = tag_name(doc, elem, &len);
+    if (name == NULL)
+        return false;
+
+    for (size_t i = 0; i < PCA_TABLESIZE(controls); i++) {
+        if (strlen(controls[i]) == len &&
+                pcutils_strncasecmp(name, controls[i], len) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+static bool
+match_compound(purc_document_t doc, pcdoc_element_t elem,
+        const struct css_compound *compound);
+
+static bool
+match_simple(purc_document_t doc, pcdoc_element_t elem,
+        const struct css_simple *simple)
+{
+    const char *val;
+    size_t len;
+
+    switch (simple->kind) {
+    case SIMPLE_ID:
+        val = special_attr_value(doc, elem, PCDOC_ATTR_ID, &len);
+        return val && len == simple->value_len &&
+            memcmp(val, simple->name, len) == 0;
+
+    case SIMPLE_CLASS:
+        val = special_attr_value(doc, elem, PCDOC_ATTR_CLASS, &len);
+        return val && has_token(val, len, simple->name, simple->value_len);
+
+    case SIMPLE_ATTR_EXISTS:
+    case SIMPLE_ATTR_EQUALS:
+    case SIMPLE_ATTR_INCLUDES:
+    case SIMPLE_ATTR_DASHMATCH:
+    case SIMPLE_ATTR_PREFIX:
+    case SIMPLE_ATTR_SUFFIX:
+    case SIMPLE_ATTR_SUBSTRING:
+        val = attr_value(doc, elem, simple->name, &len);
+        return val && match_attribute(simple, val, len);
+
+    case SIMPLE_CHECKED:
+        return attr_value(doc, elem, "checked", &len) ||
+            attr_value(doc, elem, "selected", &len);
+
+    case SIMPLE_DISABLED:
+        return is_form_control(doc, elem) &&
+            attr_value(doc, elem, "disabled", &len);
+
+    case SIMPLE_ENABLED:
+        return is_form_control(doc, elem) &&
+            !attr_value(doc, elem, "disabled", &len);
+
+    case SIMPLE_ROOT:
+        return parent_elem(doc, elem) == NULL;
+
+    case SIMPLE_EMPTY: {
+        size_t nrs[PCDOC_NODE_OTHERS + 1] = { };
+        if (doc->ops->children_count == NULL ||
+                doc->ops->children_count(doc, elem, nrs))
+            return true;
+        return nrs[PCDOC_NODE_ELEMENT] == 0 && nrs[PCDOC_NODE_TEXT] == 0 &&
+            nrs[PCDOC_NODE_DATA] == 0 && nrs[PCDOC_NODE_CDATA_SECTION] == 0;
+    }
+
+    case SIMPLE_FIRST_CHILD:
+        return sibling_elem(doc, elem, false) == NULL;
+
+    case SIMPLE_LAST_CHILD:
+        return sibling_elem(doc, elem, true) == NULL;
+
+    case SIMPLE_ONLY_CHILD:
+        return sibling_elem(doc, elem, false) == NULL &&
+            sibling_elem(doc, elem, true) == NULL;
+
+    case SIMPLE_FIRST_OF_TYPE:
+        return sibling_index(doc, elem, false, true) == 1;
+
+    case SIMPLE_LAST_OF_TYPE:
+        return sibling_index(doc, elem, true, true) == 1;
+
+    case SIMPLE_ONLY_OF_TYPE:
+        return sibling_index(doc, elem, false, true) == 1 &&
+            sibling_index(doc, elem, true, true) == 1;
+
+    case SIMPLE_NTH_CHILD:
+        return match_nth(simple->a, simple->b,
+                sibling_index(doc, elem, false, false));
+
+    case SIMPLE_NTH_LAST_CHILD:
+        return match_nth(simple->a, simple->b,
+                sibling_index(doc, elem, true, false));
+
+    case SIMPLE_NTH_OF_TYPE:
+        return match_nth(simple->a, simple->b,
+                sibling_index(doc, elem, false, true));
+
+    case SIMPLE_NTH_LAST_OF_TYPE:
+        return match_nth(simple->a, simple->b,
+                sibling_index(doc, elem, true, true));
+
+    case SIMPLE_NOT:
+        return !match_compound(doc, elem, simple->negation);
+    }
+
+    return false;
+}
+
+static bool
+match_compound(purc_document_t doc, pcdoc_element_t elem,
+        const struct css_compound *compound)
+{
+    if (compound->tag) {
+        size_t len;
+        const char *name = tag_name(doc, elem, &len);
+        if (name == NULL || len != compound->tag_len ||
+                pcutils_strncasecmp(name, compound->tag, len))
+            return false;
+    }
+
+    for (size_t i = 0; i < compound->nr_simples; i++) {
+        if (!match_simple(doc, elem, compound->simples + i))
+            return false;
+    }
+
+    return true;
+}
+
+/* matches the compounds [0, idx] of the complex selector, right to left */
+static bool
+match_complex(purc_document_t doc, pcdoc_element_t elem,
+        const struct css_complex *complex, size_t idx)
+{
+    const struct css_compound *compound = complex->compounds + idx;
+
+    if (!match_compound(doc, elem, compound))
+        return false;
+
+    if (idx == 0)
+        return true;
+
+    pcdoc_element_t other;
+    switch (compound->comb) {
+    case COMB_CHILD:
+        other = parent_elem(doc, elem);
+        return other && match_complex(doc, other, complex, idx - 1);
+
+    case COMB_DESCENDANT:
+        for (other = parent_elem(doc, elem); other;
+                other = parent_elem(doc, other)) {
+            if (match_complex(doc, other, complex, idx - 1))
+                return true;
+        }
+        return false;
+
+    case COMB_NEXT_SIBLING:
+        other = sibling_elem(doc, elem, false);
+        return other && match_complex(doc, other, complex, idx - 1);
+
+    case COMB_SUBSEQUENT:
+        for (other = sibling_elem(doc, elem, false); other;
+                other = sibling_elem(doc, other, false)) {
+            if (match_complex(doc, other, complex, idx - 1))
+                return true;
+        }
+        return false;
+
+    case COMB_NONE:
+        break;
+    }
+
+    return false;
+}
+
+bool
+pcdoc_selector_match(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_selector_t selector)
+{
+    for (size_t i = 0; i < selector->nr_complexes; i++) {
+        const struct css_complex *complex = selector->complexes + i;
+        if (match_complex(doc, elem, complex, complex->nr_compounds - 1))
+            return true;
+    }
+
+    return false;
+}
+
+struct select_info {
+    pcdoc_selector_t    selector;
+    pcdoc_element_cb    cb;
+    void               *ctxt;
+};
+
+static int
+select_element(purc_document_t doc, pcdoc_element_t elem, void *ctxt)
+{
+    struct select_info *info = ctxt;
+
+    if (pcdoc_selector_match(doc, elem, info->selector))
+        return info->cb(doc, elem, info->ctxt);
+    return 0;
+}
+
+static bool
+in_scope(purc_document_t doc, pcdoc_element_t elem, pcdoc_element_t scope)
+{
+    for (; elem; elem = parent_elem(doc, elem)) {
+        if (elem == scope)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * When the rightmost compound of a single complex selector has an id or
+ * a class, only the elements found in the index of the document need to
+ * be matched.
+ *
+ * Returns 1 if the index is not available.
+ */
+static int
+travel_indexed(purc_document_t doc, pcdoc_element_t scope,
+        pcdoc_selector_t selector, pcdoc_element_cb cb, void *ctxt)
+{
+    if (selector->nr_complexes != 1)
+        return 1;
+
+    const struct css_complex *complex = selector->complexes;
+    const struct css_compound *compound;
+    compound = complex->compounds + complex->nr_compounds - 1;
+
+    /* the simple selectors are sorted: the id first, then the classes */
+    if (compound->nr_simples == 0 || compound->simples[0].kind > SIMPLE_CLASS)
+        return 1;
+
+    const struct css_simple *key = compound->simples;
+    pcdoc_element_t *elems;
+    size_t nr;
+    if (pcdoc_index_lookup(doc,
+                key->kind == SIMPLE_ID ? PCDOC_ATTR_ID : PCDOC_ATTR_CLASS,
+                key->name, key->value_len, &elems, &nr))
+        return 1;
+
+    pcdoc_element_t root = doc->ops->special_elem(doc,
+            PCDOC_SPECIAL_ELEM_ROOT);
+    if (scope == root)
+        scope = NULL;
+
+    for (size_t i = 0; i < nr; i++) {
+        if (scope && !in_scope(doc, elems[i], scope))
+            continue;
+
+        if (match_complex(doc, elems[i], complex, complex->nr_compounds - 1) &&
+                cb(doc, elems[i], ctxt))
+            return -1;
+    }
+
+    return 0;
+}
+
+int
+pcdoc_selector_travel(purc_document_t doc, pcdoc_element_t scope,
+        pcdoc_selector_t selector, pcdoc_element_cb cb, void *ctxt)
+{
+    int r = travel_indexed(doc, scope, selector, cb, ctxt);
+    if (r <= 0)
+        return r;
+
+    struct select_info info = { selector, cb, ctxt };
+    return pcdoc_travel_descendant_elements(doc, scope,
+            select_element, &info, NULL);
+}
+
+/* The selector operations of documents */
+
+static int
+found_element(purc_document_t doc, pcdoc_element_t elem, void *ctxt)
+{
+    UNUSED_PARAM(doc);
+
+    *(pcdoc_element_t *)ctxt = elem;
+    return 1;
+}
+
+pcdoc_element_t
+pcdoc_selector_find_elem(purc_document_t doc, pcdoc_element_t scope,
+        const char *text)
+{
+    pcdoc_selector_t selector = pcdoc_selector_new(text);
+    if (selector == NULL)
+        return NULL;
+
+    pcdoc_element_t found = NULL;
+    pcdoc_selector_travel(doc, scope, selector, found_element, &found);
+    pcdoc_selector_delete(selector);
+    return found;
+}
+
+static int
+collect_element(purc_document_t doc, pcdoc_element_t elem, void *ctxt)
+{
+    UNUSED_PARAM(doc);
+
+    pcdoc_elem_coll_t coll = ctxt;
+    if (pcutils_arrlist_append(coll->elems, elem)) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+pcdoc_selector_elem_coll_select(purc_document_t doc,
+        pcdoc_elem_coll_t coll, pcdoc_element_t scope, const char *text)
+{
+    pcdoc_selector_t selector = pcdoc_selector_new(text);
+    if (selector == NULL)
+        return -1;
+
+    int r = pcdoc_selector_travel(doc, scope, selector, collect_element, coll);
+    pcdoc_selector_delete(selector);
+    return r ? -1 : 0;
+}
+
+int
+pcdoc_selector_elem_coll_filter(purc_document_t doc,
+        pcdoc_elem_coll_t dst_coll, pcdoc_elem_coll_t src_coll,
+        const char *text)
+{
+    pcdoc_selector_t selector = pcdoc_selector_new(text);
+    if (selector == NULL)
+        return -1;
+
+    int r = 0;
+    size_t n = pcutils_arrlist_length(src_coll->elems);
+    for (size_t i = 0; i < n; i++) {
+        pcdoc_element_t elem = pcutils_arrlist_get_idx(src_coll->elems, i);
+        if (pcdoc_selector_match(doc, elem, selector) &&
+                collect_element(doc, elem, dst_coll)) {
+            r = -1;
+            break;
+        }
+    }
+
+    pcdoc_selector_delete(selector);
+    return r;
+}
@@ -303,6 +303,7 @@ pcdoc_element_children_count(purc_document_t doc, pcdoc_element_t elem,
                 *nr_text_nodes = nrs[PCDOC_NODE_TEXT];
             if (nr_data_nodes)
                 *nr_data_nodes = nrs[PCDOC_NODE_DATA];
+            return 0;
         }
         else {
             return -1;
@@ -536,7 +537,7 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
                     PCDOC_SPECIAL_ELEM_ROOT);
         }
 
-        if (!doc->ops->elem_coll_select(doc, coll, ancestor, selector)) {
+        if (doc->ops->elem_coll_select(doc, coll, ancestor, selector)) {
             pcdoc_elem_coll_delete(doc, coll);
             coll = NULL;
         }
@@ -546,13 +547,13 @@ pcdoc_elem_coll_new_from_descendants(purc_document_t doc,
 }
 
 pcdoc_elem_coll_t
-pcdoc_elem_coll_filter(purc_document_t doc,
+pcdoc_elem_coll_select(purc_document_t doc,
         pcdoc_elem_coll_t elem_coll, const char *selector)
 {
     pcdoc_elem_coll_t dst_coll = element_collection_new(selector);
 
     if (doc->ops->elem_coll_filter) {
-        if (!doc->ops->elem_coll_filter(doc, dst_coll,
+        if (doc->ops->elem_coll_filter(doc, dst_coll,
                 elem_coll, selector)) {
             pcdoc_elem_coll_delete(doc, dst_coll);
             dst_coll = NULL;
@@ -569,6 +570,7 @@ pcdoc_elem_coll_delete(purc_document_t doc,
     UNUSED_PARAM(doc);
 
     pcutils_arrlist_free(elem_coll->elems);
+    free(elem_coll->selector);
     return free(elem_coll);
 }
 
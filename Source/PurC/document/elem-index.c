@@ -0,0 +1,576 @@
+/**
+ * @file elem-index.c
+ * @date 2026/10/16
+ * @brief The id and class indexes of target documents.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A document which sets `maintain_index` gets two hash tables, from the
+ * identifiers and from the class names to the elements carrying them.
+ * The tables are built by a single traverse on the first lookup; after
+ * that the document implementation reports every change of the `id` and
+ * `class` attributes and every subtree inserted or removed, and the
+ * tables follow incrementally.
+ *
+ * The elements of a bucket are kept in document order: an element added
+ * after the last one in document order is appended without further ado,
+ * otherwise the bucket is marked unordered and sorted on the next lookup.
+ */
+
+#include "config.h"
+
+#include "purc-document.h"
+#include "purc-errors.h"
+#include "purc-utils.h"
+
+#include "private/document.h"
+#include "private/hashtable.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_INIT_SIZE     64
+
+struct elem_bucket {
+    char                   *name;
+    pcdoc_element_t        *elems;
+    size_t                  nr_elems;
+    size_t                  sz_elems;
+
+    /* the elements are in document order */
+    unsigned                ordered:1;
+    /* the bucket is in the pending list of a subtree removal */
+    unsigned                pending:1;
+};
+
+struct pcdoc_elem_index {
+    struct pchash_table    *ids;
+    struct pchash_table    *classes;
+
+    /* an element was lost for lack of memory; rebuild on next lookup */
+    bool                    stale;
+};
+
+static void bucket_free_entry(struct pchash_entry *e)
+{
+    struct elem_bucket *bucket = (struct elem_bucket *)pchash_entry_v(e);
+
+    free(bucket->elems);
+    free(bucket->name);
+    free(bucket);
+}
+
+static inline bool is_class_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+/* Document order */
+
+static inline pcdoc_element_t
+parent_elem(purc_document_t doc, pcdoc_element_t elem)
+{
+    pcdoc_node node;
+    node.type = PCDOC_NODE_ELEMENT;
+    node.elem = elem;
+    return doc->ops->get_parent(doc, node);
+}
+
+static size_t elem_depth(purc_document_t doc, pcdoc_element_t elem)
+{
+    size_t depth = 0;
+    while ((elem = parent_elem(doc, elem)))
+        depth++;
+    return depth;
+}
+
+/*
+ * Compares the positions of two siblings by walking away from the first
+ * one in both directions, so the cost is bounded by their distance.
+ */
+static int
+sibling_order(purc_document_t doc, pcdoc_element_t a, pcdoc_element_t b)
+{
+    pcdoc_element_t fwd = a, bwd = a;
+
+    while (fwd || bwd) {
+        if (fwd && (fwd = doc->ops->get_sibling_elem(doc, fwd, true)) == b)
+            return -1;
+        if (bwd && (bwd = doc->ops->get_sibling_elem(doc, bwd, false)) == b)
+            return 1;
+    }
+
+    /* not siblings at all */
+    return (a < b) ? -1 : 1;
+}
+
+static int
+doc_order(purc_document_t doc, pcdoc_element_t a, pcdoc_element_t b)
+{
+    if (a == b)
+        return 0;
+
+    size_t da = elem_depth(doc, a);
+    size_t db = elem_depth(doc, b);
+
+    while (da > db) {
+        pcdoc_element_t parent = parent_elem(doc, a);
+        if (parent == b)
+            return 1;       /* b is an ancestor of a */
+        a = parent;
+        da--;
+    }
+
+    while (db > da) {
+        pcdoc_element_t parent = parent_elem(doc, b);
+        if (parent == a)
+            return -1;      /* a is an ancestor of b */
+        b = parent;
+        db--;
+    }
+
+    for (;;) {
+        pcdoc_element_t pa = parent_elem(doc, a);
+        pcdoc_element_t pb = parent_elem(doc, b);
+        if (pa == pb)
+            break;
+        a = pa;
+        b = pb;
+    }
+
+    return sibling_order(doc, a, b);
+}
+
+static void
+sort_elems(purc_document_t doc, pcdoc_element_t *elems,
+        pcdoc_element_t *tmp, size_t nr)
+{
+    if (nr < 2)
+        return;
+
+    size_t half = nr / 2;
+    sort_elems(doc, elems, tmp, half);
+    sort_elems(doc, elems + half, tmp, nr - half);
+
+    /* the halves are already in order */
+    if (doc_order(doc, elems[half - 1], elems[half]) < 0)
+        return;
+
+    size_t i = 0, j = half, k = 0;
+    while (i < half && j < nr) {
+        if (doc_order(doc, elems[j], elems[i]) < 0)
+            tmp[k++] = elems[j++];
+        else
+            tmp[k++] = elems[i++];
+    }
+    while (i < half)
+        tmp[k++] = elems[i++];
+    while (j < nr)
+        tmp[k++] = elems[j++];
+
+    memcpy(elems, tmp, sizeof(pcdoc_element_t) * nr);
+}
+
+static int
+bucket_sort(purc_document_t doc, struct elem_bucket *bucket)
+{
+    if (bucket->nr_elems > 1) {
+        pcdoc_element_t *tmp;
+        tmp = malloc(sizeof(pcdoc_element_t) * bucket->nr_elems);
+        if (tmp == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+
+        sort_elems(doc, bucket->elems, tmp, bucket->nr_elems);
+        free(tmp);
+    }
+
+    bucket->ordered = 1;
+    return 0;
+}
+
+/* Buckets */
+
+static struct elem_bucket *
+bucket_get(struct pchash_table *table, const char *name, size_t len,
+        bool create)
+{
+    char buf[64];
+    char *key = buf;
+
+    if (len >= sizeof(buf) && (key = malloc(len + 1)) == NULL)
+        return NULL;
+    memcpy(key, name, len);
+    key[len] = 0;
+
+    struct elem_bucket *bucket = NULL;
+    pchash_table_lookup_ex(table, key, (void **)&bucket);
+    if (bucket == NULL && create) {
+        bucket = calloc(1, sizeof(*bucket));
+        if (bucket && (bucket->name = strdup(key)) &&
+                pchash_table_insert(table, bucket->name, bucket) == 0) {
+            bucket->ordered = 1;
+        }
+        else if (bucket) {
+            free(bucket->name);
+            free(bucket);
+            bucket = NULL;
+        }
+    }
+
+    if (key != buf)
+        free(key);
+    return bucket;
+}
+
+static int
+bucket_add(purc_document_t doc, struct elem_bucket *bucket,
+        pcdoc_element_t elem, bool in_order)
+{
+    if (bucket->nr_elems == bucket->sz_elems) {
+        size_t sz = bucket->sz_elems ? bucket->sz_elems * 2 : 4;
+        pcdoc_element_t *elems;
+        elems = realloc(bucket->elems, sizeof(pcdoc_element_t) * sz);
+        if (elems == NULL)
+            return -1;
+
+        bucket->elems = elems;
+        bucket->sz_elems = sz;
+    }
+
+    if (!in_order && bucket->ordered && bucket->nr_elems > 0 &&
+            doc_order(doc, bucket->elems[bucket->nr_elems - 1], elem) > 0)
+        bucket->ordered = 0;
+
+    bucket->elems[bucket->nr_elems++] = elem;
+    return 0;
+}
+
+static void
+bucket_remove(struct elem_bucket *bucket, pcdoc_element_t elem)
+{
+    for (size_t i = 0; i < bucket->nr_elems; i++) {
+        if (bucket->elems[i] == elem) {
+            bucket->nr_elems--;
+            memmove(bucket->elems + i, bucket->elems + i + 1,
+                    sizeof(pcdoc_element_t) * (bucket->nr_elems - i));
+            break;
+        }
+    }
+}
+
+/* Adding and removing elements */
+
+typedef void (*bucket_cb)(purc_document_t doc, struct elem_bucket *bucket,
+        pcdoc_element_t elem, void *ctxt);
+
+/* calls cb for the bucket of the id and the class names of the element */
+static void
+for_each_bucket(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_special_attr which, bool create, bucket_cb cb, void *ctxt)
+{
+    struct pcdoc_elem_index *index = doc->index;
+    const char *val;
+    size_t len;
+
+    if (doc->ops->get_special_attr(doc, elem, which, &val, &len) || len == 0)
+        return;
+
+    if (which == PCDOC_ATTR_ID) {
+        struct elem_bucket *bucket;
+        bucket = bucket_get(index->ids, val, len, create);
+        if (bucket)
+            cb(doc, bucket, elem, ctxt);
+        else if (create)
+            index->stale = true;
+        return;
+    }
+
+    const char *end = val + len;
+    while (val < end) {
+        while (val < end && is_class_ws(*val))
+            val++;
+
+        const char *start = val;
+        while (val < end && !is_class_ws(*val))
+            val++;
+
+        if (val > start) {
+            struct elem_bucket *bucket;
+            bucket = bucket_get(index->classes, start, val - start, create);
+            if (bucket)
+                cb(doc, bucket, elem, ctxt);
+            else if (create)
+                index->stale = true;
+        }
+    }
+}
+
+struct addition {
+    pcdoc_element_t         skip;
+    bool                    in_order;
+};
+
+static void
+add_to_bucket(purc_document_t doc, struct elem_bucket *bucket,
+        pcdoc_element_t elem, void *ctxt)
+{
+    struct addition *addition = ctxt;
+
+    /* a class name repeated in the same attribute */
+    if (bucket->nr_elems > 0 && bucket->elems[bucket->nr_elems - 1] == elem)
+        return;
+
+    if (bucket_add(doc, bucket, elem, addition->in_order))
+        doc->index->stale = true;
+}
+
+static void
+remove_from_bucket(purc_document_t doc, struct elem_bucket *bucket,
+        pcdoc_element_t elem, void *ctxt)
+{
+    UNUSED_PARAM(doc);
+    UNUSED_PARAM(ctxt);
+
+    bucket_remove(bucket, elem);
+}
+
+static int
+add_element(purc_document_t doc, pcdoc_element_t elem, void *ctxt)
+{
+    struct addition *addition = ctxt;
+
+    if (elem != addition->skip) {
+        for_each_bucket(doc, elem, PCDOC_ATTR_ID, true,
+                add_to_bucket, addition);
+        for_each_bucket(doc, elem, PCDOC_ATTR_CLASS, true,
+                add_to_bucket, addition);
+    }
+    return 0;
+}
+
+struct removal {
+    pcdoc_element_t         skip;
+    bool                    hit;
+
+    /* the elements to remove */
+    struct pchash_table    *elems;
+    /* the buckets to compact */
+    struct pcutils_arrlist *buckets;
+};
+
+static void
+mark_bucket(purc_document_t doc, struct elem_bucket *bucket,
+        pcdoc_element_t elem, void *ctxt)
+{
+    UNUSED_PARAM(doc);
+    UNUSED_PARAM(elem);
+
+    struct removal *removal = ctxt;
+    removal->hit = true;
+    if (!bucket->pending) {
+        if (pcutils_arrlist_append(removal->buckets, bucket) == 0)
+            bucket->pending = 1;
+    }
+}
+
+static int
+mark_element(purc_document_t doc, pcdoc_element_t elem, void *ctxt)
+{
+    struct removal *removal = ctxt;
+
+    if (elem == removal->skip)
+        return 0;
+
+    removal->hit = false;
+    for_each_bucket(doc, elem, PCDOC_ATTR_ID, false, mark_bucket, removal);
+    for_each_bucket(doc, elem, PCDOC_ATTR_CLASS, false, mark_bucket, removal);
+
+    if (removal->hit &&
+            pchash_table_insert(removal->elems, elem, NULL))
+        return -1;
+    return 0;
+}
+
+static void
+compact_bucket(struct elem_bucket *bucket, struct pchash_table *elems)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < bucket->nr_elems; i++) {
+        if (pchash_table_lookup_entry(elems, bucket->elems[i]) == NULL)
+            bucket->elems[n++] = bucket->elems[i];
+    }
+
+    bucket->nr_elems = n;
+    bucket->pending = 0;
+}
+
+static struct pcdoc_elem_index *
+index_build(purc_document_t doc)
+{
+    struct pcdoc_elem_index *index = calloc(1, sizeof(*index));
+    if (index == NULL)
+        goto failed;
+
+    index->ids = pchash_kstr_table_new(INDEX_INIT_SIZE, bucket_free_entry);
+    index->classes = pchash_kstr_table_new(INDEX_INIT_SIZE,
+            bucket_free_entry);
+    if (index->ids == NULL || index->classes == NULL)
+        goto failed;
+
+    doc->index = index;
+
+    /* the traverse is in document order */
+    struct addition addition = { NULL, true };
+    pcdoc_travel_descendant_elements(doc, NULL, add_element, &addition, NULL);
+    return index;
+
+failed:
+    if (index) {
+        if (index->ids)
+            pchash_table_free(index->ids);
+        if (index->classes)
+            pchash_table_free(index->classes);
+        free(index);
+    }
+    doc->index = NULL;
+    purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    return NULL;
+}
+
+void
+pcdoc_index_destroy(purc_document_t doc)
+{
+    struct pcdoc_elem_index *index = doc->index;
+
+    if (index) {
+        pchash_table_free(index->ids);
+        pchash_table_free(index->classes);
+        free(index);
+        doc->index = NULL;
+    }
+}
+
+void
+pcdoc_index_add_attr(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_special_attr which)
+{
+    if (doc->index) {
+        struct addition addition = { NULL, false };
+        for_each_bucket(doc, elem, which, true, add_to_bucket, &addition);
+    }
+}
+
+void
+pcdoc_index_remove_attr(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_special_attr which)
+{
+    if (doc->index) {
+        for_each_bucket(doc, elem, which, false, remove_from_bucket, NULL);
+    }
+}
+
+void
+pcdoc_index_add_subtree(purc_document_t doc, pcdoc_element_t elem,
+        bool with_self)
+{
+    if (doc->index) {
+        struct addition addition = { with_self ? NULL : elem, false };
+        pcdoc_travel_descendant_elements(doc, elem, add_element,
+                &addition, NULL);
+    }
+}
+
+void
+pcdoc_index_remove_subtree(purc_document_t doc, pcdoc_element_t elem,
+        bool with_self)
+{
+    if (doc->index == NULL)
+        return;
+
+    struct removal removal;
+    removal.skip = with_self ? NULL : elem;
+    removal.elems = pchash_kptr_table_new(INDEX_INIT_SIZE, NULL);
+    removal.buckets = pcutils_arrlist_new_ex(NULL, 8);
+    if (removal.elems == NULL || removal.buckets == NULL) {
+        /* better to lose the index than to keep dangling elements */
+        pcdoc_index_destroy(doc);
+        goto done;
+    }
+
+    if (pcdoc_travel_descendant_elements(doc, elem, mark_element,
+                &removal, NULL)) {
+        /* some elements could not be recorded */
+        for (size_t i = 0; i < pcutils_arrlist_length(removal.buckets); i++) {
+            struct elem_bucket *bucket;
+            bucket = pcutils_arrlist_get_idx(removal.buckets, i);
+            bucket->pending = 0;
+        }
+        pcdoc_index_destroy(doc);
+        goto done;
+    }
+
+    size_t n = pcutils_arrlist_length(removal.buckets);
+    for (size_t i = 0; i < n; i++) {
+        compact_bucket(pcutils_arrlist_get_idx(removal.buckets, i),
+                removal.elems);
+    }
+
+done:
+    if (removal.elems)
+        pchash_table_free(removal.elems);
+    if (removal.buckets)
+        pcutils_arrlist_free(removal.buckets);
+}
+
+int
+pcdoc_index_lookup(purc_document_t doc, pcdoc_special_attr which,
+        const char *name, size_t len, pcdoc_element_t **elems, size_t *nr)
+{
+    if (!doc->maintain_index)
+        return -1;
+
+    struct pcdoc_elem_index *index = doc->index;
+    if (index && index->stale) {
+        pcdoc_index_destroy(doc);
+        index = NULL;
+    }
+
+    if (index == NULL && (index = index_build(doc)) == NULL)
+        return -1;
+
+    struct elem_bucket *bucket;
+    bucket = bucket_get(which == PCDOC_ATTR_ID ? index->ids : index->classes,
+            name, len, false);
+    if (bucket == NULL || bucket->nr_elems == 0) {
+        *elems = NULL;
+        *nr = 0;
+        return 0;
+    }
+
+    if (!bucket->ordered && bucket_sort(doc, bucket))
+        return -1;
+
+    *elems = bucket->elems;
+    *nr = bucket->nr_elems;
+    return 0;
+}
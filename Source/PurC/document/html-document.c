@@ -63,6 +63,7 @@ static purc_document_t create(const char *content, size_t length)
     doc->data_content = 0;
     doc->have_head = 1;
     doc->have_body = 1;
+    doc->maintain_index = 1;
 
     doc->refc = 1;
 
@@ -75,6 +76,7 @@ static purc_document_t create(const char *content, size_t length)
 static void destroy(purc_document_t doc)
 {
     assert(doc->impl);
+    pcdoc_index_destroy(doc);
     pchtml_html_document_destroy(doc->impl);
     free(doc);
 }
@@ -158,10 +160,12 @@ static pcdoc_element_t operate_element(purc_document_t doc,
     UNUSED_PARAM(self_close);
 
     if (op == PCDOC_OP_ERASE) {
+        pcdoc_index_remove_subtree(doc, elem, true);
         dom_erase_element(pcdom_interface_element(elem));
         return NULL;
     }
     else if (op == PCDOC_OP_CLEAR) {
+        pcdoc_index_remove_subtree(doc, elem, false);
         dom_clear_element(pcdom_interface_element(elem));
         return elem;
     }
@@ -171,6 +175,10 @@ static pcdoc_element_t operate_element(purc_document_t doc,
         return NULL;
     }
 
+    /* the new element has no attribute to index yet */
+    if (op == PCDOC_OP_DISPLACE)
+        pcdoc_index_remove_subtree(doc, elem, false);
+
     pcdom_element_t *dom_elem = pcdom_interface_element(elem);
     pcdom_document_t *dom_doc = pcdom_interface_document(doc->impl);
     pcdom_element_t *new_elem;
@@ -203,6 +211,8 @@ static pcdoc_text_node_t new_text_content(purc_document_t doc,
     text_node = pcdom_document_create_text_node(dom_doc,
             (const unsigned char *)text, length ? length : strlen(text));
     if (text_node) {
+        if (op == PCDOC_OP_DISPLACE)
+            pcdoc_index_remove_subtree(doc, elem, false);
         dom_node_ops[op](dom_elem, pcdom_interface_node(text_node));
     }
     else {
@@ -366,6 +376,35 @@ static const dom_subtree_op dom_subtree_ops[] = {
     dom_displace_content_by_subtree,
 };
 
+/*
+ * Collects the top-level elements of a parsed fragment, which are to be
+ * indexed once moved into the document.
+ */
+static int
+dom_fragment_elements(purc_document_t doc, pcdom_node_t *subtree,
+        struct pcutils_arrlist **elems)
+{
+    *elems = NULL;
+    if (doc->index == NULL || subtree->first_child == NULL)
+        return 0;
+
+    *elems = pcutils_arrlist_new_ex(NULL, 4);
+    if (*elems == NULL)
+        return -1;
+
+    pcdom_node_t *child = subtree->first_child->first_child;
+    for (; child; child = child->next) {
+        if (child->type == PCDOM_NODE_TYPE_ELEMENT &&
+                pcutils_arrlist_append(*elems, child)) {
+            pcutils_arrlist_free(*elems);
+            *elems = NULL;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 static pcdoc_node new_content(purc_document_t doc,
             pcdoc_element_t elem, pcdoc_operation op,
             const char *content, size_t length)
@@ -385,7 +424,24 @@ static pcdoc_node new_content(purc_document_t doc,
             content, length ? length : strlen(content));
 
     if (subtree) {
+        struct pcutils_arrlist *elems;
+        if (dom_fragment_elements(doc, subtree, &elems)) {
+            /* out of memory; rebuild the indexes on next lookup */
+            pcdoc_index_destroy(doc);
+        }
+
+        if (op == PCDOC_OP_DISPLACE)
+            pcdoc_index_remove_subtree(doc, elem, false);
         dom_subtree_ops[op](dom_elem, subtree);
+
+        if (elems) {
+            size_t n = pcutils_arrlist_length(elems);
+            for (size_t i = 0; i < n; i++) {
+                pcdoc_index_add_subtree(doc,
+                        pcutils_arrlist_get_idx(elems, i), true);
+            }
+            pcutils_arrlist_free(elems);
+        }
     }
     else {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
@@ -425,24 +481,37 @@ static int set_attribute(purc_document_t doc,
             pcdoc_element_t elem, pcdoc_operation op,
             const char *name, const char *val, size_t len)
 {
-    UNUSED_PARAM(doc);
-
     pcdom_element_t *dom_elem = pcdom_interface_element(elem);
+    int retv;
+
+    int which = -1;
+    if (pcutils_strcasecmp(name, "id") == 0)
+        which = PCDOC_ATTR_ID;
+    else if (pcutils_strcasecmp(name, "class") == 0)
+        which = PCDOC_ATTR_CLASS;
+
+    if (which >= 0)
+        pcdoc_index_remove_attr(doc, elem, (pcdoc_special_attr)which);
+
     if (op == PCDOC_OP_ERASE) {
-        return dom_remove_element_attr(dom_elem, name);
+        retv = dom_remove_element_attr(dom_elem, name);
     }
     else if (op == PCDOC_OP_CLEAR) {
-        return dom_set_element_attribute(dom_elem, name, "", 0);
+        retv = dom_set_element_attribute(dom_elem, name, "", 0);
     }
     else if (op == PCDOC_OP_DISPLACE) {
-        return dom_set_element_attribute(dom_elem, name,
+        retv = dom_set_element_attribute(dom_elem, name,
                 val, len ? len : strlen(val));
     }
     else {
         purc_set_error(PURC_ERROR_INVALID_VALUE);
+        retv = -1;
     }
 
-    return -1;
+    if (which >= 0)
+        pcdoc_index_add_attr(doc, elem, (pcdoc_special_attr)which);
+
+    return retv;
 }
 
 static pcdoc_element_t special_elem(purc_document_t doc,
@@ -472,11 +541,37 @@ static pcdoc_element_t get_parent(purc_document_t doc, pcdoc_node node)
 
     pcdom_node_t *dom_node = pcdom_interface_node(node.elem);
 
-    assert(dom_node->parent->type == PCDOM_NODE_TYPE_ELEMENT);
+    /* the parent of the root element is the document */
+    if (dom_node->parent == NULL ||
+            dom_node->parent->type != PCDOM_NODE_TYPE_ELEMENT)
+        return NULL;
 
     return (pcdoc_element_t)dom_node->parent;
 }
 
+static pcdoc_element_t get_sibling_elem(purc_document_t doc,
+        pcdoc_element_t elem, bool next)
+{
+    UNUSED_PARAM(doc);
+
+    pcdom_node_t *dom_node = pcdom_interface_node(elem);
+    do {
+        dom_node = next ? dom_node->next : dom_node->prev;
+    } while (dom_node && dom_node->type != PCDOM_NODE_TYPE_ELEMENT);
+
+    return (pcdoc_element_t)dom_node;
+}
+
+static int get_tag_name(purc_document_t doc, pcdoc_element_t elem,
+        const char **local_name, size_t *local_len)
+{
+    UNUSED_PARAM(doc);
+
+    pcdom_element_t *dom_elem = pcdom_interface_element(elem);
+    *local_name = (const char *)pcdom_element_local_name(dom_elem, local_len);
+    return *local_name ? 0 : -1;
+}
+
 static int children_count(purc_document_t doc, pcdoc_element_t elem,
         size_t *nrs)
 {
@@ -636,21 +731,18 @@ travel(purc_document_t doc, pcdoc_element_t ancestor,
 
     pcdom_node_t *child = dom_node->first_child;
     for (; child; child = child->next) {
-        if (node_type(child->type) == info->type) {
+        if (child->type == PCDOM_NODE_TYPE_ELEMENT) {
+            /* the recursive call visits the child element itself */
+            int r = travel(doc, (pcdoc_element_t)child, cb, info);
+            if (r)
+                return -1;
+        }
+        else if (node_type(child->type) == info->type) {
             int r = cb(doc, child, info->ctxt);
             if (r)
                 return -1;
             info->nr++;
         }
-
-        if (child->type == PCDOM_NODE_TYPE_ELEMENT) {
-            pcdoc_element_t elem = (pcdoc_element_t)child;
-            if (child->first_child) {
-                int r = travel(doc, elem, cb, info);
-                if (r)
-                    return -1;
-            }
-        }
     }
 
     return 0;
@@ -677,6 +769,8 @@ struct purc_document_ops _pcdoc_html_ops = {
     .set_attribute = set_attribute,
     .special_elem = special_elem,
     .get_parent = get_parent,
+    .get_sibling_elem = get_sibling_elem,
+    .get_tag_name = get_tag_name,
     .children_count = children_count,
     .get_child = get_child,
     .get_attribute = get_attribute,
@@ -685,7 +779,8 @@ struct purc_document_ops _pcdoc_html_ops = {
     .get_data = NULL,
     .travel = travel,
     .serialize = serialize,
-    .elem_coll_select = NULL,
-    .elem_coll_filter = NULL,
+    .find_elem = pcdoc_selector_find_elem,
+    .elem_coll_select = pcdoc_selector_elem_coll_select,
+    .elem_coll_filter = pcdoc_selector_elem_coll_filter,
 };
 
@@ -31,6 +31,7 @@
 #include "private/errors.h"
 #include "private/atom-buckets.h"
 #include "private/dvobjs.h"
+#include "private/ejson.h"
 #include "private/utils.h"
 #include "private/utf8.h"
 #include "helper.h"
@@ -613,13 +614,17 @@ parse_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         goto failed;
     }
 
+    purc_variant_t retv;
+    retv = pcejson_parse_json(string, length, PCEJSON_DEFAULT_DEPTH, NULL);
+    if (retv != PURC_VARIANT_INVALID)
+        return retv;
+
     struct purc_ejson_parse_tree *ptree;
     ptree = purc_variant_ejson_parse_string(string, length);
     if (ptree == NULL) {
         goto failed;
     }
 
-    purc_variant_t retv;
     retv = purc_variant_ejson_parse_tree_evalute(ptree, NULL, NULL, silently);
     purc_variant_ejson_parse_tree_destroy(ptree);
     return retv;
@@ -1930,9 +1935,7 @@ shuffle_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
         ssize_t sz = purc_variant_array_get_size(argv[0]);
 
         if (sz > 1) {
-            struct pcutils_array_list *al = variant_array_get_data(argv[0]);
-            struct pcutils_array_list_node *p;
-            array_list_for_each(al, p) {
+            for (size_t idx = 0; idx < (size_t)sz; idx++) {
 
                 size_t new_idx;
                 if (sz < RAND_MAX) {
@@ -1943,8 +1946,8 @@ shuffle_getter(purc_variant_t root, size_t nr_args, purc_variant_t *argv,
                     new_idx = new_idx * sz / RAND_MAX;
                 }
 
-                if (new_idx != p->idx)
-                    pcutils_array_list_swap(al, p->idx, new_idx);
+                if (new_idx != idx)
+                    pcvariant_array_swap(argv[0], idx, new_idx);
             }
         }
     }
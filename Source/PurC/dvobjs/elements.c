@@ -26,6 +26,7 @@
 #include "purc-errors.h"
 
 #include "private/dvobjs.h"
+#include "private/document.h"
 #include "private/stringbuilder.h"
 
 #include "internal.h"
@@ -486,53 +487,13 @@ add_element(struct pcdvobjs_elements *elements, pcdoc_element_t elem)
     return true;
 }
 
-struct visit_args {
-    struct pcdvobjs_elements *elements;
-    const char               *css;
-};
-
-static bool
-match_by_class(purc_document_t doc, pcdoc_element_t element,
-        struct visit_args *args)
-{
-    bool found = false;
-    pcdoc_element_has_class(doc, element, args->css + 1, &found);
-    return found;
-}
-
-static bool
-match_by_id(purc_document_t doc, pcdoc_element_t element,
-        struct visit_args *args)
-{
-    const char *s;
-    size_t len;
-    s = pcdoc_element_id(doc, element, &len);
-
-    if (s && s[len]=='\0' &&
-            strncmp(s, args->css + 1, len)==0 &&
-            args->css[1+len]=='\0')
-    {
-        return true;
-    }
-
-    return false;
-}
-
 static int
 visit_element(purc_document_t doc, pcdoc_element_t element, void *ud)
 {
-    struct visit_args *args = (struct visit_args*)ud;
-
-    if (args->css[0] == '.') {
-        if (!match_by_class(doc, element, args))
-            return 0;
-    }
-    else if (args->css[0] == '#') {
-        if (!match_by_id(doc, element, args))
-            return 0;
-    }
+    UNUSED_PARAM(doc);
 
-    if (!add_element(args->elements, element))
+    struct pcdvobjs_elements *elements = (struct pcdvobjs_elements*)ud;
+    if (!add_element(elements, element))
         return -1;
 
     return 0;
@@ -542,20 +503,16 @@ purc_variant_t
 pcdvobjs_query_elements(purc_document_t doc, pcdoc_element_t root,
         const char *css)
 {
-    if (strcmp(css, "*") != 0) {
-        if (css[0] != '.' && css[0] != '#') {
-            pcinst_set_error(PURC_ERROR_ARGUMENT_MISSED);
-            return PURC_VARIANT_INVALID;
-        }
-        if (css[1] == '\0') {
-            pcinst_set_error(PURC_ERROR_ARGUMENT_MISSED);
-            return PURC_VARIANT_INVALID;
-        }
-    }
+    /* compiled once, then served by the selector cache */
+    pcdoc_selector_t selector = pcdoc_selector_new(css);
+    if (selector == NULL)
+        return PURC_VARIANT_INVALID;
 
     purc_variant_t elements = make_elements();
-    if (elements == PURC_VARIANT_INVALID)
+    if (elements == PURC_VARIANT_INVALID) {
+        pcdoc_selector_delete(selector);
         return PURC_VARIANT_INVALID;
+    }
 
     PC_ASSERT(purc_variant_is_type(elements, PURC_VARIANT_TYPE_NATIVE));
     void *entity = purc_variant_native_get_entity(elements);
@@ -566,16 +523,13 @@ pcdvobjs_query_elements(purc_document_t doc, pcdoc_element_t root,
     elems->css = strdup(css);
     if (elems->css == NULL) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        pcdoc_selector_delete(selector);
         purc_variant_unref(elements);
         return PURC_VARIANT_INVALID;
     }
 
-    struct visit_args args;
-    args.elements = (struct pcdvobjs_elements*)entity;
-    args.css      = css;
-
-    int r = pcdoc_travel_descendant_elements(doc, root,
-            visit_element, &args, NULL);
+    int r = pcdoc_selector_travel(doc, root, selector, visit_element, elems);
+    pcdoc_selector_delete(selector);
     if (r) {
         purc_variant_unref(elements);
         return PURC_VARIANT_INVALID;
@@ -29,45 +29,37 @@
 #include "purc-variant.h"
 #include "helper.h"
 
+#include "private/regex.h"
+
 #include <math.h>
 #include <regex.h>
 
 static bool reg_cmp(const char *buf1, const char *buf2)
 {
-    regex_t reg;
-    int err = 0;
-    int number = 10;
-    regmatch_t pmatch[number];
-
     if ((buf1 == NULL) || (buf2 == NULL))
         return false;
 
-    if (regcomp(&reg, buf1, REG_EXTENDED) < 0) {
-        goto error;
-    }
-
-    err = regexec(&reg, buf2, number, pmatch, 0);
-
-    if (err == REG_NOMATCH) {
-        goto error_free;
-    }
-    else if (err) {
-        goto error_free;
-    }
-
-    if (pmatch[0].rm_so == -1) {
-        goto error_free;
+#if HAVE(GLIB)
+    /* the pattern is compiled once and then served by the regex cache */
+    struct pcregex *regex = pcregex_lookup(buf1, 0, 0);
+    if (regex == NULL) {
+        purc_clr_error();
+        return false;
     }
 
-    regfree(&reg);
+    bool matched = pcregex_match(regex, buf2, NULL);
+    pcregex_destroy(regex);
+    return matched;
+#else
+    regex_t reg;
 
-    return true;
+    if (regcomp(&reg, buf1, REG_EXTENDED | REG_NOSUB) != 0)
+        return false;
 
-error_free:
+    int err = regexec(&reg, buf2, 0, NULL, 0);
     regfree(&reg);
-
-error:
-    return false;
+    return err == 0;
+#endif
 }
 
 static purc_variant_t
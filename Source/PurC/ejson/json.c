@@ -0,0 +1,491 @@
+/*
+ * @file json.c
+ * @date 2022/09/20
+ * @brief The fast path to parse plain JSON into variants directly.
+ *
+ * Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The parser here only accepts the subset of JSON which the eJSON parser
+ * evaluates to a constant, and it must give exactly the same result:
+ *
+ *  - the whitespaces are the ones of eJSON (no carriage return);
+ *  - a `$` in a double-quoted string introduces an expression in eJSON,
+ *    so it is left to the eJSON parser;
+ *  - the escape sequences `\b`, `\f`, `\n`, `\r`, `\t`, and `\uXXXX` are
+ *    kept as is, while `\$`, `\{`, `\}`, `\<`, `\>`, `\/`, `\\`, and `\"`
+ *    are replaced by the escaped character;
+ *  - the four-byte UTF-8 sequences are rejected by the eJSON reader.
+ *
+ * For anything else, the parser gives up silently, and the caller falls
+ * back to pcejson_parse(), which also reports the error if there is one.
+ */
+
+#include "config.h"
+
+#include "private/ejson.h"
+#include "purc-variant.h"
+#include "purc-utils.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_NUMBER_LEN      64
+#define MAX_EXACT_DIGITS    15
+
+struct json_parser {
+    const char *p;
+    const char *end;
+    uint32_t depth;
+    uint32_t max_depth;
+
+    /* the buffer to unescape the strings */
+    char *buf;
+    size_t sz_buf;
+};
+
+static purc_variant_t parse_value(struct json_parser *parser);
+
+static inline bool is_ws(char c)
+{
+    return c == ' ' || c == 0x0A || c == 0x09 || c == 0x0C;
+}
+
+static inline void skip_ws(struct json_parser *parser)
+{
+    while (parser->p < parser->end && is_ws(*parser->p))
+        parser->p++;
+}
+
+static inline bool at_end(struct json_parser *parser)
+{
+    /* a null byte ends the input as it does for the eJSON parser */
+    return parser->p == parser->end || *parser->p == 0;
+}
+
+#define ONES    ((uint64_t)0x0101010101010101ULL)
+#define HIGHS   ((uint64_t)0x8080808080808080ULL)
+
+/* may report false positives after the first matched byte only */
+static inline uint64_t has_zero_byte(uint64_t v)
+{
+    return (v - ONES) & ~v & HIGHS;
+}
+
+/* whether the word contains `"`, `\`, `$`, a null byte, or a non-ASCII byte */
+static inline bool has_special_byte(uint64_t w)
+{
+    return (has_zero_byte(w ^ (ONES * '"')) |
+            has_zero_byte(w ^ (ONES * '\\')) |
+            has_zero_byte(w ^ (ONES * '$')) |
+            has_zero_byte(w) | (w & HIGHS)) != 0;
+}
+
+static int unescaped_char(char c)
+{
+    switch (c) {
+    case '$':
+    case '{':
+    case '}':
+    case '<':
+    case '>':
+    case '/':
+    case '\\':
+    case '"':
+        return c;
+    }
+    return 0;
+}
+
+static inline bool is_hex_digit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') ||
+        (c >= 'A' && c <= 'F');
+}
+
+static purc_variant_t unescape_string(struct json_parser *parser,
+        const char *str, size_t len)
+{
+    if (len > parser->sz_buf) {
+        size_t sz = parser->sz_buf ? parser->sz_buf : 128;
+        while (sz < len)
+            sz *= 2;
+        char *buf = realloc(parser->buf, sz);
+        if (buf == NULL)
+            return PURC_VARIANT_INVALID;
+        parser->buf = buf;
+        parser->sz_buf = sz;
+    }
+
+    const char *end = str + len;
+    char *q = parser->buf;
+    while (str < end) {
+        const char *bs = memchr(str, '\\', end - str);
+        size_t n = (bs ? bs : end) - str;
+        memcpy(q, str, n);
+        q += n;
+        str += n;
+        if (bs == NULL)
+            break;
+
+        int c = unescaped_char(bs[1]);
+        if (c) {
+            *q++ = c;
+            str += 2;
+        }
+        else {
+            /* keep the escape sequence as the eJSON parser does */
+            *q++ = *str++;
+        }
+    }
+
+    return purc_variant_make_string_ex(parser->buf, q - parser->buf, false);
+}
+
+/* parser->p points to the opening double quote */
+static purc_variant_t parse_string(struct json_parser *parser)
+{
+    const char *start = ++parser->p;
+    const char *p = start;
+    const char *end = parser->end;
+    bool escaped = false;
+    bool non_ascii = false;
+
+    while (true) {
+        while (end - p >= 8) {
+            uint64_t w;
+            memcpy(&w, p, sizeof(w));
+            if (has_special_byte(w))
+                break;
+            p += 8;
+        }
+
+        if (p == end)
+            return PURC_VARIANT_INVALID;
+
+        unsigned char c = *p;
+        if (c == '"')
+            break;
+
+        if (c == '\\') {
+            if (end - p < 2)
+                return PURC_VARIANT_INVALID;
+
+            switch (p[1]) {
+            case 'b':
+            case 'f':
+            case 'n':
+            case 'r':
+            case 't':
+                p += 2;
+                break;
+            case 'u':
+                if (end - p < 6 || !is_hex_digit(p[2]) ||
+                        !is_hex_digit(p[3]) || !is_hex_digit(p[4]) ||
+                        !is_hex_digit(p[5]))
+                    return PURC_VARIANT_INVALID;
+                p += 6;
+                break;
+            default:
+                if (!unescaped_char(p[1]))
+                    return PURC_VARIANT_INVALID;
+                escaped = true;
+                p += 2;
+                break;
+            }
+            continue;
+        }
+
+        if (c == '$' || c == 0 || c >= 0xF0)
+            return PURC_VARIANT_INVALID;
+        if (c >= 0x80)
+            non_ascii = true;
+        p++;
+    }
+
+    size_t len = p - start;
+    parser->p = p + 1;
+
+    if (non_ascii) {
+        size_t nr_chars;
+        if (!pcutils_string_check_utf8_len(start, len, &nr_chars, NULL))
+            return PURC_VARIANT_INVALID;
+    }
+
+    if (escaped)
+        return unescape_string(parser, start, len);
+    return purc_variant_make_string_ex(start, len, false);
+}
+
+static purc_variant_t parse_number(struct json_parser *parser)
+{
+    const char *start = parser->p;
+    const char *p = start;
+    const char *end = parser->end;
+    bool negative = false;
+    bool integer = true;
+    uint64_t u64 = 0;
+
+    if (*p == '-') {
+        negative = true;
+        p++;
+    }
+
+    if (p == end || *p < '0' || *p > '9')
+        return PURC_VARIANT_INVALID;
+
+    if (*p == '0') {
+        p++;
+    }
+    else {
+        while (p < end && *p >= '0' && *p <= '9') {
+            u64 = u64 * 10 + (*p - '0');
+            p++;
+        }
+    }
+    size_t nr_digits = p - start - (negative ? 1 : 0);
+
+    if (p < end && *p == '.') {
+        integer = false;
+        p++;
+        if (p == end || *p < '0' || *p > '9')
+            return PURC_VARIANT_INVALID;
+        while (p < end && *p >= '0' && *p <= '9')
+            p++;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        integer = false;
+        p++;
+        if (p < end && (*p == '+' || *p == '-'))
+            p++;
+        if (p == end || *p < '0' || *p > '9')
+            return PURC_VARIANT_INVALID;
+        while (p < end && *p >= '0' && *p <= '9')
+            p++;
+    }
+
+    parser->p = p;
+
+    /* the integers with no more than 15 digits are exact in double */
+    if (integer && nr_digits <= MAX_EXACT_DIGITS) {
+        double d = (double)u64;
+        return purc_variant_make_number(negative ? -d : d);
+    }
+
+    char buf[MAX_NUMBER_LEN];
+    size_t len = p - start;
+    if (len >= sizeof(buf))
+        return PURC_VARIANT_INVALID;
+    memcpy(buf, start, len);
+    buf[len] = 0;
+    return purc_variant_make_number(strtod(buf, NULL));
+}
+
+static purc_variant_t parse_keyword(struct json_parser *parser)
+{
+    size_t left = parser->end - parser->p;
+
+    if (left >= 4 && memcmp(parser->p, "true", 4) == 0) {
+        parser->p += 4;
+        return purc_variant_make_boolean(true);
+    }
+    if (left >= 5 && memcmp(parser->p, "false", 5) == 0) {
+        parser->p += 5;
+        return purc_variant_make_boolean(false);
+    }
+    if (left >= 4 && memcmp(parser->p, "null", 4) == 0) {
+        parser->p += 4;
+        return purc_variant_make_null();
+    }
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t parse_object(struct json_parser *parser)
+{
+    if (++parser->depth > parser->max_depth)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t object = purc_variant_make_object(0,
+            PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
+    if (object == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    parser->p++;
+    skip_ws(parser);
+    if (parser->p < parser->end && *parser->p == '}') {
+        parser->p++;
+        goto done;
+    }
+
+    while (true) {
+        if (parser->p == parser->end || *parser->p != '"')
+            goto failed;
+
+        purc_variant_t key = parse_string(parser);
+        if (key == PURC_VARIANT_INVALID)
+            goto failed;
+
+        skip_ws(parser);
+        if (parser->p == parser->end || *parser->p != ':') {
+            purc_variant_unref(key);
+            goto failed;
+        }
+        parser->p++;
+        skip_ws(parser);
+
+        purc_variant_t value = parse_value(parser);
+        if (value == PURC_VARIANT_INVALID) {
+            purc_variant_unref(key);
+            goto failed;
+        }
+
+        bool ok = purc_variant_object_set(object, key, value);
+        purc_variant_unref(key);
+        purc_variant_unref(value);
+        if (!ok)
+            goto failed;
+
+        skip_ws(parser);
+        if (parser->p == parser->end)
+            goto failed;
+        if (*parser->p == '}') {
+            parser->p++;
+            break;
+        }
+        if (*parser->p != ',')
+            goto failed;
+        parser->p++;
+        skip_ws(parser);
+    }
+
+done:
+    parser->depth--;
+    return object;
+
+failed:
+    purc_variant_unref(object);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t parse_array(struct json_parser *parser)
+{
+    if (++parser->depth > parser->max_depth)
+        return PURC_VARIANT_INVALID;
+
+    purc_variant_t array = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    if (array == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    parser->p++;
+    skip_ws(parser);
+    if (parser->p < parser->end && *parser->p == ']') {
+        parser->p++;
+        goto done;
+    }
+
+    while (true) {
+        purc_variant_t v = parse_value(parser);
+        if (v == PURC_VARIANT_INVALID)
+            goto failed;
+
+        bool ok = purc_variant_array_append(array, v);
+        purc_variant_unref(v);
+        if (!ok)
+            goto failed;
+
+        skip_ws(parser);
+        if (parser->p == parser->end)
+            goto failed;
+        if (*parser->p == ']') {
+            parser->p++;
+            break;
+        }
+        if (*parser->p != ',')
+            goto failed;
+        parser->p++;
+        skip_ws(parser);
+    }
+
+done:
+    parser->depth--;
+    return array;
+
+failed:
+    purc_variant_unref(array);
+    return PURC_VARIANT_INVALID;
+}
+
+static purc_variant_t parse_value(struct json_parser *parser)
+{
+    if (parser->p == parser->end)
+        return PURC_VARIANT_INVALID;
+
+    switch (*parser->p) {
+    case '{':
+        return parse_object(parser);
+    case '[':
+        return parse_array(parser);
+    case '"':
+        /* `"""` starts a triple-quoted string of eJSON */
+        if (parser->end - parser->p >= 3 &&
+                parser->p[1] == '"' && parser->p[2] == '"')
+            return PURC_VARIANT_INVALID;
+        return parse_string(parser);
+    case 't':
+    case 'f':
+    case 'n':
+        return parse_keyword(parser);
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+        return parse_number(parser);
+    }
+
+    return PURC_VARIANT_INVALID;
+}
+
+purc_variant_t pcejson_parse_json(const char *json, size_t sz,
+        uint32_t depth, size_t *consumed)
+{
+    struct json_parser parser = {
+        .p = json,
+        .end = json + sz,
+        .depth = 0,
+        .max_depth = depth > 0 ? depth : PCEJSON_DEFAULT_DEPTH,
+        .buf = NULL,
+        .sz_buf = 0,
+    };
+
+    skip_ws(&parser);
+    purc_variant_t v = parse_value(&parser);
+    if (v != PURC_VARIANT_INVALID) {
+        skip_ws(&parser);
+        if (!at_end(&parser)) {
+            purc_variant_unref(v);
+            v = PURC_VARIANT_INVALID;
+        }
+        else if (consumed) {
+            *consumed = parser.p - json;
+        }
+    }
+
+    free(parser.buf);
+    return v;
+}
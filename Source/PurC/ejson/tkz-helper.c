@@ -42,6 +42,10 @@
 #define NR_CONSUMED_LIST_LIMIT   10
 #define MIN_BUFFER_CAPACITY      32
 
+/* must be a power of 2 and larger than NR_CONSUMED_LIST_LIMIT */
+#define NR_RING_UCS              16
+#define RING_UCS_MASK            (NR_RING_UCS - 1)
+
 #if HAVE(GLIB)
 #define    PCHVML_ALLOC(sz)   g_slice_alloc0(sz)
 #define    PCHVML_FREE(p)     g_slice_free1(sizeof(*p), (gpointer)p)
@@ -50,11 +54,23 @@
 #define    PCHVML_FREE(p)     free(p)
 #endif
 
+/*
+ * The characters decoded from the rwstream are kept in a ring buffer, so
+ * that the last NR_CONSUMED_LIST_LIMIT characters can be reconsumed
+ * without any memory allocation:
+ *
+ *  - `nr_decoded` is the number of characters decoded from the rwstream;
+ *  - `next` is the (unmasked) index of the next character to return;
+ *    `next < nr_decoded` means there are characters to reconsume;
+ *  - `nr_consumed` is the number of characters which can be reconsumed.
+ */
 struct tkz_reader {
     purc_rwstream_t rws;
-    struct list_head reconsume_list;
-    struct list_head consumed_list;
-    size_t nr_consumed_list;
+
+    struct tkz_uc ring[NR_RING_UCS];
+    size_t nr_decoded;
+    size_t next;
+    size_t nr_consumed;
 
     struct tkz_uc curr_uc;
     int line;
@@ -62,26 +78,15 @@ struct tkz_reader {
     int consumed;
 };
 
-struct tkz_uc *tkz_uc_new(void)
-{
-    return PCHVML_ALLOC(sizeof(struct tkz_uc));
-}
-
-void tkz_uc_destroy(struct tkz_uc *uc)
-{
-    if (uc) {
-        PCHVML_FREE(uc);
-    }
-}
-
 struct tkz_reader *tkz_reader_new(void)
 {
     struct tkz_reader *reader = PCHVML_ALLOC(sizeof(struct tkz_reader));
     if (!reader) {
         return NULL;
     }
-    INIT_LIST_HEAD(&reader->reconsume_list);
-    INIT_LIST_HEAD(&reader->consumed_list);
+    reader->nr_decoded = 0;
+    reader->next = 0;
+    reader->nr_consumed = 0;
     reader->line = 1;
     reader->column = 0;
     reader->consumed = 0;
@@ -94,10 +99,10 @@ void tkz_reader_set_rwstream(struct tkz_reader *reader,
     reader->rws = rws;
 }
 
-static struct tkz_uc*
-tkz_reader_read_from_rwstream(struct tkz_reader *reader)
+static void
+tkz_reader_read_from_rwstream(struct tkz_reader *reader, struct tkz_uc *puc)
 {
-    char c[8] = {0};
+    char c[8];
     uint32_t uc = 0;
     int nr_c = purc_rwstream_read_utf8_char(reader->rws, c, &uc);
     if (nr_c < 0) {
@@ -106,113 +111,46 @@ tkz_reader_read_from_rwstream(struct tkz_reader *reader)
     reader->column++;
     reader->consumed++;
 
-    reader->curr_uc.character = uc;
-    reader->curr_uc.line = reader->line;
-    reader->curr_uc.column = reader->column;
-    reader->curr_uc.position = reader->consumed;
+    puc->character = uc;
+    puc->line = reader->line;
+    puc->column = reader->column;
+    puc->position = reader->consumed;
     if (uc == '\n') {
         reader->line++;
         reader->column = 0;
     }
-    return &reader->curr_uc;
-}
-
-static struct tkz_uc*
-tkz_reader_read_from_reconsume_list(struct tkz_reader *reader)
-{
-    struct tkz_uc *puc = list_entry(reader->reconsume_list.next,
-            struct tkz_uc, list);
-    reader->curr_uc = *puc;
-    list_del_init(&puc->list);
-    tkz_uc_destroy(puc);
-    return &reader->curr_uc;
-}
-
-#define print_uc_list(uc_list, tag)                                         \
-    do {                                                                    \
-        PC_DEBUG("begin print %s list\n|", tag);                            \
-        struct list_head *p, *n;                                            \
-        list_for_each_safe(p, n, uc_list) {                                 \
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);        \
-            PC_DEBUG("%c", puc->character);                                 \
-        }                                                                   \
-        PC_DEBUG("|\nend print %s list\n", tag);                            \
-    } while(0)
-
-#define PRINT_CONSUMED_LIST(reader)    \
-        print_uc_list(&reader->consumed_list, "consumed")
-
-#define PRINT_RECONSUM_LIST(reader)    \
-        print_uc_list(&reader->reconsume_list, "reconsume")
-
-static bool
-tkz_reader_add_consumed(struct tkz_reader *reader, struct tkz_uc *uc)
-{
-    struct tkz_uc *p = tkz_uc_new();
-    if (!p) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return false;
-    }
-
-    *p = *uc;
-    list_add_tail(&p->list, &reader->consumed_list);
-    reader->nr_consumed_list++;
-
-    if (reader->nr_consumed_list > NR_CONSUMED_LIST_LIMIT) {
-        struct tkz_uc *first = list_first_entry(
-                &reader->consumed_list, struct tkz_uc, list);
-        list_del_init(&first->list);
-        tkz_uc_destroy(first);
-        reader->nr_consumed_list--;
-    }
-    return true;
 }
 
 bool tkz_reader_reconsume_last_char(struct tkz_reader *reader)
 {
-    if (!reader->nr_consumed_list) {
-        return true;
+    if (reader->nr_consumed) {
+        reader->nr_consumed--;
+        reader->next--;
     }
-
-    struct tkz_uc *last = list_last_entry(
-            &reader->consumed_list, struct tkz_uc, list);
-    list_del_init(&last->list);
-    reader->nr_consumed_list--;
-
-    list_add(&last->list, &reader->reconsume_list);
     return true;
 }
 
 struct tkz_uc *tkz_reader_next_char(struct tkz_reader *reader)
 {
-    struct tkz_uc *ret = NULL;
-    if (list_empty(&reader->reconsume_list)) {
-        ret = tkz_reader_read_from_rwstream(reader);
-    }
-    else {
-        ret = tkz_reader_read_from_reconsume_list(reader);
+    struct tkz_uc *puc = reader->ring + (reader->next & RING_UCS_MASK);
+
+    if (reader->next == reader->nr_decoded) {
+        tkz_reader_read_from_rwstream(reader, puc);
+        reader->nr_decoded++;
     }
+    reader->next++;
 
-    if (tkz_reader_add_consumed(reader, ret)) {
-        return ret;
+    if (reader->nr_consumed < NR_CONSUMED_LIST_LIMIT) {
+        reader->nr_consumed++;
     }
-    return NULL;
+
+    reader->curr_uc = *puc;
+    return &reader->curr_uc;
 }
 
 void tkz_reader_destroy(struct tkz_reader *reader)
 {
     if (reader) {
-        struct list_head *p, *n;
-        list_for_each_safe(p, n, &reader->reconsume_list) {
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);
-            list_del_init(&puc->list);
-            tkz_uc_destroy(puc);
-        }
-        list_for_each_safe(p, n, &reader->consumed_list) {
-            struct tkz_uc *puc = list_entry(p, struct tkz_uc, list);
-            list_del_init(&puc->list);
-            tkz_uc_destroy(puc);
-        }
         PCHVML_FREE(reader);
     }
 }
@@ -37,7 +37,7 @@
 struct pcexec_exe_filter_inst {
     struct purc_exec_inst       super;
 
-    struct exe_filter_param        param;
+    struct exe_filter_param       *param;  // shared with the rule cache
 
     purc_variant_t              result_set;
 };
@@ -46,8 +46,10 @@ struct pcexec_exe_filter_inst {
 static inline void
 reset(struct pcexec_exe_filter_inst *exe_filter_inst)
 {
-    struct exe_filter_param *param = &exe_filter_inst->param;
-    exe_filter_param_reset(param);
+    if (exe_filter_inst->param) {
+        pcexecutor_put_rule(exe_filter_inst->param);
+        exe_filter_inst->param = NULL;
+    }
     pcexecutor_inst_reset(&exe_filter_inst->super);
     PCEXE_CLR_VAR(exe_filter_inst->result_set);
 }
@@ -191,26 +193,25 @@ prepare_result_set(struct pcexec_exe_filter_inst *exe_filter_inst)
     return ok;
 }
 
+PCEXEC_DEFINE_RULE_OPS(exe_filter);
+
 static inline bool
 parse_rule(struct pcexec_exe_filter_inst *exe_filter_inst,
         const char* rule)
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
 
-    struct exe_filter_param param = {0};
-    int r = exe_filter_parse(rule, strlen(rule), &param);
     if (inst->err_msg) {
         free(inst->err_msg);
         inst->err_msg = NULL;
     }
 
-    if (r) {
-        inst->err_msg = param.err_msg;
-        param.err_msg = NULL;
+    struct exe_filter_param *param;
+    param = pcexecutor_get_rule(&exe_filter_rule_ops, rule, &inst->err_msg);
+    if (!param)
         return false;
-    }
 
-    exe_filter_param_reset(&exe_filter_inst->param);
+    pcexecutor_put_rule(exe_filter_inst->param);
     exe_filter_inst->param = param;
 
     return prepare_result_set(exe_filter_inst);
@@ -242,7 +243,7 @@ check_item_with_object(struct pcexec_exe_filter_inst *exe_filter_inst,
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct filter_rule *rule = &exe_filter_inst->param.rule;
+    struct filter_rule *rule = &exe_filter_inst->param->rule;
 
     purc_variant_t v = purc_variant_array_get(item, 1);
     PC_ASSERT(v != PURC_VARIANT_INVALID);
@@ -288,7 +289,7 @@ check_item_with_array(struct pcexec_exe_filter_inst *exe_filter_inst,
 {
     purc_exec_inst_t inst = &exe_filter_inst->super;
     purc_exec_iter_t it = &inst->it;
-    struct filter_rule *rule = &exe_filter_inst->param.rule;
+    struct filter_rule *rule = &exe_filter_inst->param->rule;
 
     if (filter_rule_eval(rule, item, result)) {
         // TODO: exception
@@ -451,11 +452,6 @@ exe_filter_create(enum purc_exec_type type,
     inst->type        = type;
     inst->asc_desc    = asc_desc;
 
-    int debug_flex, debug_bison;
-    pcexecutor_get_debug(&debug_flex, &debug_bison);
-    exe_filter_inst->param.debug_flex  = debug_flex;
-    exe_filter_inst->param.debug_bison = debug_bison;
-
     enum purc_variant_type vt = purc_variant_get_type(input);
     if (vt == PURC_VARIANT_TYPE_OBJECT ||
         vt == PURC_VARIANT_TYPE_ARRAY ||
@@ -51,6 +51,7 @@
 #include "executor_err_msgs.inc"
 
 #include <pthread.h>
+#include <stddef.h>
 
 static int comp_pcexec_key(const void *key1, const void *key2)
 {
@@ -147,6 +148,144 @@ static void _init_registers_once(void)
     _do_registers();
 }
 
+struct rule_key {
+    const struct pcexec_rule_ops   *ops;
+    const char                     *rule;
+};
+
+// a compiled rule, referenced by the rule cache and the executor instances
+struct rule_entry {
+    struct rule_key                 key;
+    struct list_head                lru;        // in heap->rule_lru
+    size_t                          refc;
+
+    max_align_t                     param[];
+};
+
+static int comp_rule_key(const void *key1, const void *key2)
+{
+    const struct rule_key *l = (const struct rule_key*)key1;
+    const struct rule_key *r = (const struct rule_key*)key2;
+
+    if (l->ops != r->ops)
+        return (l->ops < r->ops) ? -1 : 1;
+
+    return strcmp(l->rule, r->rule);
+}
+
+static void
+rule_entry_unref(struct rule_entry *entry)
+{
+    PC_ASSERT(entry->refc > 0);
+    if (--entry->refc)
+        return;
+
+    entry->key.ops->reset(entry->param);
+    free((char*)entry->key.rule);
+    free(entry);
+}
+
+static void
+rule_cache_evict(struct pcexecutor_heap *heap, struct rule_entry *entry)
+{
+    pcutils_map_erase(heap->rule_cache, &entry->key);
+    list_del(&entry->lru);
+    heap->rule_stat.nr_entries--;
+    rule_entry_unref(entry);
+}
+
+static void
+rule_cache_cleanup(struct pcexecutor_heap *heap)
+{
+    struct rule_entry *p, *n;
+    list_for_each_entry_safe(p, n, &heap->rule_lru, lru) {
+        rule_cache_evict(heap, p);
+    }
+
+    if (heap->rule_cache) {
+        pcutils_map_destroy(heap->rule_cache);
+        heap->rule_cache = NULL;
+    }
+}
+
+void *pcexecutor_get_rule(const struct pcexec_rule_ops *ops, const char *rule,
+        char **err_msg)
+{
+    struct pcexecutor_heap *heap = pcinst_current()->executor_heap;
+    struct rule_key key = { ops, rule };
+    struct rule_entry *entry;
+
+    pcutils_map_entry *found = pcutils_map_find(heap->rule_cache, &key);
+    if (found) {
+        entry = (struct rule_entry*)found->val;
+        list_move(&entry->lru, &heap->rule_lru);
+        heap->rule_stat.nr_hits++;
+        entry->refc++;
+        return entry->param;
+    }
+
+    heap->rule_stat.nr_misses++;
+
+    entry = (struct rule_entry*)calloc(1, sizeof(*entry) + ops->size);
+    if (!entry) {
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return NULL;
+    }
+
+    struct pcexec_rule_param *param = (struct pcexec_rule_param*)entry->param;
+    pcexecutor_get_debug(&param->debug_flex, &param->debug_bison);
+    if (ops->parse(rule, strlen(rule), param)) {
+        // a failed compilation is not cached
+        *err_msg = param->err_msg;
+        param->err_msg = NULL;
+        ops->reset(param);
+        free(entry);
+        return NULL;
+    }
+
+    entry->key.ops = ops;
+    entry->key.rule = strdup(rule);
+    entry->refc = 1;
+    if (!entry->key.rule ||
+            pcutils_map_insert(heap->rule_cache, &entry->key, entry)) {
+        // works without the cache
+        free((char*)entry->key.rule);
+        entry->key.rule = NULL;
+        return entry->param;
+    }
+
+    // one reference is held by the cache itself
+    entry->refc++;
+    list_add(&entry->lru, &heap->rule_lru);
+    heap->rule_stat.nr_entries++;
+
+    while (heap->rule_stat.nr_entries > heap->rule_stat.capacity) {
+        rule_cache_evict(heap, list_last_entry(&heap->rule_lru,
+                    struct rule_entry, lru));
+        heap->rule_stat.nr_evictions++;
+    }
+
+    return entry->param;
+}
+
+void pcexecutor_put_rule(void *param)
+{
+    if (param)
+        rule_entry_unref(container_of(param, struct rule_entry, param));
+}
+
+const struct pcexec_rule_cache_stat *
+pcexecutor_rule_cache_stat(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst == NULL || inst->executor_heap == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return NULL;
+    }
+
+    return &inst->executor_heap->rule_stat;
+}
+
 static int _init_instance(struct pcinst *inst,
         const purc_instance_extra_info* extra_info)
 {
@@ -180,6 +319,17 @@ static int _init_instance(struct pcinst *inst,
     inst->executor_heap->debug_flex = 0;
     inst->executor_heap->debug_bison = 0;
 
+    inst->executor_heap->rule_cache = pcutils_map_create(NULL, NULL,
+            NULL, NULL, comp_rule_key, false);
+    if (!inst->executor_heap->rule_cache) {
+        free(inst->executor_heap);
+        inst->executor_heap = NULL;
+        pcinst_set_error(PCEXECUTOR_ERROR_OOM);
+        return -1;
+    }
+    INIT_LIST_HEAD(&inst->executor_heap->rule_lru);
+    inst->executor_heap->rule_stat.capacity = PCEXECUTOR_RULE_CACHE_CAPACITY;
+
     PC_ASSERT(purc_get_last_error() == 0);
     return 0;
 }
@@ -189,6 +339,9 @@ static void _cleanup_instance(struct pcinst *inst)
     if (!inst->executor_heap)
         return;
 
+    // the rules still used by live executor instances are released
+    // when the instances put them back
+    rule_cache_cleanup(inst->executor_heap);
     free(inst->executor_heap);
     inst->executor_heap = NULL;
 }
@@ -292,8 +445,9 @@ bool purc_register_executor(const char* name, const purc_exec_ops_t ops)
     return r ? false : true;
 }
 
+// the name of the executor is the first `len` bytes of `name`
 static inline bool
-get_executor(const char* name, pcexec_ops_t ops)
+get_executor(const char* name, size_t len, pcexec_ops_t ops)
 {
     pcutils_map_entry *entry = NULL;
 
@@ -304,10 +458,10 @@ get_executor(const char* name, pcexec_ops_t ops)
         return false;
     }
 
-    purc_atom_t atom = PCHVML_KEYWORD_ATOM(HVML, name);
+    purc_atom_t atom = PCHVML_KEYWORD_ATOM_LEN(HVML, name, len);
     if (atom == 0) {
         purc_set_error_with_info(PCEXECUTOR_ERROR_BAD_ARG,
-                "unknown atom: %s", name);
+                "unknown atom: %.*s", (int)len, name);
     }
 
     void *key = (void*)(uint64_t)atom;
@@ -365,11 +519,7 @@ int pcexecutor_get_by_rule(const char *rule, pcexec_ops_t ops)
     while (*t && !purc_isspace(*t) && *t != ':')
         ++t;
 
-    char *s = strndup(h, t-h);
-    PC_ASSERT(s);
-
-    bool ok = get_executor(s, ops);
-    free(s);
+    bool ok = get_executor(h, t - h, ops);
 
     return ok ? 0 : -1;
 }
@@ -408,18 +558,10 @@ pcexecutor_get_rule_name(const char *rule)
     while (*t && !purc_isspace(*t) && *t != ':')
         ++t;
 
-    char buf[128];
-
-    int n = snprintf(buf, sizeof(buf), "%.*s", (int)(t-h), h);
-    if (n < 0 || (size_t)n >= sizeof(buf)) {
-        pcinst_set_error(PCEXECUTOR_ERROR_BAD_ARG);
-        return 0;
-    }
-
-    purc_atom_t atom = PCHVML_KEYWORD_ATOM(HVML, buf);
+    purc_atom_t atom = PCHVML_KEYWORD_ATOM_LEN(HVML, h, t - h);
     if (atom == 0) {
         purc_set_error_with_info(PCEXECUTOR_ERROR_BAD_ARG,
-                "unknown atom: %s", buf);
+                "unknown atom: %.*s", (int)(t - h), h);
     }
     return atom;
 }
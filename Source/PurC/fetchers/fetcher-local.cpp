@@ -26,18 +26,246 @@
 
 #include "fetcher-internal.h"
 
-#include <wtf/URL.h>
+#include <wtf/Condition.h>
+#include <wtf/Deque.h>
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/Lock.h>
 #include <wtf/RunLoop.h>
+#include <wtf/FastMalloc.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/Threading.h>
+#include <wtf/URL.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
 #include <unistd.h>
 
 #include <stdlib.h>
 
+/* The number of the worker threads is bounded by `max_conns` and this. */
+#define LOCAL_FETCHER_MAX_WORKERS       8
+
+/* The unit of `cache_quota` (KiB). */
+#define LOCAL_FETCHER_QUOTA_UNIT        1024
+
+/* The contents of a local file, and the stat information used to tell
+ * whether the file has been changed since it was read. */
+class LocalResource : public ThreadSafeRefCounted<LocalResource> {
+public:
+    static RefPtr<LocalResource> load(const char* path);
+
+    bool isValidFor(const struct stat& st) const
+    {
+        return m_dev == st.st_dev && m_ino == st.st_ino
+            && m_size == st.st_size && m_mtime == mtimeOf(st);
+    }
+
+    const uint8_t* data() const { return m_data.data(); }
+    size_t size() const { return m_data.size(); }
+
+private:
+    static uint64_t mtimeOf(const struct stat& st)
+    {
+#if OS(DARWIN)
+        return st.st_mtimespec.tv_sec * 1000000000ULL
+            + st.st_mtimespec.tv_nsec;
+#else
+        return st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+#endif
+    }
+
+    dev_t m_dev { 0 };
+    ino_t m_ino { 0 };
+    off_t m_size { 0 };
+    uint64_t m_mtime { 0 };
+    Vector<uint8_t> m_data;
+};
+
+RefPtr<LocalResource> LocalResource::load(const char* path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return nullptr;
+    }
+
+    RefPtr<LocalResource> res = adoptRef(new LocalResource);
+    res->m_dev = st.st_dev;
+    res->m_ino = st.st_ino;
+    res->m_size = st.st_size;
+    res->m_mtime = mtimeOf(st);
+    res->m_data.resize(st.st_size);
+
+    size_t done = 0;
+    while (done < res->m_data.size()) {
+        ssize_t n = read(fd, res->m_data.data() + done,
+                res->m_data.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += n;
+    }
+    close(fd);
+
+    /* the file was truncated while reading it; do not trust the stat */
+    if (done != res->m_data.size()) {
+        res->m_data.shrink(done);
+        res->m_mtime = 0;
+    }
+    return res;
+}
+
+/* The response cache shared by the runner and the worker threads. The
+ * entries are validated against the file's device, inode, size, and mtime
+ * on every hit, and the least recently used ones are evicted when the
+ * total size exceeds the quota. */
+class LocalResourceCache {
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    explicit LocalResourceCache(size_t quota) : m_quota(quota) { }
+
+    RefPtr<LocalResource> get(const char* path);
+
+private:
+    void removeLocked(const String& key);
+
+    Lock m_lock;
+    HashMap<String, RefPtr<LocalResource>> m_entries;
+    ListHashSet<String> m_lru;
+    size_t m_quota;
+    size_t m_used { 0 };
+};
+
+RefPtr<LocalResource> LocalResourceCache::get(const char* path)
+{
+    struct stat st;
+    if (stat(path, &st) || !S_ISREG(st.st_mode))
+        return nullptr;
+
+    String key = String::fromUTF8(path);
+    {
+        auto locker = holdLock(m_lock);
+        auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            if (it->value->isValidFor(st)) {
+                m_lru.appendOrMoveToLast(key);
+                return it->value;
+            }
+            removeLocked(key);
+        }
+    }
+
+    RefPtr<LocalResource> res = LocalResource::load(path);
+    if (!res || res->size() > m_quota)
+        return res;
+
+    auto locker = holdLock(m_lock);
+    removeLocked(key);
+    m_entries.add(key, res);
+    m_lru.add(key);
+    m_used += res->size();
+    while (m_used > m_quota && !m_lru.isEmpty())
+        removeLocked(m_lru.first());
+
+    return res;
+}
+
+void LocalResourceCache::removeLocked(const String& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return;
+
+    m_used -= it->value->size();
+    m_entries.remove(it);
+    m_lru.remove(key);
+}
+
+/* A bounded pool of threads which read the local files; the threads are
+ * spawned on demand, and the pending tasks are drained before the pool
+ * is destroyed. */
+class LocalFetcherWorkers {
+    WTF_MAKE_FAST_ALLOCATED;
+public:
+    explicit LocalFetcherWorkers(size_t max_workers)
+        : m_maxWorkers(max_workers ? max_workers : 1) { }
+    ~LocalFetcherWorkers();
+
+    void post(Function<void()>&&);
+
+private:
+    void run();
+
+    Lock m_lock;
+    Condition m_condition;
+    Deque<Function<void()>> m_tasks;
+    Vector<Ref<Thread>> m_threads;
+    size_t m_maxWorkers;
+    size_t m_idle { 0 };
+    bool m_stopping { false };
+};
+
+LocalFetcherWorkers::~LocalFetcherWorkers()
+{
+    Vector<Ref<Thread>> threads;
+    {
+        auto locker = holdLock(m_lock);
+        m_stopping = true;
+        threads = WTFMove(m_threads);
+    }
+    m_condition.notifyAll();
+
+    for (auto& thread : threads)
+        thread->waitForCompletion();
+}
+
+void LocalFetcherWorkers::post(Function<void()>&& task)
+{
+    auto locker = holdLock(m_lock);
+    m_tasks.append(WTFMove(task));
+    if (m_tasks.size() > m_idle && m_threads.size() < m_maxWorkers) {
+        m_threads.append(Thread::create("local-fetcher", [this] {
+            run();
+        }));
+    }
+    m_condition.notifyOne();
+}
+
+void LocalFetcherWorkers::run()
+{
+    for (;;) {
+        Function<void()> task;
+        {
+            auto locker = holdLock(m_lock);
+            while (m_tasks.isEmpty() && !m_stopping) {
+                m_idle++;
+                m_condition.wait(m_lock);
+                m_idle--;
+            }
+            if (m_tasks.isEmpty())
+                return;
+            task = m_tasks.takeFirst();
+        }
+        task();
+    }
+}
+
 struct pcfetcher_local {
     struct pcfetcher base;
     char* base_uri;
+
+    LocalFetcherWorkers* workers;
+    LocalResourceCache* cache;
 };
 
 struct mime_type {
@@ -45,7 +273,7 @@ struct mime_type {
     const char* mime;
 };
 
-struct mime_type  mime_types[] = {
+static struct mime_type  mime_types[] = {
     { "",       "unknown" },
     { ".hvml",   "text/hvml" },
     { ".html",   "text/html" },
@@ -55,6 +283,10 @@ struct mime_type  mime_types[] = {
 static const char* get_mime(const char* name)
 {
     const char* ext = strrchr(name, '.');
+    if (ext == NULL) {
+        return mime_types[0].mime;
+    }
+
     size_t sz = sizeof(mime_types) / sizeof(struct mime_type);
     for (size_t i = 1; i < sz; i++) {
         if (strcmp(ext, mime_types[i].ext) == 0) {
@@ -88,6 +320,11 @@ struct pcfetcher* pcfetcher_local_init(size_t max_conns, size_t cache_quota)
 
     local->base_uri = NULL;
 
+    local->workers = new LocalFetcherWorkers(
+            std::min(max_conns, (size_t)LOCAL_FETCHER_MAX_WORKERS));
+    local->cache = new LocalResourceCache(
+            cache_quota * LOCAL_FETCHER_QUOTA_UNIT);
+
     return fetcher;
 }
 
@@ -98,6 +335,11 @@ int pcfetcher_local_term(struct pcfetcher* fetcher)
     }
 
     struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
+    /* waits for the pending requests; their responses will still be
+     * delivered to the run loops of the requesting threads */
+    delete local->workers;
+    delete local->cache;
+
     if (local->base_uri) {
         free(local->base_uri);
     }
@@ -162,6 +404,42 @@ const char* pcfetcher_cookie_loccal_remove(struct pcfetcher* fetcher,
     return NULL;
 }
 
+static bool get_local_path(struct pcfetcher_local* local, const char* url,
+        CString& path)
+{
+    String uri;
+    if (local->base_uri &&
+            strncmp(url, local->base_uri, strlen(local->base_uri)) != 0) {
+        uri.append(local->base_uri);
+    }
+    uri.append(url);
+    PurCWTF::URL wurl(URL(), uri);
+    if (!wurl.isLocalFile()) {
+        return false;
+    }
+
+    path = wurl.path().utf8();
+    return true;
+}
+
+/* The response is served from memory, so that the callers can always use
+ * purc_rwstream_get_mem_buffer() on it. */
+static purc_rwstream_t make_response(const LocalResource& res)
+{
+    purc_rwstream_t rws = purc_rwstream_new_buffer(res.size(), 0);
+    if (rws == NULL) {
+        return NULL;
+    }
+
+    if (res.size() && purc_rwstream_write(rws, res.data(), res.size())
+            != (ssize_t)res.size()) {
+        purc_rwstream_destroy(rws);
+        return NULL;
+    }
+    purc_rwstream_seek(rws, 0, SEEK_SET);
+    return rws;
+}
+
 purc_variant_t pcfetcher_local_request_async(
         struct pcfetcher* fetcher,
         const char* url,
@@ -171,53 +449,69 @@ purc_variant_t pcfetcher_local_request_async(
         pcfetcher_response_handler handler,
         void* ctxt)
 {
-    UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(url);
     UNUSED_PARAM(method);
     UNUSED_PARAM(params);
     UNUSED_PARAM(timeout);
-    UNUSED_PARAM(handler);
-    UNUSED_PARAM(ctxt);
 
     if (!fetcher || !url || !handler) {
         return PURC_VARIANT_INVALID;
     }
 
+    struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
     struct pcfetcher_callback_info *info = pcfetcher_create_callback_info();
-    info->rws = pcfetcher_local_request_sync(fetcher, url, method,
-            params, timeout, &info->header);
+    if (info == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
     info->handler = handler;
     info->ctxt = ctxt;
     info->req_id = purc_variant_make_native(info, NULL);
+    if (info->req_id == PURC_VARIANT_INVALID) {
+        pcfetcher_destroy_callback_info(info);
+        return PURC_VARIANT_INVALID;
+    }
 
-    if (!info->rws) {
-        info->header.ret_code = 404;
+    CString path;
+    bool local_file = get_local_path(local, url, path);
+    if (local_file) {
+        info->header.mime_type = strdup(get_mime(path.data()));
     }
 
-    RunLoop *runloop = &RunLoop::current();
-#ifdef NDEBUG
-    runloop->dispatch([info] {
-#else
-    // random
-    double tm = randomNumber() * 5;
-    runloop->dispatchAfter(Seconds(tm), [info] {
-#endif
-                if (!info->cancelled) {
-                    info->handler(info->req_id, info->ctxt, &info->header,
-                            info->rws);
-                    info->rws = NULL;
+    /* the response is always delivered by the run loop of this thread */
+    Ref<RunLoop> runloop = RunLoop::current();
+    LocalResourceCache* cache = local->cache;
+    local->workers->post([info, cache, local_file, path = WTFMove(path),
+            runloop = WTFMove(runloop)] () mutable {
+        RefPtr<LocalResource> res;
+        if (local_file) {
+            res = cache->get(path.data());
+        }
+
+        runloop->dispatch([info, res = WTFMove(res)] {
+            if (!info->cancelled) {
+                if (res) {
+                    info->rws = make_response(*res);
                 }
-                pcfetcher_destroy_callback_info(info);
-            });
 
-    return info->req_id;
-}
+                if (info->rws) {
+                    info->header.ret_code = 200;
+                    info->header.sz_resp = res->size();
+                }
+                else {
+                    info->header.ret_code = 404;
+                    info->header.sz_resp = 0;
+                }
 
-off_t filesize(const char* filename)
-{
-    struct stat statbuf;
-    stat(filename,&statbuf);
-    return statbuf.st_size;
+                info->handler(info->req_id, info->ctxt, &info->header,
+                        info->rws);
+                info->rws = NULL;
+            }
+            pcfetcher_destroy_callback_info(info);
+        });
+    });
+
+    return info->req_id;
 }
 
 purc_rwstream_t pcfetcher_local_request_sync(
@@ -228,60 +522,56 @@ purc_rwstream_t pcfetcher_local_request_sync(
         uint32_t timeout,
         struct pcfetcher_resp_header *resp_header)
 {
-    UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(url);
     UNUSED_PARAM(method);
     UNUSED_PARAM(params);
     UNUSED_PARAM(timeout);
-    UNUSED_PARAM(resp_header);
 
     if (!fetcher || !url) {
         return NULL;
     }
+
     struct pcfetcher_local* local = (struct pcfetcher_local*)fetcher;
-    String uri;
-    if (local->base_uri &&
-            strncmp(url, local->base_uri, strlen(local->base_uri)) != 0) {
-        uri.append(local->base_uri);
-    }
-    uri.append(url);
-    PurCWTF::URL wurl(URL(), uri);
-    if (!wurl.isLocalFile()) {
-        resp_header->ret_code = 404;
-        resp_header->sz_resp = 0;
-        resp_header->mime_type = NULL;
-        return NULL;
+    CString path;
+    RefPtr<LocalResource> res;
+    purc_rwstream_t rws = NULL;
+    if (get_local_path(local, url, path)) {
+        res = local->cache->get(path.data());
+        if (res) {
+            rws = make_response(*res);
+        }
     }
 
-    const StringView path = wurl.path();
-    const CString& cpath = path.utf8();
-
-    const char* file = cpath.data();
-
-    purc_rwstream_t rws = purc_rwstream_new_from_file(file, "r");
-    if (rws && resp_header) {
-        resp_header->ret_code = 200;
-        resp_header->sz_resp = filesize(file);
-        resp_header->mime_type = strdup(get_mime(file));
-        return rws;
+    if (resp_header) {
+        if (rws) {
+            resp_header->ret_code = 200;
+            resp_header->sz_resp = res->size();
+            resp_header->mime_type = strdup(get_mime(path.data()));
+        }
+        else {
+            resp_header->ret_code = 404;
+            resp_header->sz_resp = 0;
+            resp_header->mime_type = NULL;
+        }
     }
 
-    return NULL;
+    return rws;
 }
 
 void pcfetcher_local_cancel_async(struct pcfetcher* fetcher,
         purc_variant_t request)
 {
     UNUSED_PARAM(fetcher);
-    UNUSED_PARAM(request);
 
-#ifndef NDEBUG
     struct pcfetcher_callback_info *info = (struct pcfetcher_callback_info *)
         purc_variant_native_get_entity(request);
+    if (info == NULL || info->cancelled) {
+        return;
+    }
+
+    /* the pending response will be dropped by the run loop */
     info->cancelled = true;
     info->header.ret_code = RESP_CODE_USER_CANCEL;
     info->handler(info->req_id, info->ctxt, &info->header, NULL);
-#endif
 }
 
 int pcfetcher_local_check_response(struct pcfetcher* fetcher,
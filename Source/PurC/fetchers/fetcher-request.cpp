@@ -33,6 +33,9 @@
 #include "NetworkResourceLoadParameters.h"
 #include "ResourceError.h"
 #include "ResourceResponse.h"
+#include "SharedMemory.h"
+
+#include "private/rwstream.h"
 
 #include <wtf/RunLoop.h>
 
@@ -48,6 +51,8 @@ PcFetcherRequest::PcFetcherRequest(uint64_t sessionId,
     : m_sessionId(sessionId)
     , m_req_id(0)
     , m_is_async(false)
+    , m_resp_mapped(false)
+    , m_resp_failed(false)
     , m_connection(IPC::Connection::createClientConnection(identifier, *this, queue))
     , m_workQueue(queue)
     , m_fetcherProcess(process)
@@ -295,6 +300,11 @@ void PcFetcherRequest::didReceiveMessage(IPC::Connection&,
                 decoder, this, &PcFetcherRequest::didReceiveSharedBuffer);
         return;
     }
+    if (decoder.messageName() == Messages::WebResourceLoader::DidReceiveResource::name()) {
+        IPC::handleMessage<Messages::WebResourceLoader::DidReceiveResource>(
+                decoder, this, &PcFetcherRequest::didReceiveResource);
+        return;
+    }
     if (decoder.messageName() == Messages::WebResourceLoader::DidFinishResourceLoad::name()) {
         IPC::handleMessage<Messages::WebResourceLoader::DidFinishResourceLoad>(
                 decoder, this, &PcFetcherRequest::didFinishResourceLoad);
@@ -343,6 +353,48 @@ void PcFetcherRequest::didReceiveResponse(
     }
     size_t init = m_callback->header.sz_resp ? m_callback->header.sz_resp : DEF_RWS_SIZE;
     m_callback->rws = purc_rwstream_new_buffer(init, INT_MAX);
+    m_resp_mapped = false;
+    m_resp_failed = false;
+}
+
+bool PcFetcherRequest::makeResponseWritable(void)
+{
+    if (!m_resp_mapped) {
+        return true;
+    }
+
+    // copy the mapped body into a buffer which the later data can follow
+    size_t sz_content = 0;
+    void *mem = purc_rwstream_get_mem_buffer(m_callback->rws, &sz_content);
+    purc_rwstream_t rws = purc_rwstream_new_buffer(
+            sz_content ? sz_content : DEF_RWS_SIZE, INT_MAX);
+    if (rws == NULL) {
+        return false;
+    }
+    if (sz_content &&
+            purc_rwstream_write(rws, mem, sz_content) != (ssize_t)sz_content) {
+        purc_rwstream_destroy(rws);
+        return false;
+    }
+
+    purc_rwstream_destroy(m_callback->rws);
+    m_callback->rws = rws;
+    m_callback->header.sz_resp = 0;
+    m_resp_mapped = false;
+    return true;
+}
+
+void PcFetcherRequest::failResponse(void)
+{
+    // a truncated body is never reported as a good one
+    m_callback->header.ret_code = RESP_CODE_BAD_RESOURCE;
+    m_callback->header.sz_resp = 0;
+    if (m_callback->rws) {
+        purc_rwstream_destroy(m_callback->rws);
+        m_callback->rws = NULL;
+    }
+    m_resp_mapped = false;
+    m_resp_failed = true;
 }
 
 void PcFetcherRequest::didReceiveSharedBuffer(
@@ -350,12 +402,68 @@ void PcFetcherRequest::didReceiveSharedBuffer(
 {
     UNUSED_PARAM(encodedDataLength);
     auto locker = holdLock(m_callbackLock);
-    if (m_callback == NULL) {
+    if (m_callback == NULL || m_resp_failed) {
+        return;
+    }
+    if (!makeResponseWritable()) {
+        failResponse();
         return;
     }
     purc_rwstream_write(m_callback->rws, data.data(), data.size());
 }
 
+static void releaseSharedMemory(void *ctxt)
+{
+    static_cast<SharedMemory*>(ctxt)->deref();
+}
+
+void PcFetcherRequest::didReceiveResource(SharedMemory::Handle&& handle,
+        uint64_t size)
+{
+    auto locker = holdLock(m_callbackLock);
+    if (m_callback == NULL || m_resp_failed) {
+        return;
+    }
+
+    RefPtr<SharedMemory> memory = SharedMemory::map(handle,
+            SharedMemory::Protection::ReadOnly);
+    if (!memory || size > memory->size()) {
+        failResponse();
+        return;
+    }
+
+    size_t sz_content = 0;
+    if (m_callback->rws) {
+        purc_rwstream_get_mem_buffer(m_callback->rws, &sz_content);
+    }
+
+    if (sz_content) {
+        // some data were already received; keep them in order
+        if (!makeResponseWritable() ||
+                purc_rwstream_write(m_callback->rws, memory->data(), size)
+                    != (ssize_t)size) {
+            failResponse();
+        }
+        return;
+    }
+
+    // the stream owns the mapping from now on; no byte is copied
+    SharedMemory *mapped = memory.leakRef();
+    purc_rwstream_t rws = pcrwstream_new_from_mem_ro(mapped->data(), size,
+            releaseSharedMemory, mapped);
+    if (rws == NULL) {
+        mapped->deref();
+        return;
+    }
+
+    if (m_callback->rws) {
+        purc_rwstream_destroy(m_callback->rws);
+    }
+    m_callback->rws = rws;
+    m_callback->header.sz_resp = size;
+    m_resp_mapped = true;
+}
+
 void PcFetcherRequest::didFinishResourceLoad(
         const NetworkLoadMetrics& networkLoadMetrics)
 {
@@ -32,6 +32,7 @@
 
 #include "WebCoreArgumentCoders.h"
 #include "SharedBufferDataReference.h"
+#include "SharedMemory.h"
 #include "Connection.h"
 #include "MessageReceiverMap.h"
 #include "ProcessLauncher.h"
@@ -108,6 +109,10 @@ protected:
     void didReceiveResponse(const PurCFetcher::ResourceResponse&, bool);
     void didReceiveSharedBuffer(IPC::SharedBufferDataReference&&,
             int64_t encodedDataLength);
+    void didReceiveResource(PurCFetcher::SharedMemory::Handle&&,
+            uint64_t size);
+    bool makeResponseWritable(void);
+    void failResponse(void);
     void didFinishResourceLoad(const PurCFetcher::NetworkLoadMetrics&);
     void didFailResourceLoad(const ResourceError& error);
     void willSendRequest(ResourceRequest&&,
@@ -117,6 +122,10 @@ private:
     uint64_t m_sessionId;
     uint64_t m_req_id;
     bool m_is_async;
+    // the response body is a read-only mapping of a shared memory
+    bool m_resp_mapped;
+    // the response body was lost; the later data is dropped
+    bool m_resp_failed;
 
     RefPtr<IPC::Connection> m_connection;
     BinarySemaphore m_waitForSyncReplySemaphore;
@@ -3735,10 +3735,8 @@ const char* description(MessageName name)
         return "WebResourceLoader::DidBlockAuthenticationChallenge";
     case MessageName::WebResourceLoader_StopLoadingAfterXFrameOptionsOrContentSecurityPolicyDenied:
         return "WebResourceLoader::StopLoadingAfterXFrameOptionsOrContentSecurityPolicyDenied";
-#if ENABLE(SHAREABLE_RESOURCE)
     case MessageName::WebResourceLoader_DidReceiveResource:
         return "WebResourceLoader::DidReceiveResource";
-#endif
     case MessageName::WebSocketChannel_DidConnect:
         return "WebSocketChannel::DidConnect";
     case MessageName::WebSocketChannel_DidClose:
@@ -7336,9 +7334,7 @@ ReceiverName receiverName(MessageName messageName)
     case MessageName::WebResourceLoader_ServiceWorkerDidNotHandle:
     case MessageName::WebResourceLoader_DidBlockAuthenticationChallenge:
     case MessageName::WebResourceLoader_StopLoadingAfterXFrameOptionsOrContentSecurityPolicyDenied:
-#if ENABLE(SHAREABLE_RESOURCE)
     case MessageName::WebResourceLoader_DidReceiveResource:
-#endif
         return ReceiverName::WebResourceLoader;
     case MessageName::WebSocketChannel_DidConnect:
     case MessageName::WebSocketChannel_DidClose:
@@ -12388,10 +12384,8 @@ bool isValidMessageName(MessageName messageName)
         return true;
     if (messageName == IPC::MessageName::WebResourceLoader_StopLoadingAfterXFrameOptionsOrContentSecurityPolicyDenied)
         return true;
-#if ENABLE(SHAREABLE_RESOURCE)
     if (messageName == IPC::MessageName::WebResourceLoader_DidReceiveResource)
         return true;
-#endif
     if (messageName == IPC::MessageName::WebSocketChannel_DidConnect)
         return true;
     if (messageName == IPC::MessageName::WebSocketChannel_DidClose)
@@ -2367,9 +2367,7 @@ enum class MessageName : uint16_t {
     , WebResourceLoader_ServiceWorkerDidNotHandle = 1475
     , WebResourceLoader_DidBlockAuthenticationChallenge = 1476
     , WebResourceLoader_StopLoadingAfterXFrameOptionsOrContentSecurityPolicyDenied = 1477
-#if ENABLE(SHAREABLE_RESOURCE)
     , WebResourceLoader_DidReceiveResource = 1478
-#endif
     , WebSocketChannel_DidConnect = 1479
     , WebSocketChannel_DidClose = 1480
     , WebSocketChannel_DidReceiveText = 1481
@@ -31,6 +31,7 @@
 #include "Attachment.h"
 #include "Connection.h"
 #include "MessageNames.h"
+#include "SharedMemory.h"
 
 #include <wtf/Optional.h>
 #include <wtf/Forward.h>
@@ -421,6 +422,33 @@ private:
     Arguments m_arguments;
 };
 
+/* The whole body of a response in a shared memory segment, which is mapped
+ * read-only by the receiver instead of being copied out of the message.
+ * The fetcher uses it for the bodies not smaller than the threshold below,
+ * and DidReceiveSharedBuffer for the others. */
+#define PCFETCHER_SHM_BODY_THRESHOLD    (256 * 1024)
+
+class DidReceiveResource {
+public:
+    using Arguments = std::tuple<const PurCFetcher::SharedMemory::Handle&, uint64_t>;
+
+    static IPC::MessageName name() { return IPC::MessageName::WebResourceLoader_DidReceiveResource; }
+    static const bool isSync = false;
+
+    DidReceiveResource(const PurCFetcher::SharedMemory::Handle& handle, uint64_t size)
+        : m_arguments(handle, size)
+    {
+    }
+
+    const Arguments& arguments() const
+    {
+        return m_arguments;
+    }
+
+private:
+    Arguments m_arguments;
+};
+
 } // namespace WebResourceLoader
 
 
@@ -199,6 +199,26 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
         void *ud, int (*cmp)(struct pcutils_array_list_node *l,
                 struct pcutils_array_list_node *r, void *ud));
 
+/*
+ * Sorts the nodes by keys computed beforehand: `keys` holds `key_size` bytes
+ * for each node in the current order. The sort is stable. Long lists are
+ * sorted by several threads, so `cmp` shall only look at the keys.
+ */
+int
+pcutils_array_list_sort_by_keys(struct pcutils_array_list *al,
+        const void *keys, size_t key_size, void *ud,
+        int (*cmp)(const void *l, const void *r, void *ud));
+
+/*
+ * Fills `idx` with the stable sorting permutation of `nr` keys: the i-th
+ * key in order is the one at `idx[i]`. The same threading rule as above
+ * applies to `cmp`.
+ */
+int
+pcutils_sort_index_by_keys(const void *keys, size_t nr, size_t key_size,
+        void *ud, int (*cmp)(const void *l, const void *r, void *ud),
+        size_t *idx);
+
 PCA_EXTERN_C_END
 
 #endif // PURC_PRIVATE_ARRAY_LIST_H
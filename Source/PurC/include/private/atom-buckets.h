@@ -41,9 +41,10 @@ enum pcatom_bucket {
     ATOM_BUCKET_MSG,    /* the message types such as changed, attached, ... */
     ATOM_BUCKET_RDROP,  /* the renderer operations: startSession, load, ... */
     ATOM_BUCKET_DVOBJ,  /* the keywords of DVObjs: all, default, ... */
+    ATOM_BUCKET_OBJKEY, /* the keys of the members of objects */
 
     /* XXX: change this if you add a new atom bucket. */
-    ATOM_BUCKET_LAST = ATOM_BUCKET_RDROP,
+    ATOM_BUCKET_LAST = ATOM_BUCKET_OBJKEY,
 };
 
 /* Make sure ATOM_BUCKET_LAST is less than PURC_ATOM_BUCKETS_NR */
@@ -71,8 +71,17 @@ struct purc_document_ops {
     pcdoc_element_t (*special_elem)(purc_document_t doc,
             pcdoc_special_elem elem);
 
+    // returns NULL for the root element
     pcdoc_element_t (*get_parent)(purc_document_t doc, pcdoc_node node);
 
+    // nullable; the previous or the next sibling element
+    pcdoc_element_t (*get_sibling_elem)(purc_document_t doc,
+            pcdoc_element_t elem, bool next);
+
+    // nullable
+    int (*get_tag_name)(purc_document_t doc, pcdoc_element_t elem,
+            const char **local_name, size_t *local_len);
+
     // nullable
     int (*children_count)(purc_document_t doc, pcdoc_element_t elem,
             size_t *nrs);
@@ -99,15 +108,19 @@ struct purc_document_ops {
     pcdoc_element_t (*find_elem)(purc_document_t doc, pcdoc_element_t scope,
             const char *selector);
 
+    // returns 0 on success
     int (*elem_coll_select)(purc_document_t doc,
             pcdoc_elem_coll_t coll, pcdoc_element_t scope,
             const char *selector);
 
+    // returns 0 on success
     int (*elem_coll_filter)(purc_document_t doc,
             pcdoc_elem_coll_t dst_coll,
             pcdoc_elem_coll_t src_coll, const char *selector);
 };
 
+struct pcdoc_elem_index;
+
 struct purc_document {
     purc_document_type type;
     pcrdr_msg_data_type def_text_type;
@@ -116,10 +129,15 @@ struct purc_document {
     unsigned data_content:1;
     unsigned have_head:1;
     unsigned have_body:1;
+    /* the implementation reports changes to the id and class indexes */
+    unsigned maintain_index:1;
     unsigned refc;
 
     struct purc_document_ops *ops;
 
+    /* built on the first lookup; see document/elem-index.c */
+    struct pcdoc_elem_index *index;
+
     void *impl;
 };
 
@@ -140,6 +158,96 @@ extern struct purc_document_ops _pcdoc_void_ops WTF_INTERNAL;
 extern struct purc_document_ops _pcdoc_plain_ops WTF_INTERNAL;
 extern struct purc_document_ops _pcdoc_html_ops WTF_INTERNAL;
 
+/* A compiled CSS selector (group); see document/css-selector.c */
+struct pcdoc_selector;
+typedef struct pcdoc_selector pcdoc_selector;
+typedef struct pcdoc_selector *pcdoc_selector_t;
+
+/*
+ * Returns a reference to the compiled form of a CSS selector group.
+ * Compiled selectors are cached per thread by the selector string.
+ * Returns NULL and sets PURC_ERROR_INVALID_VALUE for a bad selector.
+ */
+pcdoc_selector_t
+pcdoc_selector_new(const char *selector) WTF_INTERNAL;
+
+/* Drops a reference returned by pcdoc_selector_new(). */
+void
+pcdoc_selector_delete(pcdoc_selector_t selector) WTF_INTERNAL;
+
+/* Checks whether the element matches the selector. */
+bool
+pcdoc_selector_match(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_selector_t selector) WTF_INTERNAL;
+
+/*
+ * Calls cb for every element matching the selector in the subtree rooted
+ * at scope (included, NULL for the root element), in document order.
+ *
+ * The callback must not change the document. Returns 0 for all matching
+ * elements visited, otherwise the traverse was broken by the callback.
+ */
+int
+pcdoc_selector_travel(purc_document_t doc, pcdoc_element_t scope,
+        pcdoc_selector_t selector, pcdoc_element_cb cb, void *ctxt)
+        WTF_INTERNAL;
+
+/* Empties the compiled selector cache of the calling thread. */
+void
+pcdoc_selector_cache_cleanup(void) WTF_INTERNAL;
+
+/* Implementations of the selector operations on top of the other ops. */
+pcdoc_element_t
+pcdoc_selector_find_elem(purc_document_t doc, pcdoc_element_t scope,
+        const char *selector) WTF_INTERNAL;
+
+int
+pcdoc_selector_elem_coll_select(purc_document_t doc,
+        pcdoc_elem_coll_t coll, pcdoc_element_t scope,
+        const char *selector) WTF_INTERNAL;
+
+int
+pcdoc_selector_elem_coll_filter(purc_document_t doc,
+        pcdoc_elem_coll_t dst_coll,
+        pcdoc_elem_coll_t src_coll, const char *selector) WTF_INTERNAL;
+
+/*
+ * The id and class indexes. The documents setting `maintain_index` call
+ * the functions below around every change of the `id` and `class`
+ * attributes and of the tree; they do nothing until the first lookup.
+ */
+void
+pcdoc_index_destroy(purc_document_t doc) WTF_INTERNAL;
+
+void
+pcdoc_index_add_attr(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_special_attr which) WTF_INTERNAL;
+
+void
+pcdoc_index_remove_attr(purc_document_t doc, pcdoc_element_t elem,
+        pcdoc_special_attr which) WTF_INTERNAL;
+
+/* with_self: whether to include the element itself or its descendants only */
+void
+pcdoc_index_add_subtree(purc_document_t doc, pcdoc_element_t elem,
+        bool with_self) WTF_INTERNAL;
+
+void
+pcdoc_index_remove_subtree(purc_document_t doc, pcdoc_element_t elem,
+        bool with_self) WTF_INTERNAL;
+
+/*
+ * Gets the elements having the identifier or the class name, in document
+ * order. The array is owned by the index and valid until the next change
+ * of the document.
+ *
+ * Returns -1 if the document does not maintain the indexes.
+ */
+int
+pcdoc_index_lookup(purc_document_t doc, pcdoc_special_attr which,
+        const char *name, size_t len, pcdoc_element_t **elems, size_t *nr)
+        WTF_INTERNAL;
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -62,6 +62,16 @@ void pcejson_reset (struct pcejson* parser, uint32_t depth, uint32_t flags);
 int pcejson_parse (struct pcvcm_node** vcm_tree, struct pcejson** parser,
                    purc_rwstream_t rwstream, uint32_t depth);
 
+/*
+ * Parse plain JSON in memory to a variant directly, without the VCM tree.
+ * Returns PURC_VARIANT_INVALID without setting any error if the text uses
+ * any eJSON extension or is malformed; the caller should fall back to
+ * pcejson_parse() then. On success, @consumed (if not NULL) returns
+ * the number of bytes parsed.
+ */
+purc_variant_t pcejson_parse_json (const char *json, size_t sz,
+                   uint32_t depth, size_t *consumed);
+
 #ifdef __cplusplus
 }
 #endif  /* __cplusplus */
@@ -27,10 +27,13 @@
 
 #include "config.h"
 
+#include <stddef.h>
+
 #include "purc-macros.h"
 #include "purc-errors.h"
 #include "purc-executor.h"
 
+#include "private/list.h"
 #include "private/map.h"
 
 PCA_EXTERN_C_BEGIN
@@ -98,9 +101,78 @@ int pcexec_register_ops(pcexec_ops_t ops);
 int pcexec_get_by_rule(const char *rule, pcexec_ops_t ops);
 
 
+// the maximal number of compiled rules kept by the rule cache of an instance
+#define PCEXECUTOR_RULE_CACHE_CAPACITY      128
+
+// the leading members of the param of every executor with a rule parser
+struct pcexec_rule_param {
+    char              *err_msg;
+    int                debug_flex;
+    int                debug_bison;
+};
+
+// the operations to compile a rule string into an executor-specific param,
+// which starts with the members of struct pcexec_rule_param
+struct pcexec_rule_ops {
+    // the size of the compiled param
+    size_t             size;
+
+    // parse `input` into the zero-filled `param`; returns 0 on success,
+    // otherwise non-zero with the error message in the `err_msg` member
+    int  (*parse)(const char *input, size_t len, void *param);
+
+    // release the resources held by `param`
+    void (*reset)(void *param);
+};
+
+/*
+ * Define `<name>_rule_ops` for the param `struct <name>_param` by the
+ * parser `<name>_parse()` and `<name>_param_reset()` of an executor.
+ */
+#define PCEXEC_DEFINE_RULE_OPS(name)                                        \
+    typedef int _dummy_##name##_rule_param[                                 \
+        (offsetof(struct name##_param, err_msg) ==                          \
+            offsetof(struct pcexec_rule_param, err_msg) &&                  \
+        offsetof(struct name##_param, debug_flex) ==                        \
+            offsetof(struct pcexec_rule_param, debug_flex) &&               \
+        offsetof(struct name##_param, debug_bison) ==                       \
+            offsetof(struct pcexec_rule_param, debug_bison)) * 2 - 1];      \
+                                                                            \
+    static int                                                              \
+    name##_rule_parse(const char *input, size_t len, void *param)           \
+    {                                                                       \
+        return name##_parse(input, len, (struct name##_param *)param);      \
+    }                                                                       \
+                                                                            \
+    static void                                                             \
+    name##_rule_reset(void *param)                                          \
+    {                                                                       \
+        name##_param_reset((struct name##_param *)param);                   \
+    }                                                                       \
+                                                                            \
+    static const struct pcexec_rule_ops name##_rule_ops = {                 \
+        .size        = sizeof(struct name##_param),                         \
+        .parse       = name##_rule_parse,                                   \
+        .reset       = name##_rule_reset,                                   \
+    }
+
+struct pcexec_rule_cache_stat {
+    size_t nr_hits;
+    size_t nr_misses;
+    size_t nr_evictions;
+    size_t nr_entries;
+    size_t capacity;
+};
+
 struct pcexecutor_heap {
     unsigned int       debug_flex:1;
     unsigned int       debug_bison:1;
+
+    // the compiled rules, keyed by (ops, rule string)
+    struct pcutils_map                 *rule_cache;
+    // the compiled rules in LRU order, the most recently used first
+    struct list_head                    rule_lru;
+    struct pcexec_rule_cache_stat       rule_stat;
 };
 
 // 用于迭代的迭代器
@@ -132,6 +204,29 @@ void pcexecutor_get_debug(int *debug_flex, int *debug_bison);
 
 void pcexecutor_inst_reset(struct purc_exec_inst *inst);
 
+/*
+ * Get the compiled param of `rule` from the rule cache of the current
+ * instance, or compile it by calling `ops->parse` on a cache miss.
+ * The param is shared by all executor instances using the same rule.
+ * It is not strictly read-only: the matching helpers compile a wildcard
+ * pattern spec or a regular expression into it on first evaluation.
+ * This is safe because the cache belongs to one instance, and hence to one
+ * thread, and the compiled matcher depends only on the rule string, so
+ * every sharer would fill in the same value. The executors must not
+ * store any per-iteration state in the param. Every successful call must
+ * be paired with a call to pcexecutor_put_rule().
+ *
+ * Returns NULL on failure; the error message of the compiler, if any, is
+ * returned in `err_msg`.
+ */
+void *pcexecutor_get_rule(const struct pcexec_rule_ops *ops, const char *rule,
+        char **err_msg);
+
+void pcexecutor_put_rule(void *param);
+
+// the statistic of the rule cache of the current instance, for the tests
+const struct pcexec_rule_cache_stat *pcexecutor_rule_cache_stat(void);
+
 
 int pcexecutor_register(pcexec_ops_t ops);
 
@@ -41,6 +41,7 @@ enum pcfetcher_request_method {
 
 #define RESP_CODE_USER_STOP         -1
 #define RESP_CODE_USER_CANCEL       -2
+#define RESP_CODE_BAD_RESOURCE      -3
 
 struct pcfetcher_resp_header {
     int ret_code;
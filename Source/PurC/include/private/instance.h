@@ -93,8 +93,12 @@ struct pcinst {
 
     struct pcvariant_heap  *variant_heap;
     struct pcvariant_heap  *org_vrt_heap;
+    /* the arena used when moving variants to other instances */
+    struct pcvariant_heap  *move_arena;
 
     struct pcvarmgr        *variables;
+    // bumped whenever a name is bound to or unbound from any variable manager
+    uint64_t                var_names_gen;
 
     struct pcrdr_conn      *conn_to_rdr;
     struct renderer_capabilities *rdr_caps;
@@ -123,6 +127,13 @@ pcinst_get_session_variables(const char* name)
 struct pcrdr_msg *pcinst_get_message(void) WTF_INTERNAL;
 void pcinst_put_message(struct pcrdr_msg *msg) WTF_INTERNAL;
 
+typedef void (*pcinst_wakeup_fn)(void *ctxt);
+
+/* Set the function which will be called (in the thread of the sender)
+   when a message is moved to the move buffer of the current instance. */
+int pcinst_set_move_buffer_wakeup(pcinst_wakeup_fn func,
+        void *ctxt) WTF_INTERNAL;
+
 int
 pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
         purc_variant_t source_uri, purc_variant_t observed,
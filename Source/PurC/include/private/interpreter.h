@@ -125,7 +125,25 @@ struct pcintr_heap {
 
     purc_cond_handler    cond_handler;
     unsigned int         keep_alive:1;
+    unsigned int         schedule_pending:1;
     double               timestamp;
+
+    // coroutines which need to be visited by the scheduler:
+    // ready to execute one step, or having new messages or tasks
+    struct list_head     active_coroutines;
+
+    pcintr_timer_t       *idle_timer;       // IDLE_EVENT_TIMEOUT
+    uintptr_t            conn_monitor;      // fd monitor of conn_to_rdr
+    int                  conn_monitor_fd;
+
+    // the DOM operations queued during one step of a coroutine;
+    // they are coalesced and sent to the renderer in one batch
+    // when the step finishes (see pcintr_rdr_flush_dom_batch()).
+    struct list_head     rdr_dom_reqs;      // struct pcintr_rdr_dom_req
+    size_t               nr_rdr_dom_reqs;
+    size_t               nr_rdr_dom_pending;    // sent, not responded yet
+    size_t               nr_rdr_dom_failed;
+    unsigned int         rdr_dom_batching:1;
 };
 
 struct pcintr_stack_frame;
@@ -140,6 +158,47 @@ struct pcintr_stack_frame_pseudo;
 typedef struct pcintr_stack_frame_pseudo pcintr_stack_frame_pseudo;
 typedef struct pcintr_stack_frame_pseudo *pcintr_stack_frame_pseudo_t;
 
+struct pcregex;
+struct pcintr_observer;
+struct pcintr_observer_bucket;
+struct pcintr_observer_iterator;
+
+/*
+ * The index of the observers for dispatching events: the observers using
+ * the default matching function are hashed by (observed, event type),
+ * those observing native entities are hashed by the event type only,
+ * and the others are kept in a generic list.
+ */
+struct pcintr_observer_index {
+    struct pcintr_observer_bucket **buckets;
+    size_t                          nr_buckets;
+    size_t                          nr_keys;
+
+    /* the observers having their own matching functions */
+    struct list_head                generic;
+
+    /* the serial number of the last registered observer */
+    uint64_t                        last_serial;
+
+    /* the iterators in use; the buckets are kept while dispatching */
+    struct pcintr_observer_iterator *iterators;
+    /* the buckets emptied while the iterators are in use */
+    struct pcintr_observer_bucket  *empty_buckets;
+};
+
+/* the iterator over the candidate observers of an event */
+struct pcintr_observer_iterator {
+    struct pcintr_observer_index   *index;
+    struct pcintr_observer_iterator *prev;
+
+#define PCINTR_NR_OBSERVER_LISTS    3
+    struct list_head               *heads[PCINTR_NR_OBSERVER_LISTS];
+    struct list_head               *nexts[PCINTR_NR_OBSERVER_LISTS];
+
+    /* the serial number of the last observer to iterate */
+    uint64_t                        last_serial;
+};
+
 struct pcintr_observer;
 typedef void (*observer_on_revoke_fn)(struct pcintr_observer *observer,
         void *data);
@@ -226,6 +285,10 @@ struct pcintr_stack {
     /* create by hvml <observe on...> */
     struct list_head              hvml_observers;
 
+    /* the indexes of the observers above for dispatching events */
+    struct pcintr_observer_index  intr_index;
+    struct pcintr_observer_index  hvml_index;
+
     // async request ids (array)
     purc_variant_t                async_request_ids;
 
@@ -280,6 +343,7 @@ struct pcintr_coroutine {
     purc_variant_t              doc_wrotten_len;
 
     struct rb_node              node;     /* heap::coroutines */
+    struct list_head            ln_active; /* heap::active_coroutines */
 
     struct list_head            children; /* struct pcintr_coroutine_child */
 
@@ -407,6 +471,9 @@ struct pcintr_stack_frame {
     purc_variant_t     except_templates;
     purc_variant_t     error_templates;
 
+    // the variable managers resolved for the names looked up from this frame
+    struct pcintr_named_var_cache *named_var_cache;
+
     unsigned int       silently:1;
 };
 
@@ -461,11 +528,23 @@ struct pcintr_observer {
     observer_on_revoke_fn on_revoke;
     void *on_revoke_data;
 
+    // NULL for the default matching function
     observer_match_fn   is_match;
     observer_handle_fn  handle;
     void               *handle_data;
     bool                auto_remove;
     uint64_t            timestamp;
+
+    // linked in the index of the observers
+    struct list_head                node_index;
+    struct pcintr_observer_index   *index;
+    struct pcintr_observer_bucket  *bucket;
+    // the serial number in the index, in the order of registration
+    uint64_t                        serial;
+
+    // the matcher of the sub type compiled when registering
+    int                 sub_type_kind;
+    struct pcregex     *sub_type_regex;
 };
 
 struct pcinst;
@@ -584,6 +663,9 @@ pcintr_get_scope_variable(purc_coroutine_t cor, pcvdom_element_t elem,
 purc_variant_t
 pcintr_find_named_var(pcintr_stack_t stack, const char* name);
 
+void
+pcintr_release_named_var_cache(struct pcintr_stack_frame *frame);
+
 purc_variant_t
 pcintr_get_symbolized_var (pcintr_stack_t stack, unsigned int number,
         char symbol);
@@ -660,6 +742,40 @@ void
 pcintr_revoke_observer_ex(pcintr_stack_t stack, purc_variant_t observed,
         purc_atom_t msg_type_atom, const char *sub_type);
 
+bool
+pcintr_is_observer_match(struct pcintr_observer *observer, pcrdr_msg *msg,
+        purc_variant_t observed, purc_atom_t type, const char *sub_type);
+
+void
+pcintr_observer_index_init(struct pcintr_observer_index *index);
+
+/* all observers should have been removed from the index */
+void
+pcintr_observer_index_cleanup(struct pcintr_observer_index *index);
+
+int
+pcintr_observer_index_add(struct pcintr_observer_index *index,
+        struct pcintr_observer *observer);
+
+void
+pcintr_observer_index_remove(struct pcintr_observer *observer);
+
+/*
+ * Iterates the observers which may match the event in the order of
+ * registration. The observers can be registered or revoked during
+ * the iteration; those registered are not iterated.
+ */
+void
+pcintr_observer_index_begin(struct pcintr_observer_index *index,
+        struct pcintr_observer_iterator *it,
+        purc_variant_t observed, purc_atom_t type);
+
+struct pcintr_observer *
+pcintr_observer_index_next(struct pcintr_observer_iterator *it);
+
+void
+pcintr_observer_index_end(struct pcintr_observer_iterator *it);
+
 bool
 pcintr_load_dynamic_variant(pcintr_coroutine_t cor,
     const char *name, size_t len);
@@ -742,6 +858,10 @@ pcintr_coroutine_get_uri(pcintr_coroutine_t co)
 void
 pcintr_schedule(void *ctxt);
 
+/* put the coroutine into the active queue and request a scheduling */
+void
+pcintr_coroutine_wakeup(pcintr_coroutine_t co);
+
 void
 pcintr_coroutine_set_result(pcintr_coroutine_t co, purc_variant_t result);
 
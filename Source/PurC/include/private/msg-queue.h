@@ -29,6 +29,7 @@
 
 #include "config.h"
 
+#include <stddef.h>
 #include <stdatomic.h>
 
 #include "private/list.h"
@@ -39,20 +40,36 @@
 #define MSG_QS_EVENT    0x40000000
 #define MSG_QS_VOID     0x80000000
 
+/* the index slot of the queued events having the same key */
+struct pcinst_event_slot;
+
 struct pcinst_msg_hdr {
     atomic_uint             owner;
     struct list_head        ln;
+    /* the index slot of a queued event */
+    struct pcinst_event_slot *event_slot;
 };
 
 struct pcinst_msg_queue {
-    struct purc_rwlock  lock;
+    /* the lock for the requests, the responses and the void messages */
+    struct purc_mutex   lock;
     struct list_head    req_msgs;
     struct list_head    res_msgs;
-    struct list_head    event_msgs;
     struct list_head    void_msgs;
 
-    uint64_t            state;
-    size_t              nr_msgs;
+    /* the lock for the events and the index of events */
+    struct purc_mutex   event_lock;
+    struct list_head    event_msgs;
+
+    /* the hash index of the queued events keyed by
+       (target, targetValue, eventName, elementValue) */
+    struct pcinst_event_slot  **event_slots;
+    size_t              nr_event_slots;     /* the number of buckets */
+    size_t              nr_event_keys;
+
+    /* read without locking to check the queue quickly */
+    atomic_uint         state;
+    atomic_size_t       nr_msgs;
 };
 
 /* Make sure the size of `struct list_head` is two times of sizeof(void *) */
@@ -62,6 +79,9 @@ _COMPILE_TIME_ASSERT(onwer_atom,
         sizeof(atomic_uint) == sizeof(purc_atom_t));
 _COMPILE_TIME_ASSERT(list_head,
         sizeof(struct list_head) == (sizeof(void *) * 2));
+_COMPILE_TIME_ASSERT(msg_hdr,
+        offsetof(struct pcinst_msg_hdr, event_slot) ==
+        offsetof(struct pcrdr_msg, __padding3));
 #undef _COMPILE_TIME_ASSERT
 
 PCA_EXTERN_C_BEGIN
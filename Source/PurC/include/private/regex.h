@@ -77,7 +77,9 @@ extern "C" {
 
 
 /*
- * Scans for a match in string for pattern
+ * Scans for a match in string for pattern. The compiled pattern is kept
+ * in a per-thread LRU cache, so repeated checks against the same pattern
+ * do not compile it again.
  */
 bool pcregex_is_match_ex(const char *pattern, const char *str,
         enum pcregex_compile_flags compile_options,
@@ -95,8 +97,26 @@ struct pcregex *pcregex_new_ex(const char *pattern,
 
 struct pcregex *pcregex_new(const char *pattern);
 
+/*
+ * Returns a reference to the compiled form of the pattern shared through
+ * the per-thread cache. Release it with pcregex_destroy().
+ */
+struct pcregex *pcregex_lookup(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options);
+
+struct pcregex *pcregex_ref(struct pcregex *regex);
+
+/*
+ * Drops a reference to the regex; frees it when it was the last one.
+ */
 void pcregex_destroy(struct pcregex *regex);
 
+/*
+ * Empties the pattern cache of the calling thread.
+ */
+void pcregex_cache_cleanup(void);
+
 
 /*
  * Scans for a match in string for the pattern in regex.
@@ -25,5 +25,36 @@
 #ifndef PURC_PRIVATE_RWSTREAM_H
 #define PURC_PRIVATE_RWSTREAM_H
 
+#include "purc-rwstream.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+PCA_EXTERN_C_BEGIN
+
+/*
+ * Returns the bytes of a memory-backed stream from the current position
+ * without copying them, or NULL (no error set) for other kinds of streams.
+ */
+const uint8_t *pcrwstream_peek_mem(purc_rwstream_t rws, size_t *sz_avail);
+
+/*
+ * Advances the current position of a memory-backed stream by the bytes
+ * which were returned by pcrwstream_peek_mem() and have been consumed.
+ */
+void pcrwstream_consume_mem(purc_rwstream_t rws, size_t count);
+
+typedef void (*pcrws_cb_release)(void *ctxt);
+
+/*
+ * Creates a read-only stream over the given memory without copying it.
+ * The memory is handed over to the stream: @release (nullable) is called
+ * with @ctxt when the stream is destroyed. Writing to the stream fails.
+ */
+purc_rwstream_t pcrwstream_new_from_mem_ro(const void *mem, size_t sz,
+        pcrws_cb_release release, void *ctxt);
+
+PCA_EXTERN_C_END
+
 #endif /* not defined PURC_PRIVATE_RWSTREAM_H */
 
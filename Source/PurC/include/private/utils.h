@@ -231,6 +231,17 @@ int pcutils_parse_uint64(const char *buf, size_t len, uint64_t *retval);
 int pcutils_parse_double(const char *buf, size_t len, double *retval);
 int pcutils_parse_long_double(const char *buf, size_t len, long double *retval);
 
+/* the size of the buffer for pcutils_dtoa_shortest(), including
+ * the terminating null byte */
+#define PCUTILS_DTOA_BUFSZ      32
+
+/*
+ * Formats a finite double in the style of `%.17g`, but with the fewest
+ * digits which still read back to the same double; e.g. `0.1` instead of
+ * `0.10000000000000001`. Returns the length of the string in @buf.
+ */
+size_t pcutils_dtoa_shortest(double d, char *buf);
+
 struct pcutils_mystring {
     char *buff;
     size_t nr_bytes;
@@ -40,6 +40,7 @@ PCA_EXTERN_C_BEGIN
 #define PCVARIANT_FLAG_NOFREE          PCVARIANT_FLAG_CONSTANT
 #define PCVARIANT_FLAG_EXTRA_SIZE      (0x01 << 1)  // when use extra space
 #define PCVARIANT_FLAG_STRING_STATIC   (0x01 << 2)  // make_string_static
+#define PCVARIANT_FLAG_FROZEN          (0x01 << 3)  // shared by instances
 
 #define PVT(t)          (PURC_VARIANT_TYPE##t)
 #define IS_CONTAINER(t) (t == PURC_VARIANT_TYPE_OBJECT || \
@@ -209,8 +210,27 @@ struct pcvariant_heap {
 #else
     struct list_head    v_reserved;
 #endif
+
+    // the slab allocator of the instance; NULL for the move heap and arenas.
+    struct pcvariant_slab *slab;
 };
 
+/* the largest object the slab allocator for variants serves */
+#define PCVARIANT_SLAB_MAX_SIZE \
+    (PURC_VARIANT_NR_SLAB_CLASSES * 16)
+
+struct pcvariant_slab *pcvariant_slab_new(void) WTF_INTERNAL;
+void pcvariant_slab_delete(struct pcvariant_slab *slab) WTF_INTERNAL;
+void pcvariant_slab_stat(struct pcvariant_slab *slab,
+        struct purc_variant_stat *stat) WTF_INTERNAL;
+
+/* allocate/free an object of at most PCVARIANT_SLAB_MAX_SIZE bytes from
+   the slab allocator of the current instance. The object can be freed by
+   any instance or thread. */
+void *pcvariant_slab_alloc(size_t size);
+void *pcvariant_slab_alloc_0(size_t size);
+void pcvariant_slab_free(void *ptr);
+
 // internal interfaces for moving variant.
 purc_variant_t pcvariant_move_heap_in(purc_variant_t v) WTF_INTERNAL;
 purc_variant_t pcvariant_move_heap_out(purc_variant_t v) WTF_INTERNAL;
@@ -218,6 +238,9 @@ purc_variant_t pcvariant_move_heap_out(purc_variant_t v) WTF_INTERNAL;
 void pcvariant_use_move_heap(void) WTF_INTERNAL;
 void pcvariant_use_norm_heap(void) WTF_INTERNAL;
 
+// account a frozen variant in the current heap before releasing it.
+void pcvariant_move_heap_thaw(purc_variant_t v) WTF_INTERNAL;
+
 purc_variant *pcvariant_alloc(void) WTF_INTERNAL;
 purc_variant *pcvariant_alloc_0(void) WTF_INTERNAL;
 void pcvariant_free(purc_variant *v) WTF_INTERNAL;
@@ -229,8 +252,10 @@ struct pcvar_rev_update_edge {
     union {
         // where to locate in parent
         struct set_node             *set_me;
-        struct obj_node             *obj_me;
-        struct arr_node             *arr_me;
+        // an odd number unique to the member in the object
+        void                        *obj_me;
+        // an odd number unique to the slot of the member in the array
+        void                        *arr_me;
     };
 };
 
@@ -241,7 +266,7 @@ struct set_node {
     struct rb_node                       rbnode;
     struct pcutils_array_list_node       alnode;
     purc_variant_t   val;  // actual variant-element
-    char             md5[33];
+    uint64_t         hash; // see pcvariant_hash_by_set()
 };
 
 struct variant_set {
@@ -249,10 +274,17 @@ struct variant_set {
     const char            **keynames;
     size_t                  nr_keynames;
     bool                    caseless;
-    struct rb_root          elems;  // multiple-variant-elements stored in set
+    // multiple-variant-elements stored in set, ordered by the hashes and
+    // then the values; by the values only if caseless.
+    struct rb_root          elems;
     struct pcutils_array_list al;    // struct set_node
 
-    // key: arr_node/obj_node/set_node
+    // open-addressing index of the nodes keyed by hash (linear probing);
+    // not used by caseless sets.
+    struct set_node       **slots;
+    size_t                  nr_slots;   // zero or power of 2
+
+    // key: arr_me/obj_me/set_node
     // val: parent
     pcutils_map                     *rev_update_chain;
 };
@@ -260,33 +292,88 @@ struct variant_set {
 // internal struct used by variant-obj object
 typedef struct variant_obj      *variant_obj_t;
 
-struct obj_node {
-    struct rb_node   node;
+struct obj_member {
     purc_variant_t   key;
     purc_variant_t   val;
+    purc_atom_t      atom;  // the key interned in ATOM_BUCKET_OBJKEY
 };
 
+// a member of a hashed object
+struct obj_node {
+    struct obj_member       m;
+    struct rb_node          node;
+    uintptr_t               edge_key;   // zero until an edge is built
+};
+
+// an object having more members is converted to the hashed form
+#define PCVARIANT_OBJ_HASH_THRESHOLD   16
+
 struct variant_obj {
-    struct rb_root          kvs;  // struct obj_node*
     size_t                  size;
+    bool                    hashed;
+
+    union {
+        // the flat form: the members stored contiguously, ordered by keys,
+        // and looked up by a linear scan over the atoms of the keys.
+        struct {
+            struct obj_member      *members;
+            uint32_t                sz;         // the capacity of members
+            // the keys of the edges from the members to this object, in the
+            // same order as members; only allocated while in a set.
+            uintptr_t              *edge_keys;
+        };
+
+        // the hashed form: the nodes ordered by keys in kvs, and indexed
+        // by the atoms of the keys (open addressing with linear probing).
+        struct {
+            struct rb_root          kvs;
+            struct obj_node       **slots;
+            uint32_t                nr_slots;   // power of 2
+        };
+    };
 
-    // key: arr_node/obj_node/set_node
+    // key: arr_me/obj_me/set_node
     // val: parent
     pcutils_map                     *rev_update_chain;
 };
 
+struct obj_iterator {
+    purc_variant_t                obj;
+
+    struct obj_member            *curr;     // NULL at the end
+    purc_atom_t                   atom;     // the atom of curr
+
+    // the flat form: the index of curr
+    size_t                        idx;
+    // the hashed form: the neighbours of curr
+    struct obj_node              *next;
+    struct obj_node              *prev;
+};
+
+struct obj_iterator
+pcvar_obj_it_first(purc_variant_t obj);
+struct obj_iterator
+pcvar_obj_it_last(purc_variant_t obj);
+void
+pcvar_obj_it_next(struct obj_iterator *it);
+void
+pcvar_obj_it_prev(struct obj_iterator *it);
+
 // internal struct used by variant-arr
 typedef struct variant_arr      *variant_arr_t;
 
-struct arr_node {
-    struct pcutils_array_list_node       node;
-    purc_variant_t   val;
-};
+#define PCVARIANT_ARR_MIN_SIZE         8
 
 struct variant_arr {
-    struct pcutils_array_list     al;  // struct arr_node*
+    purc_variant_t         *vals;   // the members stored contiguously
+    size_t                  nr;
+    size_t                  sz;     // the capacity of vals
 
-    // key: arr_node/obj_node/set_node
+    // the keys of the edges from the members to this array, in the same
+    // order as vals; only allocated while the array belongs to a set.
+    uintptr_t              *edge_keys;
+
+    // key: arr_me/obj_me/set_node
     // val: parent
     pcutils_map                     *rev_update_chain;
 };
@@ -300,6 +387,29 @@ int pcvariant_array_sort(purc_variant_t value, void *ud,
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud));
 
+/* sort the members by keys computed once per member before sorting */
+struct pcvariant_sort_ops {
+    size_t      key_size;
+    // fill the key of a member; return 0 on success.
+    int  (*make_key)(purc_variant_t val, void *key, void *ud);
+    // compare two keys; may be called from other threads and
+    // shall not touch any variant.
+    int  (*cmp_key)(const void *l, const void *r, void *ud);
+    // release the key, can be NULL.
+    void (*free_key)(void *key, void *ud);
+};
+
+int pcvariant_array_sort_by_keys(purc_variant_t value, void *ud,
+        const struct pcvariant_sort_ops *ops);
+/* swap two members without firing any event */
+int pcvariant_array_swap(purc_variant_t value, size_t i, size_t j);
+int pcvariant_set_sort_by_keys(purc_variant_t value, void *ud,
+        const struct pcvariant_sort_ops *ops);
+
+/* the string used to compare the value as a sort key: the string itself
+ * for string-like values, otherwise the stringified copy stored in *buf. */
+const char *pcvariant_sort_key_string(purc_variant_t val, char **buf);
+
 int pcvariant_diff(purc_variant_t l, purc_variant_t r);
 int pcvariant_diff_ex(purc_variant_t l, purc_variant_t r,
         enum purc_variant_compare_opt opt);
@@ -391,6 +501,10 @@ pcvariant_is_in_set (purc_variant_t set, purc_variant_t value)
 purc_variant_t
 pcvariant_object_shallow_copy(purc_variant_t obj);
 
+/* Like purc_variant_object_get_by_ckey(), but sets no error when absent */
+purc_variant_t
+pcvariant_object_find(purc_variant_t obj, const char* key);
+
 bool
 pcvariant_object_clear(purc_variant_t object, bool silently);
 
@@ -415,27 +529,18 @@ purc_variant_t *tuple_members(purc_variant_t tuple, size_t *sz)
     return tuple->vrt_vrt;
 }
 
-// md5 shall be at least 33 bytes long
-void pcvariant_md5_ex(char *md5, purc_variant_t val, const char *salt,
-    bool caseless, unsigned int serialize_flags) WTF_INTERNAL;
+// 64-bit hash of the stringified form of the variant
+uint64_t
+pcvariant_hash(purc_variant_t val) WTF_INTERNAL;
 
-PCA_INLINE void
-pcvariant_md5(char *md5, purc_variant_t val)
-{
-    const char *salt = NULL;
-    unsigned int serialize_flags = 0;
-    bool caseless = false;
-    pcvariant_md5_ex(md5, val, salt, caseless, serialize_flags);
-}
+// hash of the value (or of its unique keys) as compared by the set
+uint64_t
+pcvariant_hash_by_set(purc_variant_t val, purc_variant_t set) WTF_INTERNAL;
 
-// md5 shall be at least 33 bytes long
-void
-pcvariant_md5_by_set(char *md5, purc_variant_t val,
-        purc_variant_t set) WTF_INTERNAL;
-
-int
-pcvariant_diff_by_set(const char *md5l, purc_variant_t l,
-        const char *md5r, purc_variant_t r, purc_variant_t set);
+// hash consistent with purc_variant_is_equal_to(): equal variants have
+// the same hash
+uint64_t
+pcvariant_hash_equal(purc_variant_t val) WTF_INTERNAL;
 
 PCA_EXTERN_C_END
 
@@ -450,113 +555,74 @@ PCA_EXTERN_C_END
 
 // purc_variant_t _arr;
 #define variant_array_get_data(_arr)        \
-    &(((variant_arr_t)_arr->sz_ptr[1])->al)
-
-// purc_variant_t _arr;
-// struct arr_node *_p;
-#define foreach_in_variant_array(_arr, _p)                               \
-    array_list_for_each_entry(variant_array_get_data(_arr),              \
-            _p, node)
-
-// purc_variant_t _arr;
-// struct arr_node *_p, *_n;
-#define foreach_in_variant_array_safe(_arr, _p, _n)                      \
-    array_list_for_each_entry_safe(variant_array_get_data(_arr),         \
-            _p, _n, node)
-
-// purc_variant_t _arr;
-// struct arr_node *_p;
-#define foreach_in_variant_array_reverse(_arr, _p)                       \
-    array_list_for_each_entry_reverse(variant_array_get_data(_arr),      \
-            _p, node)
-
-// purc_variant_t _arr;
-// struct arr_node *_p, *_n;
-#define foreach_in_variant_array_reverse_safe(_arr, _p, _n)              \
-    array_list_for_each_entry_reverse_safe(variant_array_get_data(_arr), \
-            _p, _n, node)
+    ((variant_arr_t)(_arr)->sz_ptr[1])
 
 #define foreach_value_in_variant_array(_arr, _val, _idx)              \
     do {                                                              \
-        struct arr_node *_p;                                          \
-        foreach_in_variant_array(_arr, _p) {                          \
-            _val = _p->val;                                           \
-            _idx = _p->node.idx;                                      \
+        variant_arr_t _data = variant_array_get_data(_arr);           \
+        size_t _i;                                                    \
+        for (_i = 0; _i < _data->nr; _i++) {                          \
+            _val = _data->vals[_i];                                   \
+            _idx = _i;                                                \
      /* } */                                                          \
  /* } while (0) */
 
-#define foreach_value_in_variant_array_safe(_arr, _val, _idx)      \
-    do {                                                           \
-        struct arr_node *_p, *_n;                                  \
-        foreach_in_variant_array_safe(_arr, _p, _n) {              \
-            _val = _p->val;                                        \
-            _idx = _p->node.idx;                                   \
-     /* } */                                                       \
+// the body may remove the current member
+#define foreach_value_in_variant_array_safe(_arr, _val, _idx)         \
+    do {                                                              \
+        variant_arr_t _data = variant_array_get_data(_arr);           \
+        size_t _i, _nr;                                               \
+        for (_i = 0; (_nr = _data->nr, _i < _nr);                     \
+             _i += (_data->nr < _nr) ? 0 : 1) {                       \
+            _val = _data->vals[_i];                                   \
+            _idx = _i;                                                \
+     /* } */                                                          \
  /* } while (0) */
 
 #define foreach_value_in_variant_array_reverse(_arr, _val, _idx)      \
     do {                                                              \
-        struct arr_node *_p;                                          \
-        foreach_in_variant_array_reverse(_arr, _p) {                  \
-            _val = _p->val;                                           \
-            _idx = _p->node.idx;                                      \
+        variant_arr_t _data = variant_array_get_data(_arr);           \
+        size_t _i;                                                    \
+        for (_i = _data->nr; _i > 0; ) {                              \
+            _val = _data->vals[--_i];                                 \
+            _idx = _i;                                                \
      /* } */                                                          \
  /* } while (0) */
 
-#define foreach_value_in_variant_array_reverse_safe(_arr, _val, _idx)   \
-    do {                                                                \
-        struct arr_node *_p, *_n;                                       \
-        foreach_in_variant_array_reverse_safe(_arr, _p, _n) {           \
-            _val = _p->val;                                             \
-            _idx = _p->node.idx;                                        \
-     /* } */                                                            \
+// the body may remove the current member
+#define foreach_value_in_variant_array_reverse_safe(_arr, _val, _idx) \
+    do {                                                              \
+        variant_arr_t _data = variant_array_get_data(_arr);           \
+        size_t _i;                                                    \
+        for (_i = _data->nr;                                          \
+             ({ if (_i > _data->nr) _i = _data->nr; _i > 0; }); ) {   \
+            _val = _data->vals[--_i];                                 \
+            _idx = _i;                                                \
+     /* } */                                                          \
  /* } while (0) */
 
 #define foreach_value_in_variant_object(_obj, _val)                 \
     do {                                                            \
-        variant_obj_t _data;                                        \
-        _data = (variant_obj_t)_obj->sz_ptr[1];                     \
-        struct rb_root *_root = &_data->kvs;                        \
-        struct rb_node *_p = pcutils_rbtree_first(_root);           \
-        for (; _p; _p = pcutils_rbtree_next(_p))                    \
+        struct obj_iterator _it = pcvar_obj_it_first(_obj);         \
+        for (; _it.curr; pcvar_obj_it_next(&_it))                   \
         {                                                           \
-            struct obj_node *_node;                                 \
-            _node = container_of(_p, struct obj_node, node);        \
-            _val = _node->val;                                      \
+            _val = _it.curr->val;                                   \
      /* } */                                                        \
  /* } while (0) */
 
 #define foreach_key_value_in_variant_object(_obj, _key, _val)       \
     do {                                                            \
-        variant_obj_t _data;                                        \
-        _data = (variant_obj_t)_obj->sz_ptr[1];                     \
-        struct rb_root *_root = &_data->kvs;                        \
-        struct rb_node *_p = pcutils_rbtree_first(_root);           \
-        for (; _p; _p = pcutils_rbtree_next(_p))                    \
+        struct obj_iterator _it = pcvar_obj_it_first(_obj);         \
+        for (; _it.curr; pcvar_obj_it_next(&_it))                   \
         {                                                           \
-            struct obj_node *_node;                                 \
-            _node = container_of(_p, struct obj_node, node);        \
-            _key = _node->key;                                      \
-            _val = _node->val;                                      \
+            _key = _it.curr->key;                                   \
+            _val = _it.curr->val;                                   \
      /* } */                                                        \
  /* } while (0) */
 
+// the body may remove the current member
 #define foreach_in_variant_object_safe_x(_obj, _key, _val)          \
-    do {                                                            \
-        variant_obj_t _data;                                        \
-        _data = (variant_obj_t)_obj->sz_ptr[1];                     \
-        struct rb_root *_root = &_data->kvs;                        \
-        struct rb_node *_p, *_next;                                 \
-        for (_p = pcutils_rbtree_first(_root);                      \
-            ({_next = _p ? pcutils_rbtree_next(_p) : NULL; _p;});   \
-            _p = _next)                                             \
-        {                                                           \
-            struct obj_node *_node;                                 \
-            _node = container_of(_p, struct obj_node, node);        \
-            _key = _node->key;                                      \
-            _val = _node->val;                                      \
-     /* } */                                                        \
- /* } while (0) */
+    foreach_key_value_in_variant_object(_obj, _key, _val)
 
 #define foreach_value_in_variant_set(_set, _val)                        \
     do {                                                                \
@@ -290,6 +290,17 @@ struct pcvdom_element*
 pcvdom_util_document_parse_fragment_buf(const unsigned char *buf, size_t len,
         struct pcvdom_pos *pos);
 
+// the version of the compact binary form of vDOM;
+// bump it whenever the layout of the binary form changes
+#define PCVDOM_BINARY_VERSION       1
+
+int
+pcvdom_util_document_write_binary(struct pcvdom_document *doc,
+        purc_rwstream_t out);
+
+struct pcvdom_document*
+pcvdom_util_document_from_binary(const void *buf, size_t len);
+
 enum pcvdom_util_node_serialize_opt {
     PCVDOM_UTIL_NODE_SERIALIZE__UNDEF,
     PCVDOM_UTIL_NODE_SERIALIZE_INDENT,
@@ -662,6 +662,7 @@ struct pcrdr_msg
     purc_atom_t             __owner;
     void                   *__padding1; // reserved for struct list_head
     void                   *__padding2; // reserved for struct list_head
+    void                   *__padding3; // reserved for the event index
 
     pcrdr_msg_type          type;
     pcrdr_msg_target        target;
@@ -1339,6 +1340,25 @@ purc_inst_retrieve_message(size_t index);
 PCA_EXPORT pcrdr_msg *
 purc_inst_take_away_message(size_t index);
 
+/**
+ * Get the statistics of the move buffer of an instance.
+ *
+ * @param inst_to: the atom of the endpoint of the instance.
+ * @param depth (nullable): the buffer to receive the number of the messages
+ *  moved to the move buffer but not taken away yet.
+ * @param nr_moved (nullable): the buffer to receive the total number of
+ *  the messages moved to the move buffer.
+ * @param nr_dropped (nullable): the buffer to receive the number of
+ *  the messages failed to move because the move buffer was full.
+ *
+ * Returns: 0 for success, otherwise the error code.
+ *
+ * Since: 0.8.2
+ */
+PCA_EXPORT int
+purc_inst_move_buffer_stats(purc_atom_t inst_to, size_t *depth,
+        size_t *nr_moved, size_t *nr_dropped);
+
 
 /**@}*/
 
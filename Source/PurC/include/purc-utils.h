@@ -371,6 +371,22 @@ static inline purc_atom_t purc_atom_from_static_string(const char* string) {
 PCA_EXPORT purc_atom_t
 purc_atom_try_string_ex(int bucket, const char* string);
 
+/**
+ * purc_atom_try_string_len:
+ * @bucket: the identifier of the atom bucket.
+ * @string: (nullable): a string, which is not necessarily null-terminated
+ * @len: the length of the string in bytes
+ *
+ * Same as purc_atom_try_string_ex() except that the string is given by
+ * its first @len bytes, so a part of a longer string can be looked up
+ * without copying it.
+ *
+ * Returns: the #purc_atom_t associated with the string, or 0 if @string is
+ *     %NULL or there is no #purc_atom_t associated with it
+ */
+PCA_EXPORT purc_atom_t
+purc_atom_try_string_len(int bucket, const char* string, size_t len);
+
 /**
  * purc_atom_try_string:
  * @string: (nullable): a string
@@ -402,7 +418,8 @@ static inline purc_atom_t purc_atom_try_string(const char* string) {
  * same string in the same bucket after calling this function, you will get
  * another atom value. Note that the old atom value will be invalid, i.e.,
  * you cannot get the string by calling purc_atom_to_string() by using the
- * old atom value.
+ * old atom value, and the string returned by purc_atom_to_string() for the
+ * old atom value will be freed soon.
  *
  * This function must not be used before library constructors have finished
  * running.
@@ -441,7 +458,8 @@ static inline bool purc_atom_remove_string(const char* string) {
  *
  * Gets the string associated with the given #purc_atom_t.
  *
- * Returns: the string associated with the #purc_atom_t
+ * Returns: the string associated with the #purc_atom_t; the string is
+ *      valid until the atom is removed.
  */
 PCA_EXPORT const char*
 purc_atom_to_string(purc_atom_t atom);
@@ -2182,6 +2182,21 @@ purc_variant_object_remove(purc_variant_t obj, purc_variant_t key,
 }
 
 
+/* The number of size classes of the slab allocator for variants. */
+#define PURC_VARIANT_NR_SLAB_CLASSES    8
+
+struct purc_variant_slab_stat {
+    /* the size of the objects in this class */
+    size_t sz_obj;
+    /* the number of objects in use (including those freed by other
+       instances but not yet reclaimed) */
+    size_t nr_used;
+    /* the number of free objects in the pages of this class */
+    size_t nr_free;
+    /* the number of pages held by this class */
+    size_t nr_pages;
+};
+
 struct purc_variant_stat {
     size_t nr_values[PURC_VARIANT_TYPE_NR];
     size_t sz_mem[PURC_VARIANT_TYPE_NR];
@@ -2189,6 +2204,12 @@ struct purc_variant_stat {
     size_t sz_total_mem;
     size_t nr_reserved;
     size_t nr_max_reserved;
+
+    /* the statistics of the slab allocator of the current instance, which
+       holds the variant headers and the nodes of containers */
+    struct purc_variant_slab_stat slab[PURC_VARIANT_NR_SLAB_CLASSES];
+    /* the memory occupied by the pages of the slab allocator */
+    size_t sz_slab_mem;
 };
 
 /**
@@ -354,6 +354,8 @@ purc_get_runner_variable(const char *name);
 struct pcvdom_document;
 typedef struct pcvdom_document* purc_vdom_t;
 
+#define PURC_ENVV_VDOM_CACHE_DIR    "PURC_VDOM_CACHE_DIR"
+
 /**
  * purc_load_hvml_from_string:
  *
@@ -361,6 +363,9 @@ typedef struct pcvdom_document* purc_vdom_t;
  *
  * Loads a HVML program from a string.
  *
+ * The compiled vDOM is cached on disk in the same way as
+ * purc_load_hvml_from_file() does.
+ *
  * Returns: A valid pointer to the vDOM tree for success; @NULL for failure.
  *
  * Since 0.0.1
@@ -375,6 +380,11 @@ purc_load_hvml_from_string(const char* string);
  *
  * Loads a HVML program from a file.
  *
+ * If the environment variable `PURC_VDOM_CACHE_DIR` names a directory,
+ * the compiled vDOM is also kept there in a binary form keyed by the MD5
+ * digest of the program, and is loaded from there next time instead
+ * of parsing the program again.
+ *
  * Returns: A valid pointer to the vDOM tree for success; @NULL for failure.
  *
  * Since 0.0.1
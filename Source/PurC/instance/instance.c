@@ -36,6 +36,7 @@
 #include "private/html.h"
 #include "private/vdom.h"
 #include "private/dom.h"
+#include "private/document.h"
 #include "private/dvobjs.h"
 #include "private/executor.h"
 #include "private/atom-buckets.h"
@@ -43,6 +44,7 @@
 #include "private/pcrdr.h"
 #include "private/msg-queue.h"
 #include "private/runners.h"
+#include "private/regex.h"
 #include "purc-runloop.h"
 
 #include "../interpreter/internal.h"
@@ -60,6 +62,7 @@
 #include "generic_err_msgs.inc"
 
 #define FETCHER_MAX_CONNS        100
+/* in KiB */
 #define FETCHER_CACHE_QUOTA      10240
 
 static struct const_str_atom _except_names[] = {
@@ -406,6 +409,9 @@ static void cleanup_instance(struct pcinst *curr_inst)
         curr_inst->bt = NULL;
     }
 
+    pcregex_cache_cleanup();
+    pcdoc_selector_cache_cleanup();
+
     purc_atom_remove_string_ex(PURC_ATOM_BUCKET_DEF,
             curr_inst->endpoint_name);
 
@@ -60,3 +60,9 @@ purc_atom_t pchvml_keyword_try_string(enum pcatom_bucket bucket,
     return purc_atom_try_string_ex(bucket, keyword);
 }
 
+purc_atom_t pchvml_keyword_try_string_len(enum pcatom_bucket bucket,
+        const char *keyword, size_t len)
+{
+    return purc_atom_try_string_len(bucket, keyword, len);
+}
+
@@ -37,8 +37,12 @@
 #include "private/utils.h"
 #include "private/ports.h"
 #include "private/debug.h"
+#include "private/tls.h"
 
 #include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+#include <sched.h>
 #include <assert.h>
 
 #if HAVE(GLIB)
@@ -46,22 +50,62 @@
 #endif
 
 #define NR_DEF_MAX_MSGS     4
+#define NR_MB_CACHE_SLOTS   16      /* must be a power of 2 */
 
 // #define PRINT_DEBUG
 
-struct pcinst_move_buffer {
-    struct purc_rwlock  lock;
-    struct list_head    msgs;
-
-    unsigned int        flags;
-    size_t              max_nr_msgs;
-    size_t              nr_msgs;
-};
-
 /* the header of the struct pcrdr_msg */
 struct pcrdr_msg_hdr {
     atomic_uint             owner;
-    struct list_head        ln;
+    union {
+        /* linked in the list of the messages drained by the owner */
+        struct list_head    ln;
+        /* linked in the lock-free queue of the move buffer */
+        struct pcrdr_msg_hdr * _Atomic next;
+    };
+};
+
+/*
+ * A move buffer is a bounded multi-producer/single-consumer queue (the
+ * intrusive queue of Dmitry Vyukov): the senders push the messages with one
+ * atomic exchange, and the owner drains them into the private list `msgs`,
+ * which serves the index-based retrieving and taking.
+ *
+ * Destroying a move buffer removes it from the map and puts it on the free
+ * list, from which the next move buffer is allocated. The memory of a move
+ * buffer is never returned to the system before exiting, so the senders can
+ * cache the pointer to the move buffer per atom without holding the lock;
+ * a sender checks the atom of the move buffer after registering itself
+ * in `nr_senders`, and a stale pointer in the cache is rejected.
+ */
+struct pcinst_move_buffer {
+    /* the last message pushed by the senders */
+    struct pcrdr_msg_hdr * _Atomic head;
+    /* the following members are only accessed by the owner */
+    struct pcrdr_msg_hdr   *tail;
+    struct pcrdr_msg_hdr    stub;
+    struct list_head        msgs;
+    size_t                  nr_msgs;
+
+    /* the following members are set before opening the move buffer */
+    atomic_uint             atom;
+    unsigned int            flags;
+    size_t                  max_nr_msgs;
+
+    atomic_bool             opened;
+    /* the number of the senders accessing the move buffer */
+    atomic_uint             nr_senders;
+
+    /* the number of messages reserved by the senders but not taken away */
+    atomic_size_t           depth;
+    atomic_size_t           nr_moved;
+    atomic_size_t           nr_dropped;
+
+    pcinst_wakeup_fn _Atomic wakeup;
+    void * _Atomic          wakeup_ctxt;
+
+    /* linked in the free list; protected by `mb_lock` */
+    struct pcinst_move_buffer *next_free;
 };
 
 /* Make sure the size of `struct list_head` is two times of sizeof(void *) */
@@ -71,10 +115,26 @@ _COMPILE_TIME_ASSERT(onwer_atom,
         sizeof(atomic_uint) == sizeof(purc_atom_t));
 _COMPILE_TIME_ASSERT(list_head,
         sizeof(struct list_head) == (sizeof(void *) * 2));
+_COMPILE_TIME_ASSERT(msg_hdr,
+        sizeof(struct pcrdr_msg_hdr) <= offsetof(pcrdr_msg, type));
 #undef _COMPILE_TIME_ASSERT
 
+/* the per-thread cache mapping the endpoint atoms to the move buffers */
+struct mb_cache {
+    /* the value of `mb_generation` when the cache was filled */
+    unsigned int                generation;
+    purc_atom_t                 atoms[NR_MB_CACHE_SLOTS];
+    struct pcinst_move_buffer  *mbs[NR_MB_CACHE_SLOTS];
+};
+
+PURC_DEFINE_THREAD_LOCAL(struct mb_cache, mb_cache);
+
 static struct purc_rwlock      mb_lock;
 static struct sorted_array    *mb_atom2buff_map;
+static struct pcinst_move_buffer *mb_free_list;
+
+/* increased when a move buffer is destroyed to invalidate the caches */
+static atomic_uint              mb_generation;
 
 static void mvbuf_cleanup_once(void)
 {
@@ -84,9 +144,23 @@ static void mvbuf_cleanup_once(void)
     }
 
     if (mb_atom2buff_map) {
+        struct pcinst_move_buffer *mb;
+        size_t count = pcutils_sorted_array_count(mb_atom2buff_map);
+
+        for (size_t i = 0; i < count; i++) {
+            pcutils_sorted_array_get(mb_atom2buff_map, i, (void **)&mb);
+            free(mb);
+        }
+
         pcutils_sorted_array_destroy(mb_atom2buff_map);
         mb_atom2buff_map = NULL;
     }
+
+    while (mb_free_list) {
+        struct pcinst_move_buffer *mb = mb_free_list;
+        mb_free_list = mb->next_free;
+        free(mb);
+    }
 }
 
 static int mvbuf_init_once(void)
@@ -117,6 +191,117 @@ fail_lock:
     return -1;
 }
 
+static struct pcinst_move_buffer *
+find_move_buffer(purc_atom_t atom)
+{
+    struct mb_cache *cache = PURC_GET_THREAD_LOCAL(mb_cache);
+    size_t slot = atom & (NR_MB_CACHE_SLOTS - 1);
+    struct pcinst_move_buffer *mb = NULL;
+
+    if (LIKELY(cache)) {
+        unsigned int generation = atomic_load(&mb_generation);
+        if (UNLIKELY(cache->generation != generation)) {
+            memset(cache, 0, sizeof(*cache));
+            cache->generation = generation;
+        }
+        else if (cache->atoms[slot] == atom && cache->mbs[slot]) {
+            return cache->mbs[slot];
+        }
+    }
+
+    purc_rwlock_reader_lock(&mb_lock);
+    if (!pcutils_sorted_array_find(mb_atom2buff_map,
+                (void *)(uintptr_t)atom, (void **)&mb))
+        mb = NULL;
+    purc_rwlock_reader_unlock(&mb_lock);
+
+    /* a move buffer destroyed after this bumps the generation */
+    if (mb && LIKELY(cache)) {
+        cache->atoms[slot] = atom;
+        cache->mbs[slot] = mb;
+    }
+
+    return mb;
+}
+
+static inline void
+wait_for_senders(struct pcinst_move_buffer *mb)
+{
+    while (atomic_load(&mb->nr_senders))
+        sched_yield();
+}
+
+static void
+mb_push(struct pcinst_move_buffer *mb, struct pcrdr_msg_hdr *hdr)
+{
+    struct pcrdr_msg_hdr *prev;
+
+    atomic_store_explicit(&hdr->next, NULL, memory_order_relaxed);
+    prev = atomic_exchange_explicit(&mb->head, hdr, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, hdr, memory_order_release);
+}
+
+/* only called by the owner */
+static struct pcrdr_msg_hdr *
+mb_pop(struct pcinst_move_buffer *mb)
+{
+    struct pcrdr_msg_hdr *tail = mb->tail;
+    struct pcrdr_msg_hdr *next;
+
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &mb->stub) {
+        if (next == NULL)
+            return NULL;
+
+        mb->tail = tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+
+    if (next) {
+        mb->tail = next;
+        return tail;
+    }
+
+    /* a sender has exchanged the head but not linked the message yet */
+    if (tail != atomic_load_explicit(&mb->head, memory_order_acquire))
+        return NULL;
+
+    mb_push(mb, &mb->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next) {
+        mb->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+/* only called by the owner */
+static void
+mb_drain(struct pcinst_move_buffer *mb)
+{
+    struct pcrdr_msg_hdr *hdr;
+
+    while ((hdr = mb_pop(mb))) {
+        list_add_tail(&hdr->ln, &mb->msgs);
+        mb->nr_msgs++;
+    }
+}
+
+/* returns the move buffer owned by the current instance if it is opened */
+static struct pcinst_move_buffer *
+my_move_buffer(struct pcinst *inst)
+{
+    struct pcinst_move_buffer *mb = find_move_buffer(inst->endpoint_atom);
+
+    if (mb && atomic_load_explicit(&mb->opened, memory_order_relaxed)) {
+        mb_drain(mb);
+        return mb;
+    }
+
+    return NULL;
+}
+
 pcrdr_msg *
 pcinst_get_message(void)
 {
@@ -192,46 +377,52 @@ purc_inst_create_move_buffer(unsigned int flags, size_t max_msgs)
     purc_rwlock_writer_lock(&mb_lock);
 
     if (pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)atom, (void **)&mb)) {
-        mb = NULL;
+                (void *)(uintptr_t)atom, NULL)) {
         errcode = PURC_ERROR_DUPLICATED;
         goto done;
     }
 
-    if ((mb = malloc(sizeof(*mb))) == NULL) {
-        errcode = PURC_ERROR_OUT_OF_MEMORY;
-        goto done;
+    if (mb_free_list) {
+        mb = mb_free_list;
     }
-
-    purc_rwlock_init(&mb->lock);
-    if (mb->lock.native_impl == NULL) {
-        errcode = PURC_ERROR_BAD_SYSTEM_CALL;
+    else if ((mb = calloc(1, sizeof(*mb))) == NULL) {
+        errcode = PURC_ERROR_OUT_OF_MEMORY;
         goto done;
     }
 
     if (pcutils_sorted_array_add(mb_atom2buff_map,
                 (void *)(uintptr_t)atom, mb) < 0) {
+        if (mb != mb_free_list)
+            free(mb);
         errcode = PURC_ERROR_OUT_OF_MEMORY;
         goto done;
     }
 
+    if (mb == mb_free_list)
+        mb_free_list = mb->next_free;
+    mb->next_free = NULL;
+
+    /* no sender can push a message to a closed move buffer */
+    atomic_store(&mb->stub.next, NULL);
+    atomic_store(&mb->head, &mb->stub);
+    mb->tail = &mb->stub;
+    list_head_init(&mb->msgs);
+
+    atomic_store(&mb->atom, atom);
     mb->flags = flags;
     mb->nr_msgs = 0;
     mb->max_nr_msgs = (max_msgs > 0) ? max_msgs : NR_DEF_MAX_MSGS;
-    list_head_init(&mb->msgs);
+    atomic_store(&mb->depth, 0);
+    atomic_store(&mb->nr_moved, 0);
+    atomic_store(&mb->nr_dropped, 0);
+    atomic_store(&mb->wakeup_ctxt, NULL);
+    atomic_store(&mb->wakeup, NULL);
+    atomic_store(&mb->opened, true);
 
 done:
     purc_rwlock_writer_unlock(&mb_lock);
 
     if (errcode) {
-        if (mb) {
-            if (mb->lock.native_impl) {
-                purc_rwlock_clear(&mb->lock);
-            }
-
-            free(mb);
-        }
-
         purc_set_error(errcode);
         return 0;
     }
@@ -277,21 +468,28 @@ purc_inst_destroy_move_buffer(void)
     if (inst == NULL)
         return -1;
 
-    purc_atom_t atom = inst->endpoint_atom;
-    int errcode = 0;
-    struct pcinst_move_buffer *mb = NULL;
+    struct pcinst_move_buffer *mb = find_move_buffer(inst->endpoint_atom);
+    if (mb == NULL || !atomic_load(&mb->opened)) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return -1;
+    }
 
+    /* the broadcasting senders can not see the move buffer after this */
     purc_rwlock_writer_lock(&mb_lock);
+    pcutils_sorted_array_remove(mb_atom2buff_map,
+            (void *)(uintptr_t)inst->endpoint_atom);
+    atomic_fetch_add(&mb_generation, 1);
+    purc_rwlock_writer_unlock(&mb_lock);
 
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)atom, (void **)&mb)) {
-        mb = NULL;
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
-    }
+    /* no sender can push a message after this */
+    atomic_store(&mb->opened, false);
+    wait_for_senders(mb);
+    atomic_store(&mb->wakeup, NULL);
+    atomic_store(&mb->wakeup_ctxt, NULL);
+
+    mb_drain(mb);
 
     struct list_head *p, *n;
-    purc_rwlock_writer_lock(&mb->lock);
     pcvariant_use_move_heap();
     list_for_each_safe(p, n, &mb->msgs) {
 
@@ -306,20 +504,13 @@ purc_inst_destroy_move_buffer(void)
         nr++;
     }
     pcvariant_use_norm_heap();
-    purc_rwlock_writer_unlock(&mb->lock);
 
-    pcutils_sorted_array_remove(mb_atom2buff_map, (void *)(uintptr_t)atom);
-    purc_rwlock_clear(&mb->lock);
-    free(mb);
+    atomic_store(&mb->depth, 0);
 
-done:
+    purc_rwlock_writer_lock(&mb_lock);
+    mb->next_free = mb_free_list;
+    mb_free_list = mb;
     purc_rwlock_writer_unlock(&mb_lock);
-
-    if (errcode) {
-        purc_set_error(errcode);
-        return -1;
-    }
-
     return nr;
 }
 
@@ -358,6 +549,51 @@ do_take_message(struct pcinst* inst, pcrdr_msg *msg)
     }
 }
 
+/*
+ * Moves the message to the move buffer; returns 0 for success, otherwise
+ * the error code and the message is left untouched.
+ */
+static int
+move_to_buffer(struct pcinst* inst, struct pcinst_move_buffer *mb,
+        purc_atom_t inst_to, pcrdr_msg *msg)
+{
+    int errcode = 0;
+
+    atomic_fetch_add(&mb->nr_senders, 1);
+    /* the move buffer may have been destroyed and reused for another atom */
+    if (!atomic_load(&mb->opened) || atomic_load(&mb->atom) != inst_to) {
+        errcode = PURC_ERROR_NOT_EXISTS;
+        goto done;
+    }
+
+    /* check before reserving to keep the full buffer from being hammered */
+    if (atomic_load_explicit(&mb->depth, memory_order_relaxed) >=
+            mb->max_nr_msgs) {
+        errcode = PURC_ERROR_TOO_SMALL_BUFF;
+    }
+    else if (atomic_fetch_add(&mb->depth, 1) >= mb->max_nr_msgs) {
+        atomic_fetch_sub(&mb->depth, 1);
+        errcode = PURC_ERROR_TOO_SMALL_BUFF;
+    }
+
+    if (errcode) {
+        atomic_fetch_add_explicit(&mb->nr_dropped, 1, memory_order_relaxed);
+        goto done;
+    }
+
+    do_move_message(inst, msg);
+    mb_push(mb, (struct pcrdr_msg_hdr *)msg);
+    atomic_fetch_add_explicit(&mb->nr_moved, 1, memory_order_relaxed);
+
+    pcinst_wakeup_fn wakeup = atomic_load(&mb->wakeup);
+    if (wakeup)
+        wakeup(atomic_load(&mb->wakeup_ctxt));
+
+done:
+    atomic_fetch_sub(&mb->nr_senders, 1);
+    return errcode;
+}
+
 size_t
 purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
 {
@@ -375,78 +611,55 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
         return 0;
     }
 
-    purc_rwlock_reader_lock(&mb_lock);
-
     if (inst_to != (purc_atom_t)PURC_EVENT_TARGET_BROADCAST) {
-        if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                    (void *)(uintptr_t)inst_to, (void **)&mb)) {
+        mb = find_move_buffer(inst_to);
+        if (mb == NULL)
             errcode = PURC_ERROR_NOT_EXISTS;
-            goto done;
-        }
-
-        if (mb->nr_msgs >= mb->max_nr_msgs) {
-            errcode = PURC_ERROR_TOO_SMALL_BUFF;
-            goto done;
-        }
-
-        do_move_message(inst, msg);
-
-        purc_rwlock_writer_lock(&mb->lock);
-        struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)msg;
-        list_add_tail(&hdr->ln, &mb->msgs);
-        mb->nr_msgs++;
-        purc_rwlock_writer_unlock(&mb->lock);
-
-        nr++;
+        else if ((errcode = move_to_buffer(inst, mb, inst_to, msg)) == 0)
+            nr++;
     }
     else {
-        size_t count = pcutils_sorted_array_count(mb_atom2buff_map);
+        purc_rwlock_reader_lock(&mb_lock);
 
+        size_t count = pcutils_sorted_array_count(mb_atom2buff_map);
         for (size_t i = 0; i < count; i++) {
             pcutils_sorted_array_get(mb_atom2buff_map, i, (void **)&mb);
-            if (mb->flags & PCINST_MOVE_BUFFER_BROADCAST &&
-                    mb->nr_msgs < mb->max_nr_msgs) {
+            if (!(mb->flags & PCINST_MOVE_BUFFER_BROADCAST) ||
+                    !atomic_load(&mb->opened))
+                continue;
 
-                pcrdr_msg *my_msg;
-
-                if (i == count - 1) {
-                    my_msg = msg;
-                    do_move_message(inst, msg);
-                    // FIXME: if count > 1 and flags without PCINST_MOVE_BUFFER_BROADCAST
-                    // not reatch here
-                    msg = NULL;
-                }
-                else {
-                    my_msg = pcrdr_clone_message(msg);
-                    if (my_msg) {
-                        do_move_message(inst, my_msg);
-                        pcrdr_release_message(my_msg);
-                    }
-                    else {
-                        PC_ERROR("failed to clone message to broadcast: %p\n",
-                                msg);
-                        break;
-                    }
+            pcrdr_msg *my_msg;
+            if (i == count - 1) {
+                my_msg = msg;
+            }
+            else {
+                my_msg = pcrdr_clone_message(msg);
+                if (my_msg == NULL) {
+                    PC_ERROR("failed to clone message to broadcast: %p\n",
+                            msg);
+                    break;
                 }
+            }
 
-                purc_rwlock_writer_lock(&mb->lock);
-                struct pcrdr_msg_hdr *hdr = (struct pcrdr_msg_hdr *)my_msg;
-                list_add_tail(&hdr->ln, &mb->msgs);
-                mb->nr_msgs++;
-                purc_rwlock_writer_unlock(&mb->lock);
+            if (move_to_buffer(inst, mb, atomic_load(&mb->atom),
+                        my_msg) == 0) {
+                if (my_msg == msg)
+                    msg = NULL;
                 nr++;
             }
+            else if (my_msg != msg) {
+                pcrdr_release_message(my_msg);
+            }
         }
 
+        purc_rwlock_reader_unlock(&mb_lock);
+
         // FIXME:
         if (msg) {
             pcrdr_release_message(msg);
         }
     }
 
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
-
     if (errcode) {
         purc_set_error(errcode);
     }
@@ -455,7 +668,7 @@ done:
 }
 
 int
-purc_inst_holding_messages_count(size_t *nr)
+pcinst_set_move_buffer_wakeup(pcinst_wakeup_fn func, void *ctxt)
 {
     struct pcinst* inst = pcinst_current();
     if (inst == NULL) {
@@ -463,28 +676,38 @@ purc_inst_holding_messages_count(size_t *nr)
         return PURC_ERROR_NO_INSTANCE;
     }
 
-    int errcode = 0;
-    struct pcinst_move_buffer *mb;
-
-    purc_rwlock_reader_lock(&mb_lock);
-
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb)) {
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
+    struct pcinst_move_buffer *mb = find_move_buffer(inst->endpoint_atom);
+    if (mb == NULL || !atomic_load(&mb->opened)) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return PURC_ERROR_NOT_EXISTS;
     }
 
-    /* no need to lock the buffer */
-    *nr = mb->nr_msgs;
+    /* make sure no sender is calling the old wakeup function on return */
+    atomic_store(&mb->wakeup, NULL);
+    wait_for_senders(mb);
 
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
+    atomic_store(&mb->wakeup_ctxt, ctxt);
+    atomic_store(&mb->wakeup, func);
+    return 0;
+}
 
-    if (errcode) {
-        purc_set_error(errcode);
+int
+purc_inst_holding_messages_count(size_t *nr)
+{
+    struct pcinst* inst = pcinst_current();
+    if (inst == NULL) {
+        purc_set_error(PURC_ERROR_NO_INSTANCE);
+        return PURC_ERROR_NO_INSTANCE;
     }
 
-    return errcode;
+    struct pcinst_move_buffer *mb = my_move_buffer(inst);
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return PURC_ERROR_NOT_EXISTS;
+    }
+
+    *nr = mb->nr_msgs;
+    return 0;
 }
 
 const pcrdr_msg *
@@ -494,19 +717,13 @@ purc_inst_retrieve_message(size_t index)
     if (inst == NULL)
         return NULL;
 
-    int errcode = 0;
     const pcrdr_msg *msg = NULL;
-    struct pcinst_move_buffer *mb;
-
-    purc_rwlock_reader_lock(&mb_lock);
-
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb)) {
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
+    struct pcinst_move_buffer *mb = my_move_buffer(inst);
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
 
-    purc_rwlock_reader_lock(&mb->lock);
     if (index < mb->nr_msgs) {
         struct list_head *p;
         struct pcrdr_msg_hdr *hdr;
@@ -522,14 +739,6 @@ purc_inst_retrieve_message(size_t index)
             i++;
         }
     }
-    purc_rwlock_reader_unlock(&mb->lock);
-
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
-
-    if (errcode) {
-        purc_set_error(errcode);
-    }
 
     return msg;
 }
@@ -543,19 +752,13 @@ purc_inst_take_away_message(size_t index)
         return NULL;
     }
 
-    int errcode = 0;
     pcrdr_msg *msg = NULL;
-    struct pcinst_move_buffer *mb;
-
-    purc_rwlock_reader_lock(&mb_lock);
-
-    if (!pcutils_sorted_array_find(mb_atom2buff_map,
-                (void *)(uintptr_t)inst->endpoint_atom, (void **)&mb)) {
-        errcode = PURC_ERROR_NOT_EXISTS;
-        goto done;
+    struct pcinst_move_buffer *mb = my_move_buffer(inst);
+    if (mb == NULL) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
 
-    purc_rwlock_writer_lock(&mb->lock);
     if (index < mb->nr_msgs) {
         struct list_head *p, *n;
         struct pcrdr_msg_hdr *hdr;
@@ -575,25 +778,41 @@ purc_inst_take_away_message(size_t index)
         }
     }
     else {
-        errcode = PURC_ERROR_NOT_EXISTS;
-    }
-    purc_rwlock_writer_unlock(&mb->lock);
-
-    if (msg)
-        do_take_message(inst, msg);
-
-done:
-    purc_rwlock_reader_unlock(&mb_lock);
-
-    if (errcode) {
-        purc_set_error(errcode);
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return NULL;
     }
 
+    /* release the slot for the senders */
+    atomic_fetch_sub(&mb->depth, 1);
+    do_take_message(inst, msg);
     return msg;
 }
 
+int
+purc_inst_move_buffer_stats(purc_atom_t inst_to, size_t *depth,
+        size_t *nr_moved, size_t *nr_dropped)
+{
+    struct pcinst_move_buffer *mb = find_move_buffer(inst_to);
+    if (mb == NULL || !atomic_load(&mb->opened) ||
+            atomic_load(&mb->atom) != inst_to) {
+        purc_set_error(PURC_ERROR_NOT_EXISTS);
+        return PURC_ERROR_NOT_EXISTS;
+    }
+
+    if (depth)
+        *depth = atomic_load_explicit(&mb->depth, memory_order_relaxed);
+    if (nr_moved)
+        *nr_moved = atomic_load_explicit(&mb->nr_moved, memory_order_relaxed);
+    if (nr_dropped)
+        *nr_dropped = atomic_load_explicit(&mb->nr_dropped,
+                memory_order_relaxed);
+    return 0;
+}
+
 #else   /* HAVE(STDATOMIC_H) */
 
+#include "private/instance.h"
+
 #if HAVE(GLIB)
     #include <gmodule.h>
 #endif
@@ -647,6 +866,14 @@ purc_inst_move_message(purc_atom_t inst_to, pcrdr_msg *msg)
     return 0;
 }
 
+int
+pcinst_set_move_buffer_wakeup(pcinst_wakeup_fn func, void *ctxt)
+{
+    UNUSED_PARAM(func);
+    UNUSED_PARAM(ctxt);
+    return PURC_ERROR_NOT_SUPPORTED;
+}
+
 int
 purc_inst_holding_messages_count(size_t *nr)
 {
@@ -671,6 +898,18 @@ purc_inst_take_away_message(size_t index)
     return NULL;
 }
 
+int
+purc_inst_move_buffer_stats(purc_atom_t inst_to, size_t *depth,
+        size_t *nr_moved, size_t *nr_dropped)
+{
+    UNUSED_PARAM(inst_to);
+    UNUSED_PARAM(depth);
+    UNUSED_PARAM(nr_moved);
+    UNUSED_PARAM(nr_dropped);
+    purc_set_error(PURC_ERROR_NOT_SUPPORTED);
+    return PURC_ERROR_NOT_SUPPORTED;
+}
+
 #endif  /* !HAVE(STDATOMIC_H) */
 
 struct pcmodule _module_mvbuf = {
@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include "private/errors.h"
+#include "private/debug.h"
 #include "private/instance.h"
 #include "private/utils.h"
 #include "private/variant.h"
@@ -37,25 +38,39 @@
 
 #include <sys/time.h>
 
+#define NR_EVENT_SLOTS_MIN      16      /* must be a power of 2 */
+
+struct pcinst_event_slot {
+    struct pcinst_event_slot   *next;
+    uint64_t                    hash;
+
+    /* the first event having this key in the queue */
+    pcrdr_msg                  *first;
+    /* the number of the queued events having this key */
+    size_t                      nr_events;
+};
+
 struct pcinst_msg_queue *
 pcinst_msg_queue_create(void)
 {
     int errcode = 0;
     struct pcinst_msg_queue *queue = NULL;
 
-    if ((queue = malloc(sizeof(*queue))) == NULL) {
+    if ((queue = calloc(1, sizeof(*queue))) == NULL) {
         errcode = PURC_ERROR_OUT_OF_MEMORY;
         goto done;
     }
 
-    purc_rwlock_init(&queue->lock);
-    if (queue->lock.native_impl == NULL) {
+    purc_mutex_init(&queue->lock);
+    purc_mutex_init(&queue->event_lock);
+    if (queue->lock.native_impl == NULL ||
+            queue->event_lock.native_impl == NULL) {
         errcode = PURC_ERROR_BAD_SYSTEM_CALL;
         goto done;
     }
 
-    queue->state = 0;
-    queue->nr_msgs = 0;
+    atomic_init(&queue->state, 0);
+    atomic_init(&queue->nr_msgs, 0);
     list_head_init(&queue->req_msgs);
     list_head_init(&queue->res_msgs);
     list_head_init(&queue->event_msgs);
@@ -66,7 +81,10 @@ done:
     if (errcode) {
         if (queue) {
             if (queue->lock.native_impl) {
-                purc_rwlock_clear(&queue->lock);
+                purc_mutex_clear(&queue->lock);
+            }
+            if (queue->event_lock.native_impl) {
+                purc_mutex_clear(&queue->event_lock);
             }
 
             free(queue);
@@ -93,21 +111,43 @@ grind_msg_list(struct list_head *msgs)
     return nr;
 }
 
+static void
+destroy_event_slots(struct pcinst_msg_queue *queue)
+{
+    for (size_t i = 0; i < queue->nr_event_slots; i++) {
+        struct pcinst_event_slot *slot = queue->event_slots[i];
+        while (slot) {
+            struct pcinst_event_slot *next = slot->next;
+            free(slot);
+            slot = next;
+        }
+    }
+
+    free(queue->event_slots);
+    queue->event_slots = NULL;
+    queue->nr_event_slots = 0;
+    queue->nr_event_keys = 0;
+}
+
 ssize_t
 pcinst_msg_queue_destroy(struct pcinst_msg_queue *queue)
 {
     ssize_t nr = 0;
-    purc_rwlock_writer_lock(&queue->lock);
-
+    purc_mutex_lock(&queue->lock);
     nr += grind_msg_list(&queue->req_msgs);
     nr += grind_msg_list(&queue->res_msgs);
-    nr += grind_msg_list(&queue->event_msgs);
     nr += grind_msg_list(&queue->void_msgs);
-    queue->nr_msgs -= nr;
+    purc_mutex_unlock(&queue->lock);
+
+    purc_mutex_lock(&queue->event_lock);
+    nr += grind_msg_list(&queue->event_msgs);
+    destroy_event_slots(queue);
+    purc_mutex_unlock(&queue->event_lock);
 
-    purc_rwlock_writer_unlock(&queue->lock);
+    atomic_fetch_sub(&queue->nr_msgs, nr);
 
-    purc_rwlock_clear(&queue->lock);
+    purc_mutex_clear(&queue->lock);
+    purc_mutex_clear(&queue->event_lock);
     free(queue);
 
     return nr;
@@ -126,6 +166,149 @@ is_event_match(pcrdr_msg *left, pcrdr_msg *right)
     return false;
 }
 
+#define HASH_FNV64_OFFSET           0xcbf29ce484222325ULL
+#define HASH_FNV64_PRIME            0x100000001b3ULL
+
+static inline uint64_t
+hash_bytes(uint64_t hash, const void *bytes, size_t len)
+{
+    const unsigned char *p = bytes;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= HASH_FNV64_PRIME;
+    }
+    return hash;
+}
+
+static uint64_t
+event_key_hash(pcrdr_msg *msg)
+{
+    uint64_t hash = HASH_FNV64_OFFSET;
+
+    hash = hash_bytes(hash, &msg->target, sizeof(msg->target));
+    hash = hash_bytes(hash, &msg->targetValue, sizeof(msg->targetValue));
+    /* equal variants have the same hash */
+    uint64_t h = pcvariant_hash_equal(msg->eventName);
+    hash = hash_bytes(hash, &h, sizeof(h));
+    h = pcvariant_hash_equal(msg->elementValue);
+    return hash_bytes(hash, &h, sizeof(h));
+}
+
+static struct pcinst_event_slot *
+find_event_slot(struct pcinst_msg_queue *queue, pcrdr_msg *msg,
+        uint64_t hash)
+{
+    if (queue->nr_event_slots == 0)
+        return NULL;
+
+    struct pcinst_event_slot *slot;
+    slot = queue->event_slots[hash & (queue->nr_event_slots - 1)];
+    while (slot) {
+        if (slot->hash == hash && is_event_match(slot->first, msg))
+            return slot;
+        slot = slot->next;
+    }
+
+    return NULL;
+}
+
+static int
+grow_event_slots(struct pcinst_msg_queue *queue)
+{
+    size_t nr_slots = queue->nr_event_slots ?
+        queue->nr_event_slots * 2 : NR_EVENT_SLOTS_MIN;
+    struct pcinst_event_slot **slots = calloc(nr_slots, sizeof(*slots));
+    if (slots == NULL)
+        return -1;
+
+    for (size_t i = 0; i < queue->nr_event_slots; i++) {
+        struct pcinst_event_slot *slot = queue->event_slots[i];
+        while (slot) {
+            struct pcinst_event_slot *next = slot->next;
+            size_t bucket = slot->hash & (nr_slots - 1);
+            slot->next = slots[bucket];
+            slots[bucket] = slot;
+            slot = next;
+        }
+    }
+
+    free(queue->event_slots);
+    queue->event_slots = slots;
+    queue->nr_event_slots = nr_slots;
+    return 0;
+}
+
+/*
+ * Indexes a new queued event; `at_head` indicates whether the event is
+ * inserted at the head of the event list. The slot is recorded in the
+ * header of the event, because the key of the event may change while it
+ * is queued (the element value can be a mutable container).
+ */
+static int
+index_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg, uint64_t hash,
+        bool at_head)
+{
+    struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
+    struct pcinst_event_slot *slot = find_event_slot(queue, msg, hash);
+    if (slot) {
+        slot->nr_events++;
+        if (at_head)
+            slot->first = msg;
+        hdr->event_slot = slot;
+        return 0;
+    }
+
+    /* keep the load factor under 0.75 */
+    if ((queue->nr_event_keys + 1) * 4 > queue->nr_event_slots * 3 &&
+            grow_event_slots(queue))
+        return -1;
+
+    if ((slot = malloc(sizeof(*slot))) == NULL)
+        return -1;
+
+    size_t bucket = hash & (queue->nr_event_slots - 1);
+    slot->hash = hash;
+    slot->first = msg;
+    slot->nr_events = 1;
+    slot->next = queue->event_slots[bucket];
+    queue->event_slots[bucket] = slot;
+    queue->nr_event_keys++;
+    hdr->event_slot = slot;
+    return 0;
+}
+
+/* Called after the event was removed from the event list. */
+static void
+unindex_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
+{
+    struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
+    struct pcinst_event_slot *slot = hdr->event_slot;
+    hdr->event_slot = NULL;
+
+    if (--slot->nr_events == 0) {
+        struct pcinst_event_slot **pslot;
+        pslot = &queue->event_slots[slot->hash & (queue->nr_event_slots - 1)];
+        while (*pslot != slot)
+            pslot = &(*pslot)->next;
+        *pslot = slot->next;
+        free(slot);
+        queue->nr_event_keys--;
+    }
+    else if (slot->first == msg) {
+        /* only the events with KEEP option can share a slot;
+           find the next one in the queue order. */
+        struct list_head *p;
+        list_for_each(p, &queue->event_msgs) {
+            struct pcinst_msg_hdr *h = list_entry(p,
+                    struct pcinst_msg_hdr, ln);
+            if (h->event_slot == slot) {
+                slot->first = (pcrdr_msg *)h;
+                break;
+            }
+        }
+    }
+}
+
 static uint64_t
 get_timestamp_us(void)
 {
@@ -134,148 +317,120 @@ get_timestamp_us(void)
     return (uint64_t)now.tv_sec * 1000000 + now.tv_usec;
 }
 
-int
-reduce_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg, bool tail)
+/*
+ * Queues an event with the event lock held; the event which is not kept
+ * is coalesced into the first queued event having the same key, if any.
+ */
+static int
+queue_event(struct pcinst_msg_queue *queue, pcrdr_msg *msg, bool tail)
 {
-    struct pcinst_msg_hdr *hdr;
-    struct list_head *p, *n;
-    list_for_each_safe(p, n, &queue->event_msgs) {
-        hdr = list_entry(p, struct pcinst_msg_hdr, ln);
-        pcrdr_msg *orig = (pcrdr_msg*) hdr;
-        if (is_event_match(orig, msg)) {
-            if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE) {
-                return 0;
-            }
-            // OVERLAY : data
-            if (orig->data) {
-                purc_variant_unref(orig->data);
-                orig->data = PURC_VARIANT_INVALID;
-            }
-            if (msg->data) {
-                orig->data = msg->data;
-                purc_variant_ref(orig->data);
+    struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
+    uint64_t hash = event_key_hash(msg);
+
+    if (msg->reduceOpt != PCRDR_MSG_EVENT_REDUCE_OPT_KEEP) {
+        struct pcinst_event_slot *slot = find_event_slot(queue, msg, hash);
+        if (slot) {
+            pcrdr_msg *orig = slot->first;
+            if (msg->reduceOpt != PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE) {
+                // OVERLAY : data
+                if (orig->data) {
+                    purc_variant_unref(orig->data);
+                    orig->data = PURC_VARIANT_INVALID;
+                }
+                if (msg->data) {
+                    orig->data = msg->data;
+                    purc_variant_ref(orig->data);
+                }
             }
+            pcrdr_release_message(msg);
             return 0;
         }
     }
 
-    hdr = (struct pcinst_msg_hdr *)msg;
-    /* keep timestamp */
-    msg->resultValue = get_timestamp_us();
+    if (index_event(queue, msg, hash, !tail)) {
+        pcrdr_release_message(msg);
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
     if (tail) {
+        /* keep timestamp */
+        msg->resultValue = get_timestamp_us();
         list_add_tail(&hdr->ln, &queue->event_msgs);
     }
     else {
+        if (msg->reduceOpt != PCRDR_MSG_EVENT_REDUCE_OPT_KEEP)
+            msg->resultValue = get_timestamp_us();
         list_add(&hdr->ln, &queue->event_msgs);
     }
-    queue->state |= MSG_QS_EVENT;
-    queue->nr_msgs++;
 
+    atomic_fetch_or(&queue->state, MSG_QS_EVENT);
+    atomic_fetch_add(&queue->nr_msgs, 1);
     return 0;
 }
 
-int
-pcinst_msg_queue_append(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
+static int
+queue_msg(struct pcinst_msg_queue *queue, pcrdr_msg *msg, bool tail)
 {
     struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
-
-    purc_rwlock_writer_lock(&queue->lock);
+    struct list_head *msgs;
+    unsigned int flag;
+
+    if (msg->type == PCRDR_MSG_TYPE_EVENT) {
+        purc_mutex_lock(&queue->event_lock);
+        int ret = queue_event(queue, msg, tail);
+        purc_mutex_unlock(&queue->event_lock);
+        return ret;
+    }
 
     switch (msg->type) {
-    case PCRDR_MSG_TYPE_VOID:
-        list_add_tail(&hdr->ln, &queue->void_msgs);
-        queue->state |= MSG_QS_VOID;
-        queue->nr_msgs++;
-        break;
-
     case PCRDR_MSG_TYPE_REQUEST:
-        list_add_tail(&hdr->ln, &queue->req_msgs);
-        queue->state |= MSG_QS_REQ;
-        queue->nr_msgs++;
+        msgs = &queue->req_msgs;
+        flag = MSG_QS_REQ;
         break;
 
     case PCRDR_MSG_TYPE_RESPONSE:
-        list_add_tail(&hdr->ln, &queue->res_msgs);
-        queue->state |= MSG_QS_RES;
-        queue->nr_msgs++;
-        break;
-
-    case PCRDR_MSG_TYPE_EVENT:
-        queue->state |= MSG_QS_EVENT;
-        if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_KEEP) {
-            /* keep timestamp */
-            msg->resultValue = get_timestamp_us();
-            list_add_tail(&hdr->ln, &queue->event_msgs);
-            queue->state |= MSG_QS_EVENT;
-            queue->nr_msgs++;
-        }
-        else {
-            reduce_event(queue, msg, true);
-        }
+        msgs = &queue->res_msgs;
+        flag = MSG_QS_RES;
         break;
 
+    case PCRDR_MSG_TYPE_VOID:
     default:
-        list_add_tail(&hdr->ln, &queue->void_msgs);
-        queue->state |= MSG_QS_VOID;
-        queue->nr_msgs++;
+        msgs = &queue->void_msgs;
+        flag = MSG_QS_VOID;
         break;
     }
 
-    purc_rwlock_writer_unlock(&queue->lock);
+    purc_mutex_lock(&queue->lock);
+    if (tail) {
+        list_add_tail(&hdr->ln, msgs);
+    }
+    else {
+        list_add(&hdr->ln, msgs);
+    }
+    atomic_fetch_or(&queue->state, flag);
+    atomic_fetch_add(&queue->nr_msgs, 1);
+    purc_mutex_unlock(&queue->lock);
+
     return 0;
 }
 
 int
-pcinst_msg_queue_prepend(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
+pcinst_msg_queue_append(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
 {
-    struct pcinst_msg_hdr *hdr = (struct pcinst_msg_hdr *)msg;
-
-    purc_rwlock_writer_lock(&queue->lock);
-
-    switch (msg->type) {
-    case PCRDR_MSG_TYPE_VOID:
-        list_add(&hdr->ln, &queue->void_msgs);
-        queue->state |= MSG_QS_VOID;
-        queue->nr_msgs++;
-        break;
-
-    case PCRDR_MSG_TYPE_REQUEST:
-        list_add(&hdr->ln, &queue->req_msgs);
-        queue->state |= MSG_QS_REQ;
-        queue->nr_msgs++;
-        break;
-
-    case PCRDR_MSG_TYPE_RESPONSE:
-        list_add(&hdr->ln, &queue->res_msgs);
-        queue->state |= MSG_QS_RES;
-        queue->nr_msgs++;
-        break;
-
-    case PCRDR_MSG_TYPE_EVENT:
-        queue->state |= MSG_QS_EVENT;
-        if (msg->reduceOpt == PCRDR_MSG_EVENT_REDUCE_OPT_KEEP) {
-            list_add(&hdr->ln, &queue->event_msgs);
-            queue->state |= MSG_QS_EVENT;
-            queue->nr_msgs++;
-        }
-        else {
-            reduce_event(queue, msg, false);
-        }
-        break;
-
-    default:
-        list_add(&hdr->ln, &queue->void_msgs);
-        queue->state |= MSG_QS_VOID;
-        queue->nr_msgs++;
-        break;
-    }
+    return queue_msg(queue, msg, true);
+}
 
-    purc_rwlock_writer_unlock(&queue->lock);
-    return 0;
+int
+pcinst_msg_queue_prepend(struct pcinst_msg_queue *queue, pcrdr_msg *msg)
+{
+    return queue_msg(queue, msg, false);
 }
 
+/* Called with the lock of the list held. */
 static pcrdr_msg *
-get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs)
+get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs,
+        unsigned int flag)
 {
     if (list_empty(msgs)) {
         return NULL;
@@ -284,9 +439,9 @@ get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs)
             struct pcinst_msg_hdr, ln);
     pcrdr_msg *msg = (pcrdr_msg *)hdr;
     list_del(&hdr->ln);
-    queue->nr_msgs--;
+    atomic_fetch_sub(&queue->nr_msgs, 1);
     if (list_empty(msgs)) {
-        queue->state &= ~MSG_QS_RES;
+        atomic_fetch_and(&queue->state, ~flag);
     }
     return msg;
 }
@@ -294,38 +449,35 @@ get_msg(struct pcinst_msg_queue *queue, struct list_head *msgs)
 pcrdr_msg *
 pcinst_msg_queue_get_msg(struct pcinst_msg_queue *queue)
 {
-    purc_rwlock_writer_lock(&queue->lock);
     pcrdr_msg *msg = NULL;
-    if (queue->state & MSG_QS_RES) {
-        msg = get_msg(queue, &queue->res_msgs);
-        if (msg) {
-            goto done;
-        }
+    unsigned int state = atomic_load(&queue->state);
+
+    if (state & (MSG_QS_RES | MSG_QS_REQ)) {
+        purc_mutex_lock(&queue->lock);
+        msg = get_msg(queue, &queue->res_msgs, MSG_QS_RES);
+        if (msg == NULL)
+            msg = get_msg(queue, &queue->req_msgs, MSG_QS_REQ);
+        purc_mutex_unlock(&queue->lock);
+        if (msg)
+            return msg;
     }
 
-    if (queue->state & MSG_QS_REQ) {
-        msg = get_msg(queue, &queue->req_msgs);
-        if (msg) {
-            goto done;
-        }
+    if (state & MSG_QS_EVENT) {
+        purc_mutex_lock(&queue->event_lock);
+        msg = get_msg(queue, &queue->event_msgs, MSG_QS_EVENT);
+        if (msg)
+            unindex_event(queue, msg);
+        purc_mutex_unlock(&queue->event_lock);
+        if (msg)
+            return msg;
     }
 
-    if (queue->state & MSG_QS_EVENT) {
-        msg = get_msg(queue, &queue->event_msgs);
-        if (msg) {
-            goto done;
-        }
+    if (state & MSG_QS_VOID) {
+        purc_mutex_lock(&queue->lock);
+        msg = get_msg(queue, &queue->void_msgs, MSG_QS_VOID);
+        purc_mutex_unlock(&queue->lock);
     }
 
-    if (queue->state & MSG_QS_VOID) {
-        msg = get_msg(queue, &queue->void_msgs);
-        if (msg) {
-            goto done;
-        }
-    }
-
-done:
-    purc_rwlock_writer_unlock(&queue->lock);
     return msg;
 }
 
@@ -335,7 +487,11 @@ pcinst_msg_queue_get_event_by_element(struct pcinst_msg_queue *queue,
         purc_variant_t event_name)
 {
     pcrdr_msg *msg = NULL;
-    purc_rwlock_writer_lock(&queue->lock);
+
+    if (!(atomic_load(&queue->state) & MSG_QS_EVENT))
+        return NULL;
+
+    purc_mutex_lock(&queue->event_lock);
 
     struct list_head *msgs = &queue->event_msgs;
     struct list_head *p, *n;
@@ -348,11 +504,15 @@ pcinst_msg_queue_get_event_by_element(struct pcinst_msg_queue *queue,
                 purc_variant_is_equal_to(m->eventName, event_name)) {
             msg = m;
             list_del(&hdr->ln);
+            atomic_fetch_sub(&queue->nr_msgs, 1);
+            if (list_empty(msgs))
+                atomic_fetch_and(&queue->state, ~MSG_QS_EVENT);
+            unindex_event(queue, msg);
             break;
         }
     }
 
-    purc_rwlock_writer_unlock(&queue->lock);
+    purc_mutex_unlock(&queue->event_lock);
     return msg;
 }
 
@@ -381,7 +541,9 @@ purc_inst_post_event(purc_atom_t inst_to, pcrdr_msg *msg)
                 pcintr_coroutine_t co = container_of(p, struct pcintr_coroutine,
                         node);
                 if (co->cid == msg->targetValue) {
-                    return pcinst_msg_queue_append(co->mq, msg);
+                    int ret = pcinst_msg_queue_append(co->mq, msg);
+                    pcintr_coroutine_wakeup(co);
+                    return ret;
                 }
             }
         }
@@ -393,6 +555,7 @@ purc_inst_post_event(purc_atom_t inst_to, pcrdr_msg *msg)
                 pcrdr_msg *my_msg = pcrdr_clone_message(msg);
                 my_msg->targetValue = co->cid;
                 pcinst_msg_queue_append(co->mq, my_msg);
+                pcintr_coroutine_wakeup(co);
             }
             pcrdr_release_message(msg);
         }
@@ -477,10 +640,6 @@ pcinst_broadcast_event(pcrdr_msg_event_reduce_opt reduce_op,
 size_t
 pcinst_msg_queue_count(struct pcinst_msg_queue *queue)
 {
-    size_t nr = 0;
-    purc_rwlock_writer_lock(&queue->lock);
-    nr = queue->nr_msgs;
-    purc_rwlock_writer_unlock(&queue->lock);
-    return nr;
+    return atomic_load(&queue->nr_msgs);
 }
 
@@ -343,77 +343,59 @@ comp_string(const char *l, const char *r, bool ascendingly, bool casesensitively
 
 #define UNDEFINED_STR       "undefined"
 
-static char *
-variant_to_string(purc_variant_t v)
-{
-    if (!v) {
-        return strdup(UNDEFINED_STR);
-    }
-
-    char *buf = NULL;
-    int total = purc_variant_stringify_alloc(&buf, v);
-    if (total < 0) {
-        return NULL;
-    }
-    return buf;
-}
-
-static int
-comp_raw(purc_variant_t l, purc_variant_t r, bool by_number,
-        bool ascendingly, bool casesensitively)
-{
-    if (by_number) {
-        double dl = l ? purc_variant_numberify(l) : 0.0f;
-        double dr = r ? purc_variant_numberify(r) : 0.0f;
-        return comp_number(dl, dr, ascendingly);
-    }
-
-    char *buf_l = variant_to_string(l);
-    char *buf_r = variant_to_string(r);
-    int ret = comp_string(buf_l, buf_r, ascendingly, casesensitively);
-    if (buf_l) {
-        free(buf_l);
-    }
-    if (buf_r) {
-        free(buf_r);
-    }
-    return ret;
-}
+/* the value of a sort key for one member, computed before sorting */
+struct sort_field_key {
+    double          number;
+    const char     *str;
+    char           *buf;
+};
 
 static int
-comp_by_key(purc_variant_t l, purc_variant_t r, const char *key, bool by_number,
-        bool ascendingly, bool casesensitively)
+make_sort_key(purc_variant_t val, void *key, void *ud)
 {
-    purc_variant_t lv = PURC_VARIANT_INVALID;
-    purc_variant_t rv = PURC_VARIANT_INVALID;
-    if (purc_variant_is_object(l)) {
-        lv = purc_variant_object_get_by_ckey(l, key);
-        purc_clr_error();
-    }
+    struct ctxt_for_sort *ctxt = ud;
+    struct sort_field_key *fk = key;
+    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
+    for (size_t i = 0; i < nr_keys; i++, fk++) {
+        struct sort_key *k = pcutils_arrlist_get_idx(ctxt->keys, i);
+        purc_variant_t v = val;
+        if (k->key) {
+            v = PURC_VARIANT_INVALID;
+            if (purc_variant_is_object(val)) {
+                v = purc_variant_object_get_by_ckey(val, k->key);
+                purc_clr_error();
+            }
+        }
 
-    if (purc_variant_is_object(r)) {
-        rv = purc_variant_object_get_by_ckey(r, key);
-        purc_clr_error();
+        if (k->by_number) {
+            fk->number = v ? purc_variant_numberify(v) : 0.0f;
+        }
+        else if (v) {
+            fk->str = pcvariant_sort_key_string(v, &fk->buf);
+        }
+        else {
+            fk->str = UNDEFINED_STR;
+        }
     }
-
-    return comp_raw(lv, rv, by_number, ascendingly, casesensitively);
+    return 0;
 }
 
 static int
-sort_cmp(purc_variant_t l, purc_variant_t r, void *data)
+sort_cmp(const void *l, const void *r, void *ud)
 {
-    struct ctxt_for_sort *ctxt = data;
+    struct ctxt_for_sort *ctxt = ud;
+    const struct sort_field_key *kl = l;
+    const struct sort_field_key *kr = r;
     size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
-    for (size_t i = 0; i < nr_keys; i++) {
+    for (size_t i = 0; i < nr_keys; i++, kl++, kr++) {
         struct sort_key *key = pcutils_arrlist_get_idx(ctxt->keys, i);
         int ret = 0;
-        if (key->key == NULL) {
-            ret = comp_raw(l, r, key->by_number, ctxt->ascendingly,
-                    ctxt->casesensitively);
+        if (key->by_number) {
+            ret = comp_number(kl->number, kr->number, ctxt->ascendingly);
         }
         else {
-            ret = comp_by_key(l, r, key->key, key->by_number,
-                    ctxt->ascendingly, ctxt->casesensitively);
+            ret = comp_string(kl->str, kr->str, ctxt->ascendingly,
+                    ctxt->casesensitively);
         }
         if (ret != 0) {
             return ret;
@@ -422,6 +404,27 @@ sort_cmp(purc_variant_t l, purc_variant_t r, void *data)
     return 0;
 }
 
+static void
+free_sort_key(void *key, void *ud)
+{
+    struct ctxt_for_sort *ctxt = ud;
+    struct sort_field_key *fk = key;
+    size_t nr_keys = pcutils_arrlist_length(ctxt->keys);
+    for (size_t i = 0; i < nr_keys; i++, fk++) {
+        free(fk->buf);
+    }
+}
+
+static void
+init_sort_ops(struct ctxt_for_sort *ctxt, struct pcvariant_sort_ops *ops)
+{
+    ops->key_size = pcutils_arrlist_length(ctxt->keys) *
+        sizeof(struct sort_field_key);
+    ops->make_key = make_sort_key;
+    ops->cmp_key = sort_cmp;
+    ops->free_key = free_sort_key;
+}
+
 static bool
 sort_as_number(purc_variant_t val)
 {
@@ -488,7 +491,9 @@ sort_array(struct ctxt_for_sort *ctxt, purc_variant_t array,
             }
         }
     }
-    pcvariant_array_sort(array, ctxt, sort_cmp);
+    struct pcvariant_sort_ops ops;
+    init_sort_ops(ctxt, &ops);
+    pcvariant_array_sort_by_keys(array, ctxt, &ops);
 }
 
 
@@ -541,7 +546,9 @@ sort_set(struct ctxt_for_sort *ctxt, purc_variant_t set, purc_variant_t against)
             }
         }
     }
-    pcvariant_set_sort(set, ctxt, sort_cmp);
+    struct pcvariant_sort_ops ops;
+    init_sort_ops(ctxt, &ops);
+    pcvariant_set_sort_by_keys(set, ctxt, &ops);
 }
 
 static int
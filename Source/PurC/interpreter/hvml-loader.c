@@ -26,11 +26,17 @@
 
 #include "private/hvml.h"
 #include "private/map.h"
+#include "private/vdom.h"
 #include "private/fetcher.h"
 #include "private/ports.h"
 #include "../hvml/hvml-gen.h"
 
 #include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 purc_vdom_t
 purc_load_hvml_from_rwstream(purc_rwstream_t stm)
@@ -213,6 +219,98 @@ static purc_vdom_t find_vdom_in_cache(unsigned char *md5)
     return vdom;
 }
 
+static const char *
+vdom_cache_dir(void)
+{
+    const char *dir = getenv(PURC_ENVV_VDOM_CACHE_DIR);
+    return (dir && dir[0]) ? dir : NULL;
+}
+
+static bool
+vdom_cache_path(char *path, const char *dir, const unsigned char *md5)
+{
+    char hex[MD5_DIGEST_SIZE * 2 + 1];
+
+    pcutils_bin2hex(md5, MD5_DIGEST_SIZE, hex, false);
+    int n = snprintf(path, PATH_MAX + 1, "%s/%s-%d.vdom", dir, hex,
+            PCVDOM_BINARY_VERSION);
+    return n > 0 && n <= PATH_MAX;
+}
+
+static purc_vdom_t
+load_vdom_from_cache_dir(const char *dir, const unsigned char *md5)
+{
+    char path[PATH_MAX + 1];
+    purc_vdom_t vdom = NULL;
+    struct stat st;
+    int fd;
+
+    if (!vdom_cache_path(path, dir, md5) || (fd = open(path, O_RDONLY)) < 0)
+        return NULL;
+
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void *buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (buf != MAP_FAILED) {
+            vdom = pcvdom_util_document_from_binary(buf, st.st_size);
+            munmap(buf, st.st_size);
+        }
+    }
+    close(fd);
+
+    if (vdom == NULL) {
+        /* stale or broken; it will be written again after parsing */
+        unlink(path);
+        purc_clr_error();
+    }
+
+    return vdom;
+}
+
+static void
+save_vdom_to_cache_dir(const char *dir, const unsigned char *md5,
+        purc_vdom_t vdom)
+{
+    char path[PATH_MAX + 1], tmp[PATH_MAX + 1];
+    purc_rwstream_t out = NULL;
+    int fd = -1;
+
+    if (!vdom_cache_path(path, dir, md5) ||
+            snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= (int)sizeof(tmp))
+        return;
+
+    out = purc_rwstream_new_buffer(0, 0);
+    if (!out || pcvdom_util_document_write_binary(vdom, out))
+        goto failed;
+
+    size_t len;
+    const char *buf = purc_rwstream_get_mem_buffer_ex(out, &len, NULL, false);
+    if (!buf || (fd = mkstemp(tmp)) < 0)
+        goto failed;
+
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        buf += n;
+        len -= n;
+    }
+
+    /* publish the file atomically, so readers never see a partial one */
+    if (close(fd) || len > 0 || rename(tmp, path))
+        unlink(tmp);
+    purc_rwstream_destroy(out);
+    return;
+
+failed:
+    if (out)
+        purc_rwstream_destroy(out);
+    /* the disk cache is only an optimization */
+    purc_clr_error();
+}
+
 purc_vdom_t
 purc_load_hvml_from_string(const char* string)
 {
@@ -229,6 +327,12 @@ purc_load_hvml_from_string(const char* string)
 
     vdom = find_vdom_in_cache(md5);
     if (vdom == NULL) {
+        const char *cache_dir = vdom_cache_dir();
+        if (cache_dir && (vdom = load_vdom_from_cache_dir(cache_dir, md5))) {
+            cache_vdom(md5, 0, length, vdom);
+            return vdom;
+        }
+
         purc_rwstream_t in;
         in = purc_rwstream_new_from_mem((void*)string, length);
         if (!in) {
@@ -237,6 +341,8 @@ purc_load_hvml_from_string(const char* string)
 
         if ((vdom = purc_load_hvml_from_rwstream(in))) {
             cache_vdom(md5, 0, length, vdom);
+            if (cache_dir)
+                save_vdom_to_cache_dir(cache_dir, md5, vdom);
         }
 
         purc_rwstream_destroy(in);
@@ -260,6 +366,12 @@ purc_load_hvml_from_file(const char* file)
 
     vdom = find_vdom_in_cache(md5);
     if (vdom == NULL) {
+        const char *cache_dir = vdom_cache_dir();
+        if (cache_dir && (vdom = load_vdom_from_cache_dir(cache_dir, md5))) {
+            cache_vdom(md5, 0, length, vdom);
+            return vdom;
+        }
+
         purc_rwstream_t in;
         in = purc_rwstream_new_from_file(file, "r");
         if (!in) {
@@ -268,6 +380,8 @@ purc_load_hvml_from_file(const char* file)
 
         if ((vdom = purc_load_hvml_from_rwstream(in))) {
             cache_vdom(md5, 0, length, vdom);
+            if (cache_dir)
+                save_vdom_to_cache_dir(cache_dir, md5, vdom);
         }
         purc_rwstream_destroy(in);
     }
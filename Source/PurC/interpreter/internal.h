@@ -307,6 +307,45 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char *property,
         pcrdr_msg_data_type data_type, const char *data, size_t len);
 
+/* Between pcintr_rdr_begin_dom_batch() and pcintr_rdr_end_dom_batch(),
+ * the DOM operations sent by pcintr_rdr_send_dom_req_simple() and
+ * pcintr_rdr_send_dom_req_simple_raw() are queued and coalesced instead of
+ * being sent one by one; the queue is flushed as one pipelined batch,
+ * and the responses are collected once for the whole batch.
+ * Use pcintr_rdr_send_dom_req() if the result is needed synchronously;
+ * it flushes the queue before sending the request. */
+void
+pcintr_rdr_begin_dom_batch(struct pcinst *inst);
+
+void
+pcintr_rdr_end_dom_batch(struct pcinst *inst, bool flush);
+
+int
+pcintr_rdr_flush_dom_batch(struct pcinst *inst);
+
+void
+pcintr_rdr_discard_dom_batch(struct pcinst *inst);
+
+/* a DOM operation queued in the batch of an instance */
+struct pcintr_rdr_dom_req {
+    struct list_head        ln;
+
+    uint64_t                dom_handle;
+    pcdoc_element_t         element;
+    const char             *operation;  // one of PCRDR_OPERATION_XXX
+    char                   *property;
+    pcrdr_msg_data_type     data_type;
+    purc_variant_t          data;
+};
+
+/* Queues a DOM operation in the batch of the heap without flushing it,
+ * coalescing it with the tail of the queue if possible. The reference of
+ * `data` is taken over. */
+bool
+pcintr_rdr_queue_dom_req(struct pcintr_heap *heap, uint64_t dom_handle,
+        pcdoc_operation op, pcdoc_element_t element, const char *property,
+        pcrdr_msg_data_type data_type, purc_variant_t data);
+
 
 #define pcintr_rdr_dom_append_content(stack, element, content)          \
     pcintr_rdr_send_dom_req_simple_raw(stack, PCDOC_OP_APPEND,          \
@@ -460,6 +499,18 @@ pcintr_coroutine_dump(pcintr_coroutine_t co);
 void
 pcintr_handle_task(struct pcintr_observer_task *task);
 
+/* called in the runloop when the fd becomes readable, no coroutine needed */
+uintptr_t
+pcintr_runloop_add_wakeup_fd(purc_runloop_t runloop, int fd,
+        purc_runloop_func func, void *ctxt);
+
+/* start/stop the event-driven scheduler of the current instance */
+void
+pcintr_start_scheduler(struct pcinst *inst);
+
+void
+pcintr_stop_scheduler(struct pcinst *inst);
+
 PCA_EXTERN_C_END
 
 #endif  /* PURC_INTERPRETER_INTERNAL_H */
@@ -57,7 +57,6 @@
 
 
 #define COROUTINE_PREFIX    "COROUTINE"
-#define HVML_VARIABLE_REGEX "^[A-Za-z_][A-Za-z0-9_]*$"
 
 static void
 stack_frame_release(struct pcintr_stack_frame *frame)
@@ -84,6 +83,8 @@ stack_frame_release(struct pcintr_stack_frame *frame)
     PURC_VARIANT_SAFE_CLEAR(frame->result_from_child);
     PURC_VARIANT_SAFE_CLEAR(frame->except_templates);
     PURC_VARIANT_SAFE_CLEAR(frame->error_templates);
+
+    pcintr_release_named_var_cache(frame);
 }
 
 static void
@@ -322,6 +323,8 @@ stack_release(pcintr_stack_t stack)
 
     pcintr_destroy_observer_list(&stack->intr_observers);
     pcintr_destroy_observer_list(&stack->hvml_observers);
+    pcintr_observer_index_cleanup(&stack->intr_index);
+    pcintr_observer_index_cleanup(&stack->hvml_index);
 
     if (stack->doc) {
         purc_document_unref(stack->doc);
@@ -361,6 +364,10 @@ coroutine_release(pcintr_coroutine_t co)
         struct pcintr_heap *heap = pcintr_get_heap();
         PC_ASSERT(heap && co->owner == heap);
 
+        if (!list_empty(&co->ln_active)) {
+            list_del_init(&co->ln_active);
+        }
+
         stack_release(&co->stack);
         pcvdom_document_unref(co->vdom);
 
@@ -451,6 +458,8 @@ stack_init(pcintr_stack_t stack)
     INIT_LIST_HEAD(&stack->frames);
     INIT_LIST_HEAD(&stack->intr_observers);
     INIT_LIST_HEAD(&stack->hvml_observers);
+    pcintr_observer_index_init(&stack->intr_index);
+    pcintr_observer_index_init(&stack->hvml_index);
     stack->scoped_variables = RB_ROOT;
 
     stack->mode = STACK_VDOM_BEFORE_HVML;
@@ -462,6 +471,9 @@ static void _cleanup_instance(struct pcinst* inst)
     if (!heap)
         return;
 
+    pcintr_stop_scheduler(inst);
+    pcintr_rdr_discard_dom_batch(inst);
+
     struct rb_root *coroutines = &heap->coroutines;
 
     struct rb_node *p, *n;
@@ -525,6 +537,9 @@ static int _init_instance(struct pcinst* inst,
     heap->coroutines = RB_ROOT;
     heap->running_coroutine = NULL;
     heap->next_coroutine_id = 1;
+    INIT_LIST_HEAD(&heap->active_coroutines);
+    heap->conn_monitor_fd = -1;
+    INIT_LIST_HEAD(&heap->rdr_dom_reqs);
 
     heap->event_timer = pcintr_timer_create(NULL, NULL, event_timer_fire, inst);
     if (!heap->event_timer) {
@@ -1772,6 +1787,7 @@ coroutine_create(purc_vdom_t vdom, pcintr_coroutine_t parent,
 
     pcvdom_document_ref(vdom);
     co->vdom = vdom;
+    INIT_LIST_HEAD(&co->ln_active);
     pcintr_coroutine_set_state(co, CO_STATE_READY);
     INIT_LIST_HEAD(&co->children);
     INIT_LIST_HEAD(&co->registered_cancels);
@@ -1801,6 +1817,7 @@ coroutine_create(purc_vdom_t vdom, pcintr_coroutine_t parent,
     stack_init(stack);
     pcintr_coroutine_add_sub_exit_observer(co);
     pcintr_coroutine_add_last_msg_observer(co);
+    pcintr_coroutine_wakeup(co);
 
     if (parent && page_type == PCRDR_PAGE_TYPE_INHERIT) {
         stack->doc = purc_document_ref(parent->stack.doc);
@@ -1985,7 +2002,7 @@ purc_run(purc_cond_handler handler)
     heap->keep_alive = 0;
     heap->cond_handler = handler;
 
-    purc_runloop_set_idle_func(runloop, pcintr_schedule, inst);
+    pcintr_start_scheduler(inst);
     purc_runloop_run();
 
     return 0;
@@ -3205,6 +3222,9 @@ pcintr_coroutine_set_state_with_location(pcintr_coroutine_t co,
     UNUSED_PARAM(line);
     UNUSED_PARAM(func);
     co->state = state;
+
+    // the messages deferred by the former state may be handled now
+    pcintr_coroutine_wakeup(co);
 }
 
 pcdoc_element_t
@@ -3323,9 +3343,21 @@ pcintr_coroutine_get_result(pcintr_coroutine_t co)
     return PURC_VARIANT_INVALID; // NOTE: never reached here!!!
 }
 
+/* matches `^[A-Za-z_][A-Za-z0-9_]*$` */
 bool
 pcintr_is_variable_token(const char *str)
 {
-    return pcregex_is_match(HVML_VARIABLE_REGEX, str);
+    if (str == NULL)
+        return false;
+
+    if (!purc_isalpha(*str) && *str != '_')
+        return false;
+
+    while (*++str) {
+        if (!purc_isalnum(*str) && *str != '_')
+            return false;
+    }
+
+    return true;
 }
 
@@ -311,7 +311,9 @@ dispatch_move_buffer_event(struct pcinst *inst, const pcrdr_msg *msg)
             pcintr_coroutine_t co = container_of(p, struct pcintr_coroutine,
                     node);
             if (co->cid == msg->targetValue) {
-                return pcinst_msg_queue_append(co->mq, msg_clone);
+                int ret = pcinst_msg_queue_append(co->mq, msg_clone);
+                pcintr_coroutine_wakeup(co);
+                return ret;
             }
         }
     }
@@ -323,6 +325,7 @@ dispatch_move_buffer_event(struct pcinst *inst, const pcrdr_msg *msg)
             pcrdr_msg *my_msg = pcrdr_clone_message(msg_clone);
             my_msg->targetValue = co->cid;
             pcinst_msg_queue_append(co->mq, my_msg);
+            pcintr_coroutine_wakeup(co);
         }
         pcrdr_release_message(msg_clone);
     }
@@ -42,6 +42,7 @@ release_observer(struct pcintr_observer *observer)
         return;
 
     list_del(&observer->node);
+    pcintr_observer_index_remove(observer);
 
     if (observer->on_revoke) {
         observer->on_revoke(observer, observer->on_revoke_data);
@@ -119,21 +120,398 @@ pcintr_destroy_observer_list(struct list_head *observer_list)
     }
 }
 
+enum {
+    SUB_TYPE_NONE,          /* no sub type */
+    SUB_TYPE_ANY,           /* the pattern matches any sub type */
+    SUB_TYPE_LITERAL,       /* the pattern has no metacharacter */
+    SUB_TYPE_REGEX,
+    SUB_TYPE_INVALID,       /* the pattern is not a valid regex */
+};
+
+#define REGEX_METACHARS     "\\^$.|?*+()[]{}"
+
+static void
+compile_sub_type(struct pcintr_observer *observer)
+{
+    const char *pattern = observer->sub_type;
+
+    observer->sub_type_regex = NULL;
+    if (pattern == NULL) {
+        observer->sub_type_kind = SUB_TYPE_NONE;
+    }
+    else if (pattern[0] == 0 || strcmp(pattern, ".*") == 0) {
+        observer->sub_type_kind = SUB_TYPE_ANY;
+    }
+    else if (strpbrk(pattern, REGEX_METACHARS) == NULL) {
+        observer->sub_type_kind = SUB_TYPE_LITERAL;
+    }
+    else {
+        observer->sub_type_regex = pcregex_lookup(pattern, 0, 0);
+        if (observer->sub_type_regex) {
+            observer->sub_type_kind = SUB_TYPE_REGEX;
+        }
+        else {
+            observer->sub_type_kind = SUB_TYPE_INVALID;
+            purc_clr_error();
+        }
+    }
+}
+
+static bool
+is_sub_type_match(struct pcintr_observer *observer, const char *sub_type)
+{
+    if (observer->sub_type == sub_type)
+        return true;
+    if (sub_type == NULL)
+        return false;
+
+    /* the pattern is searched in the sub type like pcregex_is_match() */
+    switch (observer->sub_type_kind) {
+    case SUB_TYPE_ANY:
+        return true;
+    case SUB_TYPE_LITERAL:
+        return strstr(sub_type, observer->sub_type) != NULL;
+    case SUB_TYPE_REGEX:
+        return pcregex_match(observer->sub_type_regex, sub_type, NULL);
+    default:
+        break;
+    }
+
+    return false;
+}
+
 static bool
 is_match_default(struct pcintr_observer *observer, pcrdr_msg *msg,
         purc_variant_t observed, purc_atom_t type, const char *sub_type)
 {
     UNUSED_PARAM(msg);
-    if ((is_variant_match_observe(observer->observed, observed)) &&
-                (observer->msg_type_atom == type)) {
-        if (observer->sub_type == sub_type ||
-                pcregex_is_match(observer->sub_type, sub_type)) {
-            return true;
-        }
+    if ((observer->msg_type_atom == type) &&
+            (is_variant_match_observe(observer->observed, observed))) {
+        return is_sub_type_match(observer, sub_type);
     }
     return false;
 }
 
+bool
+pcintr_is_observer_match(struct pcintr_observer *observer, pcrdr_msg *msg,
+        purc_variant_t observed, purc_atom_t type, const char *sub_type)
+{
+    if (observer->is_match)
+        return observer->is_match(observer, msg, observed, type, sub_type);
+    return is_match_default(observer, msg, observed, type, sub_type);
+}
+
+#define NR_OBSERVER_BUCKETS_MIN     16      /* must be a power of 2 */
+
+/* the hash of the observed variant for the native entities */
+#define OBSERVED_HASH_NATIVE        0
+
+struct pcintr_observer_bucket {
+    struct pcintr_observer_bucket  *next;
+    uint64_t                        hash;
+    uint64_t                        observed_hash;
+    purc_atom_t                     type;
+
+    /* the next bucket emptied while dispatching */
+    struct pcintr_observer_bucket  *next_empty;
+    bool                            is_empty_listed;
+
+    /* the observers in the order of registration */
+    struct list_head                observers;
+};
+
+static inline uint64_t
+bucket_hash(uint64_t observed_hash, purc_atom_t type)
+{
+    uint64_t hash = observed_hash ^ type;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static uint64_t
+observed_hash(purc_variant_t observed)
+{
+    if (observed && purc_variant_is_native(observed))
+        return OBSERVED_HASH_NATIVE;
+
+    uint64_t hash = pcvariant_hash_equal(observed);
+    return (hash == OBSERVED_HASH_NATIVE) ? 1 : hash;
+}
+
+static struct pcintr_observer_bucket *
+find_bucket(struct pcintr_observer_index *index, uint64_t observed_hash,
+        purc_atom_t type)
+{
+    if (index->nr_buckets == 0)
+        return NULL;
+
+    uint64_t hash = bucket_hash(observed_hash, type);
+    struct pcintr_observer_bucket *bucket;
+    bucket = index->buckets[hash & (index->nr_buckets - 1)];
+    while (bucket) {
+        if (bucket->observed_hash == observed_hash && bucket->type == type)
+            return bucket;
+        bucket = bucket->next;
+    }
+
+    return NULL;
+}
+
+static int
+grow_buckets(struct pcintr_observer_index *index)
+{
+    size_t nr_buckets = index->nr_buckets ?
+        index->nr_buckets * 2 : NR_OBSERVER_BUCKETS_MIN;
+    struct pcintr_observer_bucket **buckets;
+    buckets = calloc(nr_buckets, sizeof(*buckets));
+    if (buckets == NULL)
+        return -1;
+
+    for (size_t i = 0; i < index->nr_buckets; i++) {
+        struct pcintr_observer_bucket *bucket = index->buckets[i];
+        while (bucket) {
+            struct pcintr_observer_bucket *next = bucket->next;
+            size_t n = bucket->hash & (nr_buckets - 1);
+            bucket->next = buckets[n];
+            buckets[n] = bucket;
+            bucket = next;
+        }
+    }
+
+    free(index->buckets);
+    index->buckets = buckets;
+    index->nr_buckets = nr_buckets;
+    return 0;
+}
+
+static struct pcintr_observer_bucket *
+get_bucket(struct pcintr_observer_index *index, uint64_t observed_hash,
+        purc_atom_t type)
+{
+    struct pcintr_observer_bucket *bucket;
+    bucket = find_bucket(index, observed_hash, type);
+    if (bucket)
+        return bucket;
+
+    /* keep the load factor under 0.75 */
+    if ((index->nr_keys + 1) * 4 > index->nr_buckets * 3 &&
+            grow_buckets(index))
+        return NULL;
+
+    if ((bucket = malloc(sizeof(*bucket))) == NULL)
+        return NULL;
+
+    bucket->hash = bucket_hash(observed_hash, type);
+    bucket->observed_hash = observed_hash;
+    bucket->type = type;
+    bucket->next_empty = NULL;
+    bucket->is_empty_listed = false;
+    list_head_init(&bucket->observers);
+
+    size_t n = bucket->hash & (index->nr_buckets - 1);
+    bucket->next = index->buckets[n];
+    index->buckets[n] = bucket;
+    index->nr_keys++;
+    return bucket;
+}
+
+static void
+free_bucket(struct pcintr_observer_index *index,
+        struct pcintr_observer_bucket *bucket)
+{
+    struct pcintr_observer_bucket **pbucket;
+    pbucket = &index->buckets[bucket->hash & (index->nr_buckets - 1)];
+    while (*pbucket != bucket)
+        pbucket = &(*pbucket)->next;
+
+    *pbucket = bucket->next;
+    free(bucket);
+    index->nr_keys--;
+}
+
+/* free the buckets emptied while dispatching and still empty */
+static void
+free_empty_buckets(struct pcintr_observer_index *index)
+{
+    struct pcintr_observer_bucket *bucket = index->empty_buckets;
+    while (bucket) {
+        struct pcintr_observer_bucket *next = bucket->next_empty;
+        if (list_empty(&bucket->observers))
+            free_bucket(index, bucket);
+        else
+            bucket->is_empty_listed = false;
+        bucket = next;
+    }
+
+    index->empty_buckets = NULL;
+}
+
+void
+pcintr_observer_index_init(struct pcintr_observer_index *index)
+{
+    memset(index, 0, sizeof(*index));
+    list_head_init(&index->generic);
+}
+
+void
+pcintr_observer_index_cleanup(struct pcintr_observer_index *index)
+{
+    PC_ASSERT(list_empty(&index->generic));
+    PC_ASSERT(index->iterators == NULL);
+
+    free_empty_buckets(index);
+    for (size_t i = 0; i < index->nr_buckets; i++) {
+        while (index->buckets[i])
+            free_bucket(index, index->buckets[i]);
+    }
+    PC_ASSERT(index->nr_keys == 0);
+
+    free(index->buckets);
+    index->buckets = NULL;
+    index->nr_buckets = 0;
+}
+
+int
+pcintr_observer_index_add(struct pcintr_observer_index *index,
+        struct pcintr_observer *observer)
+{
+    struct list_head *list = &index->generic;
+    struct pcintr_observer_bucket *bucket = NULL;
+
+    if (observer->is_match == NULL) {
+        bucket = get_bucket(index, observed_hash(observer->observed),
+                observer->msg_type_atom);
+        if (bucket == NULL) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        list = &bucket->observers;
+    }
+
+    compile_sub_type(observer);
+    observer->index = index;
+    observer->bucket = bucket;
+    observer->serial = ++index->last_serial;
+    list_add_tail(&observer->node_index, list);
+    return 0;
+}
+
+void
+pcintr_observer_index_remove(struct pcintr_observer *observer)
+{
+    struct pcintr_observer_index *index = observer->index;
+    if (index == NULL)
+        return;
+
+    /* move the iterators in use off the observer */
+    struct pcintr_observer_iterator *it;
+    for (it = index->iterators; it; it = it->prev) {
+        for (int i = 0; i < PCINTR_NR_OBSERVER_LISTS; i++) {
+            if (it->nexts[i] == &observer->node_index)
+                it->nexts[i] = observer->node_index.next;
+        }
+    }
+
+    list_del(&observer->node_index);
+    struct pcintr_observer_bucket *bucket = observer->bucket;
+    if (bucket && list_empty(&bucket->observers)) {
+        /* the iterators in use may refer to the bucket */
+        if (index->iterators == NULL)
+            free_bucket(index, bucket);
+        else if (!bucket->is_empty_listed) {
+            bucket->is_empty_listed = true;
+            bucket->next_empty = index->empty_buckets;
+            index->empty_buckets = bucket;
+        }
+    }
+
+    if (observer->sub_type_regex) {
+        pcregex_destroy(observer->sub_type_regex);
+        observer->sub_type_regex = NULL;
+    }
+
+    observer->index = NULL;
+    observer->bucket = NULL;
+}
+
+void
+pcintr_observer_index_begin(struct pcintr_observer_index *index,
+        struct pcintr_observer_iterator *it,
+        purc_variant_t observed, purc_atom_t type)
+{
+    struct pcintr_observer_bucket *bucket;
+
+    memset(it, 0, sizeof(*it));
+    it->index = index;
+
+    uint64_t hash = observed_hash(observed);
+    bucket = find_bucket(index, hash, type);
+    if (bucket)
+        it->heads[0] = &bucket->observers;
+
+    /* the bucket of the native entities is already the first list */
+    if (hash != OBSERVED_HASH_NATIVE) {
+        bucket = find_bucket(index, OBSERVED_HASH_NATIVE, type);
+        if (bucket)
+            it->heads[1] = &bucket->observers;
+    }
+
+    it->heads[2] = &index->generic;
+
+    for (int i = 0; i < PCINTR_NR_OBSERVER_LISTS; i++) {
+        if (it->heads[i])
+            it->nexts[i] = it->heads[i]->next;
+    }
+
+    /* the observers registered from now on are not iterated */
+    it->last_serial = index->last_serial;
+
+    it->prev = index->iterators;
+    index->iterators = it;
+}
+
+struct pcintr_observer *
+pcintr_observer_index_next(struct pcintr_observer_iterator *it)
+{
+    struct pcintr_observer *found = NULL;
+    int which = -1;
+
+    /* merge the lists sorted by the serial numbers */
+    for (int i = 0; i < PCINTR_NR_OBSERVER_LISTS; i++) {
+        if (it->heads[i] == NULL || it->nexts[i] == it->heads[i])
+            continue;
+
+        struct pcintr_observer *observer;
+        observer = list_entry(it->nexts[i], struct pcintr_observer,
+                node_index);
+        if (observer->serial > it->last_serial)
+            continue;
+
+        if (found == NULL || observer->serial < found->serial) {
+            found = observer;
+            which = i;
+        }
+    }
+
+    if (found)
+        it->nexts[which] = found->node_index.next;
+    return found;
+}
+
+void
+pcintr_observer_index_end(struct pcintr_observer_iterator *it)
+{
+    struct pcintr_observer_index *index = it->index;
+
+    PC_ASSERT(index->iterators == it);
+    index->iterators = it->prev;
+
+    if (index->iterators == NULL && index->empty_buckets)
+        free_empty_buckets(index);
+}
+
 static int
 observer_handle_default(pcintr_coroutine_t co, struct pcintr_observer *p,
         pcrdr_msg *msg, purc_atom_t type, const char *sub_type, void *data)
@@ -168,6 +546,7 @@ observer_handle_default(pcintr_coroutine_t co, struct pcintr_observer *p,
     }
 
     list_add_tail(&task->ln, &co->tasks);
+    pcintr_coroutine_wakeup(co);
     return 0;
 }
 
@@ -227,11 +606,20 @@ pcintr_register_observer(pcintr_stack_t  stack,
     observer->sub_type = sub_type ? strdup(sub_type) : NULL;
     observer->on_revoke = on_revoke;
     observer->on_revoke_data = on_revoke_data;
-    observer->is_match = is_match ? is_match : is_match_default;
+    observer->is_match = is_match;
     observer->handle = handle ? handle : observer_handle_default;
     observer->handle_data = handle_data;
     observer->auto_remove = auto_remove;
     observer->timestamp = get_timestamp_us();
+
+    struct pcintr_observer_index *index = (source == OBSERVER_SOURCE_INTR) ?
+        &stack->intr_index : &stack->hvml_index;
+    if (pcintr_observer_index_add(index, observer)) {
+        purc_variant_unref(observer->observed);
+        free(observer->sub_type);
+        free(observer);
+        return NULL;
+    }
     add_observer_into_list(stack, list, observer);
 
     // observe idle
@@ -317,7 +705,8 @@ revoke_observer_from_list(struct list_head *list, purc_variant_t observed,
 {
     struct pcintr_observer *p, *n;
     list_for_each_entry_safe(p, n, list, node) {
-        if (p->is_match(p, NULL, observed, msg_type_atom, sub_type)) {
+        if (pcintr_is_observer_match(p, NULL, observed, msg_type_atom,
+                    sub_type)) {
             pcintr_revoke_observer(p);
             break;
         }
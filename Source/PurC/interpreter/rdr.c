@@ -116,6 +116,10 @@ pcrdr_msg *pcintr_rdr_send_request_and_wait_response(struct pcrdr_conn *conn,
         purc_variant_t data, size_t data_len)
 {
     pcrdr_msg *response_msg = NULL;
+
+    /* keep the order of the DOM operations queued in the current batch */
+    pcintr_rdr_flush_dom_batch(pcinst_current());
+
     pcrdr_msg *msg = pcrdr_make_request_message(
             target,                             /* target */
             target_value,                       /* target_value */
@@ -1041,22 +1045,52 @@ static const char *rdr_ops[] = {
     "",     // unknown
 };
 
+static bool
+rdr_dom_req_allowed(pcintr_stack_t stack)
+{
+    return stack && stack->co->target_page_handle != 0
+        && stack->co->stage == CO_STAGE_OBSERVING;
+}
+
+static const char *
+rdr_dom_operation(pcdoc_operation op, const char *property)
+{
+    if (property && op == PCDOC_OP_DISPLACE) {
+        // VW: use 'update' operation when displace property
+        return rdr_ops[PCDOC_OP_UPDATE];
+    }
+
+    return rdr_ops[op];
+}
+
+static int
+rdr_dom_element_handle(char *buf, size_t sz, pcdoc_element_t element)
+{
+    int n = snprintf(buf, sz,
+            "%llx", (unsigned long long int)(uint64_t)element);
+    if (n < 0) {
+        purc_set_error(PURC_ERROR_BAD_STDC_CALL);
+        return -1;
+    }
+    else if ((size_t)n >= sz) {
+        PC_DEBUG ("Too small elemer to serialize message.\n");
+        purc_set_error(PURC_ERROR_TOO_SMALL_BUFF);
+        return -1;
+    }
+
+    return 0;
+}
+
 pcrdr_msg *
 pcintr_rdr_send_dom_req(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char* property,
         pcrdr_msg_data_type data_type, purc_variant_t data)
 {
-    if (!stack || stack->co->target_page_handle == 0
-            || stack->co->stage != CO_STAGE_OBSERVING) {
+    if (!rdr_dom_req_allowed(stack)) {
         return NULL;
     }
 
-    const char *operation = rdr_ops[op];
-    if (property && op == PCDOC_OP_DISPLACE) {
-        // VW: use 'update' operation when displace property
-        operation = PCRDR_OPERATION_UPDATE;
-    }
-
+    const char *operation = rdr_dom_operation(op, property);
     pcrdr_msg *response_msg = NULL;
 
     pcrdr_msg_target target = PCRDR_MSG_TARGET_DOM;
@@ -1064,15 +1098,7 @@ pcintr_rdr_send_dom_req(pcintr_stack_t stack, pcdoc_operation op,
     pcrdr_msg_element_type element_type = PCRDR_MSG_ELEMENT_TYPE_HANDLE;
 
     char elem[LEN_BUFF_LONGLONGINT];
-    int n = snprintf(elem, sizeof(elem),
-            "%llx", (unsigned long long int)(uint64_t)element);
-    if (n < 0) {
-        purc_set_error(PURC_ERROR_BAD_STDC_CALL);
-        goto failed;
-    }
-    else if ((size_t)n >= sizeof (elem)) {
-        PC_DEBUG ("Too small elemer to serialize message.\n");
-        purc_set_error(PURC_ERROR_TOO_SMALL_BUFF);
+    if (rdr_dom_element_handle(elem, sizeof(elem), element)) {
         goto failed;
     }
 
@@ -1100,6 +1126,354 @@ failed:
     return NULL;
 }
 
+/* the max number of DOM operations queued before flushing the batch */
+#define RDR_DOM_BATCH_MAX           32
+
+/* the timeout (ms) to poll the connection for the responses of a batch */
+#define RDR_DOM_BATCH_POLL_MS       10
+
+static void
+rdr_dom_req_delete(struct pcintr_heap *heap, struct pcintr_rdr_dom_req *req)
+{
+    list_del(&req->ln);
+    heap->nr_rdr_dom_reqs--;
+
+    if (req->property)
+        free(req->property);
+    if (req->data)
+        purc_variant_unref(req->data);
+    free(req);
+}
+
+static bool
+rdr_dom_req_same_target(struct pcintr_rdr_dom_req *req, uint64_t dom_handle,
+        pcdoc_element_t element, const char *property)
+{
+    if (req->dom_handle != dom_handle || req->element != element)
+        return false;
+
+    if (req->property == NULL || property == NULL)
+        return req->property == property;
+
+    return strcmp(req->property, property) == 0;
+}
+
+/* Only the plain texts can be concatenated: two HTML fragments are parsed
+   one by one by the renderer, and their concatenation may be parsed into
+   a different tree (e.g. `<b>` and `</b>`). */
+static bool
+rdr_dom_req_is_text(pcrdr_msg_data_type data_type, purc_variant_t data)
+{
+    return data && purc_variant_is_string(data) &&
+        data_type == PCRDR_MSG_DATA_TYPE_PLAIN;
+}
+
+/* Whether the operation changes the whole content or the whole property;
+   such an operation supersedes the former ones on the same target. */
+static bool
+rdr_dom_req_is_replacing(const char *operation)
+{
+    return operation == rdr_ops[PCDOC_OP_DISPLACE] ||
+        operation == rdr_ops[PCDOC_OP_UPDATE];
+}
+
+static bool
+rdr_dom_req_is_superseded(const char *operation)
+{
+    return rdr_dom_req_is_replacing(operation) ||
+        operation == rdr_ops[PCDOC_OP_APPEND] ||
+        operation == rdr_ops[PCDOC_OP_PREPEND] ||
+        operation == rdr_ops[PCDOC_OP_CLEAR];
+}
+
+static purc_variant_t
+rdr_dom_req_concat_text(purc_variant_t first, purc_variant_t second)
+{
+    size_t len1, len2;
+    const char *str1 = purc_variant_get_string_const_ex(first, &len1);
+    const char *str2 = purc_variant_get_string_const_ex(second, &len2);
+
+    char *buf = malloc(len1 + len2 + 1);
+    if (buf == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    memcpy(buf, str1, len1);
+    memcpy(buf + len1, str2, len2);
+    buf[len1 + len2] = 0;
+    return purc_variant_make_string_reuse_buff(buf, len1 + len2 + 1, false);
+}
+
+/* Try to merge the operation with the ones at the tail of the queue.
+   Returns true if the operation has been merged into the tail one. */
+static bool
+rdr_dom_req_coalesce(struct pcintr_heap *heap, uint64_t dom_handle,
+        pcdoc_element_t element, const char *operation, const char *property,
+        pcrdr_msg_data_type data_type, purc_variant_t data)
+{
+    struct pcintr_rdr_dom_req *last;
+
+    if (rdr_dom_req_is_replacing(operation)) {
+        // displace/update: the former operations on the same target
+        // are useless.
+        while (!list_empty(&heap->rdr_dom_reqs)) {
+            last = list_last_entry(&heap->rdr_dom_reqs,
+                    struct pcintr_rdr_dom_req, ln);
+            if (!rdr_dom_req_same_target(last, dom_handle, element, property)
+                    || !rdr_dom_req_is_superseded(last->operation))
+                break;
+            rdr_dom_req_delete(heap, last);
+        }
+        return false;
+    }
+
+    if (operation != rdr_ops[PCDOC_OP_APPEND] ||
+            list_empty(&heap->rdr_dom_reqs))
+        return false;
+
+    // append after append/displace: concatenate the contents;
+    // only for the content or the text content of the element.
+    if (property && strcmp(property, "textContent"))
+        return false;
+
+    last = list_last_entry(&heap->rdr_dom_reqs,
+            struct pcintr_rdr_dom_req, ln);
+    if (!rdr_dom_req_same_target(last, dom_handle, element, property) ||
+            (last->operation != rdr_ops[PCDOC_OP_APPEND] &&
+             !rdr_dom_req_is_replacing(last->operation)) ||
+            last->data_type != data_type ||
+            !rdr_dom_req_is_text(last->data_type, last->data) ||
+            !rdr_dom_req_is_text(data_type, data))
+        return false;
+
+    purc_variant_t merged = rdr_dom_req_concat_text(last->data, data);
+    if (merged == PURC_VARIANT_INVALID)
+        return false;
+
+    purc_variant_unref(last->data);
+    last->data = merged;
+    purc_variant_unref(data);
+    return true;
+}
+
+bool
+pcintr_rdr_queue_dom_req(struct pcintr_heap *heap, uint64_t dom_handle,
+        pcdoc_operation op, pcdoc_element_t element, const char *property,
+        pcrdr_msg_data_type data_type, purc_variant_t data)
+{
+    const char *operation = rdr_dom_operation(op, property);
+    struct pcintr_rdr_dom_req *req;
+
+    if (rdr_dom_req_coalesce(heap, dom_handle, element, operation, property,
+                data_type, data))
+        return true;
+
+    req = calloc(1, sizeof(*req));
+    if (req == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        goto failed;
+    }
+
+    if (property) {
+        req->property = strdup(property);
+        if (req->property == NULL) {
+            free(req);
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            goto failed;
+        }
+    }
+
+    req->dom_handle = dom_handle;
+    req->element = element;
+    req->operation = operation;
+    req->data_type = data_type;
+    req->data = data;
+    list_add_tail(&req->ln, &heap->rdr_dom_reqs);
+    heap->nr_rdr_dom_reqs++;
+    return true;
+
+failed:
+    if (data)
+        purc_variant_unref(data);
+    return false;
+}
+
+/* Queue a DOM operation; the reference of `data` is taken over. */
+static bool
+rdr_dom_req_queue(struct pcinst *inst, pcintr_stack_t stack,
+        pcdoc_operation op, pcdoc_element_t element, const char *property,
+        pcrdr_msg_data_type data_type, purc_variant_t data)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    if (!pcintr_rdr_queue_dom_req(heap, stack->co->target_dom_handle,
+                op, element, property, data_type, data))
+        return false;
+
+    if (heap->nr_rdr_dom_reqs >= RDR_DOM_BATCH_MAX) {
+        pcintr_rdr_flush_dom_batch(inst);
+    }
+    return true;
+}
+
+static int
+rdr_dom_batch_response_handler(pcrdr_conn* conn,
+        const char *request_id, int state,
+        void *context, const pcrdr_msg *response_msg)
+{
+    UNUSED_PARAM(conn);
+    UNUSED_PARAM(request_id);
+    UNUSED_PARAM(context);
+
+    // the heap may have gone when the connection is freed
+    struct pcinst *inst = pcinst_current();
+    struct pcintr_heap *heap = inst ? inst->intr_heap : NULL;
+    if (heap == NULL)
+        return 0;
+
+    if (heap->nr_rdr_dom_pending > 0)
+        heap->nr_rdr_dom_pending--;
+
+    if (state != PCRDR_RESPONSE_RESULT ||
+            response_msg->retCode != PCRDR_SC_OK) {
+        heap->nr_rdr_dom_failed++;
+    }
+
+    return 0;
+}
+
+static int
+rdr_dom_req_send(struct pcrdr_conn *conn, struct pcintr_rdr_dom_req *req)
+{
+    char elem[LEN_BUFF_LONGLONGINT];
+    if (rdr_dom_element_handle(elem, sizeof(elem), req->element))
+        return -1;
+
+    pcrdr_msg *msg = pcrdr_make_request_message(
+            PCRDR_MSG_TARGET_DOM,               /* target */
+            req->dom_handle,                    /* target_value */
+            req->operation,                     /* operation */
+            NULL,                               /* request_id */
+            NULL,                               /* source_uri */
+            PCRDR_MSG_ELEMENT_TYPE_HANDLE,      /* element_type */
+            elem,                               /* element */
+            req->property,                      /* property */
+            PCRDR_MSG_DATA_TYPE_VOID,           /* data_type */
+            NULL,                               /* data */
+            0                                   /* data_len */
+            );
+    if (msg == NULL) {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    // the message takes over the data
+    msg->dataType = req->data_type;
+    msg->data = req->data;
+    req->data = PURC_VARIANT_INVALID;
+
+    int ret = pcrdr_send_request(conn, msg, PCRDR_TIME_DEF_EXPECTED,
+            NULL, rdr_dom_batch_response_handler);
+    pcrdr_release_message(msg);
+    return ret;
+}
+
+static int
+rdr_dom_batch_send(struct pcinst *inst, struct pcintr_heap *heap)
+{
+    struct pcrdr_conn *conn = inst->conn_to_rdr;
+    if (conn == NULL) {
+        pcintr_rdr_discard_dom_batch(inst);
+        return 0;
+    }
+
+    // send all requests without waiting, then collect the responses once.
+    heap->nr_rdr_dom_failed = 0;
+    struct pcintr_rdr_dom_req *req, *next;
+    list_for_each_entry_safe(req, next, &heap->rdr_dom_reqs, ln) {
+        if (rdr_dom_req_send(conn, req) == 0)
+            heap->nr_rdr_dom_pending++;
+        else
+            heap->nr_rdr_dom_failed++;
+        rdr_dom_req_delete(heap, req);
+    }
+
+    while (heap->nr_rdr_dom_pending > 0) {
+        if (pcrdr_wait_and_dispatch_message(conn, RDR_DOM_BATCH_POLL_MS) < 0
+                && purc_get_last_error() != PCRDR_ERROR_TIMEOUT) {
+            // the connection is broken; the pending requests will be
+            // cancelled when the connection is freed.
+            heap->nr_rdr_dom_pending = 0;
+            return -1;
+        }
+    }
+
+    if (heap->nr_rdr_dom_failed) {
+        PC_WARN("%u DOM operations failed in the batch\n",
+                (unsigned)heap->nr_rdr_dom_failed);
+        return -1;
+    }
+
+    return 0;
+}
+
+int
+pcintr_rdr_flush_dom_batch(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst ? inst->intr_heap : NULL;
+    if (heap == NULL || list_empty(&heap->rdr_dom_reqs))
+        return 0;
+
+    // the failures of the batched operations are not reported to
+    // the coroutine, like the ones sent by the simple functions;
+    // keep the error and the exception info left by the caller.
+    int last_err = inst->errcode;
+    purc_variant_t last_exinfo = inst->err_exinfo;
+    if (last_exinfo)
+        purc_variant_ref(last_exinfo);
+
+    int ret = rdr_dom_batch_send(inst, heap);
+
+    if (inst->errcode != last_err || inst->err_exinfo != last_exinfo) {
+        purc_set_error_exinfo(last_err, last_exinfo);
+    }
+    else if (last_exinfo) {
+        purc_variant_unref(last_exinfo);
+    }
+
+    return ret;
+}
+
+void
+pcintr_rdr_discard_dom_batch(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst ? inst->intr_heap : NULL;
+    if (heap == NULL)
+        return;
+
+    struct pcintr_rdr_dom_req *req, *next;
+    list_for_each_entry_safe(req, next, &heap->rdr_dom_reqs, ln) {
+        rdr_dom_req_delete(heap, req);
+    }
+}
+
+void
+pcintr_rdr_begin_dom_batch(struct pcinst *inst)
+{
+    inst->intr_heap->rdr_dom_batching = 1;
+}
+
+void
+pcintr_rdr_end_dom_batch(struct pcinst *inst, bool flush)
+{
+    inst->intr_heap->rdr_dom_batching = 0;
+
+    if (flush) {
+        pcintr_rdr_flush_dom_batch(inst);
+    }
+}
+
 pcrdr_msg *
 pcintr_rdr_send_dom_req_raw(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char* property,
@@ -1143,6 +1517,18 @@ pcintr_rdr_send_dom_req_simple(pcintr_stack_t stack, pcdoc_operation op,
         pcdoc_element_t element, const char *property,
         pcrdr_msg_data_type data_type, purc_variant_t data)
 {
+    struct pcinst *inst = pcinst_current();
+    if (inst->intr_heap && inst->intr_heap->rdr_dom_batching) {
+        if (!rdr_dom_req_allowed(stack)) {
+            if (data)
+                purc_variant_unref(data);
+            return false;
+        }
+
+        return rdr_dom_req_queue(inst, stack, op, element, property,
+                data_type, data);
+    }
+
     pcrdr_msg *response_msg = pcintr_rdr_send_dom_req(stack, op,
             element, property, data_type, data);
     if (response_msg != NULL) {
@@ -1166,6 +1552,30 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack,
         data = " ";
         len = 1;
     }
+
+    struct pcinst *inst = pcinst_current();
+    if (inst->intr_heap && inst->intr_heap->rdr_dom_batching) {
+        if (!rdr_dom_req_allowed(stack)) {
+            return false;
+        }
+
+        purc_variant_t req_data;
+        if (data_type == PCRDR_MSG_DATA_TYPE_JSON) {
+            req_data = purc_variant_make_from_json_string(data, len);
+        }
+        else {  /* VW: for other data types */
+            req_data = purc_variant_make_string_ex(data, len, false);
+        }
+
+        if (req_data == PURC_VARIANT_INVALID) {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return false;
+        }
+
+        return rdr_dom_req_queue(inst, stack, op, element, property,
+                data_type, req_data);
+    }
+
     pcrdr_msg *response_msg = pcintr_rdr_send_dom_req_raw(stack, op,
             element, property, data_type, data, len);
 
@@ -1175,4 +1585,3 @@ pcintr_rdr_send_dom_req_simple_raw(pcintr_stack_t stack,
     }
     return false;
 }
-
@@ -170,6 +170,21 @@ uintptr_t purc_runloop_add_fd_monitor(purc_runloop_t runloop, int fd,
         });
 }
 
+uintptr_t pcintr_runloop_add_wakeup_fd(purc_runloop_t runloop, int fd,
+        purc_runloop_func func, void *ctxt)
+{
+    RunLoop *runLoop = runloop ? (RunLoop*)runloop : &RunLoop::current();
+
+    return runLoop->addFdMonitor(fd,
+            (GIOCondition)(G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP),
+            [func, ctxt] (gint fd, GIOCondition condition) -> gboolean {
+            UNUSED_PARAM(fd);
+            UNUSED_PARAM(condition);
+            func(ctxt);
+            return true;
+        });
+}
+
 void purc_runloop_remove_fd_monitor(purc_runloop_t runloop, uintptr_t handle)
 {
     if (!runloop) {
@@ -41,7 +41,6 @@
 
 #include <sys/time.h>
 
-#define SCHEDULE_SLEEP          10000           // usec
 #define IDLE_EVENT_TIMEOUT      100             // ms
 
 #define BUILTIN_VAR_CRTN        PURC_PREDEF_VARNAME_CRTN
@@ -95,12 +94,97 @@ handle_rdr_conn_lost(struct pcinst *inst)
                 PURC_VARIANT_INVALID, PURC_VARIANT_INVALID);
     }
 
+    if (heap->conn_monitor) {
+        purc_runloop_remove_fd_monitor(inst->running_loop, heap->conn_monitor);
+        heap->conn_monitor = 0;
+        heap->conn_monitor_fd = -1;
+    }
+
     // FIXME:
     // pcrdr_disconnect(inst->conn_to_rdr);
     pcrdr_free_connection(inst->conn_to_rdr);
     inst->conn_to_rdr = NULL;
 }
 
+static void
+schedule_in_current_inst(void *ctxt)
+{
+    UNUSED_PARAM(ctxt);
+
+    struct pcinst *inst = pcinst_current();
+    if (inst && inst->intr_heap) {
+        inst->intr_heap->schedule_pending = 0;
+        pcintr_schedule(inst);
+    }
+}
+
+static void
+request_schedule(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    if (heap->schedule_pending) {
+        return;
+    }
+
+    heap->schedule_pending = 1;
+    purc_runloop_dispatch(inst->running_loop, schedule_in_current_inst, NULL);
+}
+
+void
+pcintr_coroutine_wakeup(pcintr_coroutine_t co)
+{
+    struct pcintr_heap *heap = co->owner;
+    if (!heap) {
+        // not attached to the heap yet
+        return;
+    }
+
+    if (list_empty(&co->ln_active)) {
+        list_add_tail(&co->ln_active, &heap->active_coroutines);
+    }
+
+    request_schedule(heap->owner);
+}
+
+/* called in the thread of the sender of the message */
+static void
+wakeup_by_move_buffer(void *ctxt)
+{
+    purc_runloop_t runloop = (purc_runloop_t)ctxt;
+
+    /* the instance will be resolved in the thread of the runloop */
+    purc_runloop_dispatch(runloop, schedule_in_current_inst, NULL);
+}
+
+static void
+wakeup_by_conn(void *ctxt)
+{
+    request_schedule((struct pcinst *)ctxt);
+}
+
+static void
+watch_conn_to_rdr(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+    struct pcrdr_conn *conn = inst->conn_to_rdr;
+    int fd = conn ? pcrdr_conn_socket_fd(conn) : -1;
+
+    if (fd == heap->conn_monitor_fd) {
+        return;
+    }
+
+    if (heap->conn_monitor) {
+        purc_runloop_remove_fd_monitor(inst->running_loop, heap->conn_monitor);
+        heap->conn_monitor = 0;
+    }
+
+    if (fd >= 0) {
+        heap->conn_monitor = pcintr_runloop_add_wakeup_fd(inst->running_loop,
+                fd, wakeup_by_conn, inst);
+    }
+    heap->conn_monitor_fd = fd;
+}
+
 
 void
 pcintr_check_after_execution_full(struct pcinst *inst, pcintr_coroutine_t co)
@@ -302,36 +386,16 @@ execute_one_step_for_ready_co(struct pcinst *inst, pcintr_coroutine_t co)
     pcintr_set_current_co(co);
 
     pcintr_coroutine_set_state(co, CO_STATE_RUNNING);
+    pcintr_rdr_begin_dom_batch(inst);
     pcintr_execute_one_step_for_ready_co(co);
     pcintr_check_after_execution_full(inst, co);
+    // the DOM operations queued by the steps are sent when
+    // the coroutine yields.
+    pcintr_rdr_end_dom_batch(inst, co->state != CO_STATE_READY);
 
     pcintr_set_current_co(NULL);
 }
 
-// execute one step for all ready coroutines of the inst
-// return whether busy
-static bool
-execute_one_step(struct pcinst *inst)
-{
-    struct pcintr_heap *heap = inst->intr_heap;
-    struct rb_root *coroutines = &heap->coroutines;
-    struct rb_node *p, *n;
-    struct rb_node *first = pcutils_rbtree_first(coroutines);
-    bool busy = false;
-    pcutils_rbtree_for_each_safe(first, p, n) {
-        pcintr_coroutine_t co = container_of(p, struct pcintr_coroutine,
-                node);
-        if (co->state != CO_STATE_READY) {
-            continue;
-        }
-
-        execute_one_step_for_ready_co(inst, co);
-        busy = true;
-    }
-    return busy;
-}
-
-
 void
 check_and_dispatch_event_from_conn(struct pcinst *inst)
 {
@@ -357,16 +421,20 @@ check_and_dispatch_event_from_conn(struct pcinst *inst)
 }
 
 static int
-handle_event_by_observer_list(purc_coroutine_t co, struct list_head *list,
+handle_event_by_observer_list(purc_coroutine_t co,
+        struct pcintr_observer_index *index,
         pcrdr_msg *msg, purc_atom_t event_type,
         const char *event_sub_type, bool *event_observed, bool *busy)
 {
     int ret = PURC_ERROR_INCOMPLETED;
     purc_variant_t observed = msg->elementValue;
-    struct pcintr_observer *observer, *next;
-    list_for_each_entry_safe(observer, next, list, node) {
-        bool match = observer->is_match(observer, msg, observed, event_type,
-                event_sub_type);
+    struct pcintr_observer_iterator it;
+    struct pcintr_observer *observer;
+
+    pcintr_observer_index_begin(index, &it, observed, event_type);
+    while ((observer = pcintr_observer_index_next(&it))) {
+        bool match = pcintr_is_observer_match(observer, msg, observed,
+                event_type, event_sub_type);
         if ((co->stage & observer->cor_stage) &&
                 (co->state & observer->cor_state) && match) {
             ret = observer->handle(co, observer, msg, event_type,
@@ -380,6 +448,7 @@ handle_event_by_observer_list(purc_coroutine_t co, struct list_head *list,
             *event_observed = true;
         }
     }
+    pcintr_observer_index_end(&it);
     return ret;
 }
 
@@ -426,7 +495,7 @@ handle_coroutine_event(pcintr_coroutine_t co)
     // observer
     if (msg) {
         handle_ret = handle_event_by_observer_list(co,
-                &co->stack.intr_observers, msg, event_type, event_sub_type,
+                &co->stack.intr_index, msg, event_type, event_sub_type,
                 &msg_observed, &busy);
 
         if (handle_ret == PURC_ERROR_OK) {
@@ -435,7 +504,7 @@ handle_coroutine_event(pcintr_coroutine_t co)
         }
         else {
             handle_ret = handle_event_by_observer_list(co,
-                    &co->stack.hvml_observers, msg, event_type, event_sub_type,
+                    &co->stack.hvml_index, msg, event_type, event_sub_type,
                     &msg_observed, &busy);
 
             if (handle_ret == PURC_ERROR_OK) {
@@ -473,31 +542,32 @@ out:
     return busy;
 }
 
+// handle the pending messages and tasks of the coroutine,
+// return whether busy.
 static bool
-dispatch_event(struct pcinst *inst)
+dispatch_event(pcintr_coroutine_t co)
 {
-    UNUSED_PARAM(inst);
-
     bool is_busy = false;
-    check_and_dispatch_event_from_conn(inst);
 
-    bool co_is_busy = false;
-    struct pcintr_heap *heap = inst->intr_heap;
-    struct rb_root *coroutines = &heap->coroutines;
-    struct rb_node *p, *n;
-    struct rb_node *first = pcutils_rbtree_first(coroutines);
-    pcutils_rbtree_for_each_safe(first, p, n) {
-        pcintr_coroutine_t co;
-        co = container_of(p, struct pcintr_coroutine, node);
-        co_is_busy = handle_coroutine_event(co);
+    // every message is tried once; the observed messages which are not
+    // handled yet are appended again, they will be tried again when
+    // the state or the stage of the coroutine changed.
+    size_t nr_tries = pcinst_msg_queue_count(co->mq) + 1;
+    while (nr_tries > 0) {
+        if (co->state == CO_STATE_READY || co->state == CO_STATE_RUNNING) {
+            break;
+        }
+
+        if (handle_coroutine_event(co)) {
+            is_busy = true;
+        }
 
         if (co->stack.exited && co->stack.last_msg_read) {
             pcintr_run_exiting_co(co);
+            break;
         }
 
-        if (co_is_busy) {
-            is_busy = true;
-        }
+        nr_tries--;
     }
 
     return is_busy;
@@ -506,44 +576,117 @@ dispatch_event(struct pcinst *inst)
 void
 pcintr_schedule(void *ctxt)
 {
-    static int i = 0;
     struct pcinst *inst = (struct pcinst *)ctxt;
     if (!inst) {
-        goto out_sleep;
+        return;
     }
 
     struct pcintr_heap *heap = inst->intr_heap;
     if (!heap) {
-        goto out_sleep;
+        return;
     }
 
+    bool is_busy = false;
 
-    // 1. exec one step for all ready coroutines and
-    // return whether step is busy
-    bool step_is_busy = execute_one_step(inst);
+    // 1. read the messages from the renderer connection or move buffer
+    check_and_dispatch_event_from_conn(inst);
+    watch_conn_to_rdr(inst);
+
+    // 2. visit the active coroutines only: exec one step for the ready
+    // coroutines and dispatch events for observing / stopped coroutines;
+    // the coroutines woken up during this pass will be visited next time.
+    struct list_head active;
+    list_head_init(&active);
+    list_splice_init(&heap->active_coroutines, &active);
+
+    while (!list_empty(&active)) {
+        pcintr_coroutine_t co = list_first_entry(&active,
+                struct pcintr_coroutine, ln_active);
+        list_del_init(&co->ln_active);
+
+        if (co->state == CO_STATE_READY) {
+            execute_one_step_for_ready_co(inst, co);
+            is_busy = true;
+        }
 
-    // 2. dispatch event for observing / stopped coroutines
-    bool event_is_busy = dispatch_event(inst);
+        if (dispatch_event(co)) {
+            is_busy = true;
+        }
+    }
 
-    // 3. its busy, goto next scheduler without sleep
-    if (step_is_busy || event_is_busy) {
+    if (is_busy) {
         pcintr_update_timestamp(inst);
-        goto out;
     }
 
-    // 5. broadcast idle event
+    if (list_empty(&heap->active_coroutines)) {
+        pcintr_rdr_flush_dom_batch(inst);
+    }
+
+    // 3. there are coroutines woken up, schedule again after the other
+    // sources of the runloop are processed; otherwise, the runloop blocks
+    // until it is woken up by a new message, a timer, or the connection.
+    if (!list_empty(&heap->active_coroutines)) {
+        request_schedule(inst);
+    }
+}
+
+static void
+idle_timer_fire(pcintr_timer_t timer, const char* id, void* data)
+{
+    UNUSED_PARAM(timer);
+    UNUSED_PARAM(id);
+
+    struct pcinst *inst = (struct pcinst *)data;
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    // check the connection for the renderers which can not wake us up,
+    // and the timeout of the pending requests.
+    request_schedule(inst);
+
     double now = pcintr_get_current_time();
     if (now - IDLE_EVENT_TIMEOUT > heap->timestamp) {
         broadcast_idle_event(inst);
         pcintr_update_timestamp(inst);
     }
+}
+
+void
+pcintr_start_scheduler(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    if (heap->idle_timer == NULL) {
+        heap->idle_timer = pcintr_timer_create(inst->running_loop, NULL,
+                idle_timer_fire, inst);
+        if (heap->idle_timer) {
+            pcintr_timer_set_interval(heap->idle_timer, IDLE_EVENT_TIMEOUT);
+            pcintr_timer_start(heap->idle_timer);
+        }
+    }
 
-out_sleep:
-    pcutils_usleep(SCHEDULE_SLEEP);
+    pcinst_set_move_buffer_wakeup(wakeup_by_move_buffer, inst->running_loop);
+    request_schedule(inst);
+}
 
-out:
-    i++;
-    return;
+void
+pcintr_stop_scheduler(struct pcinst *inst)
+{
+    struct pcintr_heap *heap = inst->intr_heap;
+
+    if (heap->move_buff) {
+        pcinst_set_move_buffer_wakeup(NULL, NULL);
+    }
+
+    if (heap->idle_timer) {
+        pcintr_timer_destroy(heap->idle_timer);
+        heap->idle_timer = NULL;
+    }
+
+    if (heap->conn_monitor) {
+        purc_runloop_remove_fd_monitor(inst->running_loop, heap->conn_monitor);
+        heap->conn_monitor = 0;
+        heap->conn_monitor_fd = -1;
+    }
 }
 
 int pcintr_yield(
@@ -191,9 +191,20 @@ static bool mgr_change_handler(purc_variant_t source, pcvar_op_t msg_type,
     return true;
 }
 
+static inline void
+bump_names_gen(void)
+{
+    struct pcinst *inst = pcinst_current();
+    if (inst)
+        inst->var_names_gen++;
+}
+
 static bool mgr_handler(purc_variant_t source, pcvar_op_t msg_type,
         void* ctxt, size_t nr_args, purc_variant_t* argv)
 {
+    if (msg_type & (PCVAR_OPERATION_GROW | PCVAR_OPERATION_SHRINK))
+        bump_names_gen();
+
     switch (msg_type) {
     case PCVAR_OPERATION_GROW:
         return mgr_grow_handler(source, msg_type, ctxt, nr_args, argv);
@@ -261,6 +272,7 @@ int pcvarmgr_destroy(pcvarmgr_t mgr)
 {
     if (mgr) {
         PC_ASSERT(mgr->node.rb_parent == NULL);
+        bump_names_gen();
         if (mgr->listener) {
             purc_variant_revoke_listener(mgr->object, mgr->listener);
         }
@@ -359,92 +371,207 @@ bool pcvarmgr_dispatch_except(pcvarmgr_t mgr, const char* name,
     return true;
 }
 
-static purc_variant_t
-_find_named_scope_var_in_vdom(purc_coroutine_t cor,
-        pcvdom_element_t elem, const char* name, pcvarmgr_t* mgr)
+#define NAMED_VAR_CACHE_SLOTS       8
+
+// the variable manager resolved for a name looked up from a frame;
+// valid while the frame keeps its position and scope, and no name has been
+// bound to or unbound from any variable manager since it was resolved.
+struct named_var_slot {
+    char               *name;
+    pcvarmgr_t          mgr;
+    pcvdom_element_t    pos;
+    pcvdom_element_t    scope;
+    uint64_t            gen;
+};
+
+struct pcintr_named_var_cache {
+    struct named_var_slot   slots[NAMED_VAR_CACHE_SLOTS];
+};
+
+static inline uint64_t
+names_gen(void)
 {
-    if (!elem || !name) {
-        PC_ASSERT(name); // FIXME: still recoverable???
-        purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-        return PURC_VARIANT_INVALID;
+    struct pcinst *inst = pcinst_current();
+    return inst ? inst->var_names_gen : 0;
+}
+
+static inline struct named_var_slot *
+named_var_slot(struct pcintr_stack_frame *frame, const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
     }
 
-    purc_variant_t v;
+    return frame->named_var_cache->slots +
+        (hash & (NAMED_VAR_CACHE_SLOTS - 1));
+}
 
-again:
+static pcvarmgr_t
+named_var_cache_get(struct pcintr_stack_frame *frame, const char *name,
+        uint64_t gen)
+{
+    if (!frame->named_var_cache)
+        return NULL;
 
-    v = pcintr_get_scope_variable(cor, elem, name);
-    if (v) {
-        if (mgr) {
-            *mgr = pcintr_get_scope_variables(cor, elem);
-        }
-        return v;
+    struct named_var_slot *slot = named_var_slot(frame, name);
+    if (slot->name && slot->gen == gen && slot->pos == frame->pos &&
+            slot->scope == frame->scope && strcmp(slot->name, name) == 0)
+        return slot->mgr;
+
+    return NULL;
+}
+
+static void
+named_var_cache_put(struct pcintr_stack_frame *frame, const char *name,
+        pcvarmgr_t mgr, uint64_t gen)
+{
+    if (!frame->named_var_cache) {
+        frame->named_var_cache = (struct pcintr_named_var_cache *)calloc(1,
+                sizeof(*frame->named_var_cache));
+        if (!frame->named_var_cache)
+            return;
     }
 
-    elem = pcvdom_element_parent(elem);
-    if (elem)
-        goto again;
+    struct named_var_slot *slot = named_var_slot(frame, name);
+    if (!slot->name || strcmp(slot->name, name)) {
+        free(slot->name);
+        slot->name = strdup(name);
+        if (!slot->name)
+            return;
+    }
 
-    purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-    return PURC_VARIANT_INVALID;
+    slot->mgr = mgr;
+    slot->pos = frame->pos;
+    slot->scope = frame->scope;
+    slot->gen = gen;
 }
 
-static purc_variant_t
-_find_named_scope_var(purc_coroutine_t cor,
-        struct pcintr_stack_frame *frame, const char* name, pcvarmgr_t* mgr)
+void
+pcintr_release_named_var_cache(struct pcintr_stack_frame *frame)
 {
-    if (frame->scope)
-        return _find_named_scope_var_in_vdom(cor, frame->scope, name, mgr);
+    struct pcintr_named_var_cache *cache = frame->named_var_cache;
+    if (!cache)
+        return;
 
-    pcvdom_element_t elem = frame->pos;
+    for (size_t i = 0; i < NAMED_VAR_CACHE_SLOTS; i++)
+        free(cache->slots[i].name);
+    free(cache);
+    frame->named_var_cache = NULL;
+}
 
-    if (!elem || !name) {
-        PC_ASSERT(name); // FIXME: still recoverable???
-        purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
+static inline purc_variant_t
+find_in_mgr(pcvarmgr_t mgr, const char *name)
+{
+    if (mgr == NULL)
         return PURC_VARIANT_INVALID;
-    }
+    return pcvariant_object_find(mgr->object, name);
+}
 
-    purc_variant_t v;
+static pcvarmgr_t
+find_named_scope_var(purc_coroutine_t cor, pcvdom_element_t elem,
+        const char *name, purc_variant_t *var)
+{
+    pcvarmgr_t mgr = pcintr_get_scoped_variables(cor,
+            pcvdom_ele_cast_to_node(elem));
 
-again:
+    *var = find_in_mgr(mgr, name);
+    return *var ? mgr : NULL;
+}
 
-    v = pcintr_get_scope_variable(cor, elem, name);
-    if (v) {
-        if (mgr) {
-            *mgr = pcintr_get_scope_variables(cor, elem);
-        }
-        return v;
+static pcvarmgr_t
+find_named_scope_var_in_vdom(purc_coroutine_t cor, pcvdom_element_t elem,
+        const char *name, purc_variant_t *var)
+{
+    for (; elem; elem = pcvdom_element_parent(elem)) {
+        pcvarmgr_t mgr = find_named_scope_var(cor, elem, name, var);
+        if (mgr)
+            return mgr;
     }
 
-    frame = pcintr_stack_frame_get_parent(frame);
-    if (frame) {
-        if (frame->scope)
-            return _find_named_scope_var_in_vdom(cor, frame->scope, name, mgr);
+    return NULL;
+}
+
+static pcvarmgr_t
+find_named_runner_var(purc_coroutine_t cor, const char *name,
+        purc_variant_t *var)
+{
+    pcvarmgr_t mgr;
 
-        elem = frame->pos;
-        if (elem)
-            goto again;
+    if (cor) {
+        mgr = cor->variables;
+        *var = find_in_mgr(mgr, name);
+        if (*var)
+            return mgr;
     }
 
-    purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-    return PURC_VARIANT_INVALID;
+    mgr = pcinst_get_variables();
+    *var = find_in_mgr(mgr, name);
+    return *var ? mgr : NULL;
 }
 
-static purc_variant_t
-find_cor_level_var(purc_coroutine_t cor, const char* name)
+/*
+ * Resolve the variable manager holding `name` by walking the scopes of
+ * the frames from `bottom` up, then the coroutine and the runner.
+ *
+ * The result is remembered by the first frame above `bottom` on the walk,
+ * so the later lookups from its descendants (e.g. the children of an
+ * `iterate` element) skip the walk above it.
+ */
+static pcvarmgr_t
+find_named_var_mgr(purc_coroutine_t cor, struct pcintr_stack_frame *bottom,
+        const char *name, purc_variant_t *var)
 {
-    PC_ASSERT(name);
-    if (!cor) {
-        purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-        return PURC_VARIANT_INVALID;
+    bool has_scoped = cor && cor->stack.scoped_variables.rb_node;
+    struct pcintr_stack_frame *frame = bottom;
+    struct pcintr_stack_frame *holder = NULL;
+    uint64_t gen = names_gen();
+    pcvarmgr_t mgr = NULL;
+
+    while (frame) {
+        if (frame != bottom) {
+            mgr = named_var_cache_get(frame, name, gen);
+            if (mgr) {
+                *var = find_in_mgr(mgr, name);
+                if (*var)
+                    goto found;
+                mgr = NULL;
+            }
+
+            if (!holder)
+                holder = frame;
+        }
+
+        if (frame->scope) {
+            if (has_scoped)
+                mgr = find_named_scope_var_in_vdom(cor, frame->scope, name,
+                        var);
+            break;
+        }
+
+        if (!frame->pos)
+            break;
+
+        if (has_scoped) {
+            mgr = find_named_scope_var(cor, frame->pos, name, var);
+            if (mgr)
+                break;
+        }
+
+        frame = pcintr_stack_frame_get_parent(frame);
     }
 
-    purc_variant_t v = purc_coroutine_get_variable(cor, name);
-    if (v) {
-        return v;
+    if (!mgr) {
+        mgr = find_named_runner_var(cor, name, var);
+        if (!mgr)
+            return NULL;
     }
-    purc_set_error_with_info(PCVARIANT_ERROR_NOT_FOUND, "name:%s", name);
-    return PURC_VARIANT_INVALID;
+
+found:
+    if (holder)
+        named_var_cache_put(holder, name, mgr, gen);
+    return mgr;
 }
 
 purc_variant_t
@@ -467,44 +594,22 @@ purc_get_runner_variable(const char* name)
     return PURC_VARIANT_INVALID;
 }
 
-static inline purc_variant_t
-find_inst_var(const char *name)
-{
-    return purc_get_runner_variable(name);
-}
-
 static purc_variant_t
 _find_named_temp_var(struct pcintr_stack_frame *frame, const char *name)
 {
-    struct pcintr_stack_frame *p = frame;
-
-again:
-
-    if (p == NULL) {
-        purc_set_error(PURC_ERROR_ENTITY_NOT_FOUND);
-        return PURC_VARIANT_INVALID;
-    }
-
-    do {
+    for (struct pcintr_stack_frame *p = frame; p;
+            p = pcintr_stack_frame_get_parent(p)) {
         purc_variant_t tmp;
         tmp = pcintr_get_exclamation_var(p);
-        if (tmp == PURC_VARIANT_INVALID)
-            break;
-
-        if (purc_variant_is_object(tmp) == false)
-            break;
-
-        purc_variant_t v;
-        v = purc_variant_object_get_by_ckey(tmp, name);
-        if (v == PURC_VARIANT_INVALID)
-            break;
-
-        return v;
-    } while (0);
+        if (tmp == PURC_VARIANT_INVALID || !purc_variant_is_object(tmp))
+            continue;
 
-    p = pcintr_stack_frame_get_parent(p);
+        purc_variant_t v = pcvariant_object_find(tmp, name);
+        if (v)
+            return v;
+    }
 
-    goto again;
+    return PURC_VARIANT_INVALID;
 }
 
 purc_variant_t
@@ -525,20 +630,7 @@ pcintr_find_named_var(pcintr_stack_t stack, const char* name)
         return v;
     }
 
-    v = _find_named_scope_var(stack->co, frame, name, NULL);
-    if (v) {
-        purc_clr_error();
-        return v;
-    }
-
-    v = find_cor_level_var(stack->co, name);
-    if (v) {
-        purc_clr_error();
-        return v;
-    }
-
-    v = find_inst_var(name);
-    if (v) {
+    if (find_named_var_mgr(stack->co, frame, name, &v)) {
         purc_clr_error();
         return v;
     }
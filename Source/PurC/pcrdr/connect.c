@@ -180,6 +180,8 @@ int pcrdr_free_connection(pcrdr_conn* conn)
         free(pr);
     }
 
+    if (conn->rx_buf)
+        free(conn->rx_buf);
     free(conn);
 
     return 0;
@@ -67,6 +67,10 @@ struct pcrdr_conn {
     /* the pending requests queue */
     struct list_head pending_requests;
 
+    /* the receive buffer reused for the incoming packets */
+    char  *rx_buf;
+    size_t sz_rx_buf;
+
     /* operations */
     int (*wait_message) (pcrdr_conn* conn, int timeout_ms);
     pcrdr_msg *(*read_message) (pcrdr_conn* conn);
@@ -26,6 +26,7 @@
 #include "config.h"
 #include "private/pcrdr.h"
 #include "private/instance.h"
+#include "private/atom-buckets.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -372,29 +373,14 @@ void pcrdr_release_message(pcrdr_msg *msg)
     pcinst_put_message(msg);
 }
 
-static inline char *is_blank_line(char *line)
+static inline bool is_blank_line(const char *line, size_t len)
 {
-    while (*line) {
-        if (*line == '\n') {
-            return ++line;
-        }
-        else if (*line != ' ' && *line != '\t') {
-            return NULL;
-        }
-
-        line++;
-    }
-
-    return ++line;
-}
-
-static inline char *skip_left_spaces(char *str)
-{
-    while (*str == ' ' || *str == '\t') {
-        str++;
+    for (size_t i = 0; i < len; i++) {
+        if (line[i] != ' ' && line[i] != '\t')
+            return false;
     }
 
-    return str;
+    return true;
 }
 
 #define STR_PAIR_SEPARATOR      ":"
@@ -404,6 +390,38 @@ static inline char *skip_left_spaces(char *str)
 
 #define STR_BLANK_LINE          " \n"
 
+/* Matches a length-delimited slice against a NULL-terminated name. */
+static inline bool
+slice_equal_name(const char *slice, size_t len, const char *name)
+{
+    return pcutils_strncasecmp(slice, name, len) == 0 && name[len] == '\0';
+}
+
+static int find_name(const char *names[], size_t nr_names,
+        const char *slice, size_t len)
+{
+    for (size_t i = 0; i < nr_names; i++) {
+        if (slice_equal_name(slice, len, names[i]))
+            return (int)i;
+    }
+
+    return -1;
+}
+
+/*
+ * Interns a repeated header value such as an operation or an event name
+ * as an atom, and makes a static string variant on the atom string,
+ * so that the parser does not allocate a string buffer for the value.
+ */
+static purc_variant_t make_interned_string(const char *value)
+{
+    purc_atom_t atom = purc_atom_from_string_ex(ATOM_BUCKET_MSG, value);
+    if (atom == 0)
+        return PURC_VARIANT_INVALID;
+
+    return purc_variant_make_string_static(purc_atom_to_string(atom), false);
+}
+
 static const char *type_names[] = {
     "void",       // PCRDR_MSG_TYPE_VOID,
     "request",    // PCRDR_MSG_TYPE_REQUEST,
@@ -418,16 +436,14 @@ _COMPILE_TIME_ASSERT(types,
         PCA_TABLESIZE(type_names) == PCRDR_MSG_TYPE_NR);
 #undef _COMPILE_TIME_ASSERT
 
-static bool on_type(pcrdr_msg *msg, char *value)
+static bool on_type(pcrdr_msg *msg, char *value, size_t len)
 {
-    for (size_t i = 0; i < PCA_TABLESIZE(type_names); i++) {
-        if (pcutils_strcasecmp(value, type_names[i]) == 0) {
-            msg->type = PCRDR_MSG_TYPE_FIRST + i;
-            return true;
-        }
-    }
+    int i = find_name(type_names, PCA_TABLESIZE(type_names), value, len);
+    if (i < 0)
+        return false;
 
-    return false;
+    msg->type = PCRDR_MSG_TYPE_FIRST + i;
+    return true;
 }
 
 static const char *target_names[] = {
@@ -448,32 +464,21 @@ _COMPILE_TIME_ASSERT(targets,
         PCA_TABLESIZE(target_names) == PCRDR_MSG_TARGET_NR);
 #undef _COMPILE_TIME_ASSERT
 
-static bool on_target(pcrdr_msg *msg, char *value)
+static bool on_target(pcrdr_msg *msg, char *value, size_t len)
 {
-    char *target, *target_value;
-    char *saveptr;
-
-    target = strtok_r(value, STR_VALUE_SEPARATOR, &saveptr);
-    if (target == NULL)
+    char *target_value = memchr(value, STR_VALUE_SEPARATOR[0], len);
+    if (target_value == NULL || target_value == value ||
+            target_value + 1 == value + len)
         return false;
 
-    target_value = strtok_r(NULL, STR_VALUE_SEPARATOR, &saveptr);
-    if (target_value == NULL)
+    int i = find_name(target_names, PCA_TABLESIZE(target_names),
+            value, target_value - value);
+    if (i < 0)
         return false;
-
-    size_t i;
-    for (i = 0; i < PCA_TABLESIZE(target_names); i++) {
-        if (pcutils_strcasecmp(value, target_names[i]) == 0) {
-            msg->target = PCRDR_MSG_TARGET_FIRST + i;
-            break;
-        }
-    }
-    if (i >= PCA_TABLESIZE(target_names)) {
-        return false;
-    }
+    msg->target = PCRDR_MSG_TARGET_FIRST + i;
 
     errno = 0;
-    msg->targetValue = (uint64_t)strtoull(target_value, NULL, 16);
+    msg->targetValue = (uint64_t)strtoull(target_value + 1, NULL, 16);
 
     if (errno)
         return false;
@@ -481,25 +486,29 @@ static bool on_target(pcrdr_msg *msg, char *value)
     return true;
 }
 
-static bool on_operation(pcrdr_msg *msg, char *value)
+static bool on_operation(pcrdr_msg *msg, char *value, size_t len)
 {
-    msg->operation = purc_variant_make_string(value, true);
+    UNUSED_PARAM(len);
+
+    msg->operation = make_interned_string(value);
     if (msg->operation)
         return true;
     return false;
 }
 
-static bool on_event_name(pcrdr_msg *msg, char *value)
+static bool on_event_name(pcrdr_msg *msg, char *value, size_t len)
 {
-    msg->eventName = purc_variant_make_string(value, true);
+    UNUSED_PARAM(len);
+
+    msg->eventName = make_interned_string(value);
     if (msg->eventName)
         return true;
     return false;
 }
 
-static bool on_source_uri(pcrdr_msg *msg, char *value)
+static bool on_source_uri(pcrdr_msg *msg, char *value, size_t len)
 {
-    msg->sourceURI = purc_variant_make_string(value, true);
+    msg->sourceURI = purc_variant_make_string_ex(value, len, true);
     if (msg->sourceURI)
         return true;
     return false;
@@ -522,72 +531,58 @@ _COMPILE_TIME_ASSERT(element_types,
         PCA_TABLESIZE(element_type_names) == PCRDR_MSG_ELEMENT_TYPE_NR);
 #undef _COMPILE_TIME_ASSERT
 
-static bool on_element(pcrdr_msg *msg, char *value)
+static bool on_element(pcrdr_msg *msg, char *value, size_t len)
 {
-    char *type;
-    char *saveptr;
-
-    type = strtok_r(value, STR_VALUE_SEPARATOR, &saveptr);
-    if (type == NULL)
+    char *element_value = memchr(value, STR_VALUE_SEPARATOR[0], len);
+    if (element_value == NULL || element_value == value ||
+            element_value + 1 == value + len)
         return false;
 
-    size_t i;
-    for (i = 0; i < PCA_TABLESIZE(element_type_names); i++) {
-        if (pcutils_strcasecmp(value, element_type_names[i]) == 0) {
-            msg->elementType = PCRDR_MSG_ELEMENT_TYPE_FIRST + i;
-            break;
-        }
-    }
-    if (i >= PCA_TABLESIZE(element_type_names)) {
+    int i = find_name(element_type_names, PCA_TABLESIZE(element_type_names),
+            value, element_value - value);
+    if (i < 0)
         return false;
-    }
+    msg->elementType = PCRDR_MSG_ELEMENT_TYPE_FIRST + i;
 
-    char *element_value = strtok_r(NULL, STR_VALUE_SEPARATOR, &saveptr);
-    if (element_value == NULL)
-        return false;
-
-    msg->elementValue = purc_variant_make_string(element_value, true);
+    /* the element value (e.g., a CSS selector) takes the rest of the line */
+    element_value++;
+    msg->elementValue = purc_variant_make_string_ex(element_value,
+            value + len - element_value, true);
     if (msg->elementValue)
         return true;
     return false;
 }
 
-static bool on_property(pcrdr_msg *msg, char *value)
+static bool on_property(pcrdr_msg *msg, char *value, size_t len)
 {
-    msg->property = purc_variant_make_string(value, true);
+    msg->property = purc_variant_make_string_ex(value, len, true);
     if (msg->property)
         return true;
     return false;
 }
 
-static bool on_request_id(pcrdr_msg *msg, char *value)
+static bool on_request_id(pcrdr_msg *msg, char *value, size_t len)
 {
-    msg->requestId = purc_variant_make_string(value, true);
+    msg->requestId = purc_variant_make_string_ex(value, len, true);
     if (msg->requestId)
         return true;
     return false;
 }
 
-static bool on_result(pcrdr_msg *msg, char *value)
+static bool on_result(pcrdr_msg *msg, char *value, size_t len)
 {
-    char *subtoken;
-    char *saveptr;
-
-    subtoken = strtok_r(value, STR_VALUE_SEPARATOR, &saveptr);
-    if (subtoken == NULL)
+    char *result_value = memchr(value, STR_VALUE_SEPARATOR[0], len);
+    if (result_value == NULL || result_value == value ||
+            result_value + 1 == value + len)
         return false;
 
     errno = 0;
-    msg->retCode = (unsigned int)strtoul(subtoken, NULL, 10);
+    msg->retCode = (unsigned int)strtoul(value, NULL, 10);
     if (errno)
         return false;
 
-    subtoken = strtok_r(NULL, STR_VALUE_SEPARATOR, &saveptr);
-    if (subtoken == NULL)
-        return false;
-
     errno = 0;
-    msg->resultValue = (uint64_t)strtoull(subtoken, NULL, 16);
+    msg->resultValue = (uint64_t)strtoull(result_value + 1, NULL, 16);
     if (errno)
         return false;
 
@@ -618,20 +613,21 @@ pcrdr_data_type_name(pcrdr_msg_data_type data_type)
     return data_type_names[data_type];
 }
 
-static bool on_data_type(pcrdr_msg *msg, char *value)
+static bool on_data_type(pcrdr_msg *msg, char *value, size_t len)
 {
-    for (size_t i = 0; i < PCA_TABLESIZE(data_type_names); i++) {
-        if (pcutils_strcasecmp(value, data_type_names[i]) == 0) {
-            msg->dataType = PCRDR_MSG_DATA_TYPE_FIRST + i;
-            return true;
-        }
-    }
+    int i = find_name(data_type_names, PCA_TABLESIZE(data_type_names),
+            value, len);
+    if (i < 0)
+        return false;
 
-    return false;
+    msg->dataType = PCRDR_MSG_DATA_TYPE_FIRST + i;
+    return true;
 }
 
-static bool on_data_len(pcrdr_msg *msg, char *value)
+static bool on_data_len(pcrdr_msg *msg, char *value, size_t len)
 {
+    UNUSED_PARAM(len);
+
     errno = 0;
     msg->__data_len = strtoul(value, NULL, 10);
     if (errno)
@@ -640,7 +636,7 @@ static bool on_data_len(pcrdr_msg *msg, char *value)
     return true;
 }
 
-typedef bool (*key_op)(pcrdr_msg *msg, char *value);
+typedef bool (*key_op)(pcrdr_msg *msg, char *value, size_t len);
 
 #define STR_KEY_TYPE        "type"
 #define STR_KEY_TARGET      "target"
@@ -654,113 +650,119 @@ typedef bool (*key_op)(pcrdr_msg *msg, char *value);
 #define STR_KEY_DATA_TYPE   "dataType"
 #define STR_KEY_DATA_LEN    "dataLen"
 
-static struct key_op_pair {
+#define MIN_KEY_LEN         (sizeof(STR_KEY_TYPE) - 1)
+#define MAX_KEY_LEN         (sizeof(STR_KEY_OPERATION) - 1)
+
+/*
+ * A perfect hash of the (case-insensitive) header keys: the length of
+ * the key, its first and its last characters are enough to distinguish
+ * all keys. Keep the slots of key_ops[] in sync with KEY_HASH() when
+ * adding a new key.
+ */
+#define KEY_HASH(key, len)                                      \
+    ((((len) << 1) + (purc_tolower((key)[0]) << 2) +            \
+      purc_tolower((key)[(len) - 1])) & 0x1F)
+
+#define KEY_OP(key, op)     { key, sizeof(key) - 1, op }
+
+static const struct key_op_pair {
     const char *key;
+    size_t      len;
     key_op      op;
-} key_ops[] = {
-    { STR_KEY_DATA_LEN,     on_data_len },
-    { STR_KEY_DATA_TYPE,    on_data_type },
-    { STR_KEY_ELEMENT,      on_element },
-    { STR_KEY_EVENTNAME,    on_event_name },
-    { STR_KEY_OPERATION,    on_operation },
-    { STR_KEY_PROPERTY,     on_property },
-    { STR_KEY_REQUEST_ID,   on_request_id },
-    { STR_KEY_RESULT,       on_result },
-    { STR_KEY_SOURCEURI,    on_source_uri },
-    { STR_KEY_TARGET,       on_target },
-    { STR_KEY_TYPE,         on_type },
+} key_ops[32] = {
+    [12] = KEY_OP(STR_KEY_DATA_LEN,     on_data_len),
+    [ 5] = KEY_OP(STR_KEY_DATA_TYPE,    on_data_type),
+    [22] = KEY_OP(STR_KEY_ELEMENT,      on_element),
+    [11] = KEY_OP(STR_KEY_EVENTNAME,    on_event_name),
+    [28] = KEY_OP(STR_KEY_OPERATION,    on_operation),
+    [ 9] = KEY_OP(STR_KEY_PROPERTY,     on_property),
+    [30] = KEY_OP(STR_KEY_REQUEST_ID,   on_request_id),
+    [ 8] = KEY_OP(STR_KEY_RESULT,       on_result),
+    [ 7] = KEY_OP(STR_KEY_SOURCEURI,    on_source_uri),
+    [16] = KEY_OP(STR_KEY_TARGET,       on_target),
+    [29] = KEY_OP(STR_KEY_TYPE,         on_type),
 };
 
-static key_op find_key_op(const char* key)
+#undef KEY_OP
+
+static key_op find_key_op(const char* key, size_t len)
 {
-    static ssize_t max = sizeof(key_ops)/sizeof(key_ops[0]) - 1;
+    if (len < MIN_KEY_LEN || len > MAX_KEY_LEN)
+        return NULL;
 
-    ssize_t low = 0, high = max, mid;
-    while (low <= high) {
-        int cmp;
-
-        mid = (low + high) / 2;
-        cmp = pcutils_strcasecmp(key, key_ops[mid].key);
-        if (cmp == 0) {
-            goto found;
-        }
-        else {
-            if (cmp < 0) {
-                high = mid - 1;
-            }
-            else {
-                low = mid + 1;
-            }
-        }
-    }
+    const struct key_op_pair *pair = key_ops + KEY_HASH(key, len);
+    if (pair->len == len && pcutils_strncasecmp(key, pair->key, len) == 0)
+        return pair->op;
 
     return NULL;
-
-found:
-    return key_ops[mid].op;
 }
 
+/*
+ * Note that the packet is changed in place: every header line is
+ * terminated by a null character, and the header values are passed to
+ * the key operators as length-delimited slices of the packet.
+ */
 int pcrdr_parse_packet(char *packet, size_t sz_packet, pcrdr_msg **msg_out)
 {
     pcrdr_msg *msg;
 
-    char *str1;
-    char *line;
-    char *saveptr1;
-    char *data;
-
-    UNUSED_PARAM(sz_packet);
+    char *end = packet + sz_packet;
+    char *line = packet;
+    char *data = NULL;
 
     if ((msg = pcinst_get_message()) == NULL) {
         purc_set_error(PCRDR_ERROR_NOMEM);
         return -1;
     }
 
-    for (str1 = packet; ; str1 = NULL) {
-        line = strtok_r(str1, STR_LINE_SEPARATOR, &saveptr1);
-        if (line == NULL) {
+    while (line < end) {
+        char *eol = memchr(line, STR_LINE_SEPARATOR[0], end - line);
+        if (eol == NULL) {
             goto failed;
         }
 
-        if ((data = is_blank_line(line))) {
+        if (is_blank_line(line, eol - line)) {
+            data = eol + 1;
             break;
         }
 
-        char *key, *value;
-        char *saveptr2;
-        key = strtok_r(line, STR_PAIR_SEPARATOR, &saveptr2);
-        if (key == NULL) {
-            goto failed;
-        }
+        *eol = '\0';
 
-#if 0
-        value = strtok_r(NULL, STR_PAIR_SEPARATOR, &saveptr2);
-        if (value == NULL) {
-            goto failed;
-        }
-#else
         /* XXX: to support pattern: `eventName:create:tabbedwindow` */
-        value = line + strlen(key) + 1;
-        if (value[0] == '\0') {
+        char *value = memchr(line, STR_PAIR_SEPARATOR[0], eol - line);
+        if (value == NULL || value == line || value + 1 == eol) {
             goto failed;
         }
-#endif
 
-        key_op op = find_key_op(key);
+        key_op op = find_key_op(line, value - line);
         if (op == NULL) {
             goto failed;
         }
 
-        if (!op(msg, skip_left_spaces(value))) {
+        value++;
+        while (*value == ' ' || *value == '\t') {
+            value++;
+        }
+
+        if (!op(msg, value, eol - value)) {
             goto failed;
         }
+
+        line = eol + 1;
+    }
+
+    if (data == NULL) {
+        goto failed;
     }
 
     if (msg->dataType == PCRDR_MSG_DATA_TYPE_VOID) {
         // do nothing
     }
+    else if (msg->__data_len > (size_t)(end - data)) {
+        goto failed;
+    }
     else if (msg->dataType == PCRDR_MSG_DATA_TYPE_JSON) {
-        assert(data != NULL && msg->__data_len > 0);
+        assert(msg->__data_len > 0);
         msg->data = purc_variant_make_from_json_string(data, msg->__data_len);
 
         if (msg->data == NULL) {
@@ -768,8 +770,6 @@ int pcrdr_parse_packet(char *packet, size_t sz_packet, pcrdr_msg **msg_out)
         }
     }
     else {  /* for other text types */
-        // FIXME: check __data_len ???
-        assert(data != NULL /* && msg->__data_len > 0 */);
         msg->data = purc_variant_make_string_ex(data, msg->__data_len, true);
 
         if (msg->data == NULL) {
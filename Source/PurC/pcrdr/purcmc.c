@@ -86,14 +86,18 @@ static int my_wait_message (pcrdr_conn* conn, int timeout_ms)
     return select (conn->fd + 1, &rfds, NULL, NULL, NULL);
 }
 
+static int read_packet_to_buffer (pcrdr_conn* conn,
+        char **buf, size_t *sz_buf, size_t *sz_packet);
+
 static pcrdr_msg *my_read_message (pcrdr_conn* conn)
 {
-    void* packet;
     size_t data_len;
     pcrdr_msg* msg = NULL;
     int err_code = 0, retval;
 
-    retval = pcrdr_purcmc_read_packet_alloc (conn, &packet, &data_len);
+    /* reuse the receive buffer of the connection for every packet */
+    retval = read_packet_to_buffer (conn,
+            &conn->rx_buf, &conn->sz_rx_buf, &data_len);
     if (retval) {
         PC_DEBUG ("Failed to read packet\n");
         goto done;
@@ -104,8 +108,7 @@ static pcrdr_msg *my_read_message (pcrdr_conn* conn)
         goto done;
     }
 
-    retval = pcrdr_parse_packet (packet, data_len, &msg);
-    free (packet);
+    retval = pcrdr_parse_packet (conn->rx_buf, data_len, &msg);
 
     if (retval < 0) {
         err_code = PCRDR_ERROR_BAD_MESSAGE;
@@ -450,9 +453,14 @@ done:
     return err_code;
 }
 
-int pcrdr_purcmc_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_packet)
+/*
+ * Reads a packet into the buffer pointed to by @buf, which has @sz_buf bytes
+ * and will be reallocated if it is not large enough for the packet.
+ */
+static int read_packet_to_buffer (pcrdr_conn* conn,
+        char **buf, size_t *sz_buf, size_t *sz_packet)
 {
-    char* packet_buf = NULL;
+    char* packet_buf = *buf;
     int err_code = 0;
 
     if (conn->type == CT_UNIX_SOCKET) {
@@ -466,7 +474,6 @@ int pcrdr_purcmc_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
 
         if (header.op == US_OPCODE_PONG) {
             // TODO
-            *packet = NULL;
             *sz_packet = 0;
             return 0;
         }
@@ -478,7 +485,6 @@ int pcrdr_purcmc_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
                 goto done;
             }
 
-            *packet = NULL;
             *sz_packet = 0;
             return 0;
         }
@@ -516,9 +522,16 @@ int pcrdr_purcmc_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
                 left = 0;
             }
 
-            if ((packet_buf = malloc (total_len + 1)) == NULL) {
-                err_code = PCRDR_ERROR_NOMEM;
-                goto done;
+            if (*sz_buf < total_len + 1) {
+                size_t new_sz = ((total_len + PCRDR_DEF_PACKET_BUFF_SIZE) /
+                        PCRDR_DEF_PACKET_BUFF_SIZE) * PCRDR_DEF_PACKET_BUFF_SIZE;
+                if ((packet_buf = realloc (*buf, new_sz)) == NULL) {
+                    err_code = PCRDR_ERROR_NOMEM;
+                    goto done;
+                }
+
+                *buf = packet_buf;
+                *sz_buf = new_sz;
             }
 
             if (conn_read (conn->fd, packet_buf, header.sz_payload)) {
@@ -583,11 +596,23 @@ int pcrdr_purcmc_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_
 
 done:
     if (err_code) {
+        purc_set_error (err_code);
+        return -1;
+    }
+
+    return 0;
+}
+
+int pcrdr_purcmc_read_packet_alloc (pcrdr_conn* conn, void **packet, size_t *sz_packet)
+{
+    char *packet_buf = NULL;
+    size_t sz_buf = 0;
+
+    if (read_packet_to_buffer (conn, &packet_buf, &sz_buf, sz_packet)) {
         if (packet_buf)
             free (packet_buf);
 
         *packet = NULL;
-        purc_set_error (err_code);
         return -1;
     }
 
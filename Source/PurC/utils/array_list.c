@@ -25,12 +25,19 @@
 
 #define _GNU_SOURCE
 
+#include "config.h"
+
 #include "private/array_list.h"
 
 #include "private/debug.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#if USE(PTHREADS)
+#include <pthread.h>
+#endif
 
 static inline size_t
 align(size_t n)
@@ -261,3 +268,227 @@ pcutils_array_list_sort(struct pcutils_array_list *al,
     }
 }
 
+
+/* runs shorter than this are sorted by insertion */
+#define SORT_RUN_SIZE               16
+/* lists longer than this are split into runs sorted by several threads */
+#define SORT_PARALLEL_THRESHOLD     (64 * 1024)
+#define SORT_MAX_THREADS            4
+
+struct keyed_sort {
+    const char         *keys;
+    size_t              key_size;
+    void               *ud;
+    int (*cmp)(const void *l, const void *r, void *ud);
+};
+
+static inline int
+keyed_cmp(const struct keyed_sort *ks, size_t l, size_t r)
+{
+    return ks->cmp(ks->keys + l * ks->key_size,
+            ks->keys + r * ks->key_size, ks->ud);
+}
+
+static void
+merge_runs(const struct keyed_sort *ks, const size_t *l, size_t nl,
+        const size_t *r, size_t nr, size_t *out)
+{
+    size_t i = 0, j = 0, k = 0;
+
+    // take from the left run on ties to keep the sort stable
+    while (i < nl && j < nr) {
+        if (keyed_cmp(ks, r[j], l[i]) < 0)
+            out[k++] = r[j++];
+        else
+            out[k++] = l[i++];
+    }
+
+    if (i < nl)
+        memcpy(out + k, l + i, (nl - i) * sizeof(*out));
+    if (j < nr)
+        memcpy(out + k, r + j, (nr - j) * sizeof(*out));
+}
+
+/* stable bottom-up merge sort of idx[0, n); tmp is scratch of n slots */
+static void
+merge_sort(const struct keyed_sort *ks, size_t *idx, size_t *tmp, size_t n)
+{
+    for (size_t lo = 0; lo < n; lo += SORT_RUN_SIZE) {
+        size_t hi = lo + SORT_RUN_SIZE < n ? lo + SORT_RUN_SIZE : n;
+        for (size_t i = lo + 1; i < hi; i++) {
+            size_t v = idx[i];
+            size_t j = i;
+            while (j > lo && keyed_cmp(ks, v, idx[j - 1]) < 0) {
+                idx[j] = idx[j - 1];
+                j--;
+            }
+            idx[j] = v;
+        }
+    }
+
+    size_t *src = idx, *dst = tmp;
+    for (size_t width = SORT_RUN_SIZE; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += width * 2) {
+            size_t mid = lo + width < n ? lo + width : n;
+            size_t hi = lo + width * 2 < n ? lo + width * 2 : n;
+            merge_runs(ks, src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+        }
+
+        size_t *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != idx)
+        memcpy(idx, src, n * sizeof(*idx));
+}
+
+#if USE(PTHREADS)
+struct sort_run {
+    const struct keyed_sort    *ks;
+    size_t                     *idx;
+    size_t                     *tmp;
+    size_t                      n;
+};
+
+static void *
+sort_run_entry(void *arg)
+{
+    struct sort_run *run = (struct sort_run *)arg;
+    merge_sort(run->ks, run->idx, run->tmp, run->n);
+    return NULL;
+}
+
+static void
+parallel_merge_sort(const struct keyed_sort *ks, size_t *idx, size_t *tmp,
+        size_t n, size_t nr_threads)
+{
+    struct sort_run runs[SORT_MAX_THREADS];
+    pthread_t threads[SORT_MAX_THREADS];
+    bool started[SORT_MAX_THREADS];
+
+    for (size_t i = 0; i < nr_threads; i++) {
+        size_t lo = n * i / nr_threads;
+        size_t hi = n * (i + 1) / nr_threads;
+        runs[i].ks  = ks;
+        runs[i].idx = idx + lo;
+        runs[i].tmp = tmp + lo;
+        runs[i].n   = hi - lo;
+
+        // the first run is sorted by the calling thread
+        started[i] = i > 0 &&
+            pthread_create(threads + i, NULL, sort_run_entry, runs + i) == 0;
+    }
+
+    for (size_t i = 0; i < nr_threads; i++) {
+        if (started[i])
+            pthread_join(threads[i], NULL);
+        else
+            sort_run_entry(runs + i);
+    }
+
+    // merge the sorted runs pairwise
+    size_t *src = idx, *dst = tmp;
+    size_t nr_runs = nr_threads;
+    while (nr_runs > 1) {
+        size_t k = 0;
+        for (size_t i = 0; i < nr_runs; i += 2) {
+            size_t off = runs[i].idx - src;
+            if (i + 1 < nr_runs) {
+                merge_runs(ks, runs[i].idx, runs[i].n,
+                        runs[i + 1].idx, runs[i + 1].n, dst + off);
+                runs[k].n = runs[i].n + runs[i + 1].n;
+            }
+            else {
+                memcpy(dst + off, runs[i].idx, runs[i].n * sizeof(*dst));
+                runs[k].n = runs[i].n;
+            }
+            runs[k].idx = dst + off;
+            k++;
+        }
+        nr_runs = k;
+
+        size_t *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    if (src != idx)
+        memcpy(idx, src, n * sizeof(*idx));
+}
+#endif /* USE(PTHREADS) */
+
+int
+pcutils_sort_index_by_keys(const void *keys, size_t nr, size_t key_size,
+        void *ud, int (*cmp)(const void *l, const void *r, void *ud),
+        size_t *idx)
+{
+    for (size_t i = 0; i < nr; i++)
+        idx[i] = i;
+
+    if (nr < 2)
+        return 0;
+
+    size_t *tmp = (size_t *)malloc(nr * sizeof(*tmp));
+    if (tmp == NULL)
+        return -1;
+
+    struct keyed_sort ks = {
+        .keys       = (const char *)keys,
+        .key_size   = key_size,
+        .ud         = ud,
+        .cmp        = cmp,
+    };
+
+    size_t nr_threads = 1;
+#if USE(PTHREADS)
+    if (nr >= SORT_PARALLEL_THRESHOLD) {
+        long nr_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (nr_cpus > 1)
+            nr_threads = nr_cpus < SORT_MAX_THREADS ?
+                (size_t)nr_cpus : SORT_MAX_THREADS;
+    }
+
+    if (nr_threads > 1)
+        parallel_merge_sort(&ks, idx, tmp, nr, nr_threads);
+    else
+#endif
+        merge_sort(&ks, idx, tmp, nr);
+
+    free(tmp);
+    return 0;
+}
+
+int
+pcutils_array_list_sort_by_keys(struct pcutils_array_list *al,
+        const void *keys, size_t key_size, void *ud,
+        int (*cmp)(const void *l, const void *r, void *ud))
+{
+    size_t nr = al->nr;
+    if (nr < 2)
+        return 0;
+
+    size_t *idx = (size_t *)malloc(nr * sizeof(*idx));
+    struct pcutils_array_list_node **nodes;
+    nodes = (struct pcutils_array_list_node **)malloc(nr * sizeof(*nodes));
+    if (idx == NULL || nodes == NULL ||
+            pcutils_sort_index_by_keys(keys, nr, key_size, ud, cmp, idx)) {
+        free(idx);
+        free(nodes);
+        return -1;
+    }
+
+    // apply the permutation
+    for (size_t i = 0; i < nr; i++)
+        nodes[i] = al->nodes[idx[i]];
+
+    for (size_t i = 0; i < nr; i++) {
+        al->nodes[i] = nodes[i];
+        al->nodes[i]->idx = i;
+    }
+
+    free(nodes);
+    free(idx);
+
+    return 0;
+}
@@ -27,26 +27,145 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "purc-ports.h"
 #include "purc-utils.h"
 #include "purc-errors.h"
 #include "private/instance.h"
-#include "private/map.h"
 #include "private/utils.h"
+#include "private/tls.h"
+
+/* this feature needs C11 (stdatomic.h) or above */
+#if HAVE(STDATOMIC_H)           /* { */
+#include <stdatomic.h>
+#else                           /* }{ */
+#error "Not implemented for this platform."
+#endif                          /* } */
 
 #if PURC_ATOM_BUCKET_BITS > 16
 #error "Too many bits reserved for bucket"
 #endif
 
+/*
+ * Every bucket maps strings to atoms with a set of hash tables (shards)
+ * selected by the high bits of the hash of the string, and maps atoms to
+ * strings with an array indexed by the sequence number of the atom.
+ *
+ * Readers never lock: the tables and the arrays are only replaced as a
+ * whole (after being filled), so a reader always sees a consistent, if
+ * possibly out-of-date, snapshot. Writers lock the shard they change; the
+ * sequence numbers and the array of a bucket have their own lock.
+ *
+ * The memory a writer unlinks (the entries of removed atoms, the replaced
+ * tables and arrays) is retired and freed after a grace period, using
+ * epoch-based reclamation: a reader announces the global epoch while it
+ * reads, and a retired block is freed once no reader announces an epoch
+ * as old as the one in which the block was retired.
+ */
+
+#define ATOM_SHARD_BITS         3
+#define ATOM_SHARDS_NR          (1 << ATOM_SHARD_BITS)
+
+#define ATOM_TABLE_MIN_SIZE     16
+#define ATOM_BLOCK_SIZE         (1024 >> PURC_ATOM_BUCKET_BITS)
+
+/* the size of the per-thread lookup cache; must be a power of 2 */
+#define ATOM_CACHE_SIZE         256
+
+/* the number of retirements between two attempts to free retired memory */
+#define ATOM_GC_BATCH           64
+
+/* the header of a retired block; the first member of the block */
+struct atom_garbage {
+    struct atom_garbage *next;
+    /* the epoch when the block was retired */
+    uint64_t            epoch;
+};
+
+struct atom_entry {
+    struct atom_garbage gc;
+
+    uint64_t            hash;
+    purc_atom_t         atom;
+    /* set once the atom is removed; the entry may still be cached */
+    atomic_bool         dead;
+    const char         *string;
+
+    /* the copy of the string, if it is not a static one */
+    char                buf[];
+};
+
+/* the slot of a removed entry */
+#define ATOM_TOMBSTONE  ((struct atom_entry *)(uintptr_t)1)
+
+struct atom_table {
+    struct atom_garbage gc;
+
+    size_t              mask;
+    /* the number of slots which are not null (entries and tombstones) */
+    size_t              nr_used;
+    _Atomic(struct atom_entry *) slots[];
+};
+
+struct atom_shard {
+    purc_mutex          lock;
+    size_t              nr_entries;
+    _Atomic(struct atom_table *) table;
+};
+
+struct atom_quarks {
+    struct atom_garbage gc;
+
+    size_t              capacity;
+    _Atomic(const char *) strings[];
+};
+
 static struct atom_bucket {
     purc_atom_t     bucket_bits;
     purc_atom_t     atom_seq_id;
 
-    pcutils_map    *atom_map;
-    char**          quarks;
+    purc_mutex      quarks_lock;
+    _Atomic(struct atom_quarks *) quarks;
+
+    struct atom_shard shards[ATOM_SHARDS_NR];
 } atom_buckets[PURC_ATOM_BUCKETS_NR];
 
+/* the record of a thread reading the tables and the arrays */
+struct atom_reader {
+    /* the epoch announced while reading; zero when not reading */
+    _Atomic(uint64_t)   epoch;
+    atomic_bool         in_use;
+    struct atom_reader *next;
+
+    /* keep the records of different threads in different cache lines */
+    char                padding[64];
+};
+
+/* the global epoch; starts from 1 */
+static _Atomic(uint64_t) atom_epoch;
+
+/* all reader records; a record is reused once released by its thread */
+static _Atomic(struct atom_reader *) atom_readers;
+
+/* releases the reader record of a thread when the thread exits */
+static pthread_key_t        atom_reader_key;
+static bool                 atom_reader_key_created;
+
+static purc_mutex           atom_gc_lock;
+static struct atom_garbage *atom_garbage_list;
+/* the number of blocks retired since the last attempt to free them */
+static size_t               atom_nr_retired;
+
+struct atom_cache {
+    struct atom_reader *reader;
+    /* the epoch in which the entries were cached; zero for none */
+    uint64_t            epoch;
+    struct atom_entry  *entries[ATOM_CACHE_SIZE];
+};
+
+PURC_DEFINE_THREAD_LOCAL(struct atom_cache, atom_cache);
+
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
 
 #define BUCKET_BITS(bucket)       \
@@ -61,170 +180,453 @@ static struct atom_bucket {
 #define IS_VALID_SEQ_ID(seq)    \
     (seq < ((purc_atom_t)1 << (ATOM_BITS_NR - PURC_ATOM_BUCKET_BITS)))
 
-#define ATOM_BLOCK_SIZE         (1024 >> PURC_ATOM_BUCKET_BITS)
-#define ATOM_STRING_BLOCK_SIZE  (4096 - sizeof (size_t))
+#define HASH_TO_SHARD(hash)     ((int)((hash) >> (64 - ATOM_SHARD_BITS)))
 
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free);
+/* 64-bit FNV-1a */
+#define ATOM_HASH_INIT      0xcbf29ce484222325ULL
+#define ATOM_HASH_PRIME     0x100000001b3ULL
 
-static purc_rwlock atom_rwlock;
-static char *atom_block = NULL;
-static int  atom_block_offset = 0;
+/* also returns the length of the null-terminated string in `len` */
+static inline uint64_t
+atom_hash(const char *string, size_t *len)
+{
+    const char *p = string;
+    uint64_t hash = ATOM_HASH_INIT;
 
-static void atom_init_bucket(struct atom_bucket *bucket)
+    while (*p) {
+        hash ^= (unsigned char)*p++;
+        hash *= ATOM_HASH_PRIME;
+    }
+
+    *len = p - string;
+    return hash;
+}
+
+static inline uint64_t
+atom_hash_len(const char *string, size_t len)
 {
-    assert (bucket->atom_seq_id == 0);
+    uint64_t hash = ATOM_HASH_INIT;
 
-    bucket->atom_map = pcutils_map_create(NULL, NULL, NULL, NULL,
-            comp_key_string, false);
-    bucket->quarks = (char **)malloc(sizeof(char *) * ATOM_BLOCK_SIZE);
-    bucket->quarks[0] = NULL;
-    bucket->atom_seq_id = 1;
+    while (len--) {
+        hash ^= (unsigned char)*string++;
+        hash *= ATOM_HASH_PRIME;
+    }
 
-    assert(bucket->quarks != NULL);
+    return hash;
+}
+
+/* `string` is not necessarily null-terminated */
+static inline bool
+atom_string_equal(const char *atom_string, const char *string, size_t len)
+{
+    return strncmp(atom_string, string, len) == 0 && atom_string[len] == 0;
 }
 
 static inline struct atom_bucket *atom_get_bucket(int bucket)
 {
     assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
+    return atom_buckets + bucket;
+}
+
+static struct atom_entry *
+table_find(struct atom_table *table, uint64_t hash, const char *string,
+        size_t len)
+{
+    size_t i = hash & table->mask;
 
-    struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (UNLIKELY(atom_bucket->atom_seq_id == 0)) {
-        atom_init_bucket(atom_bucket);
-        atom_bucket->bucket_bits = BUCKET_BITS(bucket);
+    for (;;) {
+        struct atom_entry *entry = atomic_load_explicit(&table->slots[i],
+                memory_order_acquire);
+        if (entry == NULL)
+            return NULL;
+
+        if (entry != ATOM_TOMBSTONE && entry->hash == hash &&
+                atom_string_equal(entry->string, string, len))
+            return entry;
+
+        i = (i + 1) & table->mask;
+    }
+}
+
+/* HOLDS: atom_gc_lock; frees the retired blocks no reader can see */
+static void
+atom_reclaim(void)
+{
+    /* the readers announcing the new epoch cannot see the retired blocks */
+    uint64_t epoch = atomic_fetch_add_explicit(&atom_epoch, 1,
+            memory_order_acq_rel) + 1;
+    atomic_thread_fence(memory_order_seq_cst);
+
+    uint64_t oldest = epoch;
+    struct atom_reader *reader = atomic_load_explicit(&atom_readers,
+            memory_order_acquire);
+    for (; reader; reader = reader->next) {
+        uint64_t announced = atomic_load_explicit(&reader->epoch,
+                memory_order_acquire);
+        if (announced && announced < oldest)
+            oldest = announced;
     }
 
-    return atom_bucket;
+    struct atom_garbage **pp = &atom_garbage_list;
+    while (*pp) {
+        struct atom_garbage *garbage = *pp;
+        if (garbage->epoch < oldest) {
+            *pp = garbage->next;
+            free(garbage);
+        }
+        else {
+            pp = &garbage->next;
+        }
+    }
+
+    atom_nr_retired = 0;
 }
 
-static inline void atom_put_bucket(int bucket)
+/* retires a block unlinked by a writer; it is freed after a grace period */
+static void
+atom_retire(struct atom_garbage *garbage)
 {
-    assert(bucket >= 0 && bucket < PURC_ATOM_BUCKETS_NR);
+    purc_mutex_lock(&atom_gc_lock);
+
+    garbage->epoch = atomic_load_explicit(&atom_epoch, memory_order_relaxed);
+    garbage->next = atom_garbage_list;
+    atom_garbage_list = garbage;
+    if (++atom_nr_retired >= ATOM_GC_BATCH)
+        atom_reclaim();
 
-    struct atom_bucket *atom_bucket = atom_buckets + bucket;
-    if (LIKELY(atom_bucket->atom_map)) {
-        pcutils_map_destroy(atom_bucket->atom_map);
-        free(atom_bucket->quarks);
-        memset(atom_bucket, 0, sizeof(*atom_bucket));
+    purc_mutex_unlock(&atom_gc_lock);
+}
+
+static void
+atom_reader_release(void *data)
+{
+    struct atom_reader *reader = data;
+    atomic_store_explicit(&reader->in_use, false, memory_order_release);
+}
+
+static bool
+atom_reader_acquire(struct atom_cache *cache)
+{
+    struct atom_reader *reader = atomic_load_explicit(&atom_readers,
+            memory_order_acquire);
+
+    for (; reader; reader = reader->next) {
+        bool in_use = false;
+        if (atomic_compare_exchange_strong_explicit(&reader->in_use,
+                    &in_use, true, memory_order_acquire,
+                    memory_order_relaxed))
+            break;
     }
+
+    if (reader == NULL) {
+        reader = calloc(1, sizeof(*reader));
+        if (reader == NULL)
+            return false;
+
+        atomic_init(&reader->in_use, true);
+        struct atom_reader *head = atomic_load_explicit(&atom_readers,
+                memory_order_relaxed);
+        do {
+            reader->next = head;
+        } while (!atomic_compare_exchange_weak_explicit(&atom_readers,
+                    &head, reader, memory_order_release,
+                    memory_order_relaxed));
+    }
+
+    pthread_setspecific(atom_reader_key, reader);
+    cache->reader = reader;
+    /* the entries may have been cached with another record */
+    cache->epoch = 0;
+    return true;
 }
 
-purc_atom_t
-purc_atom_try_string_ex(int bucket, const char *string)
+/*
+ * Announces the current epoch for the calling thread, and flushes its
+ * cache if the epoch has advanced since the cache was filled. Returns NULL
+ * if the thread has no reader record; the caller then has to lock.
+ */
+static struct atom_cache *
+atom_read_begin(void)
 {
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
-    const pcutils_map_entry* entry = NULL;
-    purc_atom_t atom = 0;
+    struct atom_cache *cache = PURC_GET_THREAD_LOCAL(atom_cache);
+    if (UNLIKELY(cache == NULL))
+        return NULL;
 
-    if (string == NULL || atom_bucket == NULL)
-        return 0;
+    if (UNLIKELY(cache->reader == NULL) && !atom_reader_acquire(cache))
+        return NULL;
 
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if ((entry = pcutils_map_find(atom_bucket->atom_map, string))) {
-        atom = (purc_atom_t)(uintptr_t)entry->val;
+    uint64_t epoch = atomic_load_explicit(&atom_epoch, memory_order_acquire);
+    for (;;) {
+        atomic_store_explicit(&cache->reader->epoch, epoch,
+                memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+
+        /* a reclaimer which missed the announcement has bumped the epoch */
+        uint64_t now = atomic_load_explicit(&atom_epoch,
+                memory_order_acquire);
+        if (now == epoch)
+            break;
+        epoch = now;
     }
-    purc_rwlock_reader_unlock(&atom_rwlock);
 
-    return atom;
+    if (UNLIKELY(cache->epoch != epoch)) {
+        memset(cache->entries, 0, sizeof(cache->entries));
+        cache->epoch = epoch;
+    }
+
+    return cache;
 }
 
-bool
-purc_atom_remove_string_ex(int bucket, const char *string)
+static inline void
+atom_read_end(struct atom_cache *cache)
 {
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    atomic_store_explicit(&cache->reader->epoch, 0, memory_order_release);
+}
 
-    if (string == NULL || atom_bucket == NULL)
-        return false;
+/* lock-free if called between atom_read_begin() and atom_read_end() */
+static struct atom_entry *
+atom_find(struct atom_bucket *bucket, uint64_t hash, const char *string,
+        size_t len)
+{
+    struct atom_shard *shard = bucket->shards + HASH_TO_SHARD(hash);
+    struct atom_table *table = atomic_load_explicit(&shard->table,
+            memory_order_acquire);
 
-    const pcutils_map_entry* entry;
-    bool ret;
-    purc_atom_t atom;
+    return table ? table_find(table, hash, string, len) : NULL;
+}
 
-    purc_rwlock_writer_lock(&atom_rwlock);
-    if ((entry = pcutils_map_find(atom_bucket->atom_map, string))) {
-        atom = (purc_atom_t)(uintptr_t)entry->val;
-        pcutils_map_erase(atom_bucket->atom_map, (void *)string);
-        atom = ATOM_TO_SEQUENCE(atom);
-        atom_bucket->quarks[atom] = NULL;
-        ret = true;
+static struct atom_entry *
+atom_find_cached(struct atom_cache *cache, struct atom_bucket *bucket,
+        uint64_t hash, const char *string, size_t len)
+{
+    size_t i = (hash + (bucket - atom_buckets)) & (ATOM_CACHE_SIZE - 1);
+    struct atom_entry *entry = cache->entries[i];
+    if (entry && entry->hash == hash &&
+            BUCKET_BITS(ATOM_TO_BUCKET(entry->atom)) == bucket->bucket_bits &&
+            !atomic_load_explicit(&entry->dead, memory_order_acquire) &&
+            atom_string_equal(entry->string, string, len))
+        return entry;
+
+    entry = atom_find(bucket, hash, string, len);
+    if (entry)
+        cache->entries[i] = entry;
+
+    return entry;
+}
+
+static purc_atom_t
+atom_lookup(struct atom_bucket *bucket, uint64_t hash, const char *string,
+        size_t len)
+{
+    struct atom_entry *entry;
+    purc_atom_t atom = 0;
+
+    struct atom_cache *cache = atom_read_begin();
+    if (LIKELY(cache)) {
+        entry = atom_find_cached(cache, bucket, hash, string, len);
+        if (entry)
+            atom = entry->atom;
+        atom_read_end(cache);
     }
     else {
-        ret = false;
+        struct atom_shard *shard = bucket->shards + HASH_TO_SHARD(hash);
+        purc_mutex_lock(&shard->lock);
+        entry = atom_find(bucket, hash, string, len);
+        if (entry)
+            atom = entry->atom;
+        purc_mutex_unlock(&shard->lock);
     }
-    purc_rwlock_writer_unlock(&atom_rwlock);
 
-    return ret;
+    return atom;
 }
 
-/* HOLDS: atom_rwlock_lock */
-static char *
-atom_strdup(const char *string, bool *need_free)
+purc_atom_t
+purc_atom_try_string_ex(int bucket, const char *string)
 {
-    char *copy;
+    if (string == NULL)
+        return 0;
+
     size_t len;
+    uint64_t hash = atom_hash(string, &len);
+    return atom_lookup(atom_get_bucket(bucket), hash, string, len);
+}
+
+purc_atom_t
+purc_atom_try_string_len(int bucket, const char *string, size_t len)
+{
+    if (string == NULL)
+        return 0;
+
+    return atom_lookup(atom_get_bucket(bucket), atom_hash_len(string, len),
+            string, len);
+}
+
+/* HOLDS: the lock of the shard; makes room for one more entry */
+static bool
+table_reserve(struct atom_shard *shard)
+{
+    struct atom_table *table = atomic_load_explicit(&shard->table,
+            memory_order_relaxed);
 
-    len = strlen(string) + 1;
+    if (table && (table->nr_used + 1) * 4 <= (table->mask + 1) * 3)
+        return true;
 
-    /* For strings longer than half the block size, fall back
-       to strdup so that we fill our blocks at least 50%. */
-    if (len > ATOM_STRING_BLOCK_SIZE / 2 ||
-            atom_block_offset + len > ATOM_STRING_BLOCK_SIZE) {
-        *need_free = true;
-        return strdup(string);
+    /* rebuild the table without tombstones, doubling it if necessary */
+    size_t size = table ? table->mask + 1 : ATOM_TABLE_MIN_SIZE;
+    while ((shard->nr_entries + 1) * 2 > size)
+        size <<= 1;
+
+    struct atom_table *new_table = calloc(1, sizeof(*new_table) +
+            sizeof(new_table->slots[0]) * size);
+    if (new_table == NULL)
+        return false;
+
+    new_table->mask = size - 1;
+    for (size_t i = 0; table && i <= table->mask; i++) {
+        struct atom_entry *entry = atomic_load_explicit(&table->slots[i],
+                memory_order_relaxed);
+        if (entry == NULL || entry == ATOM_TOMBSTONE)
+            continue;
+
+        size_t j = entry->hash & new_table->mask;
+        while (atomic_load_explicit(&new_table->slots[j],
+                    memory_order_relaxed))
+            j = (j + 1) & new_table->mask;
+        atomic_store_explicit(&new_table->slots[j], entry,
+                memory_order_relaxed);
+        new_table->nr_used++;
     }
 
-    *need_free = false;
-    if (atom_block == NULL) {
-        atom_block = malloc(ATOM_STRING_BLOCK_SIZE);
+    /* publish the filled table; the old one may still be read */
+    atomic_store_explicit(&shard->table, new_table, memory_order_release);
+    if (table)
+        atom_retire(&table->gc);
+    return true;
+}
+
+/* HOLDS: the lock of the shard */
+static void
+table_insert(struct atom_shard *shard, struct atom_entry *entry)
+{
+    struct atom_table *table = atomic_load_explicit(&shard->table,
+            memory_order_relaxed);
+
+    size_t i = entry->hash & table->mask;
+    while (atomic_load_explicit(&table->slots[i], memory_order_relaxed))
+        i = (i + 1) & table->mask;
+
+    atomic_store_explicit(&table->slots[i], entry, memory_order_release);
+    table->nr_used++;
+    shard->nr_entries++;
+}
+
+/* allocates the sequence number for the entry and publishes its string */
+static bool
+quarks_put(struct atom_bucket *bucket, struct atom_entry *entry)
+{
+    bool ok = false;
+
+    purc_mutex_lock(&bucket->quarks_lock);
+
+    struct atom_quarks *quarks = atomic_load_explicit(&bucket->quarks,
+            memory_order_relaxed);
+    purc_atom_t seq = bucket->atom_seq_id;
+    if (!IS_VALID_SEQ_ID(seq))
+        goto done;
+
+    if (quarks == NULL || seq >= quarks->capacity) {
+        /*
+         * Like the implementation in glib, the old array is not freed here,
+         * so that purc_atom_to_string() can read it without a lock.
+         * Unlike glib, it is retired and freed after a grace period.
+         */
+        size_t capacity = quarks ? quarks->capacity * 2 : ATOM_BLOCK_SIZE;
+        struct atom_quarks *new_quarks = calloc(1, sizeof(*new_quarks) +
+                sizeof(new_quarks->strings[0]) * capacity);
+        if (new_quarks == NULL)
+            goto done;
+
+        new_quarks->capacity = capacity;
+        for (size_t i = 0; quarks && i < quarks->capacity; i++) {
+            atomic_store_explicit(&new_quarks->strings[i],
+                    atomic_load_explicit(&quarks->strings[i],
+                        memory_order_relaxed),
+                    memory_order_relaxed);
+        }
+
+        atomic_store_explicit(&bucket->quarks, new_quarks,
+                memory_order_release);
+        if (quarks)
+            atom_retire(&quarks->gc);
+        quarks = new_quarks;
     }
 
-    copy = atom_block + atom_block_offset;
-    memcpy(copy, string, len);
-    atom_block_offset += len;
+    atomic_store_explicit(&quarks->strings[seq], entry->string,
+            memory_order_release);
+    entry->atom = seq | bucket->bucket_bits;
+    bucket->atom_seq_id++;
+    ok = true;
 
-    return copy;
+done:
+    purc_mutex_unlock(&bucket->quarks_lock);
+    return ok;
 }
 
-/* HOLDS: purc_atom_rwlock_writer_lock */
-static inline purc_atom_t
+static purc_atom_t
 atom_from_string(struct atom_bucket *bucket, const char *string,
         bool duplicate, bool *newly_created)
 {
-    purc_atom_t atom = 0;
-    pcutils_map_entry* entry;
-
-    entry = pcutils_map_find(bucket->atom_map, string);
-    if (entry) {
-        atom = (purc_atom_t)(uintptr_t)entry->val;
-        assert(atom);
+    size_t len;
+    uint64_t hash = atom_hash(string, &len);
+    struct atom_entry *entry;
 
+    /* most calls find an existing atom */
+    purc_atom_t atom = atom_lookup(bucket, hash, string, len);
+    if (atom) {
         if (newly_created)
             *newly_created = false;
+        return atom;
     }
-    else {
-        bool need_free;
-        if (duplicate)
-            string = atom_strdup(string, &need_free);
-        else
-            need_free = false;
-        atom = atom_new(bucket, (char *)string, need_free);
 
+    struct atom_shard *shard = bucket->shards + HASH_TO_SHARD(hash);
+
+    purc_mutex_lock(&shard->lock);
+
+    struct atom_table *table = atomic_load_explicit(&shard->table,
+            memory_order_relaxed);
+    if (table && (entry = table_find(table, hash, string, len))) {
+        atom = entry->atom;
         if (newly_created)
-            *newly_created = true;
+            *newly_created = false;
+        goto done;
     }
 
-    return atom;
-}
+    entry = malloc(sizeof(*entry) + (duplicate ? len + 1 : 0));
+    if (entry == NULL)
+        goto done;
 
-static inline purc_atom_t
-atom_from_string_locked(struct atom_bucket *bucket, const char *string,
-        bool duplicate, bool *newly_created)
-{
-    purc_atom_t atom = 0;
-    purc_rwlock_writer_lock(&atom_rwlock);
-    atom = atom_from_string(bucket, string, duplicate, newly_created);
-    purc_rwlock_writer_unlock(&atom_rwlock);
+    entry->hash = hash;
+    atomic_init(&entry->dead, false);
+    if (duplicate) {
+        memcpy(entry->buf, string, len + 1);
+        entry->string = entry->buf;
+    }
+    else {
+        entry->string = string;
+    }
+
+    if (!table_reserve(shard) || !quarks_put(bucket, entry)) {
+        free(entry);
+        goto done;
+    }
+    table_insert(shard, entry);
+
+    atom = entry->atom;
+    if (newly_created)
+        *newly_created = true;
 
+done:
+    purc_mutex_unlock(&shard->lock);
     return atom;
 }
 
@@ -234,7 +636,7 @@ purc_atom_from_string_ex2(int bucket, const char *string, bool *newly_created)
     if (!string)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
+    return atom_from_string(atom_get_bucket(bucket), string,
             true, newly_created);
 }
 
@@ -245,132 +647,225 @@ purc_atom_from_static_string_ex2(int bucket, const char *string,
     if (!string)
         return 0;
 
-    return atom_from_string_locked(atom_get_bucket(bucket), string,
+    return atom_from_string(atom_get_bucket(bucket), string,
             false, newly_created);
 }
 
+bool
+purc_atom_remove_string_ex(int bucket, const char *string)
+{
+    if (string == NULL)
+        return false;
+
+    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    size_t len;
+    uint64_t hash = atom_hash(string, &len);
+    struct atom_shard *shard = atom_bucket->shards + HASH_TO_SHARD(hash);
+    bool ret = false;
+
+    purc_mutex_lock(&shard->lock);
+
+    struct atom_table *table = atomic_load_explicit(&shard->table,
+            memory_order_relaxed);
+    size_t i = table ? hash & table->mask : 0;
+    for (; table; i = (i + 1) & table->mask) {
+        struct atom_entry *entry = atomic_load_explicit(&table->slots[i],
+                memory_order_relaxed);
+        if (entry == NULL)
+            break;
+
+        if (entry == ATOM_TOMBSTONE || entry->hash != hash ||
+                !atom_string_equal(entry->string, string, len))
+            continue;
+
+        atomic_store_explicit(&table->slots[i], ATOM_TOMBSTONE,
+                memory_order_release);
+        shard->nr_entries--;
+
+        purc_mutex_lock(&atom_bucket->quarks_lock);
+        struct atom_quarks *quarks = atomic_load_explicit(
+                &atom_bucket->quarks, memory_order_relaxed);
+        atomic_store_explicit(&quarks->strings[ATOM_TO_SEQUENCE(entry->atom)],
+                NULL, memory_order_release);
+        purc_mutex_unlock(&atom_bucket->quarks_lock);
+
+        /* readers may still hold the entry */
+        atomic_store_explicit(&entry->dead, true, memory_order_release);
+        atom_retire(&entry->gc);
+        ret = true;
+        break;
+    }
+
+    purc_mutex_unlock(&shard->lock);
+    return ret;
+}
+
 const char *
 purc_atom_to_string(purc_atom_t atom)
 {
-    int bucket;
-    char* result = NULL;
-
     if (atom == 0)
         return NULL;
 
-    bucket = ATOM_TO_BUCKET(atom);
-    struct atom_bucket *atom_bucket = atom_get_bucket(bucket);
+    struct atom_bucket *atom_bucket = atom_get_bucket(ATOM_TO_BUCKET(atom));
+    const char *string = NULL;
+
+    struct atom_cache *cache = atom_read_begin();
+    if (UNLIKELY(cache == NULL))
+        purc_mutex_lock(&atom_bucket->quarks_lock);
+
+    struct atom_quarks *quarks = atomic_load_explicit(&atom_bucket->quarks,
+            memory_order_acquire);
+
     atom = ATOM_TO_SEQUENCE(atom);
-    purc_rwlock_reader_lock(&atom_rwlock);
-    if (atom < atom_bucket->atom_seq_id)
-        result = atom_bucket->quarks[atom];
-    purc_rwlock_reader_unlock(&atom_rwlock);
+    if (quarks && atom < quarks->capacity)
+        string = atomic_load_explicit(&quarks->strings[atom],
+                memory_order_acquire);
 
-    return result;
-}
+    if (LIKELY(cache))
+        atom_read_end(cache);
+    else
+        purc_mutex_unlock(&atom_bucket->quarks_lock);
 
-static void free_dup_key(void *key, void *data)
-{
-    UNUSED_PARAM(data);
-    if (key)
-        free(key);
+    return string;
 }
 
-/* HOLDS: purc_atom_rwlock_writer_lock */
-static inline purc_atom_t
-atom_new(struct atom_bucket *bucket, char *string, bool need_free)
+static void
+atom_cleanup_bucket(struct atom_bucket *bucket)
 {
-    purc_atom_t atom;
-    char **atoms_new;
-
-    if (bucket->atom_seq_id % ATOM_BLOCK_SIZE == 0) {
-        atoms_new = (char **)malloc(sizeof (char *) *
-                (bucket->atom_seq_id + ATOM_BLOCK_SIZE));
-        if (bucket->atom_seq_id != 0)
-            memcpy(atoms_new, bucket->quarks,
-                    sizeof (char *) * bucket->atom_seq_id);
-        memset(atoms_new + bucket->atom_seq_id, 0,
-                sizeof (char *) * ATOM_BLOCK_SIZE);
-
-        /*
-         * The implementation in glib did not free the old quarks array.
-         * The author said: `This leaks the old quarks array. Its unfortunate,
-         * but it allows us to do lockless lookup of the arrays, and there
-         * shouldn't be that many quarks in an app`.
-         *
-         * In our implementation, we do free the old quarks.
-         * Indeed, we can use realloc() instead of malloc() and memcpy()
-         */
-        free(bucket->quarks);
-        bucket->quarks = atoms_new;
+    for (int i = 0; i < ATOM_SHARDS_NR; i++) {
+        struct atom_shard *shard = bucket->shards + i;
+        struct atom_table *table = atomic_load_explicit(&shard->table,
+                memory_order_relaxed);
+
+        for (size_t j = 0; table && j <= table->mask; j++) {
+            struct atom_entry *entry = atomic_load_explicit(&table->slots[j],
+                    memory_order_relaxed);
+            if (entry && entry != ATOM_TOMBSTONE)
+                free(entry);
+        }
+
+        free(table);
+
+        if (shard->lock.native_impl)
+            purc_mutex_clear(&shard->lock);
     }
 
-    atom = bucket->atom_seq_id;
-    bucket->quarks[atom] = string;
-    atom |= bucket->bucket_bits;
-    pcutils_map_insert_ex(bucket->atom_map,
-                string, (void *)(uintptr_t)atom,
-                need_free ? free_dup_key : NULL);
-    bucket->atom_seq_id++;
+    free(atomic_load_explicit(&bucket->quarks, memory_order_relaxed));
 
-    assert(IS_VALID_SEQ_ID(bucket->atom_seq_id));
+    if (bucket->quarks_lock.native_impl)
+        purc_mutex_clear(&bucket->quarks_lock);
 
-    return atom;
+    memset(bucket, 0, sizeof(*bucket));
 }
 
 static void
 atom_cleanup_once(void)
 {
-    int bucket;
+    for (int bucket = 0; bucket < PURC_ATOM_BUCKETS_NR; bucket++) {
+        atom_cleanup_bucket(atom_buckets + bucket);
+    }
+
+    while (atom_garbage_list) {
+        struct atom_garbage *next = atom_garbage_list->next;
+        free(atom_garbage_list);
+        atom_garbage_list = next;
+    }
+    atom_nr_retired = 0;
+
+    struct atom_reader *reader = atomic_load_explicit(&atom_readers,
+            memory_order_relaxed);
+    while (reader) {
+        struct atom_reader *next = reader->next;
+        free(reader);
+        reader = next;
+    }
+    atomic_store_explicit(&atom_readers, NULL, memory_order_relaxed);
+
+    if (atom_gc_lock.native_impl)
+        purc_mutex_clear(&atom_gc_lock);
+
+    if (atom_reader_key_created) {
+        pthread_key_delete(atom_reader_key);
+        atom_reader_key_created = false;
+    }
+}
+
+static bool
+atom_init_bucket(struct atom_bucket *bucket, int id)
+{
+    bucket->bucket_bits = BUCKET_BITS(id);
+    /* the sequence number 0 is reserved for the invalid atom */
+    bucket->atom_seq_id = 1;
+
+    purc_mutex_init(&bucket->quarks_lock);
+    if (bucket->quarks_lock.native_impl == NULL)
+        return false;
 
-    for (bucket = 0; bucket < PURC_ATOM_BUCKETS_NR; bucket++) {
-        atom_put_bucket(bucket);
+    for (int i = 0; i < ATOM_SHARDS_NR; i++) {
+        purc_mutex_init(&bucket->shards[i].lock);
+        if (bucket->shards[i].lock.native_impl == NULL)
+            return false;
     }
 
-    if (atom_rwlock.native_impl)
-        purc_rwlock_clear(&atom_rwlock);
-    if (atom_block)
-        free(atom_block);
+    return true;
 }
 
 static int
 atom_init_once(void)
 {
-    int r = 0;
+    atomic_store_explicit(&atom_epoch, 1, memory_order_relaxed);
+    purc_mutex_init(&atom_gc_lock);
+    if (atom_gc_lock.native_impl == NULL)
+        goto failed;
+
+    if (pthread_key_create(&atom_reader_key, atom_reader_release))
+        goto failed;
+    atom_reader_key_created = true;
+
+    for (int bucket = 0; bucket < PURC_ATOM_BUCKETS_NR; bucket++) {
+        if (!atom_init_bucket(atom_buckets + bucket, bucket))
+            goto failed;
+    }
 
-    purc_rwlock_init(&atom_rwlock);
-    if (atom_rwlock.native_impl == NULL)
-        goto fail_lock;
+    if (atexit(atom_cleanup_once))
+        goto failed;
 
-    /* init the default bucket only */
-    if (!atom_get_bucket(0))
-        goto fail_atom;
+    return 0;
 
-    r = atexit(atom_cleanup_once);
-    if (r)
-        goto fail_atexit;
+failed:
+    atom_cleanup_once();
+    return -1;
+}
 
+static int
+atom_init_instance(struct pcinst *curr_inst,
+        const purc_instance_extra_info* extra_info)
+{
+    UNUSED_PARAM(curr_inst);
+    UNUSED_PARAM(extra_info);
     return 0;
+}
 
-fail_atexit:
-    atom_put_bucket(0);
-    if (atom_block) {
-        free(atom_block);
-        atom_block = NULL;
+static void
+atom_cleanup_instance(struct pcinst *curr_inst)
+{
+    UNUSED_PARAM(curr_inst);
+
+    /* let other threads reuse the reader record of this thread */
+    struct atom_cache *cache = PURC_GET_THREAD_LOCAL(atom_cache);
+    if (cache && cache->reader) {
+        pthread_setspecific(atom_reader_key, NULL);
+        atom_reader_release(cache->reader);
+        cache->reader = NULL;
     }
-
-fail_atom:
-    purc_rwlock_clear(&atom_rwlock);
-
-fail_lock:
-    return -1;
 }
 
 struct pcmodule _module_atom = {
     .id              = PURC_HAVE_UTILS,
     .module_inited   = 0,
 
-    .init_once       = atom_init_once,
-    .init_instance   = NULL,
+    .init_once          = atom_init_once,
+    .init_instance      = atom_init_instance,
+    .cleanup_instance   = atom_cleanup_instance,
 };
 
@@ -0,0 +1,99 @@
+/*
+ * @file dtoa.cpp
+ * @date 2026/10/16
+ * @brief The shortest round-trip formatting of double values.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include "private/utils.h"
+
+#include <wtf/dtoa/double-conversion.h>
+
+#include <string.h>
+
+using PurCWTF::double_conversion::DoubleToStringConverter;
+
+/* the precision of `%.17g` which decides the notation */
+#define G_PRECISION     17
+
+size_t pcutils_dtoa_shortest(double d, char *buf)
+{
+    char digits[DoubleToStringConverter::kBase10MaximalLength + 1];
+    bool sign;
+    int len, point;
+
+    /* Grisu3, falling back to bignums for the rare inputs it rejects */
+    DoubleToStringConverter::DoubleToAscii(d,
+            DoubleToStringConverter::SHORTEST, 0,
+            digits, sizeof(digits), &sign, &len, &point);
+
+    char *p = buf;
+    if (sign)
+        *p++ = '-';
+
+    /* the value is 0.digits * 10^point, thus the exponent of the
+       scientific notation is point - 1 */
+    int exp10 = point - 1;
+    if (exp10 < -4 || exp10 >= G_PRECISION) {
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, len - 1);
+            p += len - 1;
+        }
+
+        *p++ = 'e';
+        if (exp10 < 0) {
+            *p++ = '-';
+            exp10 = -exp10;
+        }
+        else
+            *p++ = '+';
+
+        if (exp10 >= 100)
+            *p++ = '0' + exp10 / 100;
+        *p++ = '0' + (exp10 / 10) % 10;
+        *p++ = '0' + exp10 % 10;
+    }
+    else if (point <= 0) {
+        *p++ = '0';
+        *p++ = '.';
+        memset(p, '0', -point);
+        p += -point;
+        memcpy(p, digits, len);
+        p += len;
+    }
+    else if (len <= point) {
+        memcpy(p, digits, len);
+        p += len;
+        memset(p, '0', point - len);
+        p += point - len;
+    }
+    else {
+        memcpy(p, digits, point);
+        p += point;
+        *p++ = '.';
+        memcpy(p, digits + point, len - point);
+        p += len - point;
+    }
+
+    *p = '\0';
+    return p - buf;
+}
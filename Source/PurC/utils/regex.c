@@ -32,6 +32,8 @@
 #include "purc-errors.h"
 #include "private/errors.h"
 #include "private/regex.h"
+#include "private/list.h"
+#include "private/tls.h"
 
 #if HAVE(GLIB)
 #include <glib.h>
@@ -41,8 +43,29 @@
 
 struct pcregex {
     GRegex *g_regex;
+    unsigned refc;
 };
 
+/* number of compiled patterns kept by every thread */
+#define REGEX_CACHE_SIZE        32
+
+struct regex_cache_entry {
+    struct list_head            node;
+    uint64_t                    hash;
+    enum pcregex_compile_flags  compile_options;
+    enum pcregex_match_flags    match_options;
+    char                       *pattern;
+    struct pcregex             *regex;
+};
+
+struct regex_cache {
+    /* the most recently used entry first */
+    struct list_head            lru;
+    size_t                      nr_entries;
+};
+
+PURC_DEFINE_THREAD_LOCAL(struct regex_cache, regex_cache);
+
 struct pcregex_match_info {
     GMatchInfo *g_match_info;
 };
@@ -233,6 +256,134 @@ void set_error_code_from_gerror(GError *err)
     g_error_free(err);
 }
 
+static struct pcregex *
+regex_compile(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options, GError **err)
+{
+    struct pcregex *regex = (struct pcregex *) malloc(sizeof(struct pcregex));
+    if (!regex) {
+        return NULL;
+    }
+
+    regex->g_regex = g_regex_new(pattern,
+            to_g_regex_compile_flags(compile_options),
+            to_g_regex_match_flags(match_options),
+            err);
+    if (!regex->g_regex) {
+        free(regex);
+        return NULL;
+    }
+
+    regex->refc = 1;
+    return regex;
+}
+
+static inline uint64_t
+regex_hash(const char *pattern, enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options)
+{
+    /* 64-bit FNV-1a */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    while (*pattern) {
+        hash ^= (unsigned char)*pattern++;
+        hash *= 0x100000001b3ULL;
+    }
+
+    hash ^= (uint64_t)compile_options;
+    hash *= 0x100000001b3ULL;
+    hash ^= (uint64_t)match_options << 32;
+    return hash;
+}
+
+/*
+ * Returns the compiled form of the pattern owned by the cache of the
+ * calling thread, compiling it on a miss. The least recently used entry
+ * is evicted once the cache is full. Patterns are compiled with
+ * G_REGEX_OPTIMIZE, which JIT-compiles them when GLib is built on PCRE2.
+ */
+static struct pcregex *
+regex_cache_get(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options, GError **err)
+{
+    struct regex_cache *cache = PURC_GET_THREAD_LOCAL(regex_cache);
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    if (cache->lru.next == NULL) {
+        list_head_init(&cache->lru);
+    }
+
+    uint64_t hash = regex_hash(pattern, compile_options, match_options);
+    struct regex_cache_entry *entry;
+    list_for_each_entry(entry, &cache->lru, node) {
+        if (entry->hash == hash &&
+                entry->compile_options == compile_options &&
+                entry->match_options == match_options &&
+                strcmp(entry->pattern, pattern) == 0) {
+            if (!list_is_first(&entry->node, &cache->lru))
+                list_move(&entry->node, &cache->lru);
+            return entry->regex;
+        }
+    }
+
+    struct pcregex *regex = regex_compile(pattern,
+            compile_options | PCREGEX_OPTIMIZE, match_options, err);
+    if (regex == NULL) {
+        return NULL;
+    }
+
+    char *dup = strdup(pattern);
+    if (dup == NULL) {
+        pcregex_destroy(regex);
+        return NULL;
+    }
+
+    if (cache->nr_entries < REGEX_CACHE_SIZE) {
+        entry = (struct regex_cache_entry *)malloc(sizeof(*entry));
+        if (entry == NULL) {
+            free(dup);
+            pcregex_destroy(regex);
+            return NULL;
+        }
+        cache->nr_entries++;
+    }
+    else {
+        entry = list_last_entry(&cache->lru, struct regex_cache_entry, node);
+        list_del(&entry->node);
+        pcregex_destroy(entry->regex);
+        free(entry->pattern);
+    }
+
+    entry->hash = hash;
+    entry->compile_options = compile_options;
+    entry->match_options = match_options;
+    entry->pattern = dup;
+    entry->regex = regex;
+    list_add(&entry->node, &cache->lru);
+    return regex;
+}
+
+void pcregex_cache_cleanup(void)
+{
+    struct regex_cache *cache = PURC_GET_THREAD_LOCAL(regex_cache);
+    if (cache == NULL || cache->lru.next == NULL) {
+        return;
+    }
+
+    struct regex_cache_entry *entry, *tmp;
+    list_for_each_entry_safe(entry, tmp, &cache->lru, node) {
+        list_del(&entry->node);
+        pcregex_destroy(entry->regex);
+        free(entry->pattern);
+        free(entry);
+    }
+    cache->nr_entries = 0;
+}
+
 bool pcregex_is_match_ex(const char *pattern, const char *str,
         enum pcregex_compile_flags compile_options,
         enum pcregex_match_flags match_options)
@@ -240,9 +391,19 @@ bool pcregex_is_match_ex(const char *pattern, const char *str,
     if (!pattern || !str) {
         return false;
     }
-    return g_regex_match_simple(pattern, str,
-            to_g_regex_compile_flags(compile_options),
-            to_g_regex_match_flags(match_options));
+
+    /* like g_regex_match_simple(), a bad pattern simply does not match */
+    GError *err = NULL;
+    struct pcregex *regex = regex_cache_get(pattern, compile_options,
+            match_options, &err);
+    if (regex == NULL) {
+        if (err)
+            g_error_free(err);
+        return false;
+    }
+
+    return g_regex_match(regex->g_regex, str,
+            to_g_regex_match_flags(match_options), NULL);
 }
 
 bool pcregex_is_match(const char *pattern, const char *str)
@@ -254,23 +415,19 @@ struct pcregex *pcregex_new_ex(const char *pattern,
         enum pcregex_compile_flags compile_options,
         enum pcregex_match_flags match_options)
 {
-    struct pcregex *regex = (struct pcregex *) malloc(sizeof(struct pcregex));
-    if (!regex) {
-        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return NULL;
-    }
-
     GError *err = NULL;
-    regex->g_regex = g_regex_new(pattern,
-            to_g_regex_compile_flags(compile_options),
-            to_g_regex_match_flags(match_options),
-            &err);
-    if (regex->g_regex) {
+    struct pcregex *regex = regex_compile(pattern, compile_options,
+            match_options, &err);
+    if (regex) {
         return regex;
     }
 
-    free(regex);
-    set_error_code_from_gerror(err);
+    if (err) {
+        set_error_code_from_gerror(err);
+    }
+    else {
+        purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    }
     return NULL;
 }
 
@@ -279,9 +436,42 @@ struct pcregex *pcregex_new(const char *pattern)
     return pcregex_new_ex(pattern, 0, 0);
 }
 
+struct pcregex *pcregex_lookup(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options)
+{
+    if (!pattern) {
+        purc_set_error(PURC_ERROR_INVALID_VALUE);
+        return NULL;
+    }
+
+    GError *err = NULL;
+    struct pcregex *regex = regex_cache_get(pattern, compile_options,
+            match_options, &err);
+    if (regex == NULL) {
+        if (err) {
+            set_error_code_from_gerror(err);
+        }
+        else {
+            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        }
+        return NULL;
+    }
+
+    return pcregex_ref(regex);
+}
+
+struct pcregex *pcregex_ref(struct pcregex *regex)
+{
+    if (regex) {
+        regex->refc++;
+    }
+    return regex;
+}
+
 void pcregex_destroy(struct pcregex *regex)
 {
-    if (!regex) {
+    if (!regex || --regex->refc > 0) {
         return;
     }
     g_regex_unref(regex->g_regex);
@@ -419,12 +609,28 @@ struct pcregex *pcregex_new(const char *pattern)
     return pcregex_new_ex(pattern, 0, 0);
 }
 
+struct pcregex *pcregex_lookup(const char *pattern,
+        enum pcregex_compile_flags compile_options,
+        enum pcregex_match_flags match_options)
+{
+    return pcregex_new_ex(pattern, compile_options, match_options);
+}
+
+struct pcregex *pcregex_ref(struct pcregex *regex)
+{
+    return regex;
+}
+
 void pcregex_destroy(struct pcregex *regex)
 {
     UNUSED_PARAM(regex);
     purc_set_error(PURC_ERROR_NOT_IMPLEMENTED);
 }
 
+void pcregex_cache_cleanup(void)
+{
+}
+
 bool pcregex_match_ex(struct pcregex *regex, const char *str,
             enum pcregex_match_flags match_options,
             struct pcregex_match_info **match_info)
@@ -437,6 +643,12 @@ bool pcregex_match_ex(struct pcregex *regex, const char *str,
     return false;
 }
 
+bool pcregex_match(struct pcregex *regex, const char *str,
+            struct pcregex_match_info **match_info)
+{
+    return pcregex_match_ex(regex, str, 0, match_info);
+}
+
 bool pcregex_match_info_matches(const struct pcregex_match_info *match_info)
 {
     UNUSED_PARAM(match_info);
@@ -28,6 +28,7 @@
 #include "purc-utils.h"
 #include "private/errors.h"
 #include "private/instance.h"
+#include "private/rwstream.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -36,6 +37,7 @@
 
 #if OS(UNIX)
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #endif // 0S(UNIX)
@@ -85,11 +87,25 @@ typedef struct rwstream_funcs
     int     (*destroy) (purc_rwstream_t rws);
     void*   (*get_mem_buffer) (purc_rwstream_t rws, size_t *sz_content,
             size_t *sz_buffer, bool res_buff);
+    /* returns the readable bytes which are already in memory, without
+       copying them; used by the UTF-8 decoder. */
+    const uint8_t* (*peek) (purc_rwstream_t rws, size_t *sz_avail);
+    void    (*consume) (purc_rwstream_t rws, size_t count);
 } rwstream_funcs;
 
 struct purc_rwstream
 {
     rwstream_funcs* funcs;
+
+    /* The read-ahead window for the streams which can not be peeked
+     * directly (see `peek` above). It is only filled by
+     * purc_rwstream_read_utf8_char(), and drained by purc_rwstream_read()
+     * before reading from the underlying stream again. */
+    bool read_ahead;
+    bool ra_seekable;
+    uint8_t* ra_buf;
+    size_t ra_pos;
+    size_t ra_len;
 };
 
 struct stdio_rwstream
@@ -104,6 +120,11 @@ struct mem_rwstream
     uint8_t* base;
     uint8_t* here;
     uint8_t* stop;
+
+    /* only set for the streams made by pcrwstream_new_from_mem_ro() */
+    bool read_only;
+    pcrws_cb_release release;
+    void* release_ctxt;
 };
 
 struct buffer_rwstream
@@ -141,6 +162,8 @@ static rwstream_funcs stdio_funcs = {
     stdio_write,
     stdio_flush,
     stdio_destroy,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -152,6 +175,8 @@ static ssize_t mem_flush (purc_rwstream_t rws);
 static int mem_destroy (purc_rwstream_t rws);
 static void* mem_get_mem_buffer (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff);
+static const uint8_t* mem_peek (purc_rwstream_t rws, size_t *sz_avail);
+static void mem_consume (purc_rwstream_t rws, size_t count);
 
 static rwstream_funcs mem_funcs = {
     mem_seek,
@@ -160,7 +185,9 @@ static rwstream_funcs mem_funcs = {
     mem_write,
     mem_flush,
     mem_destroy,
-    mem_get_mem_buffer
+    mem_get_mem_buffer,
+    mem_peek,
+    mem_consume
 };
 
 static off_t buffer_seek (purc_rwstream_t rws, off_t offset, int whence);
@@ -171,6 +198,8 @@ static ssize_t buffer_flush (purc_rwstream_t rws);
 static int buffer_destroy (purc_rwstream_t rws);
 static void* buffer_get_mem_buffer (purc_rwstream_t rws,
         size_t *sz_content, size_t *sz_buffer, bool res_buff);
+static const uint8_t* buffer_peek (purc_rwstream_t rws, size_t *sz_avail);
+static void buffer_consume (purc_rwstream_t rws, size_t count);
 
 static rwstream_funcs buffer_funcs = {
     buffer_seek,
@@ -179,7 +208,9 @@ static rwstream_funcs buffer_funcs = {
     buffer_write,
     buffer_flush,
     buffer_destroy,
-    buffer_get_mem_buffer
+    buffer_get_mem_buffer,
+    buffer_peek,
+    buffer_consume
 };
 
 
@@ -199,6 +230,8 @@ static rwstream_funcs fd_funcs = {
     NULL,           // flush
     fd_destroy,
     NULL,
+    NULL,
+    NULL,
 };
 #endif // OS(LINUX) || OS(UNIX) || OS(MAC_OS_X)
 
@@ -255,6 +288,27 @@ purc_rwstream_t purc_rwstream_new_from_mem (void* mem, size_t sz)
     return (purc_rwstream_t)rws;
 }
 
+purc_rwstream_t pcrwstream_new_from_mem_ro(const void *mem, size_t sz,
+        pcrws_cb_release release, void *ctxt)
+{
+    struct mem_rwstream* rws = (struct mem_rwstream*) calloc(
+            1, sizeof(struct mem_rwstream));
+    if (rws == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    rws->rwstream.funcs = &mem_funcs;
+    rws->base = (uint8_t*)mem;
+    rws->here = rws->base;
+    rws->stop = rws->base + sz;
+    rws->read_only = true;
+    rws->release = release;
+    rws->release_ctxt = ctxt;
+
+    return (purc_rwstream_t)rws;
+}
+
 purc_rwstream_t purc_rwstream_new_from_file (const char* file, const char* mode)
 {
     FILE* fp = fopen(file, mode);
@@ -273,6 +327,16 @@ purc_rwstream_t purc_rwstream_new_from_fp (FILE* fp)
 
     rws->rwstream.funcs = &stdio_funcs;
     rws->fp = fp;
+
+#if OS(UNIX)
+    /* Reading ahead a regular file never blocks, while fread() on a pipe
+       or a terminal waits for the whole block. */
+    struct stat st;
+    if (fstat(fileno(fp), &st) == 0 && S_ISREG(st.st_mode)) {
+        rws->rwstream.read_ahead = true;
+        rws->rwstream.ra_seekable = true;
+    }
+#endif
     return (purc_rwstream_t)rws;
 }
 
@@ -287,6 +351,14 @@ purc_rwstream_t purc_rwstream_new_from_unix_fd (int fd)
     }
 
     fd_rws->rwstream.funcs = &fd_funcs;
+    /* Only read ahead a file which can be rewound: the bytes read ahead
+       from a pipe or a socket would be lost for the other readers of
+       the descriptor once the stream is destroyed. */
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (S_ISREG(st.st_mode) || S_ISBLK(st.st_mode))) {
+        fd_rws->rwstream.read_ahead = true;
+        fd_rws->rwstream.ra_seekable = true;
+    }
     fd_rws->fd = fd;
     return (purc_rwstream_t)fd_rws;
 #else
@@ -336,6 +408,8 @@ static rwstream_funcs wo_funcs = {
     wo_write,
     NULL,
     NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -389,6 +463,8 @@ static rwstream_funcs ro_funcs = {
     NULL,
     NULL,
     NULL,
+    NULL,
+    NULL,
     NULL
 };
 
@@ -410,6 +486,52 @@ purc_rwstream_new_for_read (void *ctxt, pcrws_cb_read fn)
     return (purc_rwstream_t)rws;
 }
 
+/* the number of the bytes read ahead but not consumed yet */
+static inline size_t read_ahead_pending(purc_rwstream_t rws)
+{
+    return rws->ra_len - rws->ra_pos;
+}
+
+/* Gives the bytes read ahead back to the underlying stream if it is
+   seekable, so that the position of the stream is as expected by others.
+   Returns false if the bytes are still pending. */
+static bool read_ahead_rewind(purc_rwstream_t rws)
+{
+    size_t pending = read_ahead_pending(rws);
+    if (pending == 0)
+        return true;
+
+    if (!rws->ra_seekable ||
+            rws->funcs->seek(rws, -(off_t)pending, SEEK_CUR) == -1)
+        return false;
+
+    rws->ra_pos = rws->ra_len = 0;
+    return true;
+}
+
+static const uint8_t* read_ahead_peek(purc_rwstream_t rws, size_t *sz_avail)
+{
+    if (rws->ra_pos == rws->ra_len) {
+        if (rws->ra_buf == NULL) {
+            rws->ra_buf = (uint8_t*) malloc(BUFFER_SIZE);
+            if (rws->ra_buf == NULL) {
+                pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+                return NULL;
+            }
+        }
+
+        ssize_t ret = rws->funcs->read(rws, rws->ra_buf, BUFFER_SIZE);
+        if (ret < 0)
+            return NULL;
+
+        rws->ra_pos = 0;
+        rws->ra_len = ret;
+    }
+
+    *sz_avail = rws->ra_len - rws->ra_pos;
+    return rws->ra_buf + rws->ra_pos;
+}
+
 int purc_rwstream_destroy (purc_rwstream_t rws)
 {
     if (rws == NULL) {
@@ -417,6 +539,12 @@ int purc_rwstream_destroy (purc_rwstream_t rws)
         return -1;
     }
 
+    if (rws->ra_buf) {
+        read_ahead_rewind(rws);
+        free(rws->ra_buf);
+        rws->ra_buf = NULL;
+    }
+
     if (rws->funcs->destroy)
         return rws->funcs->destroy(rws);
 
@@ -431,8 +559,14 @@ off_t purc_rwstream_seek (purc_rwstream_t rws, off_t offset, int whence)
         return -1;
     }
 
-    if (rws->funcs->seek)
-        return rws->funcs->seek(rws, offset, whence);
+    if (rws->funcs->seek) {
+        if (whence == SEEK_CUR)
+            offset -= (off_t)read_ahead_pending(rws);
+        off_t pos = rws->funcs->seek(rws, offset, whence);
+        if (pos != -1)
+            rws->ra_pos = rws->ra_len = 0;
+        return pos;
+    }
 
     pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
     return -1;
@@ -445,8 +579,12 @@ off_t purc_rwstream_tell (purc_rwstream_t rws)
         return -1;
     }
 
-    if (rws->funcs->tell)
-        return rws->funcs->tell(rws);
+    if (rws->funcs->tell) {
+        off_t pos = rws->funcs->tell(rws);
+        if (pos != -1)
+            pos -= (off_t)read_ahead_pending(rws);
+        return pos;
+    }
 
     pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
     return -1;
@@ -459,8 +597,28 @@ ssize_t purc_rwstream_read (purc_rwstream_t rws, void* buf, size_t count)
         return -1;
     }
 
-    if (rws->funcs->read)
-        return rws->funcs->read(rws, buf, count);
+    /* the bytes read ahead come first */
+    size_t pending = read_ahead_pending(rws);
+    if (pending) {
+        if (pending > count)
+            pending = count;
+        memcpy(buf, rws->ra_buf + rws->ra_pos, pending);
+        rws->ra_pos += pending;
+        if (pending == count)
+            return count;
+    }
+
+    if (rws->funcs->read) {
+        /* only a regular file is read ahead, so this does not block */
+        ssize_t ret = rws->funcs->read(rws, (uint8_t*)buf + pending,
+                count - pending);
+        if (ret < 0)
+            return pending ? (ssize_t)pending : ret;
+        return pending + ret;
+    }
+
+    if (pending)
+        return pending;
 
     pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
     return -1;
@@ -484,6 +642,124 @@ static uint32_t utf8_to_uint32_t (const unsigned char* utf8_char,
     return wc;
 }
 
+static int utf8_char_len (uint8_t c)
+{
+    if (c > 0xFD) {
+        pcinst_set_error(PCRWSTREAM_ERROR_IO);
+        return -1;
+    }
+
+    int n = 1;
+    while (c & (0x80 >> n))
+        n++;
+
+    if (n < 2) {
+        pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+        return -1;
+    }
+    return n;
+}
+
+static int utf8_char_to_wc (const char* buf_utf8, int ch_len,
+        uint32_t* buf_wc)
+{
+    // FIXME
+    if (ch_len > 3) {
+        pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+        return -1;
+    }
+
+    size_t nr_chars;
+    if (buf_utf8[0] == 0) {
+        *buf_wc = 0;
+    }
+    else if(pcutils_string_check_utf8_len(buf_utf8, ch_len, &nr_chars, NULL)) {
+        *buf_wc = utf8_to_uint32_t((const unsigned char*)buf_utf8, ch_len);
+    }
+    else {
+        ch_len = -1;
+        pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+    }
+    return ch_len;
+}
+
+static inline const uint8_t* window_peek (purc_rwstream_t rws,
+        size_t *sz_avail)
+{
+    if (rws->funcs->peek)
+        return rws->funcs->peek(rws, sz_avail);
+    return read_ahead_peek(rws, sz_avail);
+}
+
+static inline void window_consume (purc_rwstream_t rws, size_t count)
+{
+    if (rws->funcs->consume)
+        rws->funcs->consume(rws, count);
+    else
+        rws->ra_pos += count;
+}
+
+/* Decodes the character from the bytes in memory, which are either
+   the content of a memory stream or the read-ahead window. */
+static int read_utf8_char_from_window (purc_rwstream_t rws, char* buf_utf8,
+        uint32_t* buf_wc)
+{
+    const uint8_t *p;
+    size_t avail;
+
+    if ((p = window_peek(rws, &avail)) == NULL)
+        return -1;
+    if (avail == 0)
+        return 0;
+
+    uint8_t c = p[0];
+    if (c < 0x80) {
+        buf_utf8[0] = c;
+        *buf_wc = c;
+        window_consume(rws, 1);
+        return 1;
+    }
+
+    int ch_len = utf8_char_len(c);
+    if (ch_len < 0) {
+        window_consume(rws, 1);
+        return -1;
+    }
+
+    /* consume the bytes as the byte-wise reading did, even on error */
+    int i = 0;
+    bool bad = false;
+    buf_utf8[i++] = c;
+    while (i < ch_len && (size_t)i < avail) {
+        c = p[i];
+        buf_utf8[i++] = c;
+        if ((c & 0xC0) != 0x80) {
+            bad = true;
+            break;
+        }
+    }
+    window_consume(rws, i);
+
+    /* the character spans the end of the window */
+    while (!bad && i < ch_len) {
+        if ((p = window_peek(rws, &avail)) == NULL || avail == 0)
+            break;
+
+        c = p[0];
+        buf_utf8[i++] = c;
+        window_consume(rws, 1);
+        if ((c & 0xC0) != 0x80)
+            bad = true;
+    }
+
+    if (bad || i < ch_len) {
+        pcinst_set_error(PCRWSTREAM_ERROR_IO);
+        return -1;
+    }
+
+    return utf8_char_to_wc(buf_utf8, ch_len, buf_wc);
+}
+
 int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
         uint32_t* buf_wc)
 {
@@ -492,31 +768,19 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
         return -1;
     }
 
+    if (rws->funcs->peek || (rws->read_ahead && rws->funcs->read))
+        return read_utf8_char_from_window(rws, buf_utf8, buf_wc);
+
     ssize_t ret =  purc_rwstream_read (rws, buf_utf8, 1);
     if (ret != 1) {
         return ret;
     }
 
-    int n = 1;
-    int ch_len = 0;
+    int ch_len = 1;
     uint8_t c = buf_utf8[0];
-    if (c > 0xFD) {
-        pcinst_set_error(PCRWSTREAM_ERROR_IO);
-        return -1;
-    }
-
     if (c & 0x80) {
-        while (c & (0x80 >> n))
-            n++;
-
-        if (n < 2) {
-            pcinst_set_error(PURC_ERROR_BAD_ENCODING);
+        if ((ch_len = utf8_char_len(c)) < 0)
             return -1;
-        }
-        ch_len = n;
-    }
-    else {
-        ch_len = 1;
     }
 
     int read_len = ch_len - 1;
@@ -537,24 +801,7 @@ int purc_rwstream_read_utf8_char (purc_rwstream_t rws, char* buf_utf8,
         read_len--;
     }
 
-    // FIXME
-    if (ch_len > 3) {
-        pcinst_set_error(PURC_ERROR_BAD_ENCODING);
-        return -1;
-    }
-
-    size_t nr_chars;
-    if (buf_utf8[0] == 0) {
-        *buf_wc = 0;
-    }
-    else if(pcutils_string_check_utf8_len(buf_utf8, ch_len, &nr_chars, NULL)) {
-        *buf_wc = utf8_to_uint32_t((const unsigned char*)buf_utf8, ch_len);
-    }
-    else {
-        ch_len = -1;
-        pcinst_set_error(PURC_ERROR_BAD_ENCODING);
-    }
-    return ch_len;
+    return utf8_char_to_wc(buf_utf8, ch_len, buf_wc);
 }
 
 ssize_t purc_rwstream_write (purc_rwstream_t rws, const void* buf, size_t count)
@@ -564,6 +811,10 @@ ssize_t purc_rwstream_write (purc_rwstream_t rws, const void* buf, size_t count)
         return -1;
     }
 
+    /* For a seekable stream, write where the reader stopped. Pipes and
+       sockets have separated directions, so the bytes read ahead stay. */
+    read_ahead_rewind(rws);
+
     if (rws->funcs->write)
         return rws->funcs->write(rws, buf, count);
 
@@ -651,6 +902,19 @@ void* purc_rwstream_get_mem_buffer_ex (purc_rwstream_t rws,
     return rws->funcs->get_mem_buffer(rws, sz_content, sz_buffer, res_buff);
 }
 
+const uint8_t *pcrwstream_peek_mem(purc_rwstream_t rws, size_t *sz_avail)
+{
+    if (rws->funcs->peek == NULL)
+        return NULL;
+    return rws->funcs->peek(rws, sz_avail);
+}
+
+void pcrwstream_consume_mem(purc_rwstream_t rws, size_t count)
+{
+    if (rws->funcs->consume)
+        rws->funcs->consume(rws, count);
+}
+
 /* stdio rwstream functions */
 static off_t stdio_seek (purc_rwstream_t rws, off_t offset, int whence)
 {
@@ -755,6 +1019,11 @@ static ssize_t mem_read (purc_rwstream_t rws, void* buf, size_t count)
 static ssize_t mem_write (purc_rwstream_t rws, const void* buf, size_t count)
 {
     struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    if (mem->read_only) {
+        pcinst_set_error(PURC_ERROR_NOT_SUPPORTED);
+        return -1;
+    }
+
     if ( (mem->here + count) > mem->stop ) {
         count = mem->stop - mem->here;
     }
@@ -777,6 +1046,9 @@ static ssize_t mem_flush (purc_rwstream_t rws)
 static int mem_destroy (purc_rwstream_t rws)
 {
     struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    if (mem->release) {
+        mem->release(mem->release_ctxt);
+    }
     mem->base = NULL;
     mem->here = NULL;
     mem->stop = NULL;
@@ -794,13 +1066,26 @@ static void* mem_get_mem_buffer (purc_rwstream_t rws,
     }
 
     if (sz_buffer) {
-        *sz_content = mem->stop - mem->base;
+        *sz_buffer = mem->stop - mem->base;
     }
 
     UNUSED_PARAM(res_buff);
     return mem->base;
 }
 
+static const uint8_t* mem_peek (purc_rwstream_t rws, size_t *sz_avail)
+{
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    *sz_avail = mem->stop - mem->here;
+    return mem->here;
+}
+
+static void mem_consume (purc_rwstream_t rws, size_t count)
+{
+    struct mem_rwstream* mem = (struct mem_rwstream *)rws;
+    mem->here += count;
+}
+
 /* buffer rwstream functions */
 static int buffer_extend (struct buffer_rwstream* buffer, size_t size)
 {
@@ -948,6 +1233,19 @@ static void* buffer_get_mem_buffer (purc_rwstream_t rws,
     return buffer->base;
 }
 
+static const uint8_t* buffer_peek (purc_rwstream_t rws, size_t *sz_avail)
+{
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    *sz_avail = buffer->stop - buffer->here;
+    return buffer->here;
+}
+
+static void buffer_consume (purc_rwstream_t rws, size_t count)
+{
+    struct buffer_rwstream* buffer = (struct buffer_rwstream *)rws;
+    buffer->here += count;
+}
+
 #if OS(LINUX) || OS(UNIX) || OS(MAC_OS_X)
 
 static off_t fd_seek (purc_rwstream_t rws, off_t offset, int whence)
@@ -50,7 +50,7 @@ purc_variant_t purc_variant_make_undefined (void)
     struct pcinst * instance = pcinst_current ();
     purc_variant_t value = &(instance->variant_heap->v_undefined);
 
-    value->refc++;
+    pcvariant_refc_inc(value);
 
     return value;
 }
@@ -60,7 +60,7 @@ purc_variant_t purc_variant_make_null (void)
     struct pcinst * instance = pcinst_current ();
     purc_variant_t value = &(instance->variant_heap->v_null);
 
-    value->refc++;
+    pcvariant_refc_inc(value);
 
     return value;
 }
@@ -75,7 +75,7 @@ purc_variant_t purc_variant_make_boolean (bool b)
     else
         value = &(instance->variant_heap->v_false);
 
-    value->refc++;
+    pcvariant_refc_inc(value);
 
     return value;
 }
@@ -32,7 +32,12 @@
 static int
 key_comp(const void *key1, const void *key2)
 {
-    return (char*)key1 - (char*)key2;
+    // the keys mix node addresses and the small numbers used by arrays:
+    // the difference of them does not fit in an int
+    uintptr_t k1 = (uintptr_t)key1;
+    uintptr_t k2 = (uintptr_t)key2;
+
+    return (k1 > k2) - (k1 < k2);
 }
 
 pcutils_map*
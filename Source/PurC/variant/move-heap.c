@@ -35,11 +35,90 @@
 #include <stdlib.h>
 #include <string.h>
 
-static struct purc_mutex        mh_lock;
+/*
+ * Every instance moves variants in its own arena, so no lock is needed
+ * when moving. The arena only accumulates the changes of the statistics,
+ * which are handed off to the statistics of the move heap atomically after
+ * the moving. The move heap itself only keeps the shared constants.
+ *
+ * The arenas are never freed before the process exits: a message moved
+ * by an instance may still be held by other instances after the instance
+ * exits. The arenas of the exited instances are recycled.
+ */
+struct mvheap_arena {
+    struct pcvariant_heap   heap;
+    struct mvheap_arena    *next;
+};
+
+static struct purc_mutex        mh_lock;    /* for the recycled arenas */
+static struct mvheap_arena     *mh_free_arenas;
 static struct pcvariant_heap    move_heap;
 
+static inline struct purc_variant_stat *arena_stat(struct pcinst *inst)
+{
+    return &inst->move_arena->stat;
+}
+
+static inline void mvheap_stat_add(size_t *counter, size_t delta)
+{
+    __atomic_add_fetch(counter, delta, __ATOMIC_RELAXED);
+}
+
+/* hand off the changes of statistics in the arena to the move heap */
+static void handoff_arena_stat(struct pcvariant_heap *arena)
+{
+    struct purc_variant_stat *stat = &arena->stat;
+
+    for (int t = PURC_VARIANT_TYPE_FIRST; t < PURC_VARIANT_TYPE_NR; t++) {
+        if (stat->nr_values[t]) {
+            mvheap_stat_add(&move_heap.stat.nr_values[t], stat->nr_values[t]);
+            stat->nr_values[t] = 0;
+        }
+
+        if (stat->sz_mem[t]) {
+            mvheap_stat_add(&move_heap.stat.sz_mem[t], stat->sz_mem[t]);
+            stat->sz_mem[t] = 0;
+        }
+    }
+
+    mvheap_stat_add(&move_heap.stat.nr_total_values, stat->nr_total_values);
+    stat->nr_total_values = 0;
+    mvheap_stat_add(&move_heap.stat.sz_total_mem, stat->sz_total_mem);
+    stat->sz_total_mem = 0;
+}
+
+static void init_constants(struct pcvariant_heap *heap, unsigned int flags)
+{
+    heap->v_undefined.type = PURC_VARIANT_TYPE_UNDEFINED;
+    heap->v_undefined.refc = 0;
+    heap->v_undefined.flags = flags;
+    INIT_LIST_HEAD(&heap->v_undefined.listeners);
+
+    heap->v_null.type = PURC_VARIANT_TYPE_NULL;
+    heap->v_null.refc = 0;
+    heap->v_null.flags = flags;
+    INIT_LIST_HEAD(&heap->v_null.listeners);
+
+    heap->v_false.type = PURC_VARIANT_TYPE_BOOLEAN;
+    heap->v_false.refc = 0;
+    heap->v_false.flags = flags;
+    heap->v_false.b = false;
+    INIT_LIST_HEAD(&heap->v_false.listeners);
+
+    heap->v_true.type = PURC_VARIANT_TYPE_BOOLEAN;
+    heap->v_true.refc = 0;
+    heap->v_true.flags = flags;
+    heap->v_true.b = true;
+}
+
 static void mvheap_cleanup_once(void)
 {
+    while (mh_free_arenas) {
+        struct mvheap_arena *arena = mh_free_arenas;
+        mh_free_arenas = arena->next;
+        free(arena);
+    }
+
     if (mh_lock.native_impl)
         purc_mutex_clear(&mh_lock);
 
@@ -69,26 +148,8 @@ static void mvheap_cleanup_once(void)
 
 static int mvheap_init_once(void)
 {
-    move_heap.v_undefined.type = PURC_VARIANT_TYPE_UNDEFINED;
-    move_heap.v_undefined.refc = 0;
-    move_heap.v_undefined.flags = PCVARIANT_FLAG_NOFREE;
-    INIT_LIST_HEAD(&move_heap.v_undefined.listeners);
-
-    move_heap.v_null.type = PURC_VARIANT_TYPE_NULL;
-    move_heap.v_null.refc = 0;
-    move_heap.v_null.flags = PCVARIANT_FLAG_NOFREE;
-    INIT_LIST_HEAD(&move_heap.v_null.listeners);
-
-    move_heap.v_false.type = PURC_VARIANT_TYPE_BOOLEAN;
-    move_heap.v_false.refc = 0;
-    move_heap.v_false.flags = PCVARIANT_FLAG_NOFREE;
-    move_heap.v_false.b = false;
-    INIT_LIST_HEAD(&move_heap.v_false.listeners);
-
-    move_heap.v_true.type = PURC_VARIANT_TYPE_BOOLEAN;
-    move_heap.v_true.refc = 0;
-    move_heap.v_true.flags = PCVARIANT_FLAG_NOFREE;
-    move_heap.v_true.b = true;
+    /* the constants in move heap are shared by all instances */
+    init_constants(&move_heap, PCVARIANT_FLAG_NOFREE | PCVARIANT_FLAG_FROZEN);
 
     struct purc_variant_stat *stat = &move_heap.stat;
     stat->nr_values[PURC_VARIANT_TYPE_UNDEFINED] = 0;
@@ -124,18 +185,69 @@ fail_atexit:
     return -1;
 }
 
+static int mvheap_init_instance(struct pcinst *curr_inst,
+        const purc_instance_extra_info* extra_info)
+{
+    UNUSED_PARAM(extra_info);
+
+    struct mvheap_arena *arena;
+
+    purc_mutex_lock(&mh_lock);
+    arena = mh_free_arenas;
+    if (arena)
+        mh_free_arenas = arena->next;
+    purc_mutex_unlock(&mh_lock);
+
+    if (arena == NULL) {
+        arena = calloc(1, sizeof(*arena));
+        if (arena == NULL)
+            return PURC_ERROR_OUT_OF_MEMORY;
+
+        /* the constants of an arena should never be used,
+           but they are shared if they are used. */
+        init_constants(&arena->heap,
+                PCVARIANT_FLAG_NOFREE | PCVARIANT_FLAG_FROZEN);
+
+        arena->heap.stat.nr_max_reserved = 0;
+#if !USE(LOOP_BUFFER_FOR_RESERVED)
+        INIT_LIST_HEAD(&arena->heap.v_reserved);
+#endif
+    }
+
+    curr_inst->move_arena = &arena->heap;
+    return PURC_ERROR_OK;
+}
+
+static void mvheap_cleanup_instance(struct pcinst *curr_inst)
+{
+    struct mvheap_arena *arena = (struct mvheap_arena *)curr_inst->move_arena;
+
+    if (arena == NULL)
+        return;
+
+    handoff_arena_stat(&arena->heap);
+    curr_inst->move_arena = NULL;
+
+    purc_mutex_lock(&mh_lock);
+    arena->next = mh_free_arenas;
+    mh_free_arenas = arena;
+    purc_mutex_unlock(&mh_lock);
+}
+
 struct pcmodule _module_mvheap = {
     .id              = PURC_HAVE_VARIANT,
     .module_inited   = 0,
 
-    .init_once       = mvheap_init_once,
-    .init_instance   = NULL,
+    .init_once          = mvheap_init_once,
+    .init_instance      = mvheap_init_instance,
+    .cleanup_instance   = mvheap_cleanup_instance,
 };
 
 static void
 move_variant_in(struct pcinst *inst, purc_variant_t v)
 {
     /* move directly and change the stat info */
+    struct purc_variant_stat *stat = arena_stat(inst);
 
     if (IS_CONTAINER(v->type) ||
             ((v->type == PURC_VARIANT_TYPE_STRING ||
@@ -144,19 +256,65 @@ move_variant_in(struct pcinst *inst, purc_variant_t v)
         inst->org_vrt_heap->stat.sz_mem[v->type] -= v->sz_ptr[0];
         inst->org_vrt_heap->stat.sz_total_mem -= v->sz_ptr[0];
 
-        move_heap.stat.sz_mem[v->type] += v->sz_ptr[0];
-        move_heap.stat.sz_total_mem += v->sz_ptr[0];
+        stat->sz_mem[v->type] += v->sz_ptr[0];
+        stat->sz_total_mem += v->sz_ptr[0];
     }
 
     inst->org_vrt_heap->stat.nr_values[v->type]--;
     inst->org_vrt_heap->stat.nr_total_values--;
-    move_heap.stat.nr_values[v->type]++;
-    move_heap.stat.nr_total_values++;
+    stat->nr_values[v->type]++;
+    stat->nr_total_values++;
 
     inst->org_vrt_heap->stat.sz_mem[v->type] -= sizeof(purc_variant);
     inst->org_vrt_heap->stat.sz_total_mem -= sizeof(purc_variant);
-    move_heap.stat.sz_mem[v->type] += sizeof(purc_variant);
-    move_heap.stat.sz_total_mem += sizeof(purc_variant);
+    stat->sz_mem[v->type] += sizeof(purc_variant);
+    stat->sz_total_mem += sizeof(purc_variant);
+}
+
+/* the immutable variants which can be shared by instances */
+static bool can_be_frozen(purc_variant_t v)
+{
+    switch (v->type) {
+    case PURC_VARIANT_TYPE_EXCEPTION:
+    case PURC_VARIANT_TYPE_NUMBER:
+    case PURC_VARIANT_TYPE_LONGINT:
+    case PURC_VARIANT_TYPE_ULONGINT:
+    case PURC_VARIANT_TYPE_LONGDOUBLE:
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+    case PURC_VARIANT_TYPE_STRING:
+    case PURC_VARIANT_TYPE_BSEQUENCE:
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+void pcvariant_move_heap_thaw(purc_variant_t v)
+{
+    struct pcinst *inst = pcinst_current();
+    struct purc_variant_stat *stat = &inst->variant_heap->stat;
+    size_t sz = sizeof(purc_variant);
+
+    if ((v->type == PURC_VARIANT_TYPE_STRING ||
+                v->type == PURC_VARIANT_TYPE_BSEQUENCE) &&
+            (v->flags & PCVARIANT_FLAG_EXTRA_SIZE)) {
+        sz += v->sz_ptr[0];
+    }
+
+    mvheap_stat_add(&move_heap.stat.nr_values[v->type], (size_t)-1);
+    mvheap_stat_add(&move_heap.stat.nr_total_values, (size_t)-1);
+    mvheap_stat_add(&move_heap.stat.sz_mem[v->type], -sz);
+    mvheap_stat_add(&move_heap.stat.sz_total_mem, -sz);
+
+    stat->nr_values[v->type]++;
+    stat->nr_total_values++;
+    stat->sz_mem[v->type] += sz;
+    stat->sz_total_mem += sz;
+
+    v->flags &= ~PCVARIANT_FLAG_FROZEN;
 }
 
 static purc_variant_t
@@ -170,37 +328,54 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
     if (v == &inst->org_vrt_heap->v_undefined) {
         retv = &move_heap.v_undefined;
         v->refc--;
-        retv->refc++;
+        pcvariant_refc_inc(retv);
     }
     else if (v == &inst->org_vrt_heap->v_null) {
         retv = &move_heap.v_null;
         v->refc--;
-        retv->refc++;
+        pcvariant_refc_inc(retv);
     }
     else if (v == &inst->org_vrt_heap->v_false) {
         retv = &move_heap.v_false;
         v->refc--;
-        retv->refc++;
+        pcvariant_refc_inc(retv);
     }
     else if (v == &inst->org_vrt_heap->v_true) {
         retv = &move_heap.v_true;
         v->refc--;
-        retv->refc++;
+        pcvariant_refc_inc(retv);
+    }
+    else if (v->flags & PCVARIANT_FLAG_FROZEN) {
+        // shared already
+        retv = v;
     }
     else if (v->refc == 1) {
         PC_DEBUG("Move in variant type %s (%u): %s\n",
                 purc_variant_typename(v->type),
-                (unsigned)move_heap.stat.nr_values[v->type],
+                (unsigned)arena_stat(inst)->nr_values[v->type],
+                purc_variant_get_string_const(v));
+
+        retv = v;
+        move_variant_in(inst, v);
+    }
+    else if (can_be_frozen(v)) {
+        // freeze the immutable variant and share it by reference count
+        PC_DEBUG("Freeze a variant type %s (%u): %s\n",
+                purc_variant_typename(v->type),
+                (unsigned)v->refc,
                 purc_variant_get_string_const(v));
 
         retv = v;
         move_variant_in(inst, v);
+        v->flags |= PCVARIANT_FLAG_FROZEN;
     }
     else {
         // clone the immutable variant
+        struct purc_variant_stat *stat = arena_stat(inst);
+
         PC_DEBUG("Clone a variant type %s (%u): %s\n",
                 purc_variant_typename(v->type),
-                (unsigned)move_heap.stat.nr_values[v->type],
+                (unsigned)stat->nr_values[v->type],
                 purc_variant_get_string_const(v));
 
         retv = pcvariant_alloc();
@@ -215,19 +390,31 @@ move_or_clone_immutable(struct pcinst *inst, purc_variant_t v)
             retv->sz_ptr[1] = (uintptr_t)malloc(v->sz_ptr[0]);
             memcpy((void *)retv->sz_ptr[1], (void *)v->sz_ptr[1], v->sz_ptr[0]);
 
-            move_heap.stat.sz_mem[v->type] += v->sz_ptr[0];
-            move_heap.stat.sz_total_mem += v->sz_ptr[0];
+            stat->sz_mem[v->type] += v->sz_ptr[0];
+            stat->sz_total_mem += v->sz_ptr[0];
         }
 
-        move_heap.stat.nr_values[v->type]++;
-        move_heap.stat.nr_total_values++;
-        move_heap.stat.sz_mem[v->type] += sizeof(purc_variant);
-        move_heap.stat.sz_total_mem += sizeof(purc_variant);
+        stat->nr_values[v->type]++;
+        stat->nr_total_values++;
+        stat->sz_mem[v->type] += sizeof(purc_variant);
+        stat->sz_total_mem += sizeof(purc_variant);
     }
 
     return retv;
 }
 
+/* the keys of a cloned object are shared with the original object */
+static void
+move_key_in(struct pcinst *inst, purc_variant_t k)
+{
+    if (k->flags & PCVARIANT_FLAG_FROZEN)
+        return;
+
+    move_variant_in(inst, k);
+    if (k->refc > 1 && can_be_frozen(k))
+        k->flags |= PCVARIANT_FLAG_FROZEN;
+}
+
 struct travel_context {
     struct pcinst *inst;
     struct pcutils_arrlist *vrts_to_unref;
@@ -280,23 +467,23 @@ move_keys_in_cloned_object(struct travel_context *ctxt, purc_variant_t obj)
         if (IS_CONTAINER(v->type)) {
             PC_DEBUG("Move in a key %s (%u): %s\n",
                     purc_variant_typename(k->type),
-                    (unsigned)move_heap.stat.nr_values[k->type],
+                    (unsigned)k->refc,
                     purc_variant_get_string_const(k));
         }
 
         switch (v->type) {
         case PURC_VARIANT_TYPE_ARRAY:
-            move_variant_in(ctxt->inst, k);
+            move_key_in(ctxt->inst, k);
             move_keys_in_cloned_array(ctxt, v);
             break;
 
         case PURC_VARIANT_TYPE_OBJECT:
-            move_variant_in(ctxt->inst, k);
+            move_key_in(ctxt->inst, k);
             move_keys_in_cloned_object(ctxt, v);
             break;
 
         case PURC_VARIANT_TYPE_SET:
-            move_variant_in(ctxt->inst, k);
+            move_key_in(ctxt->inst, k);
             move_keys_in_cloned_set(ctxt, v);
             break;
 
@@ -419,7 +606,7 @@ move_or_clone_mutable_descendants_in_array(struct travel_context *ctxt,
 
             move_keys_in_cloned_container(ctxt, retv);
 
-            _p->val = retv;
+            _data->vals[_i] = retv;
             pcutils_arrlist_append(ctxt->vrts_to_unref, v);
         }
 
@@ -469,7 +656,7 @@ move_or_clone_mutable_descendants_in_object(struct travel_context *ctxt,
         if (IS_CONTAINER(v->type)) {
             retk = move_or_clone_immutable(ctxt->inst, k);
             if (retk != k) {
-                _node->key = retk;
+                _it.curr->key = retk;
                 pcutils_arrlist_append(ctxt->vrts_to_unref, k);
             }
 
@@ -489,7 +676,7 @@ move_or_clone_mutable_descendants_in_object(struct travel_context *ctxt,
                         (unsigned)retv->refc);
                 move_keys_in_cloned_object(ctxt, retv);
 
-                _node->val = retv;
+                _it.curr->val = retv;
                 pcutils_arrlist_append(ctxt->vrts_to_unref, v);
             }
         }
@@ -616,7 +803,7 @@ move_or_clone_immutable_descendants_in_array(struct travel_context *ctxt,
         }
 
         if (retv != v) {
-            _p->val = retv;
+            _data->vals[_i] = retv;
             if (!(v->flags & PCVARIANT_FLAG_NOFREE))
                 pcutils_arrlist_append(ctxt->vrts_to_unref, v);
         }
@@ -650,13 +837,13 @@ move_or_clone_immutable_descendants_in_object(struct travel_context *ctxt,
         default:
             retk = move_or_clone_immutable(ctxt->inst, k);
             if (retk != k) {
-                _node->key = retk;
+                _it.curr->key = retk;
                 pcutils_arrlist_append(ctxt->vrts_to_unref, k);
             }
 
             retv = move_or_clone_immutable(ctxt->inst, v);
             if (retv != v) {
-                _node->val = retv;
+                _it.curr->val = retv;
                 if (!(v->flags & PCVARIANT_FLAG_NOFREE))
                     pcutils_arrlist_append(ctxt->vrts_to_unref, v);
             }
@@ -792,23 +979,24 @@ purc_variant_t pcvariant_move_heap_in(purc_variant_t v)
 static void move_container_self_out(purc_variant_t v)
 {
     struct pcinst *inst = pcinst_current();
+    struct purc_variant_stat *stat = arena_stat(inst);
 
     inst->org_vrt_heap->stat.sz_mem[v->type] += v->sz_ptr[0];
     inst->org_vrt_heap->stat.sz_total_mem += v->sz_ptr[0];
 
-    move_heap.stat.sz_mem[v->type] -= v->sz_ptr[0];
-    move_heap.stat.sz_total_mem -= v->sz_ptr[0];
+    stat->sz_mem[v->type] -= v->sz_ptr[0];
+    stat->sz_total_mem -= v->sz_ptr[0];
 
     inst->org_vrt_heap->stat.nr_values[v->type]++;
     inst->org_vrt_heap->stat.nr_total_values++;
 
-    move_heap.stat.nr_values[v->type]--;
-    move_heap.stat.nr_total_values--;
+    stat->nr_values[v->type]--;
+    stat->nr_total_values--;
 
     inst->org_vrt_heap->stat.sz_mem[v->type] += sizeof(purc_variant);
     inst->org_vrt_heap->stat.sz_total_mem += sizeof(purc_variant);
-    move_heap.stat.sz_mem[v->type] -= sizeof(purc_variant);
-    move_heap.stat.sz_total_mem -= sizeof(purc_variant);
+    stat->sz_mem[v->type] -= sizeof(purc_variant);
+    stat->sz_total_mem -= sizeof(purc_variant);
 }
 
 static purc_variant_t move_variant_out(purc_variant_t v);
@@ -846,7 +1034,7 @@ static purc_variant_t move_array_descendants_out(purc_variant_t arr)
             break;
         }
 
-        _p->val = retv;
+        _data->vals[_i] = retv;
 
     } end_foreach;
 
@@ -881,8 +1069,8 @@ static purc_variant_t move_object_descendants_out(purc_variant_t obj)
             break;
         }
 
-        _node->key = retk;
-        _node->val = retv;
+        _it.curr->key = retk;
+        _it.curr->val = retv;
 
     } end_foreach;
 
@@ -926,29 +1114,25 @@ static purc_variant_t move_variant_out(purc_variant_t v)
 {
     purc_variant_t retv = v;
     struct pcinst *inst = pcinst_current();
-
-    if (v == &move_heap.v_undefined) {
-        retv = &inst->org_vrt_heap->v_undefined;
-        v->refc--;
-        retv->refc++;
-        return retv;
-    }
-    else if (v == &move_heap.v_null) {
-        retv = &inst->org_vrt_heap->v_null;
-        v->refc--;
-        retv->refc++;
-        return retv;
-    }
-    else if (v == &move_heap.v_false) {
-        retv = &inst->org_vrt_heap->v_false;
-        v->refc--;
+    struct purc_variant_stat *stat = arena_stat(inst);
+
+    if (v->flags & PCVARIANT_FLAG_NOFREE) {
+        /* a constant in the move heap */
+        if (v->type == PURC_VARIANT_TYPE_UNDEFINED)
+            retv = &inst->org_vrt_heap->v_undefined;
+        else if (v->type == PURC_VARIANT_TYPE_NULL)
+            retv = &inst->org_vrt_heap->v_null;
+        else if (v->b)
+            retv = &inst->org_vrt_heap->v_true;
+        else
+            retv = &inst->org_vrt_heap->v_false;
+
+        pcvariant_refc_dec(v);
         retv->refc++;
         return retv;
     }
-    else if (v == &move_heap.v_true) {
-        retv = &inst->org_vrt_heap->v_true;
-        v->refc--;
-        retv->refc++;
+    else if (v->flags & PCVARIANT_FLAG_FROZEN) {
+        /* shared by instances; keep it in the move heap */
         return retv;
     }
     else if ((v->type == PURC_VARIANT_TYPE_STRING ||
@@ -957,15 +1141,15 @@ static purc_variant_t move_variant_out(purc_variant_t v)
         inst->org_vrt_heap->stat.sz_mem[v->type] += v->sz_ptr[0];
         inst->org_vrt_heap->stat.sz_total_mem += v->sz_ptr[0];
 
-        move_heap.stat.sz_mem[v->type] -= v->sz_ptr[0];
-        move_heap.stat.sz_total_mem -= v->sz_ptr[0];
+        stat->sz_mem[v->type] -= v->sz_ptr[0];
+        stat->sz_total_mem -= v->sz_ptr[0];
     }
     else if (IS_CONTAINER(v->type)) {
         inst->org_vrt_heap->stat.sz_mem[v->type] += v->sz_ptr[0];
         inst->org_vrt_heap->stat.sz_total_mem += v->sz_ptr[0];
 
-        move_heap.stat.sz_mem[v->type] -= v->sz_ptr[0];
-        move_heap.stat.sz_total_mem -= v->sz_ptr[0];
+        stat->sz_mem[v->type] -= v->sz_ptr[0];
+        stat->sz_total_mem -= v->sz_ptr[0];
 
         if (v->type == PURC_VARIANT_TYPE_ARRAY) {
             retv = move_array_descendants_out(v);
@@ -983,19 +1167,17 @@ static purc_variant_t move_variant_out(purc_variant_t v)
 
     PC_DEBUG("Move out a variant type: %s (%u): %s\n",
             purc_variant_typename(v->type),
-            (unsigned)move_heap.stat.nr_values[v->type],
+            (unsigned)v->refc,
             purc_variant_get_string_const(v));
 
-    assert(move_heap.stat.nr_values[v->type] > 0);
-    assert(move_heap.stat.nr_total_values > 0);
-
-    move_heap.stat.nr_values[v->type]--;
-    move_heap.stat.nr_total_values--;
+    /* the arena only keeps the changes; the counters may wrap around */
+    stat->nr_values[v->type]--;
+    stat->nr_total_values--;
 
     inst->org_vrt_heap->stat.sz_mem[v->type] += sizeof(purc_variant);
     inst->org_vrt_heap->stat.sz_total_mem += sizeof(purc_variant);
-    move_heap.stat.sz_mem[v->type] -= sizeof(purc_variant);
-    move_heap.stat.sz_total_mem -= sizeof(purc_variant);
+    stat->sz_mem[v->type] -= sizeof(purc_variant);
+    stat->sz_total_mem -= sizeof(purc_variant);
 
     return retv;
 }
@@ -1014,14 +1196,12 @@ purc_variant_t pcvariant_move_heap_out(purc_variant_t v)
 void pcvariant_use_move_heap(void)
 {
     struct pcinst *inst = pcinst_current();
-    purc_mutex_lock(&mh_lock);
-    inst->variant_heap = &move_heap;
+    inst->variant_heap = inst->move_arena;
 }
 
 void pcvariant_use_norm_heap(void)
 {
     struct pcinst *inst = pcinst_current();
     inst->variant_heap = inst->org_vrt_heap;
-    purc_mutex_unlock(&mh_lock);
+    handoff_arena_stat(inst->move_arena);
 }
-
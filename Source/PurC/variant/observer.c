@@ -282,6 +282,18 @@ pcvar_build_rue_downward(purc_variant_t val)
     return 0;
 }
 
+/*
+ * The keys of the edges from the members of the arrays and the objects only
+ * identify the slots: they are odd numbers, so never equal to the addresses
+ * of the nodes of the sets used as the keys in the same chains.
+ */
+uintptr_t
+pcvar_new_edge_key(void)
+{
+    static uintptr_t last_key = 1;
+    return __atomic_add_fetch(&last_key, 2, __ATOMIC_RELAXED);
+}
+
 int
 pcvar_build_edge_to_parent(purc_variant_t val,
         struct pcvar_rev_update_edge *edge)
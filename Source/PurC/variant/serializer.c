@@ -46,6 +46,7 @@
 #include "private/instance.h"
 #include "private/errors.h"
 #include "private/debug.h"
+#include "private/utils.h"
 
 #include "variant/variant-internals.h"
 
@@ -56,33 +57,87 @@
 #include <float.h>
 #include <assert.h>
 
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#endif
+
 static const char *hex_chars = "0123456789abcdefABCDEF";
 
-#define MY_WRITE(rws, buff, count)                                      \
+/* The size of the output buffer of a serializer; the serialized data
+   are written to the stream in chunks of this size. */
+#define SERIALIZER_BUFF_SIZE    4096
+
+struct serializer {
+    purc_rwstream_t rws;
+    unsigned int    flags;
+    size_t         *len_expected;
+
+    /* the custom formats of real numbers; NULL for the default ones */
+    const char     *format_double;
+    const char     *format_long_double;
+
+    /* the number of bytes written to the stream actually */
+    ssize_t         nr_written;
+
+    size_t          nr_buffered;
+    char            buff[SERIALIZER_BUFF_SIZE];
+};
+
+static int
+write_to_stream(struct serializer *ser, const char *buf, size_t count)
+{
+    while (count > 0) {
+        ssize_t n = purc_rwstream_write(ser->rws, buf, count);
+        if (n <= 0) {
+            if (ser->flags & PCVARIANT_SERIALIZE_OPT_IGNORE_ERRORS)
+                break;
+            return -1;
+        }
+
+        ser->nr_written += n;
+        buf += n;
+        count -= n;
+    }
+
+    return 0;
+}
+
+static inline int flush_buffer(struct serializer *ser)
+{
+    size_t count = ser->nr_buffered;
+
+    ser->nr_buffered = 0;
+    return write_to_stream(ser, ser->buff, count);
+}
+
+static int
+serializer_write(struct serializer *ser, const char *buf, size_t count)
+{
+    if (ser->len_expected)
+        *ser->len_expected += count;
+
+    if (LIKELY(count <= SERIALIZER_BUFF_SIZE - ser->nr_buffered)) {
+        memcpy(ser->buff + ser->nr_buffered, buf, count);
+        ser->nr_buffered += count;
+        return 0;
+    }
+
+    if (flush_buffer(ser))
+        return -1;
+
+    /* no need to copy a long run into the buffer */
+    if (count >= SERIALIZER_BUFF_SIZE)
+        return write_to_stream(ser, buf, count);
+
+    memcpy(ser->buff, buf, count);
+    ser->nr_buffered = count;
+    return 0;
+}
+
+#define MY_WRITE(ser, buff, count)                                      \
     do {                                                                \
-        const char* _buff = buff;                                       \
-        ssize_t n;                                                      \
-        size_t nr_left = (count);                                       \
-        if (len_expected)                                               \
-            *len_expected += (count);                                   \
-        while (1) {                                                     \
-            n = purc_rwstream_write((rws), _buff, nr_left);             \
-            if (n <= 0) {                                               \
-                if (flags & PCVARIANT_SERIALIZE_OPT_IGNORE_ERRORS)      \
-                    break;                                              \
-                else                                                    \
-                    goto failed;                                        \
-            }                                                           \
-            else if ((size_t)n < nr_left) {                             \
-                nr_written += n;                                        \
-                _buff += n;                                             \
-                continue;                                               \
-            }                                                           \
-            else {                                                      \
-                nr_written += n;                                        \
-                break;                                                  \
-            }                                                           \
-        }                                                               \
+        if (serializer_write((ser), (buff), (count)))                   \
+            goto failed;                                                \
     } while (0)
 
 #define MY_CHECK(n)                                                     \
@@ -91,100 +146,138 @@ static const char *hex_chars = "0123456789abcdefABCDEF";
                 !(flags & PCVARIANT_SERIALIZE_OPT_IGNORE_ERRORS)) {     \
             goto failed;                                                \
         }                                                               \
-        else {                                                          \
-            nr_written += (n);                                          \
-        }                                                               \
     } while (0)
 
-static ssize_t
-serialize_string(purc_rwstream_t rws, const char* str,
-        size_t len, unsigned int flags, size_t *len_expected)
+/* The character following the backslash in the escape sequence of a byte;
+   'u' for the control characters which have no short form, and 0 for the
+   bytes which do not need to be escaped. */
+static const char escape_table[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0,   0,   '"', 0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   '/',
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   '\\',
+};
+
+#if !CPU(X86_SSE2)
+#define ONES_IN_BYTES       0x0101010101010101ULL
+#define HIGHS_IN_BYTES      0x8080808080808080ULL
+
+/* whether any byte in the word is less than n (n <= 128) */
+#define has_byte_less(x, n) \
+    (((x) - ONES_IN_BYTES * (n)) & ~(x) & HIGHS_IN_BYTES)
+
+/* whether any byte in the word equals to c */
+#define has_byte_equal(x, c) has_byte_less((x) ^ (ONES_IN_BYTES * (c)), 1)
+#endif
+
+/* Returns the length of the leading bytes of a string
+   which do not need to be escaped. */
+static size_t
+scan_unescaped(const char *str, size_t len, bool escape_slash)
 {
-    int nr_written = 0;
-    size_t pos = 0, start_offset = 0;
-    unsigned char c;
-    char buff[3];
-
-    while (len--) {
-        c = str[pos];
-        switch (c) {
-        case '\b':
-        case '\n':
-        case '\r':
-        case '\t':
-        case '\f':
-        case '"':
-        case '\\':
-        case '/':
-            if ((flags & PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE) && c == '/') {
-                pos++;
-                break;
-            }
-
-            if (pos - start_offset > 0)
-                MY_WRITE(rws, str + start_offset, pos - start_offset);
-
-            buff[0] = 0;
-            if (c == '\b') {
-                buff[0] = '\\';
-                buff[1] = 'b';
-            }
-            else if (c == '\n') {
-                buff[0] = '\\';
-                buff[1] = 'n';
-            }
-            else if (c == '\r') {
-                buff[0] = '\\';
-                buff[1] = 'r';
-            }
-            else if (c == '\t') {
-                buff[0] = '\\';
-                buff[1] = 't';
-            }
-            else if (c == '\f') {
-                buff[0] = '\\';
-                buff[1] = 'f';
-            }
-            else if (c == '"') {
-                buff[0] = '\\';
-                buff[1] = '\"';
-            }
-            else if (c == '\\') {
-                buff[0] = '\\';
-                buff[1] = '\\';
-            }
-            else if (c == '/') {
-                buff[0] = '\\';
-                buff[1] = '/';
-            }
-
-            if (buff[0])
-                MY_WRITE(rws, buff, 2);
+    size_t pos = 0;
+
+#if CPU(X86_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8(escape_slash ? '/' : '"');
+    const __m128i max_ctrl = _mm_set1_epi8(0x1F);
+
+    for (; pos + 16 <= len; pos += 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i *)(str + pos));
+
+        /* a control character c makes max(c, 0x1F) == 0x1F */
+        __m128i hits = _mm_cmpeq_epi8(_mm_max_epu8(chunk, max_ctrl),
+                max_ctrl);
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, quote));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, backslash));
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(chunk, slash));
+
+        int mask = _mm_movemask_epi8(hits);
+        if (mask)
+            return pos + __builtin_ctz(mask);
+    }
+#else
+    for (; pos + sizeof(uint64_t) <= len; pos += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, str + pos, sizeof(word));
+
+        uint64_t hits = has_byte_less(word, 0x20) |
+            has_byte_equal(word, '"') | has_byte_equal(word, '\\');
+        if (escape_slash)
+            hits |= has_byte_equal(word, '/');
+
+        /* locate the byte in the loop below */
+        if (hits)
+            break;
+    }
+#endif
 
-            start_offset = ++pos;
+    for (; pos < len; pos++) {
+        unsigned char c = (unsigned char)str[pos];
+        if (escape_table[c] && (c != '/' || escape_slash))
             break;
+    }
 
-        default:
-            if (c < ' ') {
-                char sbuf[7];
-                if (pos - start_offset > 0)
-                    MY_WRITE(rws, str + start_offset, pos - start_offset);
+    return pos;
+}
 
-                if (snprintf(sbuf, sizeof(sbuf), "\\u00%c%c",
-                            hex_chars[c >> 4], hex_chars[c & 0xf]) < 0)
-                    goto failed;
+static int
+serialize_string(struct serializer *ser, const char* str, size_t len)
+{
+    bool escape_slash =
+        !(ser->flags & PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE);
+    char buff[6];
+
+    while (len > 0) {
+        size_t run = scan_unescaped(str, len, escape_slash);
+        if (run > 0) {
+            MY_WRITE(ser, str, run);
+            str += run;
+            len -= run;
+            if (len == 0)
+                break;
+        }
 
-                MY_WRITE(rws, sbuf, sizeof(sbuf) - 1);
-                start_offset = ++pos;
-            }
-            else
-                pos++;
+        unsigned char c = (unsigned char)*str;
+        buff[0] = '\\';
+        buff[1] = escape_table[c];
+        if (buff[1] == 'u') {
+            buff[2] = '0';
+            buff[3] = '0';
+            buff[4] = hex_chars[c >> 4];
+            buff[5] = hex_chars[c & 0xf];
+            MY_WRITE(ser, buff, 6);
         }
+        else
+            MY_WRITE(ser, buff, 2);
+
+        str++;
+        len--;
     }
-    if (pos - start_offset > 0)
-        MY_WRITE(rws, str + start_offset, pos - start_offset);
 
-    return nr_written;
+    return 0;
+
+failed:
+    return -1;
+}
+
+static int
+serialize_quoted_string(struct serializer *ser, const char* str, size_t len)
+{
+    MY_WRITE(ser, "\"", 1);
+    if (serialize_string(ser, str, len))
+        goto failed;
+    MY_WRITE(ser, "\"", 1);
+    return 0;
 
 failed:
     return -1;
@@ -257,12 +350,10 @@ static const char base64_pad = '=';
        characters followed by one "=" padding character.
    */
 
-static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
-        const void *_src, size_t srclength,
-        unsigned int flags, size_t *len_expected)
+static int serialize_bsequence_base64(struct serializer *ser,
+        const void *_src, size_t srclength)
 {
     const unsigned char *src = _src;
-    ssize_t nr_written = 0;
     uint8_t input[3] = {0};
     uint8_t output[4];
     char buff[4];
@@ -284,7 +375,7 @@ static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
         buff[2] = base64_chars[output[2]];
         buff[3] = base64_chars[output[3]];
 
-        MY_WRITE(rws, buff, 4);
+        MY_WRITE(ser, buff, 4);
     }
 
     /* Now we worry about padding. */
@@ -306,49 +397,50 @@ static ssize_t serialize_bsequence_base64(purc_rwstream_t rws,
             buff[2] = base64_chars[output[2]];
         buff[3] = base64_pad;
 
-        MY_WRITE(rws, buff, 4);
+        MY_WRITE(ser, buff, 4);
     }
 
-    return nr_written;
+    return 0;
 
 failed:
     return -1;
 }
 
-static ssize_t
-serialize_bsequence(purc_rwstream_t rws, const char* content,
-        size_t sz_content, unsigned int flags, size_t *len_expected)
+static int
+serialize_bsequence(struct serializer *ser, const char* content,
+        size_t sz_content)
 {
-    ssize_t nr_written = 0, n;
+    unsigned int flags = ser->flags;
+    int n;
     size_t i;
 
     switch (flags & PCVARIANT_SERIALIZE_OPT_BSEQUENCE_MASK) {
         case PCVARIANT_SERIALIZE_OPT_BSEQUENCE_HEX_STRING:
-            MY_WRITE(rws, "\"", 1);
+            MY_WRITE(ser, "\"", 1);
             for (i = 0; i < sz_content; i++) {
                 unsigned char byte = (unsigned char)content[i];
                 char buff[2];
                 buff [0] = hex_chars[(byte >> 4) & 0x0f];
                 buff [1] = hex_chars[byte & 0x0f];
-                MY_WRITE(rws, buff, 2);
+                MY_WRITE(ser, buff, 2);
             }
-            MY_WRITE(rws, "\"", 1);
+            MY_WRITE(ser, "\"", 1);
             break;
 
         case PCVARIANT_SERIALIZE_OPT_BSEQUENCE_HEX:
-            MY_WRITE(rws, "bx", 2);
+            MY_WRITE(ser, "bx", 2);
             for (i = 0; i < sz_content; i++) {
                 unsigned char byte = (unsigned char)content[i];
                 char buff[2];
                 buff [0] = hex_chars[(byte >> 4) & 0x0f];
                 buff [1] = hex_chars[byte & 0x0f];
-                MY_WRITE(rws, buff, 2);
+                MY_WRITE(ser, buff, 2);
             }
             break;
 
         case PCVARIANT_SERIALIZE_OPT_BSEQUENCE_BIN:
         case PCVARIANT_SERIALIZE_OPT_BSEQUENCE_BIN_DOT:
-            MY_WRITE(rws, "bb", 2);
+            MY_WRITE(ser, "bb", 2);
             for (i = 0; i < sz_content; i++) {
                 unsigned char byte = (unsigned char)content[i];
                 char buff[10];
@@ -368,20 +460,19 @@ serialize_bsequence(purc_rwstream_t rws, const char* content,
                     }
                 }
 
-                MY_WRITE(rws, buff, k);
+                MY_WRITE(ser, buff, k);
             }
             break;
 
         case PCVARIANT_SERIALIZE_OPT_BSEQUENCE_BASE64:
         default:
-            MY_WRITE(rws, "b64", 3);
-            n = serialize_bsequence_base64(rws, content, sz_content,
-                    flags, len_expected);
+            MY_WRITE(ser, "b64", 3);
+            n = serialize_bsequence_base64(ser, content, sz_content);
             MY_CHECK(n);
             break;
     }
 
-    return nr_written;
+    return 0;
 
 failed:
     return -1;
@@ -405,10 +496,25 @@ static inline UNUSED_FUNCTION bool equal_long_doubles(long double a,
 /* strlen of character literals resolved at compile time */
 #define static_strlen(string_literal) (sizeof(string_literal) - sizeof(""))
 
-static ssize_t
-serialize_number(purc_rwstream_t rws, double d, size_t *len_expected)
+/* Writes the decimal digits of an unsigned integer backwards from end;
+   returns the pointer to the first digit. */
+static inline char *u64_to_digits(uint64_t u, char *end)
+{
+    do {
+        *--end = '0' + (u % 10);
+        u /= 10;
+    } while (u);
+
+    return end;
+}
+
+/* Returns 1 if the number was serialized as an integer, 0 if it should
+   be serialized by serialize_double(), and -1 on failure. */
+static int
+serialize_number(struct serializer *ser, double d)
 {
     char buf[128];
+    const char *p = buf;
     int size;
 
     /* Although JSON RFC does not support
@@ -417,61 +523,81 @@ serialize_number(purc_rwstream_t rws, double d, size_t *len_expected)
      * how to handle these cases as strings
      */
     if (isnan(d)) {
-        strcpy(buf, "NaN");
+        p = "NaN";
         size = static_strlen("NaN");
     }
     else if (isinf(d)) {
         if (d > 0) {
-            strcpy(buf, "Infinity");
+            p = "Infinity";
             size = static_strlen("Infinity");
         }
         else {
-            strcpy(buf, "-Infinity");
+            p = "-Infinity";
             size = static_strlen("-Infinity");
         }
     }
     else {
-        double test;
-
-        /* try to format the double without decimals */
-        size = snprintf(buf, sizeof(buf), "%.0f", d);
-        if (size < 0 || size >= (int)sizeof(buf)) {
-            pcinst_set_error(PURC_ERROR_TOO_SMALL_BUFF);
-            return -1;
-        }
+        /* the integer which "%.0f" would produce */
+        double t = nearbyint(d);
 
         /* Check whether the original double can be recovered */
-        if ((sscanf(buf, "%lg", &test) != 1) || !equal_doubles(test, d)) {
+        if (!equal_doubles(t, d)) {
             /* If not, return 0 and call serialize_double */
             return 0;
         }
+
+        if (fabs(t) < 9223372036854775808.0 /* 2^63 */) {
+            int64_t i64 = (int64_t)t;
+            char *end = buf + sizeof(buf);
+            char *s;
+
+            s = u64_to_digits(i64 < 0 ? -(uint64_t)i64 : (uint64_t)i64, end);
+            if (signbit(t))     /* also for -0 */
+                *--s = '-';
+            p = s;
+            size = end - s;
+        }
+        else {
+            size = snprintf(buf, sizeof(buf), "%.0f", t);
+            if (size < 0 || size >= (int)sizeof(buf)) {
+                /* too long; use the scientific notation instead */
+                return 0;
+            }
+        }
     }
 
-    if (len_expected)
-        *len_expected += size;
-    return purc_rwstream_write(rws, buf, size);
+    MY_WRITE(ser, p, size);
+    return 1;
+
+failed:
+    return -1;
 }
 
-static ssize_t
-serialize_double(purc_rwstream_t rws, double d, int flags,
-        const char *format, size_t *len_expected)
+static int
+serialize_double(struct serializer *ser, double d)
 {
     char buf[128], *p, *q;
     int size;
 
-    static const char *std_format = "%.17g";
+    const char *format = ser->format_double;
     int format_drops_decimals = 0;
     int looks_numeric = 0;
 
     if (!format) {
-        format = std_format;
+        /* the shortest form which reads back to the same double */
+        size = (int)pcutils_dtoa_shortest(d, buf);
+        format_drops_decimals = 1;
     }
+    else {
+        size = snprintf(buf, sizeof(buf), format, d);
+        // although unlikely, snprintf might fail
+        if (UNLIKELY(size < 0)) {
+            pcinst_set_error(PURC_ERROR_OUTPUT);
+            return -1;
+        }
 
-    size = snprintf(buf, sizeof(buf), format, d);
-    // although unlikely, snprintf might fail
-    if (UNLIKELY(size < 0)) {
-        pcinst_set_error(PURC_ERROR_OUTPUT);
-        return -1;
+        if (strstr(format, ".0f") == NULL)
+            format_drops_decimals = 1;
     }
 
     p = strchr(buf, ',');
@@ -480,9 +606,6 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
     else
         p = strchr(buf, '.');
 
-    if (format == std_format || strstr(format, ".0f") == NULL)
-        format_drops_decimals = 1;
-
     looks_numeric = /* Looks like *some* kind of number */
         purc_isdigit((unsigned char)buf[0]) ||
         (size > 1 && buf[0] == '-' && purc_isdigit((unsigned char)buf[1]));
@@ -497,7 +620,7 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
         size += 2;
     }
 
-    if (p && (flags & PCVARIANT_SERIALIZE_OPT_NOZERO)) {
+    if (p && (ser->flags & PCVARIANT_SERIALIZE_OPT_NOZERO)) {
         /* last useful digit, always keep 1 zero */
         p++;
         for (q = p; *q; q++) {
@@ -515,14 +638,15 @@ serialize_double(purc_rwstream_t rws, double d, int flags,
         // but if a custom one happens to do so, just silently truncate.
         size = sizeof(buf) - 1;
 
-    if (len_expected)
-        *len_expected += size;
-    return purc_rwstream_write(rws, buf, size);
+    MY_WRITE(ser, buf, size);
+    return 0;
+
+failed:
+    return -1;
 }
 
-static ssize_t
-serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
-        const char *format, size_t *len_expected)
+static int
+serialize_long_double(struct serializer *ser, long double ld)
 {
     char buf[256], *p, *q;
     int size;
@@ -543,6 +667,7 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
     }
     else {
         static const char *std_format = "%.17Lg";
+        const char *format = ser->format_long_double;
         if (!format) {
             format = std_format;
         }
@@ -566,7 +691,7 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
         else
             p = strchr(buf, '.');
 
-        if (p && (flags & PCVARIANT_SERIALIZE_OPT_NOZERO)) {
+        if (p && (ser->flags & PCVARIANT_SERIALIZE_OPT_NOZERO)) {
             /* last useful digit, always keep 1 zero */
             p++;
             for (q = p; *q; q++) {
@@ -580,34 +705,30 @@ serialize_long_double(purc_rwstream_t rws, long double ld, int flags,
         }
 
         // append FL postfix
-        if (flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON) {
+        if (ser->flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON) {
             strcat(buf, "FL");
             size += 2;
         }
     }
 
-    if (len_expected)
-        *len_expected += size;
-    return purc_rwstream_write(rws, buf, size);
+    MY_WRITE(ser, buf, size);
+    return 0;
+
+failed:
+    return -1;
 }
 
-static ssize_t
-print_newline(purc_rwstream_t rws, unsigned int flags, size_t *len_expected)
+static inline int
+print_newline(struct serializer *ser)
 {
-    ssize_t nr_written = 0;
+    if (ser->flags & PCVARIANT_SERIALIZE_OPT_PRETTY)
+        return serializer_write(ser, "\n", 1);
 
-    if (flags & PCVARIANT_SERIALIZE_OPT_PRETTY) {
-        if (len_expected)
-            *len_expected += 1;
-        nr_written = purc_rwstream_write(rws, "\n", 1);
-    }
-
-    return nr_written;
+    return 0;
 }
 
-static ssize_t
-print_indent(purc_rwstream_t rws, int level, unsigned int flags,
-        size_t *len_expected)
+static int
+print_indent(struct serializer *ser, int level)
 {
     size_t n;
     char buff[MAX_EMBEDDED_LEVELS * 2];
@@ -615,8 +736,8 @@ print_indent(purc_rwstream_t rws, int level, unsigned int flags,
     if (level <= 0 || level > MAX_EMBEDDED_LEVELS)
         return 0;
 
-    if (flags & PCVARIANT_SERIALIZE_OPT_PRETTY) {
-        if (flags & PCVARIANT_SERIALIZE_OPT_PRETTY_TAB) {
+    if (ser->flags & PCVARIANT_SERIALIZE_OPT_PRETTY) {
+        if (ser->flags & PCVARIANT_SERIALIZE_OPT_PRETTY_TAB) {
             n = level;
             memset(buff, '\t', n);
         }
@@ -625,62 +746,44 @@ print_indent(purc_rwstream_t rws, int level, unsigned int flags,
             memset(buff, ' ', n);
         }
 
-        if (len_expected)
-            *len_expected += n;
-        return purc_rwstream_write(rws, buff, n);
+        return serializer_write(ser, buff, n);
     }
 
     return 0;
 }
 
-static inline ssize_t
-print_space(purc_rwstream_t rws, unsigned int flags, size_t* len_expected)
+static inline int
+print_space(struct serializer *ser)
 {
-    ssize_t nr_written = 0;
+    if (ser->flags & PCVARIANT_SERIALIZE_OPT_SPACED)
+        return serializer_write(ser, " ", 1);
 
-    if (flags & PCVARIANT_SERIALIZE_OPT_SPACED) {
-        if (len_expected)
-            *len_expected += 1;
-        nr_written = purc_rwstream_write(rws, " ", 1);
-    }
-
-    return nr_written;
+    return 0;
 }
 
-static inline ssize_t print_space_no_pretty(purc_rwstream_t rws,
-        unsigned int flags, size_t *len_expected)
+static inline int
+print_space_no_pretty(struct serializer *ser)
 {
-    ssize_t nr_written = 0;
+    if (ser->flags & PCVARIANT_SERIALIZE_OPT_SPACED &&
+            !(ser->flags & PCVARIANT_SERIALIZE_OPT_PRETTY))
+        return serializer_write(ser, " ", 1);
 
-    if (flags & PCVARIANT_SERIALIZE_OPT_SPACED &&
-            !(flags & PCVARIANT_SERIALIZE_OPT_PRETTY)) {
-        if (len_expected)
-            *len_expected += 1;
-        nr_written = purc_rwstream_write(rws, " ", 1);
-    }
-
-    return nr_written;
+    return 0;
 }
 
-ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
-        int level, unsigned int flags, size_t *len_expected)
+static int
+serialize_value(struct serializer *ser, purc_variant_t value, int level)
 {
-    ssize_t nr_written = 0, n;
+    unsigned int flags = ser->flags;
+    int n;
     const char* content = NULL;
     size_t sz_content = 0;
     size_t i, idx;
     char buff [256];
     purc_variant_t member = NULL;
     purc_variant_t key;
-    char* format_double = NULL;
-    char* format_long_double = NULL;
     variant_set_t data;
 
-    purc_get_local_data(PURC_LDNAME_FORMAT_DOUBLE,
-            (uintptr_t *)&format_double, NULL);
-    purc_get_local_data(PURC_LDNAME_FORMAT_LDOUBLE,
-            (uintptr_t *)&format_long_double, NULL);
-
     PC_ASSERT(value);
 
     switch (value->type) {
@@ -705,85 +808,62 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
             break;
 
         case PURC_VARIANT_TYPE_EXCEPTION:
+        case PURC_VARIANT_TYPE_ATOMSTRING:
             content = purc_atom_to_string(value->atom);
-            sz_content = strlen(content);
-            MY_WRITE(rws, "\"", 1);
-            n = serialize_string(rws, content, sz_content,
-                        flags, len_expected);
+            n = serialize_quoted_string(ser, content, strlen(content));
             MY_CHECK(n);
-            MY_WRITE(rws, "\"", 1);
 
             content = NULL;
             break;
 
         case PURC_VARIANT_TYPE_NUMBER:
             /* try to serialize the number as an integer first */
-            n = serialize_number(rws, value->d, len_expected);
+            n = serialize_number(ser, value->d);
             if (n < 0)
                 goto failed;
             if (n == 0) {
-                n = serialize_double(rws, value->d, flags,
-                        format_double, len_expected);
+                n = serialize_double(ser, value->d);
                 if (n < 0)
                     goto failed;
             }
-            nr_written += n;
 
             content = NULL;
             break;
 
         case PURC_VARIANT_TYPE_LONGINT:
         {
-            const char *format;
+            int64_t i64 = value->i64;
+            char *end = buff + sizeof(buff);
+            char *p;
+
+            p = u64_to_digits(i64 < 0 ? -(uint64_t)i64 : (uint64_t)i64, end);
+            if (i64 < 0)
+                *--p = '-';
+            MY_WRITE(ser, p, end - p);
             if (flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON)
-                format = "%lldL";
-            else
-                format = "%lld";
-
-            if (snprintf(buff, sizeof(buff), format,
-                        (long long int)value->i64) < 0)
-                goto failed;
-            content = buff;
-            // sz_content = strlen(buff);
+                MY_WRITE(ser, "L", 1);
             break;
         }
 
         case PURC_VARIANT_TYPE_ULONGINT:
         {
-            const char *format;
-            if (flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON)
-                format = "%lluUL";
-            else
-                format = "%llu";
+            char *end = buff + sizeof(buff);
+            char *p;
 
-            if (snprintf(buff, sizeof(buff), format,
-                        (long long unsigned)value->u64) < 0)
-                goto failed;
-            content = buff;
-            // sz_content = strlen(buff);
+            p = u64_to_digits(value->u64, end);
+            MY_WRITE(ser, p, end - p);
+            if (flags & PCVARIANT_SERIALIZE_OPT_REAL_EJSON)
+                MY_WRITE(ser, "UL", 2);
             break;
         }
 
         case PURC_VARIANT_TYPE_LONGDOUBLE:
-            n = serialize_long_double(rws, value->ld, flags,
-                    format_long_double, len_expected);
+            n = serialize_long_double(ser, value->ld);
             MY_CHECK(n);
 
             content = NULL;
             break;
 
-        case PURC_VARIANT_TYPE_ATOMSTRING:
-            content = purc_atom_to_string(value->atom);
-            sz_content = strlen(content);
-            MY_WRITE(rws, "\"", 1);
-            n = serialize_string(rws, content, sz_content,
-                        flags, len_expected);
-            MY_CHECK(n);
-            MY_WRITE(rws, "\"", 1);
-
-            content = NULL;
-            break;
-
         case PURC_VARIANT_TYPE_STRING:
         case PURC_VARIANT_TYPE_BSEQUENCE:
             if (value->flags & PCVARIANT_FLAG_STRING_STATIC) {
@@ -798,15 +878,10 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
                 content = (const char*)value->bytes;
                 sz_content = value->size;
             }
-            if (value->type == PURC_VARIANT_TYPE_STRING) {
-                MY_WRITE(rws, "\"", 1);
-                n = serialize_string(rws, content, sz_content - 1,
-                            flags, len_expected);
-                MY_WRITE(rws, "\"", 1);
-            }
+            if (value->type == PURC_VARIANT_TYPE_STRING)
+                n = serialize_quoted_string(ser, content, sz_content - 1);
             else
-                n = serialize_bsequence(rws, content, sz_content,
-                            flags, len_expected);
+                n = serialize_bsequence(ser, content, sz_content);
             MY_CHECK(n);
 
             content = NULL;
@@ -829,121 +904,117 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
         case PURC_VARIANT_TYPE_OBJECT:
             content = NULL;
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
-            MY_WRITE(rws, "{", 1);
-            n = print_newline(rws, flags, len_expected);
+            MY_WRITE(ser, "{", 1);
+            n = print_newline(ser);
             MY_CHECK(n);
 
             i = 0;
             foreach_key_value_in_variant_object(value, key, member)
                 if (i > 0) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
+                    MY_WRITE(ser, ",", 1);
+                    n = print_newline(ser);
                     MY_CHECK(n);
                 }
 
-                n = print_space_no_pretty(rws, flags, len_expected);
+                n = print_space_no_pretty(ser);
                 MY_CHECK(n);
 
-                n = print_indent(rws, level + 1, flags, len_expected);
+                n = print_indent(ser, level + 1);
                 MY_CHECK(n);
 
                 // key
-                MY_WRITE(rws, "\"", 1);
                 size_t len;
                 const char *ks = purc_variant_get_string_const_ex(key, &len);
                 assert(ks != NULL);
-                n = serialize_string(rws, ks, len, flags, len_expected);
+                n = serialize_quoted_string(ser, ks, len);
                 MY_CHECK(n);
-                MY_WRITE(rws, "\"", 1);
 
-                MY_WRITE(rws, ":", 1);
-                n = print_space(rws, flags, len_expected);
+                MY_WRITE(ser, ":", 1);
+                n = print_space(ser);
                 MY_CHECK(n);
 
                 // value
-                n = purc_variant_serialize(member,
-                        rws, level + 1, flags, len_expected);
+                n = serialize_value(ser, member, level + 1);
                 MY_CHECK(n);
 
                 i++;
             end_foreach;
 
             if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
+                n = print_newline(ser);
                 MY_CHECK(n);
             }
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
-            n = print_space_no_pretty(rws, flags, len_expected);
+            n = print_space_no_pretty(ser);
             MY_CHECK(n);
 
-            MY_WRITE(rws, "}", 1);
+            MY_WRITE(ser, "}", 1);
             break;
 
         case PURC_VARIANT_TYPE_ARRAY:
             content = NULL;
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
-            MY_WRITE(rws, "[", 1);
-            n = print_newline(rws, flags, len_expected);
+            MY_WRITE(ser, "[", 1);
+            n = print_newline(ser);
             MY_CHECK(n);
 
             i = 0;
             foreach_value_in_variant_array(value, member, idx)
                 (void)idx;
                 if (i > 0) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
+                    MY_WRITE(ser, ",", 1);
+                    n = print_newline(ser);
                     MY_CHECK(n);
                 }
 
-                n = print_space_no_pretty(rws, flags, len_expected);
+                n = print_space_no_pretty(ser);
                 MY_CHECK(n);
 
-                n = print_indent(rws, level + 1, flags, len_expected);
+                n = print_indent(ser, level + 1);
                 MY_CHECK(n);
 
                 // member
-                n = purc_variant_serialize(member,
-                        rws, level + 1, flags, len_expected);
+                n = serialize_value(ser, member, level + 1);
                 MY_CHECK(n);
 
                 i++;
             end_foreach;
 
             if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
+                n = print_newline(ser);
                 MY_CHECK(n);
             }
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
-            n = print_space_no_pretty(rws, flags, len_expected);
+            n = print_space_no_pretty(ser);
             MY_CHECK(n);
 
-            MY_WRITE(rws, "]", 1);
+            MY_WRITE(ser, "]", 1);
             break;
 
         case PURC_VARIANT_TYPE_SET:
             content = NULL;
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
             if (flags & PCVARIANT_SERIALIZE_OPT_UNIQKEYS)
-                MY_WRITE(rws, "[!", 2);
+                MY_WRITE(ser, "[!", 2);
             else
-                MY_WRITE(rws, "[", 1);
+                MY_WRITE(ser, "[", 1);
 
-            n = print_newline(rws, flags, len_expected);
+            n = print_newline(ser);
             MY_CHECK(n);
 
             if (flags & PCVARIANT_SERIALIZE_OPT_UNIQKEYS) {
@@ -952,8 +1023,8 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
                     for (size_t i=0; i<data->nr_keynames; ++i) {
                         const char *sk = data->keynames[i];
                         if (i>0)
-                            MY_WRITE(rws, " ", 1);
-                        MY_WRITE(rws, sk, strlen(sk));
+                            MY_WRITE(ser, " ", 1);
+                        MY_WRITE(ser, sk, strlen(sk));
                     }
                 }
             }
@@ -961,49 +1032,48 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
             i = 0;
             foreach_value_in_variant_set_order(value, member)
                 if (i > 0 || flags & PCVARIANT_SERIALIZE_OPT_UNIQKEYS) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
+                    MY_WRITE(ser, ",", 1);
+                    n = print_newline(ser);
                     MY_CHECK(n);
                 }
 
-                n = print_space_no_pretty(rws, flags, len_expected);
+                n = print_space_no_pretty(ser);
                 MY_CHECK(n);
 
-                n = print_indent(rws, level + 1, flags, len_expected);
+                n = print_indent(ser, level + 1);
                 MY_CHECK(n);
 
                 // member
-                n = purc_variant_serialize(member,
-                        rws, level + 1, flags, len_expected);
+                n = serialize_value(ser, member, level + 1);
                 MY_CHECK(n);
 
                 i++;
             end_foreach;
 
             if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
+                n = print_newline(ser);
                 MY_CHECK(n);
             }
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
-            n = print_space_no_pretty(rws, flags, len_expected);
+            n = print_space_no_pretty(ser);
             MY_CHECK(n);
 
-            MY_WRITE(rws, "]", 1);
+            MY_WRITE(ser, "]", 1);
             break;
 
         case PURC_VARIANT_TYPE_TUPLE:
         {
             content = NULL;
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
             /* TODO: might use '(' in the future. */
-            MY_WRITE(rws, "[", 1);
-            n = print_newline(rws, flags, len_expected);
+            MY_WRITE(ser, "[", 1);
+            n = print_newline(ser);
             MY_CHECK(n);
 
             i = 0;
@@ -1016,38 +1086,37 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
             for (idx = 0; idx < sz; idx++) {
 
                 if (i > 0) {
-                    MY_WRITE(rws, ",", 1);
-                    n = print_newline(rws, flags, len_expected);
+                    MY_WRITE(ser, ",", 1);
+                    n = print_newline(ser);
                     MY_CHECK(n);
                 }
 
-                n = print_space_no_pretty(rws, flags, len_expected);
+                n = print_space_no_pretty(ser);
                 MY_CHECK(n);
 
-                n = print_indent(rws, level + 1, flags, len_expected);
+                n = print_indent(ser, level + 1);
                 MY_CHECK(n);
 
                 // member
-                n = purc_variant_serialize(members[idx],
-                        rws, level + 1, flags, len_expected);
+                n = serialize_value(ser, members[idx], level + 1);
                 MY_CHECK(n);
 
                 i++;
             }
 
             if (i > 0) {
-                n = print_newline(rws, flags, len_expected);
+                n = print_newline(ser);
                 MY_CHECK(n);
             }
 
-            n = print_indent(rws, level, flags, len_expected);
+            n = print_indent(ser, level);
             MY_CHECK(n);
 
-            n = print_space_no_pretty(rws, flags, len_expected);
+            n = print_space_no_pretty(ser);
             MY_CHECK(n);
 
             /* TODO: might use ']' in the future. */
-            MY_WRITE(rws, "]", 1);
+            MY_WRITE(ser, "]", 1);
             break;
         }
 
@@ -1057,12 +1126,37 @@ ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
 
     if (content) {
         // for simple types
-        MY_WRITE(rws, content, strlen (content));
+        MY_WRITE(ser, content, strlen (content));
     }
 
-    return nr_written;
+    return 0;
 
 failed:
     return -1;
 }
 
+ssize_t purc_variant_serialize(purc_variant_t value, purc_rwstream_t rws,
+        int level, unsigned int flags, size_t *len_expected)
+{
+    struct serializer ser;
+
+    ser.rws = rws;
+    ser.flags = flags;
+    ser.len_expected = len_expected;
+    ser.format_double = NULL;
+    ser.format_long_double = NULL;
+    ser.nr_written = 0;
+    ser.nr_buffered = 0;
+
+    purc_get_local_data(PURC_LDNAME_FORMAT_DOUBLE,
+            (uintptr_t *)&ser.format_double, NULL);
+    purc_get_local_data(PURC_LDNAME_FORMAT_LDOUBLE,
+            (uintptr_t *)&ser.format_long_double, NULL);
+
+    PC_ASSERT(value);
+
+    if (serialize_value(&ser, value, level) || flush_buffer(&ser))
+        return -1;
+
+    return ser.nr_written;
+}
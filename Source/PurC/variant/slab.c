@@ -0,0 +1,429 @@
+/*
+ * @file slab.c
+ * @date 2026/10/16
+ * @brief The slab allocator for variant headers and container nodes.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "private/instance.h"
+#include "private/variant.h"
+#include "private/debug.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if OS(WINDOWS)
+#include <malloc.h>
+#endif
+
+/*
+ * Every instance owns a slab which carves the objects of a size class out
+ * of aligned pages, so the page of an object is found by masking its
+ * address. Only the owner instance touches the free list of a page.
+ *
+ * A variant may be released by another instance (a moved message, or a
+ * frozen variant shared by instances), or after the owner instance exits.
+ * Such objects are pushed onto the lock-free `remote` stack of the page,
+ * and the owner reclaims them in bulk when it runs out of free objects.
+ *
+ * When the owner exits, the pages still holding objects are orphaned:
+ * `remote` is tagged with REMOTE_ORPHANED, `live` counts the objects not
+ * returned yet, and the instance releasing the last one frees the page.
+ */
+
+#define SLAB_PAGE_SIZE          (16 * 1024)
+#define SLAB_PAGE_HDR_SIZE      128     /* keeps objects cache-line aligned */
+#define SLAB_CLASS_STEP         16
+#define SLAB_NR_CLASSES         PURC_VARIANT_NR_SLAB_CLASSES
+
+/* the empty pages kept by a slab; the pages beyond are returned to the
+   system allocator, which would otherwise trim and fault them in again
+   when an instance drops and rebuilds a large set of variants */
+#define SLAB_MAX_EMPTY_PAGES    512
+
+/* the number of full pages checked for remote frees before a new page */
+#define SLAB_MAX_FULL_SCAN      8
+
+#define REMOTE_ORPHANED         ((uintptr_t)1)
+
+struct slab_obj {
+    struct slab_obj        *next;
+};
+
+struct slab_page {
+    /* the owner slab; NULL once the owner instance exits */
+    struct pcvariant_slab  *slab;
+    struct list_head        ln;
+
+    /* the objects freed by the owner */
+    struct slab_obj        *free;
+    /* the objects never used; handed out lazily to keep RSS low */
+    char                   *bump;
+    char                   *end;
+
+    unsigned                cls;
+    unsigned                nr_used;
+    bool                    full;
+
+    /* the objects freed by others, or REMOTE_ORPHANED */
+    uintptr_t               remote;
+    /* the objects not returned yet after the page is orphaned */
+    size_t                  live;
+};
+
+struct slab_class {
+    size_t                  sz_obj;
+    size_t                  nr_objs;    /* per page */
+    size_t                  nr_used;
+    size_t                  nr_pages;
+
+    /* the pages which may have free objects; the first one is in use */
+    struct list_head        partial;
+    struct list_head        full;
+    struct list_head        empty;
+};
+
+struct pcvariant_slab {
+    struct slab_class       classes[SLAB_NR_CLASSES];
+    size_t                  nr_empty;
+};
+
+#define _COMPILE_TIME_ASSERT(name, x)               \
+       typedef int _dummy_ ## name[(x) * 2 - 1]
+
+_COMPILE_TIME_ASSERT(page_hdr, sizeof(struct slab_page) <= SLAB_PAGE_HDR_SIZE);
+_COMPILE_TIME_ASSERT(variant, sizeof(purc_variant) <= PCVARIANT_SLAB_MAX_SIZE);
+_COMPILE_TIME_ASSERT(obj_node,
+        sizeof(struct obj_node) <= PCVARIANT_SLAB_MAX_SIZE);
+_COMPILE_TIME_ASSERT(set_node,
+        sizeof(struct set_node) <= PCVARIANT_SLAB_MAX_SIZE);
+
+#undef _COMPILE_TIME_ASSERT
+
+static inline struct slab_page *page_of(void *ptr)
+{
+    return (struct slab_page *)
+        ((uintptr_t)ptr & ~(uintptr_t)(SLAB_PAGE_SIZE - 1));
+}
+
+static void page_delete(struct slab_page *page)
+{
+#if OS(WINDOWS)
+    _aligned_free(page);
+#else
+    free(page);
+#endif
+}
+
+static struct slab_page *
+page_new(struct pcvariant_slab *slab, struct slab_class *c, unsigned cls)
+{
+    void *mem;
+
+#if OS(WINDOWS)
+    mem = _aligned_malloc(SLAB_PAGE_SIZE, SLAB_PAGE_SIZE);
+#else
+    if (posix_memalign(&mem, SLAB_PAGE_SIZE, SLAB_PAGE_SIZE))
+        mem = NULL;
+#endif
+    if (mem == NULL)
+        return NULL;
+
+    struct slab_page *page = (struct slab_page *)mem;
+    page->slab = slab;
+    page->free = NULL;
+    page->bump = (char *)mem + SLAB_PAGE_HDR_SIZE;
+    page->end = page->bump + c->nr_objs * c->sz_obj;
+    page->cls = cls;
+    page->nr_used = 0;
+    page->full = false;
+    page->remote = 0;
+    page->live = 0;
+
+    c->nr_pages++;
+    return page;
+}
+
+static inline void *page_pop(struct slab_page *page, size_t sz_obj)
+{
+    struct slab_obj *obj = page->free;
+
+    if (obj) {
+        page->free = obj->next;
+    }
+    else if (page->bump < page->end) {
+        obj = (struct slab_obj *)page->bump;
+        page->bump += sz_obj;
+    }
+    else {
+        return NULL;
+    }
+
+    page->nr_used++;
+    return obj;
+}
+
+/* move the objects freed by others to the local free list */
+static size_t page_collect_remote(struct slab_class *c, struct slab_page *page)
+{
+    if (__atomic_load_n(&page->remote, __ATOMIC_RELAXED) == 0)
+        return 0;
+
+    struct slab_obj *obj = (struct slab_obj *)
+        __atomic_exchange_n(&page->remote, 0, __ATOMIC_ACQUIRE);
+    size_t n = 0;
+
+    while (obj) {
+        struct slab_obj *next = obj->next;
+        obj->next = page->free;
+        page->free = obj;
+        obj = next;
+        n++;
+    }
+
+    page->nr_used -= n;
+    c->nr_used -= n;
+    return n;
+}
+
+/* hand the page over to the instances releasing its remaining objects */
+static void page_orphan(struct slab_page *page)
+{
+    __atomic_store_n(&page->slab, NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&page->live, page->nr_used, __ATOMIC_RELAXED);
+
+    struct slab_obj *obj = (struct slab_obj *)
+        __atomic_exchange_n(&page->remote, REMOTE_ORPHANED, __ATOMIC_ACQ_REL);
+    size_t n = 0;
+
+    while (obj) {
+        obj = obj->next;
+        n++;
+    }
+
+    if (n && __atomic_sub_fetch(&page->live, n, __ATOMIC_ACQ_REL) == 0)
+        page_delete(page);
+}
+
+static void *slab_alloc(struct pcvariant_slab *slab, unsigned cls)
+{
+    struct slab_class *c = slab->classes + cls;
+    struct slab_page *page;
+    void *obj;
+
+again:
+    while (!list_empty(&c->partial)) {
+        page = list_first_entry(&c->partial, struct slab_page, ln);
+        obj = page_pop(page, c->sz_obj);
+        if (obj == NULL && page_collect_remote(c, page))
+            obj = page_pop(page, c->sz_obj);
+
+        if (obj) {
+            c->nr_used++;
+            return obj;
+        }
+
+        page->full = true;
+        list_move_tail(&page->ln, &c->full);
+    }
+
+    for (size_t i = 0; i < SLAB_MAX_FULL_SCAN && i < c->nr_pages &&
+            !list_empty(&c->full); i++) {
+        page = list_first_entry(&c->full, struct slab_page, ln);
+        if (page_collect_remote(c, page)) {
+            page->full = false;
+            list_move(&page->ln, &c->partial);
+            goto again;
+        }
+
+        list_move_tail(&page->ln, &c->full);
+    }
+
+    if (!list_empty(&c->empty)) {
+        page = list_first_entry(&c->empty, struct slab_page, ln);
+        list_del(&page->ln);
+        slab->nr_empty--;
+    }
+    else {
+        page = page_new(slab, c, cls);
+        if (page == NULL)
+            return NULL;
+    }
+
+    list_add(&page->ln, &c->partial);
+    obj = page_pop(page, c->sz_obj);
+    c->nr_used++;
+    return obj;
+}
+
+static void
+slab_free_local(struct pcvariant_slab *slab, struct slab_page *page,
+        struct slab_obj *obj)
+{
+    struct slab_class *c = slab->classes + page->cls;
+
+    obj->next = page->free;
+    page->free = obj;
+    page->nr_used--;
+    c->nr_used--;
+
+    if (page->full) {
+        page->full = false;
+        list_move(&page->ln, &c->partial);
+    }
+
+    /* the objects on the remote stack are still counted in nr_used,
+       so the stack is empty here */
+    if (page->nr_used == 0) {
+        if (slab->nr_empty < SLAB_MAX_EMPTY_PAGES) {
+            list_move(&page->ln, &c->empty);
+            slab->nr_empty++;
+        }
+        else {
+            list_del(&page->ln);
+            c->nr_pages--;
+            page_delete(page);
+        }
+    }
+}
+
+static void slab_free_remote(struct slab_page *page, struct slab_obj *obj)
+{
+    uintptr_t head = __atomic_load_n(&page->remote, __ATOMIC_ACQUIRE);
+
+    do {
+        if (head == REMOTE_ORPHANED) {
+            if (__atomic_sub_fetch(&page->live, 1, __ATOMIC_ACQ_REL) == 0)
+                page_delete(page);
+            return;
+        }
+
+        obj->next = (struct slab_obj *)head;
+    } while (!__atomic_compare_exchange_n(&page->remote, &head,
+                (uintptr_t)obj, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+}
+
+static inline struct pcvariant_slab *current_slab(void)
+{
+    struct pcinst *inst = pcinst_current();
+    return (inst && inst->org_vrt_heap) ? inst->org_vrt_heap->slab : NULL;
+}
+
+void *pcvariant_slab_alloc(size_t size)
+{
+    PC_ASSERT(size > 0 && size <= PCVARIANT_SLAB_MAX_SIZE);
+
+    struct pcvariant_slab *slab = current_slab();
+    if (slab == NULL)
+        return NULL;
+
+    return slab_alloc(slab, (unsigned)((size - 1) / SLAB_CLASS_STEP));
+}
+
+void *pcvariant_slab_alloc_0(size_t size)
+{
+    void *obj = pcvariant_slab_alloc(size);
+    if (obj)
+        memset(obj, 0, size);
+    return obj;
+}
+
+void pcvariant_slab_free(void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    struct slab_page *page = page_of(ptr);
+    struct pcvariant_slab *slab = current_slab();
+
+    if (slab && __atomic_load_n(&page->slab, __ATOMIC_RELAXED) == slab)
+        slab_free_local(slab, page, (struct slab_obj *)ptr);
+    else
+        slab_free_remote(page, (struct slab_obj *)ptr);
+}
+
+struct pcvariant_slab *pcvariant_slab_new(void)
+{
+    struct pcvariant_slab *slab = calloc(1, sizeof(*slab));
+    if (slab == NULL)
+        return NULL;
+
+    for (unsigned i = 0; i < SLAB_NR_CLASSES; i++) {
+        struct slab_class *c = slab->classes + i;
+
+        c->sz_obj = (i + 1) * SLAB_CLASS_STEP;
+        c->nr_objs = (SLAB_PAGE_SIZE - SLAB_PAGE_HDR_SIZE) / c->sz_obj;
+        list_head_init(&c->partial);
+        list_head_init(&c->full);
+        list_head_init(&c->empty);
+    }
+
+    return slab;
+}
+
+static void release_pages(struct slab_class *c, struct list_head *pages)
+{
+    struct slab_page *page, *n;
+
+    list_for_each_entry_safe(page, n, pages, ln) {
+        list_del(&page->ln);
+
+        page_collect_remote(c, page);
+        if (page->nr_used == 0) {
+            page_delete(page);
+        }
+        else {
+            PC_DEBUG("Orphan a slab page of %u-byte objects with %u in use\n",
+                    (unsigned)c->sz_obj, page->nr_used);
+            page_orphan(page);
+        }
+    }
+}
+
+void pcvariant_slab_delete(struct pcvariant_slab *slab)
+{
+    for (unsigned i = 0; i < SLAB_NR_CLASSES; i++) {
+        struct slab_class *c = slab->classes + i;
+
+        release_pages(c, &c->partial);
+        release_pages(c, &c->full);
+        release_pages(c, &c->empty);
+    }
+
+    free(slab);
+}
+
+void pcvariant_slab_stat(struct pcvariant_slab *slab,
+        struct purc_variant_stat *stat)
+{
+    stat->sz_slab_mem = 0;
+
+    for (unsigned i = 0; i < SLAB_NR_CLASSES; i++) {
+        struct slab_class *c = slab->classes + i;
+        struct purc_variant_slab_stat *s = stat->slab + i;
+
+        s->sz_obj = c->sz_obj;
+        s->nr_used = c->nr_used;
+        s->nr_free = c->nr_pages * c->nr_objs - c->nr_used;
+        s->nr_pages = c->nr_pages;
+        stat->sz_slab_mem += c->nr_pages * SLAB_PAGE_SIZE;
+    }
+}
@@ -39,8 +39,91 @@
 static size_t
 variant_arr_length(variant_arr_t data)
 {
-    struct pcutils_array_list *al = &data->al;
-    return pcutils_array_list_length(al);
+    return data->nr;
+}
+
+/* make room for at least nr members */
+static int
+variant_arr_reserve(variant_arr_t data, size_t nr)
+{
+    if (nr <= data->sz)
+        return 0;
+
+    size_t sz = data->sz ? data->sz : PCVARIANT_ARR_MIN_SIZE;
+    while (sz < nr)
+        sz *= 2;
+
+    purc_variant_t *vals;
+    vals = (purc_variant_t *)realloc(data->vals, sz * sizeof(*vals));
+    if (!vals) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+    data->vals = vals;
+
+    if (data->edge_keys) {
+        uintptr_t *keys;
+        keys = (uintptr_t *)realloc(data->edge_keys, sz * sizeof(*keys));
+        if (!keys) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        data->edge_keys = keys;
+    }
+
+    data->sz = sz;
+    return 0;
+}
+
+static int
+variant_arr_make_edge_keys(variant_arr_t data)
+{
+    if (data->edge_keys || data->sz == 0)
+        return 0;
+
+    uintptr_t *keys = (uintptr_t *)malloc(data->sz * sizeof(*keys));
+    if (!keys) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    for (size_t i = 0; i < data->nr; i++)
+        keys[i] = pcvar_new_edge_key();
+    data->edge_keys = keys;
+    return 0;
+}
+
+static void
+variant_arr_insert_slot(variant_arr_t data, size_t idx, purc_variant_t val)
+{
+    PC_ASSERT(data->nr < data->sz && idx <= data->nr);
+
+    size_t n = data->nr - idx;
+    memmove(data->vals + idx + 1, data->vals + idx, n * sizeof(*data->vals));
+    data->vals[idx] = val;
+
+    if (data->edge_keys) {
+        memmove(data->edge_keys + idx + 1, data->edge_keys + idx,
+                n * sizeof(*data->edge_keys));
+        data->edge_keys[idx] = pcvar_new_edge_key();
+    }
+
+    data->nr++;
+}
+
+static void
+variant_arr_remove_slot(variant_arr_t data, size_t idx)
+{
+    PC_ASSERT(idx < data->nr);
+
+    size_t n = data->nr - idx - 1;
+    memmove(data->vals + idx, data->vals + idx + 1, n * sizeof(*data->vals));
+    if (data->edge_keys) {
+        memmove(data->edge_keys + idx, data->edge_keys + idx + 1,
+                n * sizeof(*data->edge_keys));
+    }
+
+    data->nr--;
 }
 
 static inline bool
@@ -130,50 +213,22 @@ pcvar_arr_get_data(purc_variant_t arr)
 }
 
 static void
-break_rev_update_chain(purc_variant_t arr, struct arr_node *node)
+break_rev_update_chain(purc_variant_t arr, size_t idx)
 {
-    struct pcvar_rev_update_edge edge = {
-        .parent        = arr,
-        .arr_me        = node,
-    };
-
-    pcvar_break_edge_to_parent(node->val, &edge);
-    pcvar_break_rue_downward(node->val);
-}
-
-static void
-arr_node_release(purc_variant_t arr, struct arr_node *node)
-{
-    if (!node)
-        return;
-
-    break_rev_update_chain(arr, node);
-
-    if (node->node.idx != (size_t)-1) {
-        variant_arr_t data = pcvar_arr_get_data(arr);
-        PC_ASSERT(data);
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    purc_variant_t val = data->vals[idx];
 
-        struct pcutils_array_list *al = &data->al;
-        PC_ASSERT(al);
+    // no edge to break if the array has never belonged to a set
+    if (data->edge_keys) {
+        struct pcvar_rev_update_edge edge = {
+            .parent        = arr,
+            .arr_me        = (void *)data->edge_keys[idx],
+        };
 
-        struct pcutils_array_list_node *p;
-        int r = pcutils_array_list_remove(al, node->node.idx, &p);
-        PC_ASSERT(r == 0);
-        PC_ASSERT(&node->node == p);
-        PC_ASSERT(node->node.idx == (size_t)-1);
+        pcvar_break_edge_to_parent(val, &edge);
     }
 
-    PURC_VARIANT_SAFE_CLEAR(node->val);
-}
-
-static void
-arr_node_destroy(purc_variant_t arr, struct arr_node *node)
-{
-    if (!node)
-        return;
-
-    arr_node_release(arr, node);
-    free(node);
+    pcvar_break_rue_downward(val);
 }
 
 static purc_variant_t
@@ -186,45 +241,35 @@ variant_arr_make_pos(variant_arr_t data, size_t idx)
     return purc_variant_make_longint(idx);
 }
 
-static struct arr_node*
-arr_node_create(purc_variant_t val)
-{
-    struct arr_node *node;
-    node = (struct arr_node*)calloc(1, sizeof(*node));
-    if (!node) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return NULL;
-    }
-
-    node->node.idx = (size_t)-1;
-
-    node->val = val;
-    purc_variant_ref(val);
-
-    return node;
-}
-
 static int
-build_rev_update_chain(purc_variant_t arr, struct arr_node *node)
+build_edge(purc_variant_t arr, size_t idx)
 {
-    if (!pcvar_container_belongs_to_set(arr))
-        return 0;
-
-    int r;
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (variant_arr_make_edge_keys(data))
+        return -1;
 
     struct pcvar_rev_update_edge edge = {
         .parent        = arr,
-        .arr_me        = node,
+        .arr_me        = (void *)data->edge_keys[idx],
     };
 
-    r = pcvar_build_edge_to_parent(node->val, &edge);
+    int r = pcvar_build_edge_to_parent(data->vals[idx], &edge);
     if (r == 0) {
-        r = pcvar_build_rue_downward(node->val);
+        r = pcvar_build_rue_downward(data->vals[idx]);
     }
 
     return r ? -1 : 0;
 }
 
+static int
+build_rev_update_chain(purc_variant_t arr, size_t idx)
+{
+    if (!pcvar_container_belongs_to_set(arr))
+        return 0;
+
+    return build_edge(arr, idx);
+}
+
 static int
 check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
 {
@@ -240,7 +285,11 @@ check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
         size_t i;
         purc_variant_t v;
         foreach_value_in_variant_array(arr, v, i) {
-            PC_ASSERT(i < idx);
+            if (i == idx) {
+                r = pcvar_arr_append(_new, val);
+                if (r)
+                    break;
+            }
             r = pcvar_arr_append(_new, v);
             if (r)
                 break;
@@ -249,9 +298,11 @@ check_grow(purc_variant_t arr, size_t idx, purc_variant_t val)
         if (r)
             break;
 
-        r = pcvar_arr_append(_new, val);
-        if (r)
-            break;
+        if (idx >= variant_arr_length(pcvar_arr_get_data(arr))) {
+            r = pcvar_arr_append(_new, val);
+            if (r)
+                break;
+        }
 
         int r = pcvar_reverse_check(arr, _new);
         if (r)
@@ -278,18 +329,17 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
     variant_arr_t data = pcvar_arr_get_data(arr);
     PC_ASSERT(data);
 
-    struct pcutils_array_list *al = &data->al;
-    PC_ASSERT(al);
-
-    size_t nr = pcutils_array_list_length(al);
-    if (idx > nr)
-        idx = nr;
+    if (idx > data->nr)
+        idx = data->nr;
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
-        return -1;
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (check) {
+        pos = variant_arr_make_pos(data, idx);
+        if (pos == PURC_VARIANT_INVALID)
+            return -1;
+    }
 
-    struct arr_node *node = NULL;
+    bool inserted = false;
 
     do {
         if (check) {
@@ -300,35 +350,31 @@ variant_arr_insert_before(purc_variant_t arr, size_t idx, purc_variant_t val,
                 break;
         }
 
-        node = arr_node_create(val);
-        if (!node)
+        if (variant_arr_reserve(data, data->nr + 1))
             break;
 
-        int r;
-        PC_ASSERT(node->node.idx == (size_t)-1);
-        r = pcutils_array_list_insert_before(al, idx, &node->node);
-        if (r) {
-            PC_ASSERT(node->node.idx == (size_t)-1);
-            purc_set_error(PURC_ERROR_OUT_OF_MEMORY);
-            break;
-        }
-        PC_ASSERT(node->node.idx != (size_t)-1);
+        variant_arr_insert_slot(data, idx, purc_variant_ref(val));
+        inserted = true;
 
         if (check) {
-            if (build_rev_update_chain(arr, node))
+            if (build_rev_update_chain(arr, idx))
                 break;
 
             pcvar_adjust_set_by_descendant(arr);
             grown(arr, pos, val, check);
         }
 
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    arr_node_destroy(arr, node);
-    purc_variant_unref(pos);
+    if (inserted) {
+        break_rev_update_chain(arr, idx);
+        variant_arr_remove_slot(data, idx);
+        purc_variant_unref(val);
+    }
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
@@ -340,9 +386,9 @@ refresh_extra(purc_variant_t arr)
     variant_arr_t data = pcvar_arr_get_data(arr);
     if (data) {
         extra += sizeof(*data);
-        struct pcutils_array_list *al = &data->al;
-        extra += al->sz * sizeof(*al->nodes);
-        extra += al->nr * sizeof(struct arr_node);
+        extra += data->sz * sizeof(*data->vals);
+        if (data->edge_keys)
+            extra += data->sz * sizeof(*data->edge_keys);
     }
     pcvariant_stat_set_extra_size(arr, extra);
 }
@@ -352,9 +398,7 @@ variant_arr_append(purc_variant_t arr, purc_variant_t val,
         bool check)
 {
     variant_arr_t data = pcvar_arr_get_data(arr);
-    struct pcutils_array_list *al = &data->al;
-    size_t nr = pcutils_array_list_length(al);
-    int r = variant_arr_insert_before(arr, nr, val, check);
+    int r = variant_arr_insert_before(arr, data->nr, val, check);
     refresh_extra(arr);
     return r ? -1 : 0;
 }
@@ -369,19 +413,14 @@ variant_arr_prepend(purc_variant_t arr, purc_variant_t val,
 static purc_variant_t
 variant_arr_get(variant_arr_t data, size_t idx)
 {
-    struct pcutils_array_list *al = &data->al;
-    struct pcutils_array_list_node *p;
-    p = pcutils_array_list_get(al, idx);
-    if (p == NULL)
+    if (idx >= data->nr)
         return PURC_VARIANT_INVALID;
 
-    struct arr_node *node;
-    node = (struct arr_node*)container_of(p, struct arr_node, node);
-    return node->val;
+    return data->vals[idx];
 }
 
 static int
-check_change(purc_variant_t arr, struct arr_node *node, purc_variant_t val)
+check_change(purc_variant_t arr, size_t idx, purc_variant_t val)
 {
     if (!pcvar_container_belongs_to_set(arr))
         return 0;
@@ -396,10 +435,10 @@ check_change(purc_variant_t arr, struct arr_node *node, purc_variant_t val)
         size_t i;
         purc_variant_t v;
         foreach_value_in_variant_array(arr, v, i) {
-            if (i == node->node.idx) {
+            if (i == idx) {
                 found = true;
             }
-            r = pcvar_arr_append(_new, i == node->node.idx ? val : v);
+            r = pcvar_arr_append(_new, i == idx ? val : v);
             if (r)
                 break;
         } end_foreach;
@@ -429,54 +468,46 @@ variant_arr_set(purc_variant_t arr, size_t idx, purc_variant_t val,
     variant_arr_t data = pcvar_arr_get_data(arr);
     PC_ASSERT(data);
 
-    struct pcutils_array_list *al = &data->al;
-    PC_ASSERT(al);
-
-    size_t nr = pcutils_array_list_length(al);
-    if (idx >= nr) {
+    if (idx >= data->nr) {
         purc_set_error(PURC_ERROR_OVERFLOW);
         return -1;
     }
 
-    struct pcutils_array_list_node *p;
-    p = pcutils_array_list_get(al, idx);
-    PC_ASSERT(p);
-
-    struct arr_node *old_node;
-    old_node = (struct arr_node*)container_of(p, struct arr_node, node);
-    PC_ASSERT(old_node->val != PURC_VARIANT_INVALID);
-    if (old_node->val == val) {
+    purc_variant_t old = data->vals[idx];
+    PC_ASSERT(old != PURC_VARIANT_INVALID);
+    if (old == val) {
         // NOTE: keep refc intact
         return 0;
     }
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
-        return -1;
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (check) {
+        pos = variant_arr_make_pos(data, idx);
+        if (pos == PURC_VARIANT_INVALID)
+            return -1;
+    }
 
     do {
-        purc_variant_t old = old_node->val;
-
         if (check) {
             if (!change(arr, pos, old, val, check))
                 break;
 
-            if (check_change(arr, old_node, val))
+            if (check_change(arr, idx, val))
                 break;
 
-            old_node->val = val;
+            data->vals[idx] = val;
 
-            if (build_rev_update_chain(arr, old_node)) {
-                break_rev_update_chain(arr, old_node);
-                old_node->val = old;
+            if (build_rev_update_chain(arr, idx)) {
+                break_rev_update_chain(arr, idx);
+                data->vals[idx] = old;
                 break;
             }
 
-            old_node->val = old;
-            break_rev_update_chain(arr, old_node);
+            data->vals[idx] = old;
+            break_rev_update_chain(arr, idx);
         }
 
-        old_node->val = purc_variant_ref(val);
+        data->vals[idx] = purc_variant_ref(val);
 
         if (check) {
             pcvar_adjust_set_by_descendant(arr);
@@ -485,18 +516,18 @@ variant_arr_set(purc_variant_t arr, size_t idx, purc_variant_t val,
         }
 
         purc_variant_unref(old);
-        purc_variant_unref(pos);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
 
 static int
-check_shrink(purc_variant_t arr, struct arr_node *node)
+check_shrink(purc_variant_t arr, size_t idx)
 {
     if (!pcvar_container_belongs_to_set(arr))
         return 0;
@@ -511,7 +542,7 @@ check_shrink(purc_variant_t arr, struct arr_node *node)
         size_t i;
         purc_variant_t v;
         foreach_value_in_variant_array(arr, v, i) {
-            if (i == node->node.idx) {
+            if (i == idx) {
                 PC_ASSERT(!found);
                 found = true;
                 continue;
@@ -546,57 +577,46 @@ variant_arr_remove(purc_variant_t arr, size_t idx,
     variant_arr_t data = pcvar_arr_get_data(arr);
     PC_ASSERT(data);
 
-    struct pcutils_array_list *al = &data->al;
-    PC_ASSERT(al);
-
-    size_t nr = pcutils_array_list_length(al);
-    if (idx >= nr) {
+    if (idx >= data->nr) {
         // FIXME: failure or success???
         return 0;
     }
 
-    purc_variant_t pos = variant_arr_make_pos(data, idx);
-    if (pos == PURC_VARIANT_INVALID)
-        return -1;
-
-    struct pcutils_array_list_node *p, *n;
-    p = pcutils_array_list_get(al, idx);
-    PC_ASSERT(p);
+    purc_variant_t pos = PURC_VARIANT_INVALID;
+    if (check) {
+        pos = variant_arr_make_pos(data, idx);
+        if (pos == PURC_VARIANT_INVALID)
+            return -1;
+    }
 
-    struct arr_node *node;
-    node = (struct arr_node*)container_of(p, struct arr_node, node);
-    PC_ASSERT(node->val);
+    purc_variant_t val = data->vals[idx];
+    PC_ASSERT(val);
 
     do {
         if (check) {
-            if (!shrink(arr, pos, node->val, check))
+            if (!shrink(arr, pos, val, check))
                 break;
 
-            if (check_shrink(arr, node))
+            if (check_shrink(arr, idx))
                 break;
-
-            break_rev_update_chain(arr, node);
         }
 
-        PC_ASSERT(node->node.idx != (size_t)-1);
-        int r = pcutils_array_list_remove(al, idx, &n);
-        PC_ASSERT(r == 0);
-        PC_ASSERT(&node->node == n);
-        PC_ASSERT(node->node.idx == (size_t)-1);
+        break_rev_update_chain(arr, idx);
+        variant_arr_remove_slot(data, idx);
 
         if (check) {
             pcvar_adjust_set_by_descendant(arr);
 
-            shrunk(arr, pos, node->val, check);
+            shrunk(arr, pos, val, check);
         }
 
-        arr_node_destroy(arr, node);
-        purc_variant_unref(pos);
+        purc_variant_unref(val);
+        PURC_VARIANT_SAFE_CLEAR(pos);
 
         return 0;
     } while (0);
 
-    purc_variant_unref(pos);
+    PURC_VARIANT_SAFE_CLEAR(pos);
 
     return -1;
 }
@@ -608,13 +628,16 @@ array_release (purc_variant_t arr)
     if (!data)
         return;
 
-    struct pcutils_array_list *al = &data->al;
-    struct arr_node *p, *n;
-    array_list_for_each_entry_reverse_safe(al, p, n, node) {
-        arr_node_destroy(arr, p);
-    };
+    while (data->nr > 0) {
+        size_t idx = data->nr - 1;
+        purc_variant_t val = data->vals[idx];
+        break_rev_update_chain(arr, idx);
+        data->nr--;
+        purc_variant_unref(val);
+    }
 
-    pcutils_array_list_reset(al);
+    free(data->vals);
+    free(data->edge_keys);
 
     if (data->rev_update_chain) {
         pcvar_destroy_rev_update_chain(data->rev_update_chain);
@@ -640,23 +663,15 @@ make_array(size_t sz)
         var->flags         = PCVARIANT_FLAG_EXTRA_SIZE;
         var->refc          = 1;
 
-        size_t initial_size = ARRAY_LIST_DEFAULT_SIZE;
-        if (sz>initial_size)
-            initial_size = sz;
-
         variant_arr_t data = (variant_arr_t)calloc(1, sizeof(*data));
         if (!data) {
             pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             break;
         }
 
-        struct pcutils_array_list *al;
-        al = &data->al;
-        pcutils_array_list_init(al);
-        if (pcutils_array_list_expand(al, initial_size)) {
-            pcutils_array_list_reset(al);
+        // the storage of an empty array is allocated on the first member
+        if (sz > 0 && variant_arr_reserve(data, sz)) {
             free(data);
-            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
             break;
         }
 
@@ -863,35 +878,53 @@ bool purc_variant_array_insert_after (purc_variant_t arr, int idx,
     return purc_variant_array_insert_before(arr, idx+1, value);
 }
 
+/* reorders the members (and their edge keys) as given by idx */
+static int
+variant_arr_permute(variant_arr_t data, const size_t *idx)
+{
+    purc_variant_t *vals;
+    vals = (purc_variant_t *)malloc(data->sz * sizeof(*vals));
+    uintptr_t *keys = NULL;
+    if (vals && data->edge_keys)
+        keys = (uintptr_t *)malloc(data->sz * sizeof(*keys));
+    if (!vals || (data->edge_keys && !keys)) {
+        free(vals);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    for (size_t i = 0; i < data->nr; i++)
+        vals[i] = data->vals[idx[i]];
+    free(data->vals);
+    data->vals = vals;
+
+    if (keys) {
+        for (size_t i = 0; i < data->nr; i++)
+            keys[i] = data->edge_keys[idx[i]];
+        free(data->edge_keys);
+        data->edge_keys = keys;
+    }
+
+    return 0;
+}
+
 struct arr_user_data {
     int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud);
     void *ud;
+    const purc_variant_t *vals;
 };
 
-static int
-sort_cmp(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
-        void *ud)
+#if OS(HURD) || OS(LINUX)
+static int sort_cmp(const void *l, const void *r, void *ud)
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD) || OS(WINDOWS)
+static int sort_cmp(void *ud, const void *l, const void *r)
+#else
+#error Unsupported operating system.
+#endif
 {
-    struct arr_node *l_n, *r_n;
-    l_n = container_of(l, struct arr_node, node);
-    r_n = container_of(r, struct arr_node, node);
-
     struct arr_user_data *d = (struct arr_user_data*)ud;
-    return d->cmp(l_n->val, r_n->val, d->ud);
-}
-
-static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
-{
-    uintptr_t sort_flags;
-    purc_vrtcmp_opt_t cmpopt;
-
-    sort_flags = (uintptr_t)ud;
-    cmpopt = (purc_vrtcmp_opt_t)(sort_flags & PCVARIANT_CMPOPT_MASK);
-
-    int retv = purc_variant_compare_ex(l, r, cmpopt);
-    if (sort_flags & PCVARIANT_SORT_DESC)
-        retv = -retv;
-    return retv;
+    return d->cmp(d->vals[*(const size_t *)l], d->vals[*(const size_t *)r],
+            d->ud);
 }
 
 int pcvariant_array_sort(purc_variant_t arr, void *ud,
@@ -900,18 +933,86 @@ int pcvariant_array_sort(purc_variant_t arr, void *ud,
     if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
         return -1;
 
+    /* the default comparison stringifies the values: do it only once */
+    if (cmp == NULL) {
+        return pcvariant_array_sort_by_keys(arr, ud, &pcvar_cmpopt_sort_ops);
+    }
+
     variant_arr_t data = pcvar_arr_get_data(arr);
+    if (data->nr < 2)
+        return 0;
+
+    size_t *idx = (size_t *)malloc(data->nr * sizeof(*idx));
+    if (!idx) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    for (size_t i = 0; i < data->nr; i++)
+        idx[i] = i;
 
     struct arr_user_data d = {
-        .cmp = cmp,
-        .ud  = ud,
+        .cmp  = cmp,
+        .ud   = ud,
+        .vals = data->vals,
     };
 
-    if (d.cmp == NULL) {
-        d.cmp = vrtcmp;
+#if OS(HURD) || OS(LINUX)
+    qsort_r(idx, data->nr, sizeof(*idx), sort_cmp, &d);
+#elif OS(DARWIN) || OS(FREEBSD) || OS(NETBSD) || OS(OPENBSD)
+    qsort_r(idx, data->nr, sizeof(*idx), &d, sort_cmp);
+#elif OS(WINDOWS)
+    qsort_s(idx, data->nr, sizeof(*idx), sort_cmp, &d);
+#endif
+
+    int r = variant_arr_permute(data, idx);
+    free(idx);
+
+    return r;
+}
+
+int pcvariant_array_sort_by_keys(purc_variant_t arr, void *ud,
+        const struct pcvariant_sort_ops *ops)
+{
+    if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
+        return -1;
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (data->nr < 2)
+        return 0;
+
+    size_t *idx = (size_t *)malloc(data->nr * sizeof(*idx));
+    if (!idx) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
     }
 
-    pcutils_array_list_sort(&data->al, &d, sort_cmp);
+    int r = pcvar_sort_vals_by_keys(data->vals, data->nr, ud, ops, idx);
+    if (r == 0)
+        r = variant_arr_permute(data, idx);
+    free(idx);
+
+    return r;
+}
+
+int pcvariant_array_swap(purc_variant_t arr, size_t i, size_t j)
+{
+    if (!arr || arr->type != PURC_VARIANT_TYPE_ARRAY)
+        return -1;
+
+    variant_arr_t data = pcvar_arr_get_data(arr);
+    if (i >= data->nr || j >= data->nr)
+        return -1;
+
+    purc_variant_t v = data->vals[i];
+    data->vals[i] = data->vals[j];
+    data->vals[j] = v;
+
+    if (data->edge_keys) {
+        uintptr_t k = data->edge_keys[i];
+        data->edge_keys[i] = data->edge_keys[j];
+        data->edge_keys[j] = k;
+    }
 
     return 0;
 }
@@ -961,15 +1062,13 @@ pcvar_array_break_rue_downward(purc_variant_t arr)
     if (!data)
         return;
 
-    struct arr_node *p;
-    foreach_in_variant_array(arr, p) {
-        struct pcvar_rev_update_edge edge = {
-            .parent         = arr,
-            .arr_me         = p,
-        };
-        pcvar_break_edge_to_parent(p->val, &edge);
-        pcvar_break_rue_downward(p->val);
-    }
+    for (size_t i = 0; i < data->nr; i++)
+        break_rev_update_chain(arr, i);
+
+    // the edge keys are made again once the array joins a set
+    free(data->edge_keys);
+    data->edge_keys = NULL;
+    refresh_extra(arr);
 }
 
 void
@@ -996,20 +1095,12 @@ pcvar_array_build_rue_downward(purc_variant_t arr)
     if (!data)
         return 0;
 
-    struct arr_node *p;
-    foreach_in_variant_array(arr, p) {
-        struct pcvar_rev_update_edge edge = {
-            .parent         = arr,
-            .arr_me         = p,
-        };
-        int r = pcvar_build_edge_to_parent(p->val, &edge);
-        if (r)
-            return -1;
-        r = pcvar_build_rue_downward(p->val);
-        if (r)
+    for (size_t i = 0; i < data->nr; i++) {
+        if (build_edge(arr, i))
             return -1;
     }
 
+    refresh_extra(arr);
     return 0;
 }
 
@@ -1040,66 +1131,16 @@ pcvar_array_build_edge_to_parent(purc_variant_t arr,
     return r ? -1 : 0;
 }
 
-static struct pcutils_array_list_node*
-next_node(struct pcutils_array_list *al, struct pcutils_array_list_node *node)
-{
-    if (!node)
-        return NULL;
-    size_t count = pcutils_array_list_length(al);
-    size_t idx = node->idx + 1;
-    if (idx >= count)
-        return NULL;
-
-    return pcutils_array_list_get(al, idx);
-}
-
-static struct pcutils_array_list_node*
-prev_node(struct pcutils_array_list *al, struct pcutils_array_list_node *node)
-{
-    if (!node)
-        return NULL;
-    if (node->idx == 0)
-        return NULL;
-
-    size_t count = pcutils_array_list_length(al);
-    size_t idx = node->idx - 1;
-    if (idx >= count)
-        return NULL;
-
-    return pcutils_array_list_get(al, idx);
-}
-
 static void
-it_refresh(struct arr_iterator *it,
-        struct pcutils_array_list *al,
-        struct pcutils_array_list_node *curr)
+it_refresh(struct arr_iterator *it, size_t idx)
 {
-    struct pcutils_array_list_node *next  = NULL;
-    struct pcutils_array_list_node *prev  = NULL;
-    if (curr) {
-        next  = next_node(al, curr);
-        prev  = prev_node(al, curr);
-    }
-
-    if (curr) {
-        it->curr = container_of(curr, struct arr_node, node);
-    }
-    else {
-        it->curr = NULL;
-    }
-
-    if (next) {
-        it->next = container_of(next, struct arr_node, node);
+    variant_arr_t data = pcvar_arr_get_data(it->arr);
+    if (idx < data->nr) {
+        it->idx  = idx;
+        it->curr = data->vals[idx];
     }
     else {
-        it->next = NULL;
-    }
-
-    if (prev) {
-        it->prev = container_of(prev, struct arr_node, node);
-    }
-    else {
-        it->prev = NULL;
+        it->curr = PURC_VARIANT_INVALID;
     }
 }
 
@@ -1112,17 +1153,7 @@ pcvar_arr_it_first(purc_variant_t arr)
     if (arr == PURC_VARIANT_INVALID)
         return it;
 
-    variant_arr_t data = pcvar_arr_get_data(arr);
-    size_t count = variant_arr_length(data);
-    if (count == 0)
-        return it;
-
-    struct pcutils_array_list *al = &data->al;
-
-    struct pcutils_array_list_node *first;
-    first = pcutils_array_list_get_first(al);
-
-    it_refresh(&it, al, first);
+    it_refresh(&it, 0);
 
     return it;
 }
@@ -1137,16 +1168,7 @@ pcvar_arr_it_last(purc_variant_t arr)
         return it;
 
     variant_arr_t data = pcvar_arr_get_data(arr);
-    size_t count = variant_arr_length(data);
-    if (count == 0)
-        return it;
-
-    struct pcutils_array_list *al = &data->al;
-
-    struct pcutils_array_list_node *last;
-    last = pcutils_array_list_get_last(al);
-
-    it_refresh(&it, al, last);
+    it_refresh(&it, data->nr - 1);
 
     return it;
 }
@@ -1154,45 +1176,17 @@ pcvar_arr_it_last(purc_variant_t arr)
 void
 pcvar_arr_it_next(struct arr_iterator *it)
 {
-    if (it->curr == NULL)
+    if (it->curr == PURC_VARIANT_INVALID)
         return;
 
-    if (it->next) {
-        variant_arr_t data = pcvar_arr_get_data(it->arr);
-        struct pcutils_array_list *al = &data->al;
-
-        struct pcutils_array_list_node *next;
-        next = &it->next->node;
-
-        it_refresh(it, al, next);
-    }
-    else {
-        it->curr = NULL;
-        it->next = NULL;
-        it->prev = NULL;
-    }
+    it_refresh(it, it->idx + 1);
 }
 
 void
 pcvar_arr_it_prev(struct arr_iterator *it)
 {
-    if (it->curr == NULL)
+    if (it->curr == PURC_VARIANT_INVALID)
         return;
 
-    if (it->prev) {
-        variant_arr_t data = pcvar_arr_get_data(it->arr);
-        struct pcutils_array_list *al = &data->al;
-
-        struct pcutils_array_list_node *prev;
-        prev = &it->prev->node;
-
-        it_refresh(it, al, prev);
-    }
-    else {
-        it->curr = NULL;
-        it->next = NULL;
-        it->prev = NULL;
-    }
+    it_refresh(it, it->idx - 1);
 }
-
-
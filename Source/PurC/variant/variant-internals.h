@@ -40,6 +40,27 @@
 extern "C" {
 #endif  /* __cplusplus */
 
+/*
+ * Increase or decrease the reference count of a variant. The reference
+ * count of a frozen variant is shared by multiple instances (threads),
+ * so it is changed atomically.
+ */
+static inline void pcvariant_refc_inc(purc_variant_t v)
+{
+    if (v->flags & PCVARIANT_FLAG_FROZEN)
+        __atomic_add_fetch(&v->refc, 1, __ATOMIC_RELAXED);
+    else
+        v->refc++;
+}
+
+static inline unsigned int pcvariant_refc_dec(purc_variant_t v)
+{
+    if (v->flags & PCVARIANT_FLAG_FROZEN)
+        return __atomic_sub_fetch(&v->refc, 1, __ATOMIC_ACQ_REL);
+
+    return --v->refc;
+}
+
 /*
  * Set the extra size sz_ptr[0] of one variant, and update the statistics data.
  * This function should be called only for variant with
@@ -144,6 +165,16 @@ pcvar_array_build_rue_downward(purc_variant_t arr);
 int
 pcvar_object_build_rue_downward(purc_variant_t obj);
 
+// make a new key for the edge from a member of an array or an object
+uintptr_t
+pcvar_new_edge_key(void);
+
+// the key of the edge from the member `m` to the object `obj`; make one if
+// `make` is true and the member has no key yet. Returns NULL if no key.
+void *
+pcvar_obj_member_edge_key(purc_variant_t obj, struct obj_member *m,
+        bool make);
+
 // build edge for `val` and it's children's edges
 int
 pcvar_build_edge_to_parent(purc_variant_t val,
@@ -158,29 +189,11 @@ int
 pcvar_set_build_edge_to_parent(purc_variant_t set,
         struct pcvar_rev_update_edge *edge);
 
-struct obj_iterator {
-    purc_variant_t                obj;
-
-    struct obj_node              *curr;
-    struct obj_node              *next;
-    struct obj_node              *prev;
-};
-
-struct obj_iterator
-pcvar_obj_it_first(purc_variant_t obj);
-struct obj_iterator
-pcvar_obj_it_last(purc_variant_t obj);
-void
-pcvar_obj_it_next(struct obj_iterator *it);
-void
-pcvar_obj_it_prev(struct obj_iterator *it);
-
 struct arr_iterator {
     purc_variant_t                arr;
 
-    struct arr_node              *curr;
-    struct arr_node              *next;
-    struct arr_node              *prev;
+    size_t                        idx;
+    purc_variant_t                curr;  // PURC_VARIANT_INVALID at the end
 };
 
 struct arr_iterator
@@ -248,6 +261,19 @@ pcvar_rev_update_chain_post_handler(
 purc_variant_t
 pcvar_set_clone_struct(purc_variant_t set);
 
+int
+pcvar_sort_al_by_keys(struct pcutils_array_list *al,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node),
+        void *ud, const struct pcvariant_sort_ops *ops);
+
+/* fills idx with the order of the values sorted by their keys */
+int
+pcvar_sort_vals_by_keys(const purc_variant_t *vals, size_t nr,
+        void *ud, const struct pcvariant_sort_ops *ops, size_t *idx);
+
+/* keys for sorting with the default variant comparison */
+extern const struct pcvariant_sort_ops pcvar_cmpopt_sort_ops;
+
 // constraint-releated
 purc_variant_t
 pcvar_make_arr(void);
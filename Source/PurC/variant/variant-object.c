@@ -25,6 +25,7 @@
 
 #include "config.h"
 #include "private/variant.h"
+#include "private/atom-buckets.h"
 #include "private/errors.h"
 #include "purc-errors.h"
 #include "variant-internals.h"
@@ -35,8 +36,11 @@
 #include <stdlib.h>
 #include <string.h>
 
-#define OBJ_EXTRA_SIZE(data) (sizeof(*data) + \
-        (data->size) * sizeof(struct obj_node))
+#define OBJ_EXTRA_SIZE(data) (sizeof(*data) + ((data)->hashed ?             \
+        (data)->size * sizeof(struct obj_node) +                            \
+            (data)->nr_slots * sizeof(struct obj_node *) :                  \
+        (data)->sz * sizeof(struct obj_member) +                            \
+            ((data)->edge_keys ? (data)->sz * sizeof(uintptr_t) : 0)))
 
 static inline bool
 grow(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
@@ -127,126 +131,480 @@ pcvar_obj_get_data(purc_variant_t obj)
     return data;
 }
 
-static purc_variant_t v_object_new_with_capacity(void)
+static inline void
+refresh_extra(purc_variant_t obj)
 {
-    purc_variant_t var = pcvariant_get(PVT(_OBJECT));
-    if (!var) {
-        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return PURC_VARIANT_INVALID;
+    variant_obj_t data = pcvar_obj_get_data(obj);
+    pcvariant_stat_set_extra_size(obj, OBJ_EXTRA_SIZE(data));
+}
+
+static inline struct obj_node *
+obj_node_of(struct obj_member *m)
+{
+    return container_of(m, struct obj_node, m);
+}
+
+/* the first slot to probe; the multiplication spreads the atoms */
+static inline size_t
+atom_slot(purc_atom_t atom, size_t mask)
+{
+    return ((uint32_t)atom * 0x9e3779b1U) & mask;
+}
+
+static struct obj_member *
+flat_find(variant_obj_t data, purc_atom_t atom)
+{
+    for (size_t i = 0; i < data->size; i++) {
+        if (data->members[i].atom == atom)
+            return data->members + i;
     }
 
-    var->type          = PVT(_OBJECT);
-    var->flags         = PCVARIANT_FLAG_EXTRA_SIZE;
+    return NULL;
+}
 
-    variant_obj_t data;
-    data = (variant_obj_t)calloc(1, sizeof(*data));
+/* the index at which a member with the key `sk` keeps the members ordered */
+static size_t
+flat_position(variant_obj_t data, const char *sk)
+{
+    size_t lo = 0, hi = data->size;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        const char *s = purc_variant_get_string_const(data->members[mid].key);
+        if (strcmp(sk, s) > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
 
-    if (!data) {
-        pcvariant_put(var);
+    return lo;
+}
+
+static int
+flat_make_edge_keys(variant_obj_t data)
+{
+    if (data->edge_keys || data->sz == 0)
+        return 0;
+
+    uintptr_t *keys = (uintptr_t *)malloc(data->sz * sizeof(*keys));
+    if (!keys) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
-        return PURC_VARIANT_INVALID;
+        return -1;
     }
 
-    data->kvs = RB_ROOT;
+    for (size_t i = 0; i < data->size; i++)
+        keys[i] = pcvar_new_edge_key();
+    data->edge_keys = keys;
+    return 0;
+}
 
-    var->sz_ptr[1]     = (uintptr_t)data;
-    var->refc          = 1;
+static int
+flat_reserve(variant_obj_t data)
+{
+    if (data->size < data->sz)
+        return 0;
 
-    size_t extra = OBJ_EXTRA_SIZE(data);
-    pcvariant_stat_set_extra_size(var, extra);
+    size_t sz = data->sz ? data->sz * 2 : 2;
 
-    return var;
+    struct obj_member *members;
+    members = (struct obj_member *)realloc(data->members,
+            sz * sizeof(*members));
+    if (!members) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+    data->members = members;
+
+    if (data->edge_keys) {
+        uintptr_t *keys;
+        keys = (uintptr_t *)realloc(data->edge_keys, sz * sizeof(*keys));
+        if (!keys) {
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+        data->edge_keys = keys;
+    }
+
+    data->sz = sz;
+    return 0;
 }
 
 static void
-break_rev_update_chain(purc_variant_t obj, struct obj_node *node)
+index_place(struct obj_node **slots, size_t nr_slots, struct obj_node *node)
 {
-    struct pcvar_rev_update_edge edge = {
-        .parent        = obj,
-        .obj_me        = node,
-    };
+    size_t mask = nr_slots - 1;
+    size_t i = atom_slot(node->m.atom, mask);
+
+    while (slots[i])
+        i = (i + 1) & mask;
 
-    pcvar_break_edge_to_parent(node->val, &edge);
-    pcvar_break_rue_downward(node->val);
+    slots[i] = node;
+}
+
+static int
+index_rebuild(variant_obj_t data, size_t nr_slots)
+{
+    struct obj_node **slots;
+    slots = (struct obj_node **)calloc(nr_slots, sizeof(*slots));
+    if (!slots) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    struct rb_node *p = pcutils_rbtree_first(&data->kvs);
+    for (; p; p = pcutils_rbtree_next(p)) {
+        index_place(slots, nr_slots,
+                container_of(p, struct obj_node, node));
+    }
+
+    free(data->slots);
+    data->slots = slots;
+    data->nr_slots = nr_slots;
+
+    return 0;
+}
+
+/* the node shall have been linked into data->kvs and counted */
+static int
+index_add(variant_obj_t data, struct obj_node *node)
+{
+    // keep the load factor under 1/2
+    if (data->size * 2 > data->nr_slots) {
+        size_t nr_slots = data->nr_slots * 2;
+        while (data->size * 2 > nr_slots)
+            nr_slots *= 2;
+        return index_rebuild(data, nr_slots);
+    }
+
+    index_place(data->slots, data->nr_slots, node);
+    return 0;
 }
 
 static void
-obj_node_release(purc_variant_t obj, struct obj_node *node)
+index_remove(variant_obj_t data, struct obj_node *node)
 {
-    if (!node)
-        return;
+    struct obj_node **slots = data->slots;
+    size_t mask = data->nr_slots - 1;
+    size_t i = atom_slot(node->m.atom, mask);
+
+    while (slots[i] != node) {
+        if (slots[i] == NULL)
+            return;
+        i = (i + 1) & mask;
+    }
 
-    break_rev_update_chain(obj, node);
+    // backward shift deletion: no tombstones for linear probing
+    size_t j = i;
+    while (1) {
+        j = (j + 1) & mask;
+        if (slots[j] == NULL)
+            break;
 
-    variant_obj_t data = pcvar_obj_get_data(obj);
-    PC_ASSERT(data);
+        size_t k = atom_slot(slots[j]->m.atom, mask);
+        if ((j > i && (k <= i || k > j)) ||
+                (j < i && (k <= i && k > j))) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
 
-    struct rb_root *root = &data->kvs;
-    if (&node->node == root->rb_node || node->node.rb_parent) {
-        --data->size;
-        pcutils_rbtree_erase(&node->node, root);
-        node->node.rb_parent = NULL;
+    slots[i] = NULL;
+}
+
+static struct obj_node *
+index_find(variant_obj_t data, purc_atom_t atom)
+{
+    struct obj_node **slots = data->slots;
+    size_t mask = data->nr_slots - 1;
+
+    for (size_t i = atom_slot(atom, mask); slots[i]; i = (i + 1) & mask) {
+        if (slots[i]->m.atom == atom)
+            return slots[i];
     }
 
-    PURC_VARIANT_SAFE_CLEAR(node->key);
-    PURC_VARIANT_SAFE_CLEAR(node->val);
+    return NULL;
 }
 
 static void
-obj_node_destroy(purc_variant_t obj, struct obj_node *node)
+tree_link(variant_obj_t data, struct obj_node *node)
 {
-    if (!node)
-        return;
+    const char *sk = purc_variant_get_string_const(node->m.key);
+    struct rb_node **pnode = &data->kvs.rb_node;
+    struct rb_node *parent = NULL;
 
-    obj_node_release(obj, node);
+    while (*pnode) {
+        struct obj_node *on = container_of(*pnode, struct obj_node, node);
+        const char *s = purc_variant_get_string_const(on->m.key);
 
-    free(node);
+        parent = *pnode;
+        if (strcmp(sk, s) < 0)
+            pnode = &parent->rb_left;
+        else
+            pnode = &parent->rb_right;
+    }
+
+    pcutils_rbtree_link_node(&node->node, parent, pnode);
+    pcutils_rbtree_insert_color(&node->node, &data->kvs);
 }
 
-static struct obj_node*
-obj_node_create(purc_variant_t k, purc_variant_t v)
+/* convert a flat object to the hashed form */
+static int
+obj_make_hashed(variant_obj_t data)
 {
-    if (k->type != PVT(_STRING)) {
-        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+    struct obj_member *members = data->members;
+    uintptr_t *edge_keys = data->edge_keys;
+    size_t nr = data->size;
+
+    size_t nr_slots = PCVARIANT_OBJ_HASH_THRESHOLD * 2;
+    while (nr * 2 >= nr_slots)
+        nr_slots *= 2;
+
+    struct obj_node **slots;
+    slots = (struct obj_node **)calloc(nr_slots, sizeof(*slots));
+    if (!slots) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    // use the slots to hold the new nodes until all are allocated
+    for (size_t i = 0; i < nr; i++) {
+        slots[i] = (struct obj_node *)pcvariant_slab_alloc_0(
+                sizeof(struct obj_node));
+        if (!slots[i]) {
+            while (i > 0)
+                pcvariant_slab_free(slots[--i]);
+            free(slots);
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+            return -1;
+        }
+    }
+
+    struct obj_node **nodes = slots;
+
+    data->hashed = true;
+    data->kvs = RB_ROOT;
+    data->slots = NULL;
+    data->nr_slots = 0;
+
+    for (size_t i = 0; i < nr; i++) {
+        struct obj_node *node = nodes[i];
+        node->m = members[i];
+        node->edge_key = edge_keys ? edge_keys[i] : 0;
+        tree_link(data, node);
+    }
+
+    memset(slots, 0, nr * sizeof(*slots));
+    struct rb_node *p = pcutils_rbtree_first(&data->kvs);
+    for (; p; p = pcutils_rbtree_next(p)) {
+        index_place(slots, nr_slots, container_of(p, struct obj_node, node));
+    }
+    data->slots = slots;
+    data->nr_slots = nr_slots;
+
+    free(members);
+    free(edge_keys);
+    return 0;
+}
+
+static struct obj_member *
+find_member(variant_obj_t data, purc_atom_t atom)
+{
+    if (atom == 0)
         return NULL;
+
+    if (data->hashed) {
+        struct obj_node *node = index_find(data, atom);
+        return node ? &node->m : NULL;
+    }
+
+    return flat_find(data, atom);
+}
+
+static struct obj_member *
+find_member_by_ckey(variant_obj_t data, const char *key)
+{
+    if (data->size == 0)
+        return NULL;
+
+    // no object has the member if the key has never been interned
+    return find_member(data,
+            purc_atom_try_string_ex(ATOM_BUCKET_OBJKEY, key));
+}
+
+/* insert a new member; the key shall not be in the object yet */
+static struct obj_member *
+insert_member(variant_obj_t data, purc_variant_t k, purc_variant_t v,
+        purc_atom_t atom)
+{
+    if (!data->hashed && data->size >= PCVARIANT_OBJ_HASH_THRESHOLD) {
+        if (obj_make_hashed(data))
+            return NULL;
+    }
+
+    if (!data->hashed) {
+        if (flat_reserve(data))
+            return NULL;
+
+        size_t idx = flat_position(data, purc_variant_get_string_const(k));
+        size_t n = data->size - idx;
+        memmove(data->members + idx + 1, data->members + idx,
+                n * sizeof(*data->members));
+        if (data->edge_keys) {
+            memmove(data->edge_keys + idx + 1, data->edge_keys + idx,
+                    n * sizeof(*data->edge_keys));
+            data->edge_keys[idx] = pcvar_new_edge_key();
+        }
+
+        struct obj_member *m = data->members + idx;
+        m->key = purc_variant_ref(k);
+        m->val = purc_variant_ref(v);
+        m->atom = atom;
+        data->size++;
+        return m;
     }
 
     struct obj_node *node;
-    node = (struct obj_node*)calloc(1, sizeof(*node));
+    node = (struct obj_node *)pcvariant_slab_alloc_0(sizeof(*node));
     if (!node) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
-    node->key = purc_variant_ref(k);
-    node->val = purc_variant_ref(v);
+    node->m.key = k;
+    node->m.val = v;
+    node->m.atom = atom;
+    tree_link(data, node);
+    data->size++;
+
+    if (index_add(data, node)) {
+        pcutils_rbtree_erase(&node->node, &data->kvs);
+        data->size--;
+        pcvariant_slab_free(node);
+        return NULL;
+    }
+
+    purc_variant_ref(k);
+    purc_variant_ref(v);
+    return &node->m;
+}
+
+/* unlink the member; the caller takes over the key and the value */
+static void
+remove_member(variant_obj_t data, struct obj_member *m)
+{
+    if (!data->hashed) {
+        size_t idx = m - data->members;
+        size_t n = data->size - idx - 1;
+        memmove(data->members + idx, data->members + idx + 1,
+                n * sizeof(*data->members));
+        if (data->edge_keys) {
+            memmove(data->edge_keys + idx, data->edge_keys + idx + 1,
+                    n * sizeof(*data->edge_keys));
+        }
+    }
+    else {
+        struct obj_node *node = obj_node_of(m);
+        index_remove(data, node);
+        pcutils_rbtree_erase(&node->node, &data->kvs);
+        pcvariant_slab_free(node);
+    }
+
+    data->size--;
+}
+
+void *
+pcvar_obj_member_edge_key(purc_variant_t obj, struct obj_member *m,
+        bool make)
+{
+    variant_obj_t data = pcvar_obj_get_data(obj);
+
+    if (data->hashed) {
+        struct obj_node *node = obj_node_of(m);
+        if (node->edge_key == 0 && make)
+            node->edge_key = pcvar_new_edge_key();
+        return (void *)node->edge_key;
+    }
+
+    if (data->edge_keys == NULL) {
+        if (!make || flat_make_edge_keys(data))
+            return NULL;
+        refresh_extra(obj);
+    }
+
+    return (void *)data->edge_keys[m - data->members];
+}
+
+static purc_variant_t v_object_new_with_capacity(void)
+{
+    purc_variant_t var = pcvariant_get(PVT(_OBJECT));
+    if (!var) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    var->type          = PVT(_OBJECT);
+    var->flags         = PCVARIANT_FLAG_EXTRA_SIZE;
+
+    variant_obj_t data;
+    data = (variant_obj_t)calloc(1, sizeof(*data));
+
+    if (!data) {
+        pcvariant_put(var);
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return PURC_VARIANT_INVALID;
+    }
+
+    var->sz_ptr[1]     = (uintptr_t)data;
+    var->refc          = 1;
+
+    size_t extra = OBJ_EXTRA_SIZE(data);
+    pcvariant_stat_set_extra_size(var, extra);
 
-    return node;
+    return var;
+}
+
+static void
+break_rev_update_chain(purc_variant_t obj, struct obj_member *m)
+{
+    void *edge_key = pcvar_obj_member_edge_key(obj, m, false);
+    if (edge_key) {
+        struct pcvar_rev_update_edge edge = {
+            .parent        = obj,
+            .obj_me        = edge_key,
+        };
+        pcvar_break_edge_to_parent(m->val, &edge);
+    }
+
+    pcvar_break_rue_downward(m->val);
 }
 
 static int
-build_rev_update_chain(purc_variant_t obj, struct obj_node *node)
+build_rev_update_chain(purc_variant_t obj, struct obj_member *m)
 {
     if (!pcvar_container_belongs_to_set(obj))
         return 0;
 
     int r;
 
+    void *edge_key = pcvar_obj_member_edge_key(obj, m, true);
+    if (!edge_key)
+        return -1;
+
     struct pcvar_rev_update_edge edge = {
         .parent        = obj,
-        .obj_me        = node,
+        .obj_me        = edge_key,
     };
 
-    r = pcvar_build_edge_to_parent(node->val, &edge);
+    r = pcvar_build_edge_to_parent(m->val, &edge);
     if (r == 0) {
-        r = pcvar_build_rue_downward(node->val);
+        r = pcvar_build_rue_downward(m->val);
     }
 
     return r ? -1 : 0;
 }
 
 static int
-check_shrink(purc_variant_t obj, struct obj_node *node)
+check_shrink(purc_variant_t obj, purc_variant_t k)
 {
     if (!pcvar_container_belongs_to_set(obj))
         return 0;
@@ -261,7 +619,7 @@ check_shrink(purc_variant_t obj, struct obj_node *node)
         bool found = false;
         purc_variant_t kk, vv;
         foreach_key_value_in_variant_object(obj, kk, vv) {
-            if (kk == node->key) {
+            if (kk == k) {
                 PC_ASSERT(!found);
                 found = true;
                 continue;
@@ -295,29 +653,9 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
         bool check)
 {
     variant_obj_t data = pcvar_obj_get_data(obj);
-    struct rb_root *root = &data->kvs;
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-        int ret = strcmp(key, sk);
+    struct obj_member *m = find_member_by_ckey(data, key);
 
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
-
-    if (!entry) {
+    if (!m) {
         if (silently)
             return 0;
 
@@ -325,26 +663,21 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
         return -1;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
-    purc_variant_t k = node->key;
-    purc_variant_t v = node->val;
+    purc_variant_t k = m->key;
+    purc_variant_t v = m->val;
 
     do {
         if (check) {
             if (!shrink(obj, k, v, check))
                 break;
 
-            if (check_shrink(obj, node))
+            if (check_shrink(obj, k))
                 break;
 
-            break_rev_update_chain(obj, node);
+            break_rev_update_chain(obj, m);
         }
 
-        --data->size;
-        PC_ASSERT(entry == root->rb_node || entry->rb_parent);
-        pcutils_rbtree_erase(entry, root);
-        entry->rb_parent = NULL;
+        remove_member(data, m);
 
         if (check) {
             pcvar_adjust_set_by_descendant(obj);
@@ -352,8 +685,10 @@ v_object_remove(purc_variant_t obj, const char *key, bool silently,
             shrunk(obj, k, v, check);
         }
 
-        obj_node_destroy(obj, node);
+        purc_variant_unref(k);
+        purc_variant_unref(v);
 
+        refresh_extra(obj);
         return 0;
     } while (0);
 
@@ -401,7 +736,7 @@ check_grow(purc_variant_t obj, purc_variant_t k, purc_variant_t v)
 }
 
 static int
-check_change(purc_variant_t obj, struct obj_node *node,
+check_change(purc_variant_t obj, purc_variant_t ko,
         purc_variant_t k, purc_variant_t v)
 {
     if (!pcvar_container_belongs_to_set(obj))
@@ -417,7 +752,7 @@ check_change(purc_variant_t obj, struct obj_node *node,
         bool found = false;
         purc_variant_t kk, vv;
         foreach_key_value_in_variant_object(obj, kk, vv) {
-            if (node->key == kk) {
+            if (ko == kk) {
                 PC_ASSERT(!found);
                 found = true;
                 r = pcvar_obj_set(_new, k, v);
@@ -473,103 +808,77 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
     variant_obj_t data = pcvar_obj_get_data(obj);
     PC_ASSERT(data);
 
-    struct rb_root *root = &data->kvs;
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sko = purc_variant_get_string_const(node->key);
-        int ret = strcmp(sk, sko);
+    purc_atom_t atom = purc_atom_from_string_ex(ATOM_BUCKET_OBJKEY, sk);
+    if (atom == 0) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
 
-        parent = *pnode;
+    struct obj_member *m = find_member(data, atom);
+    if (!m) { //new the entry
+        if (check) {
+            if (!grow(obj, key, val, check))
+                return -1;
 
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
+            if (check_grow(obj, key, val))
+                return -1;
         }
-    }
 
-    if (!entry) { //new the entry
-        struct obj_node *node = obj_node_create(key, val);
-        if (!node)
+        m = insert_member(data, key, val, atom);
+        if (!m)
             return -1;
 
-        do {
-            if (check) {
-                if (!grow(obj, key, val, check))
-                    break;
-
-                if (check_grow(obj, key, val))
-                    break;
-            }
-
-            entry = &node->node;
-
-            pcutils_rbtree_link_node(entry, parent, pnode);
-            pcutils_rbtree_insert_color(entry, root);
-
-            ++data->size;
-
-            if (check) {
-                if (build_rev_update_chain(obj, node))
-                    break;
-
-                pcvar_adjust_set_by_descendant(obj);
-
-                grown(obj, key, val, check);
+        if (check) {
+            if (build_rev_update_chain(obj, m)) {
+                break_rev_update_chain(obj, m);
+                remove_member(data, m);
+                purc_variant_unref(key);
+                purc_variant_unref(val);
+                refresh_extra(obj);
+                return -1;
             }
 
-            size_t extra = OBJ_EXTRA_SIZE(data);
-            pcvariant_stat_set_extra_size(obj, extra);
-
-            return 0;
-        } while (0);
+            pcvar_adjust_set_by_descendant(obj);
 
-        obj_node_destroy(obj, node);
+            grown(obj, key, val, check);
+        }
 
-        return -1;
+        refresh_extra(obj);
+        return 0;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
-    if (node->val == val) {
+    if (m->val == val) {
         // NOTE: keep refc intact
         return 0;
     }
 
     do {
-        purc_variant_t ko = node->key;
-        purc_variant_t vo = node->val;
+        purc_variant_t ko = m->key;
+        purc_variant_t vo = m->val;
 
         if (check) {
             if (!change(obj, ko, vo, key, val, check))
                 break;
 
-            if (check_change(obj, node, key, val))
+            if (check_change(obj, ko, key, val))
                 break;
 
-            node->key = key;
-            node->val = val;
-            if (build_rev_update_chain(obj, node)) {
-                break_rev_update_chain(obj, node);
-                node->key = ko;
-                node->val = vo;
+            m->key = key;
+            m->val = val;
+            if (build_rev_update_chain(obj, m)) {
+                break_rev_update_chain(obj, m);
+                m->key = ko;
+                m->val = vo;
                 break;
             }
 
-            node->key = ko;
-            node->val = vo;
-            break_rev_update_chain(obj, node);
+            m->key = ko;
+            m->val = vo;
+            break_rev_update_chain(obj, m);
         }
 
-        node->key = purc_variant_ref(key);
-        node->val = purc_variant_ref(val);
+        m->key = purc_variant_ref(key);
+        m->val = purc_variant_ref(val);
 
         if (check) {
             pcvar_adjust_set_by_descendant(obj);
@@ -580,9 +889,7 @@ v_object_set(purc_variant_t obj, purc_variant_t key, purc_variant_t val,
         purc_variant_unref(ko);
         purc_variant_unref(vo);
 
-        size_t extra = OBJ_EXTRA_SIZE(data);
-        pcvariant_stat_set_extra_size(obj, extra);
-
+        refresh_extra(obj);
         return 0;
     } while (0);
 
@@ -752,14 +1059,31 @@ void pcvariant_object_release (purc_variant_t value)
 {
     variant_obj_t data = pcvar_obj_get_data(value);
 
-    struct rb_root *root = &data->kvs;
+    if (data->hashed) {
+        struct rb_node *p, *n;
+        pcutils_rbtree_for_each_safe(pcutils_rbtree_first(&data->kvs), p, n) {
+            struct obj_node *node;
+            node = container_of(p, struct obj_node, node);
 
-    struct rb_node *p, *n;
-    pcutils_rbtree_for_each_safe(pcutils_rbtree_first(root), p, n) {
-        struct obj_node *node;
-        node = container_of(p, struct obj_node, node);
+            break_rev_update_chain(value, &node->m);
+            purc_variant_unref(node->m.key);
+            purc_variant_unref(node->m.val);
+            pcvariant_slab_free(node);
+        }
 
-        obj_node_destroy(value, node);
+        free(data->slots);
+    }
+    else {
+        for (size_t i = 0; i < data->size; i++) {
+            struct obj_member *m = data->members + i;
+
+            break_rev_update_chain(value, m);
+            purc_variant_unref(m->key);
+            purc_variant_unref(m->val);
+        }
+
+        free(data->members);
+        free(data->edge_keys);
     }
 
     if (data->rev_update_chain) {
@@ -804,39 +1128,24 @@ purc_variant_object_get_by_ckey(purc_variant_t obj, const char* key)
         PURC_VARIANT_INVALID);
 
     variant_obj_t data = pcvar_obj_get_data(obj);
-    struct rb_root *root = &data->kvs;
+    struct obj_member *m = find_member_by_ckey(data, key);
 
-    struct rb_node **pnode = &root->rb_node;
-    struct rb_node *parent = NULL;
-    struct rb_node *entry = NULL;
-    while (*pnode) {
-        struct obj_node *node;
-        node = container_of(*pnode, struct obj_node, node);
-        const char *sk = purc_variant_get_string_const(node->key);
-
-        int ret = strcmp(key, sk);
-
-        parent = *pnode;
-
-        if (ret < 0)
-            pnode = &parent->rb_left;
-        else if (ret > 0)
-            pnode = &parent->rb_right;
-        else{
-            entry = *pnode;
-            break;
-        }
-    }
-
-    if (!entry) {
+    if (!m) {
         pcinst_set_error(PCVARIANT_ERROR_NOT_FOUND);
 
         return PURC_VARIANT_INVALID;
     }
 
-    struct obj_node *node;
-    node = container_of(entry, struct obj_node, node);
-    return node->val;
+    return m->val;
+}
+
+purc_variant_t
+pcvariant_object_find(purc_variant_t obj, const char* key)
+{
+    PC_ASSERT(obj && obj->type == PVT(_OBJECT) && key);
+
+    struct obj_member *m = find_member_by_ckey(pcvar_obj_get_data(obj), key);
+    return m ? m->val : PURC_VARIANT_INVALID;
 }
 
 bool purc_variant_object_set (purc_variant_t obj,
@@ -941,8 +1250,6 @@ purc_variant_object_release_iterator (struct purc_variant_object_iterator* it)
 
     it->it.obj  = PURC_VARIANT_INVALID;
     it->it.curr = NULL;
-    it->it.next = NULL;
-    it->it.prev = NULL;
 
     free(it);
 }
@@ -1039,17 +1346,15 @@ pcvar_object_break_rue_downward(purc_variant_t obj)
     if (!data)
         return;
 
-    struct rb_root *root = &data->kvs;
-    struct rb_node *p = pcutils_rbtree_first(root);
-    for (; p; p = pcutils_rbtree_next(p)) {
-        struct obj_node *node;
-        node = container_of(p, struct obj_node, node);
-        struct pcvar_rev_update_edge edge = {
-            .parent         = obj,
-            .obj_me         = node,
-        };
-        pcvar_break_edge_to_parent(node->val, &edge);
-        pcvar_break_rue_downward(node->val);
+    struct obj_iterator it = pcvar_obj_it_first(obj);
+    for (; it.curr; pcvar_obj_it_next(&it)) {
+        break_rev_update_chain(obj, it.curr);
+    }
+
+    if (!data->hashed && data->edge_keys) {
+        free(data->edge_keys);
+        data->edge_keys = NULL;
+        refresh_extra(obj);
     }
 }
 
@@ -1076,19 +1381,20 @@ pcvar_object_build_rue_downward(purc_variant_t obj)
     if (!data)
         return 0;
 
-    struct rb_root *root = &data->kvs;
-    struct rb_node *p = pcutils_rbtree_first(root);
-    for (; p; p = pcutils_rbtree_next(p)) {
-        struct obj_node *node;
-        node = container_of(p, struct obj_node, node);
+    struct obj_iterator it = pcvar_obj_it_first(obj);
+    for (; it.curr; pcvar_obj_it_next(&it)) {
+        void *edge_key = pcvar_obj_member_edge_key(obj, it.curr, true);
+        if (!edge_key)
+            return -1;
+
         struct pcvar_rev_update_edge edge = {
             .parent         = obj,
-            .obj_me         = node,
+            .obj_me         = edge_key,
         };
-        int r = pcvar_build_edge_to_parent(node->val, &edge);
+        int r = pcvar_build_edge_to_parent(it.curr->val, &edge);
         if (r)
             return -1;
-        r = pcvar_build_rue_downward(node->val);
+        r = pcvar_build_rue_downward(it.curr->val);
         if (r)
             return -1;
     }
@@ -1133,26 +1439,53 @@ it_refresh(struct obj_iterator *it, struct rb_node *curr)
         prev  = pcutils_rbtree_prev(curr);
     }
 
+    it->idx  = SIZE_MAX;
+    it->next = next ? container_of(next, struct obj_node, node) : NULL;
+    it->prev = prev ? container_of(prev, struct obj_node, node) : NULL;
+
     if (curr) {
-        it->curr = container_of(curr, struct obj_node, node);
+        it->curr = &container_of(curr, struct obj_node, node)->m;
+        it->atom = it->curr->atom;
     }
     else {
         it->curr = NULL;
+        it->atom = 0;
     }
+}
 
-    if (next) {
-        it->next = container_of(next, struct obj_node, node);
+static void
+it_flat_at(struct obj_iterator *it, variant_obj_t data, size_t idx)
+{
+    if (idx < data->size) {
+        it->idx  = idx;
+        it->curr = data->members + idx;
+        it->atom = it->curr->atom;
     }
     else {
-        it->next = NULL;
+        it->curr = NULL;
+        it->atom = 0;
     }
+}
 
-    if (prev) {
-        it->prev = container_of(prev, struct obj_node, node);
-    }
-    else {
-        it->prev = NULL;
+/*
+ * Locate the current member of a flat iterator again, since the body of
+ * a loop may have inserted or removed members. Returns false if the
+ * current member has been removed.
+ */
+static bool
+it_flat_locate(struct obj_iterator *it, variant_obj_t data)
+{
+    if (it->idx < data->size && data->members[it->idx].atom == it->atom)
+        return true;
+
+    for (size_t i = 0; i < data->size; i++) {
+        if (data->members[i].atom == it->atom) {
+            it->idx = i;
+            return true;
+        }
     }
+
+    return false;
 }
 
 struct obj_iterator
@@ -1168,10 +1501,10 @@ pcvar_obj_it_first(purc_variant_t obj)
     if (data->size==0)
         return it;
 
-    struct rb_root *root = &data->kvs;
-
-    struct rb_node *first = pcutils_rbtree_first(root);
-    it_refresh(&it, first);
+    if (data->hashed)
+        it_refresh(&it, pcutils_rbtree_first(&data->kvs));
+    else
+        it_flat_at(&it, data, 0);
 
     return it;
 }
@@ -1189,28 +1522,43 @@ pcvar_obj_it_last(purc_variant_t obj)
     if (data->size==0)
         return it;
 
-    struct rb_root *root = &data->kvs;
-
-    struct rb_node *last = pcutils_rbtree_last(root);
-    it_refresh(&it, last);
+    if (data->hashed)
+        it_refresh(&it, pcutils_rbtree_last(&data->kvs));
+    else
+        it_flat_at(&it, data, data->size - 1);
 
     return it;
 }
 
+/* a flat iterator on an object converted to the hashed form meanwhile */
+static bool
+it_to_hashed(struct obj_iterator *it, variant_obj_t data)
+{
+    struct obj_node *node = index_find(data, it->atom);
+    if (!node) {
+        it->curr = NULL;
+        return false;
+    }
+
+    it_refresh(it, &node->node);
+    return true;
+}
+
 void
 pcvar_obj_it_next(struct obj_iterator *it)
 {
     if (it->curr == NULL)
         return;
 
-    if (it->next) {
-        struct rb_node *next = &it->next->node;
-        it_refresh(it, next);
+    variant_obj_t data = pcvar_obj_get_data(it->obj);
+    if (it->idx == SIZE_MAX || (data->hashed && it_to_hashed(it, data))) {
+        it_refresh(it, it->next ? &it->next->node : NULL);
     }
-    else {
-        it->curr = NULL;
-        it->next = NULL;
-        it->prev = NULL;
+    else if (!data->hashed) {
+        if (it_flat_locate(it, data))
+            it_flat_at(it, data, it->idx + 1);
+        else
+            it_flat_at(it, data, it->idx);
     }
 }
 
@@ -1220,14 +1568,16 @@ pcvar_obj_it_prev(struct obj_iterator *it)
     if (it->curr == NULL)
         return;
 
-    if (it->prev) {
-        struct rb_node *prev = &it->prev->node;
-        it_refresh(it, prev);
+    variant_obj_t data = pcvar_obj_get_data(it->obj);
+    if (it->idx == SIZE_MAX || (data->hashed && it_to_hashed(it, data))) {
+        it_refresh(it, it->prev ? &it->prev->node : NULL);
     }
-    else {
-        it->curr = NULL;
-        it->next = NULL;
-        it->prev = NULL;
+    else if (!data->hashed) {
+        it_flat_locate(it, data);
+        if (it->idx == 0)
+            it_flat_at(it, data, data->size);
+        else
+            it_flat_at(it, data, it->idx - 1);
     }
 }
 
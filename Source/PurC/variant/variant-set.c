@@ -140,6 +140,7 @@ variant_set_get_extra_size(variant_set_t data)
 
     extra += sz_record * count;
     extra += sizeof(struct set_node*)*(data->al.nr);
+    extra += sizeof(struct set_node*)*(data->nr_slots);
 
     return extra;
 }
@@ -150,71 +151,6 @@ pcv_set_set_data(purc_variant_t set, variant_set_t data)
     set->sz_ptr[1]     = (uintptr_t)data;
 }
 
-static int
-obj_node_diff(struct obj_node *l, struct obj_node *r)
-{
-    int diff = 0;
-
-    purc_variant_t lk, rk;
-    lk = l->key;
-    rk = r->key;
-    PC_ASSERT(lk);
-    PC_ASSERT(rk);
-
-    if (lk != rk) {
-        diff = pcvariant_diff(lk, rk);
-        if (diff)
-            return diff;
-    }
-
-    purc_variant_t lv, rv;
-    lv = l->val;
-    rv = r->val;
-    PC_ASSERT(lv);
-    PC_ASSERT(rv);
-
-    if (lv != rv) {
-        diff = pcvariant_diff(lv, rv);
-    }
-
-    return diff;
-}
-
-static int
-variant_set_compare_by_set_keys(purc_variant_t set,
-        purc_variant_t l, purc_variant_t r)
-{
-    PC_ASSERT(set != PURC_VARIANT_INVALID);
-    PC_ASSERT(purc_variant_is_set(set));
-    PC_ASSERT(l != PURC_VARIANT_INVALID);
-    PC_ASSERT(r != PURC_VARIANT_INVALID);
-    PC_ASSERT(pcvariant_is_mutable(l));
-    PC_ASSERT(pcvariant_is_mutable(r));
-
-    int diff;
-
-    struct kv_iterator lit, rit;
-    lit = pcvar_kv_it_first(set, l);
-    rit = pcvar_kv_it_first(set, r);
-    while (1) {
-        struct obj_node *ln = lit.it.curr;
-        struct obj_node *rn = rit.it.curr;
-        if (ln == NULL && rn == NULL)
-            return 0;
-        if (ln == NULL)
-            return -1;
-        if (rn == NULL)
-            return 1;
-
-        diff = obj_node_diff(ln, rn);
-        if (diff)
-            return diff;
-
-        pcvar_kv_it_next(&lit);
-        pcvar_kv_it_next(&rit);
-    }
-}
-
 static int
 variant_set_init(variant_set_t data, const char *unique_key, bool caseless)
 {
@@ -318,15 +254,19 @@ break_rev_update_chain(purc_variant_t set, struct set_node *node)
         struct kv_iterator it;
         it = pcvar_kv_it_first(set, node->val);
         while (1) {
-            struct obj_node *on = it.it.curr;
+            struct obj_member *on = it.it.curr;
             if (on == NULL)
                 break;
             if (pcvariant_is_mutable(on->val)) {
-                struct pcvar_rev_update_edge edge = {
-                    .parent        = node->val,
-                    .obj_me        = on,
-                };
-                pcvar_break_edge_to_parent(on->val, &edge);
+                void *edge_key;
+                edge_key = pcvar_obj_member_edge_key(node->val, on, false);
+                if (edge_key) {
+                    struct pcvar_rev_update_edge edge = {
+                        .parent        = node->val,
+                        .obj_me        = edge_key,
+                    };
+                    pcvar_break_edge_to_parent(on->val, &edge);
+                }
                 pcvar_break_rue_downward(on->val);
             }
             pcvar_kv_it_next(&it);
@@ -358,6 +298,7 @@ struct element_rb_node {
     struct rb_node     **pnode;
     struct rb_node      *parent;
     struct rb_node      *entry;
+    uint64_t             hash;
 };
 
 static int
@@ -435,6 +376,115 @@ _compare(purc_variant_t _new, purc_variant_t _old,
     return _compare_by_unique_keys(_new, _old, data);
 }
 
+#define SET_MIN_SLOTS       16
+
+static void
+hash_index_place(struct set_node **slots, size_t nr_slots,
+        struct set_node *node)
+{
+    size_t mask = nr_slots - 1;
+    size_t i = (size_t)node->hash & mask;
+
+    while (slots[i])
+        i = (i + 1) & mask;
+
+    slots[i] = node;
+}
+
+static int
+hash_index_rebuild(variant_set_t data, size_t nr_slots)
+{
+    struct set_node **slots;
+    slots = (struct set_node**)calloc(nr_slots, sizeof(*slots));
+    if (!slots) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    struct pcutils_array_list *al = &data->al;
+    struct pcutils_array_list_node *p;
+    array_list_for_each(al, p) {
+        struct set_node *sn = container_of(p, struct set_node, alnode);
+        hash_index_place(slots, nr_slots, sn);
+    }
+
+    free(data->slots);
+    data->slots = slots;
+    data->nr_slots = nr_slots;
+
+    return 0;
+}
+
+/* the node shall have been appended to data->al */
+static int
+hash_index_add(variant_set_t data, struct set_node *node)
+{
+    if (data->caseless)
+        return 0;
+
+    // keep the load factor under 1/2
+    size_t count = pcutils_array_list_length(&data->al);
+    if (count * 2 > data->nr_slots) {
+        size_t nr_slots = data->nr_slots ? data->nr_slots * 2 : SET_MIN_SLOTS;
+        while (count * 2 > nr_slots)
+            nr_slots *= 2;
+        return hash_index_rebuild(data, nr_slots);
+    }
+
+    hash_index_place(data->slots, data->nr_slots, node);
+    return 0;
+}
+
+static void
+hash_index_remove(variant_set_t data, struct set_node *node)
+{
+    if (data->slots == NULL)
+        return;
+
+    struct set_node **slots = data->slots;
+    size_t mask = data->nr_slots - 1;
+    size_t i = (size_t)node->hash & mask;
+
+    while (slots[i] != node) {
+        if (slots[i] == NULL)
+            return;
+        i = (i + 1) & mask;
+    }
+
+    // backward shift deletion: no tombstones for linear probing
+    size_t j = i;
+    while (1) {
+        j = (j + 1) & mask;
+        if (slots[j] == NULL)
+            break;
+
+        size_t k = (size_t)slots[j]->hash & mask;
+        if ((j > i && (k <= i || k > j)) ||
+                (j < i && (k <= i && k > j))) {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+
+    slots[i] = NULL;
+}
+
+static struct set_node*
+hash_index_find(variant_set_t data, purc_variant_t kvs, uint64_t hash)
+{
+    struct set_node **slots = data->slots;
+    size_t mask = data->nr_slots - 1;
+    struct set_node *node;
+
+    for (size_t i = (size_t)hash & mask; (node = slots[i]);
+            i = (i + 1) & mask) {
+        if (node->hash == hash && _compare(kvs, node->val, data) == 0)
+            return node;
+    }
+
+    return NULL;
+}
+
 static void
 find_element_rb_node(struct element_rb_node *node,
         purc_variant_t set, purc_variant_t kvs)
@@ -444,18 +494,30 @@ find_element_rb_node(struct element_rb_node *node,
     struct rb_node **pnode = &root->rb_node;
     struct rb_node *parent = NULL;
     struct rb_node *entry = NULL;
-    char md5[33];
-    pcvariant_md5_by_set(md5, kvs, set);
 
+    node->hash = 0;
+    if (!data->caseless) {
+        node->hash = pcvariant_hash_by_set(kvs, set);
+        if (data->slots) {
+            struct set_node *sn = hash_index_find(data, kvs, node->hash);
+            if (sn) {
+                node->pnode  = NULL;
+                node->parent = NULL;
+                node->entry  = &sn->rbnode;
+                return;
+            }
+        }
+    }
+
+    // not found: locate the position in the rbtree to keep the order;
+    // the members of a set other than caseless are ordered by the hashes
+    // first, so the values are only compared when the hashes collide.
     while (*pnode) {
         struct set_node *on;
         on = container_of(*pnode, struct set_node, rbnode);
         int diff;
-        if (0) {
-            diff = variant_set_compare_by_set_keys(set, kvs, on->val);
-        }
-        else if (0) {
-            diff = pcvariant_diff_by_set(md5, kvs, on->md5, on->val, set);
+        if (node->hash != on->hash) {
+            diff = node->hash < on->hash ? -1 : 1;
         }
         else {
             diff = _compare(kvs, on->val, data);
@@ -483,6 +545,13 @@ find_element_rb_node(struct element_rb_node *node,
 static struct set_node*
 find_element(purc_variant_t set, purc_variant_t kvs)
 {
+    variant_set_t data = pcvar_set_get_data(set);
+
+    if (data->slots) {
+        uint64_t hash = pcvariant_hash_by_set(kvs, set);
+        return hash_index_find(data, kvs, hash);
+    }
+
     struct element_rb_node node;
     find_element_rb_node(&node, set, kvs);
 
@@ -513,13 +582,18 @@ build_rev_update_chain(purc_variant_t set, struct set_node *node)
         struct kv_iterator it;
         it = pcvar_kv_it_first(set, node->val);
         while (1) {
-            struct obj_node *on = it.it.curr;
+            struct obj_member *on = it.it.curr;
             if (on == NULL)
                 break;
             if (pcvariant_is_mutable(on->val)) {
+                void *edge_key;
+                edge_key = pcvar_obj_member_edge_key(node->val, on, true);
+                if (!edge_key)
+                    return -1;
+
                 struct pcvar_rev_update_edge edge = {
                     .parent        = node->val,
-                    .obj_me        = on,
+                    .obj_me        = edge_key,
                 };
                 int r;
                 r = pcvar_build_edge_to_parent(on->val, &edge);
@@ -573,6 +647,7 @@ elem_node_remove(purc_variant_t set, struct set_node *node)
     variant_set_t data = pcvar_set_get_data(set);
     PC_ASSERT(data);
 
+    hash_index_remove(data, node);
     pcutils_rbtree_erase(&node->rbnode, &data->elems);
 
     int r;
@@ -603,7 +678,7 @@ elem_node_destroy(purc_variant_t set, struct set_node *node)
         return;
 
     elem_node_release(set, node);
-    free(node);
+    pcvariant_slab_free(node);
 }
 
 static int
@@ -633,6 +708,10 @@ elem_node_replace(purc_variant_t set, struct set_node *node,
 static void
 variant_set_release_elems(purc_variant_t set, variant_set_t data)
 {
+    free(data->slots);
+    data->slots = NULL;
+    data->nr_slots = 0;
+
     struct pcutils_array_list *al = &data->al;
     struct pcutils_array_list_node *p, *n;
     for (p = pcutils_array_list_get_last(al);
@@ -704,19 +783,20 @@ variant_set_create_kvs_n(variant_set_t set, purc_variant_t v1, va_list ap)
 }
 
 static struct set_node*
-variant_set_create_elem_node(purc_variant_t set, purc_variant_t val)
+variant_set_create_elem_node(purc_variant_t set, purc_variant_t val,
+        uint64_t hash)
 {
     variant_set_t data = pcvar_set_get_data(set);
     PC_ASSERT(data);
 
-    struct set_node *_new = (struct set_node*)calloc(1, sizeof(*_new));
+    struct set_node *_new =
+        (struct set_node*)pcvariant_slab_alloc_0(sizeof(*_new));
     if (!_new) {
         pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
         return NULL;
     }
 
-    pcvariant_md5_by_set(_new->md5, val, set);
-
+    _new->hash = hash;
     _new->alnode.idx = (size_t)-1;
     _new->val = val;
     purc_variant_ref(val);
@@ -840,7 +920,7 @@ check_grow(purc_variant_t set, purc_variant_t val)
 
 static int
 insert(purc_variant_t set, variant_set_t data,
-        purc_variant_t val,
+        purc_variant_t val, uint64_t hash,
         struct rb_node *parent, struct rb_node **pnode,
         bool check)
 {
@@ -855,7 +935,7 @@ insert(purc_variant_t set, variant_set_t data,
                 break;
         }
 
-        node = variant_set_create_elem_node(set, val);
+        node = variant_set_create_elem_node(set, val, hash);
         if (!node)
             break;
 
@@ -873,6 +953,9 @@ insert(purc_variant_t set, variant_set_t data,
         pcutils_rbtree_link_node(entry, parent, pnode);
         pcutils_rbtree_insert_color(entry, &data->elems);
 
+        if (hash_index_add(data, node))
+            break;
+
         if (check) {
             if (!elem_node_setup_constraints(set, node))
                 break;
@@ -905,7 +988,7 @@ pcvar_set_add(purc_variant_t set, purc_variant_t val)
     }
 
     bool check = false;
-    return insert(set, data, val, rbn.parent, rbn.pnode, check);
+    return insert(set, data, val, rbn.hash, rbn.parent, rbn.pnode, check);
 }
 
 static int
@@ -963,7 +1046,8 @@ insert_or_replace(purc_variant_t set,
     find_element_rb_node(&rbn, set, val);
 
     if (!rbn.entry) {
-        int r = insert(set, data, val, rbn.parent, rbn.pnode, check);
+        int r = insert(set, data, val, rbn.hash, rbn.parent, rbn.pnode,
+                check);
 
         return r ? -1 : 0;
     }
@@ -1539,20 +1623,6 @@ struct set_user_data {
     void *ud;
 };
 
-static int vrtcmp(purc_variant_t l, purc_variant_t r, void *ud)
-{
-    uintptr_t sort_flags;
-    purc_vrtcmp_opt_t cmpopt;
-
-    sort_flags = (uintptr_t)ud;
-    cmpopt = (purc_vrtcmp_opt_t)(sort_flags & PCVARIANT_CMPOPT_MASK);
-
-    int retv = purc_variant_compare_ex(l, r, cmpopt);
-    if (sort_flags & PCVARIANT_SORT_DESC)
-        retv = -retv;
-    return retv;
-}
-
 static int
 cmp_f(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
         void *ud)
@@ -1568,6 +1638,12 @@ cmp_f(struct pcutils_array_list_node *l, struct pcutils_array_list_node *r,
     return d->cmp(nl->val, nr->val, d->ud);
 }
 
+static purc_variant_t
+set_node_val(struct pcutils_array_list_node *node)
+{
+    return container_of(node, struct set_node, alnode)->val;
+}
+
 int pcvariant_set_sort(purc_variant_t value, void *ud,
         int (*cmp)(purc_variant_t l, purc_variant_t r, void *ud))
 {
@@ -1576,8 +1652,13 @@ int pcvariant_set_sort(purc_variant_t value, void *ud,
     variant_set_t data = pcvar_set_get_data(value);
     struct pcutils_array_list *al = &data->al;
 
+    /* the default comparison stringifies the values: do it only once */
+    if (cmp == NULL)
+        return pcvar_sort_al_by_keys(al, set_node_val, ud,
+                &pcvar_cmpopt_sort_ops);
+
     struct set_user_data d = {
-        .cmp = cmp ? cmp : vrtcmp,
+        .cmp = cmp,
         .ud  = ud,
     };
 
@@ -1586,6 +1667,16 @@ int pcvariant_set_sort(purc_variant_t value, void *ud,
     return 0;
 }
 
+int pcvariant_set_sort_by_keys(purc_variant_t value, void *ud,
+        const struct pcvariant_sort_ops *ops)
+{
+    PC_ASSERT(value != PURC_VARIANT_INVALID);
+
+    variant_set_t data = pcvar_set_get_data(value);
+
+    return pcvar_sort_al_by_keys(&data->al, set_node_val, ud, ops);
+}
+
 purc_variant_t
 pcvariant_set_find(purc_variant_t set, purc_variant_t value)
 {
@@ -1925,7 +2016,7 @@ pcvar_kv_it_first(purc_variant_t set, purc_variant_t obj)
     it.it = pcvar_obj_it_first(obj);
 
     while (it.it.curr) {
-        struct obj_node *curr = it.it.curr;
+        struct obj_member *curr = it.it.curr;
         purc_variant_t key = curr->key;
         const char *sk = purc_variant_get_string_const(key);
         for (size_t i=0; i<data->nr_keynames; ++i) {
@@ -1973,7 +2064,7 @@ pcvar_kv_it_next(struct kv_iterator *it)
         pcvar_obj_it_next(&it->it);
         if (it->it.curr == NULL)
             return;
-        struct obj_node *curr = it->it.curr;
+        struct obj_member *curr = it->it.curr;
         purc_variant_t key = curr->key;
         const char *sk = purc_variant_get_string_const(key);
         for (size_t i=0; i<data->nr_keynames; ++i) {
@@ -2090,6 +2181,7 @@ pcvar_readjust_set(purc_variant_t set, struct set_node *node)
     PC_ASSERT(purc_variant_is_set(set));
     variant_set_t data = pcvar_set_get_data(set);
 
+    hash_index_remove(data, node);
     pcutils_rbtree_erase(&node->rbnode, &data->elems);
 
     struct element_rb_node rbn;
@@ -2101,6 +2193,7 @@ pcvar_readjust_set(purc_variant_t set, struct set_node *node)
     pcutils_rbtree_link_node(entry, rbn.parent, rbn.pnode);
     pcutils_rbtree_insert_color(entry, &data->elems);
 
-    return 0;
+    node->hash = rbn.hash;
+    return hash_index_add(data, node);
 }
 
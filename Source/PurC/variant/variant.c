@@ -26,6 +26,7 @@
 #include "private/variant.h"
 #include "private/instance.h"
 #include "private/ejson.h"
+#include "private/rwstream.h"
 #include "private/vcm.h"
 #include "private/errors.h"
 #include "private/debug.h"
@@ -86,32 +87,18 @@ static struct err_msg_seg _variant_err_msgs_seg = {
     variant_err_msgs
 };
 
-#if HAVE(GLIB)
 purc_variant *pcvariant_alloc(void) {
-    return (purc_variant *)g_slice_alloc(sizeof(purc_variant));
+    return (purc_variant *)pcvariant_slab_alloc(sizeof(purc_variant));
 }
 
 purc_variant *pcvariant_alloc_0(void) {
-    return (purc_variant *)g_slice_alloc0(sizeof(purc_variant));
+    return (purc_variant *)pcvariant_slab_alloc_0(sizeof(purc_variant));
 }
 
 void pcvariant_free(purc_variant *v) {
-    return g_slice_free1(sizeof(purc_variant), (gpointer)v);
-}
-#else
-purc_variant *pcvariant_alloc(void) {
-    return (purc_variant *)malloc(sizeof(purc_variant));
-}
-
-purc_variant *pcvariant_alloc_0(void) {
-    return (purc_variant *)calloc(1, sizeof(purc_variant));
+    pcvariant_slab_free(v);
 }
 
-void pcvariant_free(purc_variant *v) {
-    return free(v);
-}
-#endif
-
 purc_atom_t pcvariant_atom_grow;
 purc_atom_t pcvariant_atom_shrink;
 purc_atom_t pcvariant_atom_change;
@@ -171,6 +158,9 @@ static void _cleanup_instance(struct pcinst *inst)
     assert(heap->v_true.refc == 0);
     assert(heap->v_false.refc == 0);
 
+    if (heap->slab)
+        pcvariant_slab_delete(heap->slab);
+
     free(heap);
     inst->variant_heap = NULL;
     inst->org_vrt_heap = NULL;
@@ -190,6 +180,14 @@ static int _init_instance(struct pcinst *curr_inst,
 
     inst->org_vrt_heap = inst->variant_heap;
 
+    inst->variant_heap->slab = pcvariant_slab_new();
+    if (inst->variant_heap->slab == NULL) {
+        free(inst->variant_heap);
+        inst->variant_heap = NULL;
+        inst->org_vrt_heap = NULL;
+        return PURC_ERROR_OUT_OF_MEMORY;
+    }
+
     // initialize const values in instance
     inst->variant_heap->v_undefined.type = PURC_VARIANT_TYPE_UNDEFINED;
     inst->variant_heap->v_undefined.refc = 0;
@@ -344,7 +342,7 @@ purc_variant_t purc_variant_ref (purc_variant_t value)
         return PURC_VARIANT_INVALID;
     }
 
-    value->refc++;
+    pcvariant_refc_inc(value);
 
     referenced(value);
 
@@ -364,10 +362,13 @@ unsigned int purc_variant_unref(purc_variant_t value)
     // FIXME: pre or post?
     unreferenced(value);
 
-    value->refc--;
+    unsigned int refc = pcvariant_refc_dec(value);
 
     // VWNOTE: only non-constant values has a releaser
-    if (value->refc == 0 && !(value->flags & PCVARIANT_FLAG_NOFREE)) {
+    if (refc == 0 && !(value->flags & PCVARIANT_FLAG_NOFREE)) {
+        if (value->flags & PCVARIANT_FLAG_FROZEN)
+            pcvariant_move_heap_thaw(value);
+
         // release the extra memory used by the variant
         pcvariant_release_fn release_fn = variant_releasers[value->type];
         if (release_fn)
@@ -378,7 +379,7 @@ unsigned int purc_variant_unref(purc_variant_t value)
         return 0;
     }
 
-    return value->refc;
+    return refc;
 }
 
 const struct purc_variant_stat *purc_variant_usage_stat(void)
@@ -398,6 +399,10 @@ const struct purc_variant_stat *purc_variant_usage_stat(void)
     value = &(inst->variant_heap->v_false);
     inst->variant_heap->stat.nr_values[PURC_VARIANT_TYPE_BOOLEAN] += value->refc;
 
+    if (inst->org_vrt_heap->slab)
+        pcvariant_slab_stat(inst->org_vrt_heap->slab,
+                &inst->variant_heap->stat);
+
     return &inst->variant_heap->stat;
 }
 
@@ -1607,12 +1612,193 @@ int purc_variant_compare_ex (purc_variant_t v1,
     return compare;
 }
 
-purc_variant_t purc_variant_load_from_json_stream(purc_rwstream_t stream)
+const char *
+pcvariant_sort_key_string(purc_variant_t val, char **buf)
 {
-    if (stream  == NULL) {
-        return PURC_VARIANT_INVALID;
+    *buf = NULL;
+
+    switch (val->type) {
+        case PURC_VARIANT_TYPE_STRING:
+            return purc_variant_get_string_const(val);
+
+        case PURC_VARIANT_TYPE_ATOMSTRING:
+            return purc_variant_get_atom_string_const(val);
+
+        case PURC_VARIANT_TYPE_EXCEPTION:
+            return purc_variant_get_exception_string_const(val);
+
+        default:
+            break;
     }
 
+    if (purc_variant_stringify_alloc(buf, val) < 0) {
+        *buf = NULL;
+        return NULL;
+    }
+
+    return *buf;
+}
+
+static void
+free_sort_keys(char *keys, size_t nr, void *ud,
+        const struct pcvariant_sort_ops *ops)
+{
+    // keys not made are all zeros
+    if (ops->free_key) {
+        for (size_t i = 0; i < nr; i++)
+            ops->free_key(keys + i * ops->key_size, ud);
+    }
+    free(keys);
+}
+
+int
+pcvar_sort_al_by_keys(struct pcutils_array_list *al,
+        purc_variant_t (*node_val)(struct pcutils_array_list_node *node),
+        void *ud, const struct pcvariant_sort_ops *ops)
+{
+    size_t nr = al->nr;
+    if (nr < 2 || ops->key_size == 0)
+        return 0;
+
+    char *keys = (char *)calloc(nr, ops->key_size);
+    if (keys == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    int r = 0;
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t val = node_val(al->nodes[i]);
+        r = ops->make_key(val, keys + i * ops->key_size, ud);
+        if (r)
+            break;
+    }
+
+    if (r == 0) {
+        r = pcutils_array_list_sort_by_keys(al, keys, ops->key_size, ud,
+                ops->cmp_key);
+        if (r)
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    }
+
+    free_sort_keys(keys, nr, ud, ops);
+    return r ? -1 : 0;
+}
+
+int
+pcvar_sort_vals_by_keys(const purc_variant_t *vals, size_t nr,
+        void *ud, const struct pcvariant_sort_ops *ops, size_t *idx)
+{
+    if (nr < 2 || ops->key_size == 0) {
+        for (size_t i = 0; i < nr; i++)
+            idx[i] = i;
+        return 0;
+    }
+
+    char *keys = (char *)calloc(nr, ops->key_size);
+    if (keys == NULL) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return -1;
+    }
+
+    int r = 0;
+    for (size_t i = 0; i < nr; i++) {
+        r = ops->make_key(vals[i], keys + i * ops->key_size, ud);
+        if (r)
+            break;
+    }
+
+    if (r == 0) {
+        r = pcutils_sort_index_by_keys(keys, nr, ops->key_size, ud,
+                ops->cmp_key, idx);
+        if (r)
+            pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+    }
+
+    free_sort_keys(keys, nr, ud, ops);
+    return r ? -1 : 0;
+}
+
+struct cmpopt_sort_key {
+    double          number;
+    const char     *str;
+    char           *buf;
+    bool            is_number;
+};
+
+static int
+cmpopt_make_key(purc_variant_t val, void *key, void *ud)
+{
+    struct cmpopt_sort_key *k = (struct cmpopt_sort_key *)key;
+    purc_vrtcmp_opt_t opt;
+    opt = (purc_vrtcmp_opt_t)((uintptr_t)ud & PCVARIANT_CMPOPT_MASK);
+
+    k->is_number = (val->type == PURC_VARIANT_TYPE_NUMBER) ||
+        (val->type == PURC_VARIANT_TYPE_LONGINT) ||
+        (val->type == PURC_VARIANT_TYPE_ULONGINT) ||
+        (val->type == PURC_VARIANT_TYPE_LONGDOUBLE);
+
+    if (opt == PCVARIANT_COMPARE_OPT_NUMBER ||
+            opt == PCVARIANT_COMPARE_OPT_AUTO)
+        k->number = purc_variant_numberify(val);
+
+    if (opt != PCVARIANT_COMPARE_OPT_NUMBER) {
+        k->str = pcvariant_sort_key_string(val, &k->buf);
+        if (k->str == NULL)
+            k->str = "";
+    }
+
+    return 0;
+}
+
+/* the same as purc_variant_compare_ex() on the values of the keys */
+static int
+cmpopt_cmp_key(const void *l, const void *r, void *ud)
+{
+    const struct cmpopt_sort_key *kl = (const struct cmpopt_sort_key *)l;
+    const struct cmpopt_sort_key *kr = (const struct cmpopt_sort_key *)r;
+    uintptr_t sort_flags = (uintptr_t)ud;
+    purc_vrtcmp_opt_t opt;
+    opt = (purc_vrtcmp_opt_t)(sort_flags & PCVARIANT_CMPOPT_MASK);
+
+    int retv;
+    if (opt == PCVARIANT_COMPARE_OPT_NUMBER ||
+            (opt == PCVARIANT_COMPARE_OPT_AUTO && kl->is_number)) {
+        if (pcutils_equal_doubles(kl->number, kr->number))
+            retv = 0;
+        else
+            retv = kl->number < kr->number ? -1 : 1;
+    }
+    else if (opt == PCVARIANT_COMPARE_OPT_CASELESS) {
+        retv = pcutils_strcasecmp(kl->str, kr->str);
+    }
+    else {
+        retv = strcmp(kl->str, kr->str);
+    }
+
+    if (sort_flags & PCVARIANT_SORT_DESC)
+        retv = -retv;
+    return retv;
+}
+
+static void
+cmpopt_free_key(void *key, void *ud)
+{
+    UNUSED_PARAM(ud);
+
+    struct cmpopt_sort_key *k = (struct cmpopt_sort_key *)key;
+    free(k->buf);
+}
+
+const struct pcvariant_sort_ops pcvar_cmpopt_sort_ops = {
+    .key_size       = sizeof(struct cmpopt_sort_key),
+    .make_key       = cmpopt_make_key,
+    .cmp_key        = cmpopt_cmp_key,
+    .free_key       = cmpopt_free_key,
+};
+
+static purc_variant_t load_from_ejson_stream(purc_rwstream_t stream)
+{
     purc_variant_t value = PURC_VARIANT_INVALID;
     struct pcvcm_node* root = NULL;
     struct pcejson* parser = NULL;
@@ -1630,14 +1816,40 @@ ret:
     return value;
 }
 
+purc_variant_t purc_variant_load_from_json_stream(purc_rwstream_t stream)
+{
+    if (stream  == NULL) {
+        return PURC_VARIANT_INVALID;
+    }
+
+    /* try the fast path for plain JSON in memory first */
+    const uint8_t *mem;
+    size_t sz, consumed;
+    if ((mem = pcrwstream_peek_mem(stream, &sz))) {
+        purc_variant_t value = pcejson_parse_json((const char *)mem, sz,
+                PCEJSON_DEFAULT_DEPTH, &consumed);
+        if (value != PURC_VARIANT_INVALID) {
+            pcrwstream_consume_mem(stream, consumed);
+            return value;
+        }
+    }
+
+    return load_from_ejson_stream(stream);
+}
+
 purc_variant_t purc_variant_make_from_json_string(const char* json, size_t sz)
 {
     purc_variant_t value;
+
+    value = pcejson_parse_json(json, sz, PCEJSON_DEFAULT_DEPTH, NULL);
+    if (value != PURC_VARIANT_INVALID)
+        return value;
+
     purc_rwstream_t rwstream = purc_rwstream_new_from_mem((void*)json, sz);
     if (rwstream == NULL)
         return PURC_VARIANT_INVALID;
 
-    value = purc_variant_load_from_json_stream(rwstream);
+    value = load_from_ejson_stream(rwstream);
     purc_rwstream_destroy(rwstream);
 
     return value;
@@ -2843,22 +3055,15 @@ cmp_by_obj(purc_variant_t l, purc_variant_t r,
 {
     int diff;
 
-    variant_obj_t ld, rd;
-    ld = (variant_obj_t)l->sz_ptr[1];
-    rd = (variant_obj_t)r->sz_ptr[1];
-    PC_ASSERT(ld);
-    PC_ASSERT(rd);
-    struct rb_root *lroot = &ld->kvs;
-    struct rb_root *rroot = &rd->kvs;
-    struct rb_node *lnode = pcutils_rbtree_first(lroot);
-    struct rb_node *rnode = pcutils_rbtree_first(rroot);
+    struct obj_iterator lit = pcvar_obj_it_first(l);
+    struct obj_iterator rit = pcvar_obj_it_first(r);
     for (;
-        lnode && rnode;
-        lnode = pcutils_rbtree_next(lnode), rnode = pcutils_rbtree_next(rnode))
+        lit.curr && rit.curr;
+        pcvar_obj_it_next(&lit), pcvar_obj_it_next(&rit))
     {
-        struct obj_node *lo, *ro;
-        lo = container_of(lnode, struct obj_node, node);
-        ro = container_of(rnode, struct obj_node, node);
+        struct obj_member *lo, *ro;
+        lo = lit.curr;
+        ro = rit.curr;
         PC_ASSERT(lo->key);
         PC_ASSERT(ro->key);
         const char *lk = purc_variant_get_string_const(lo->key);
@@ -2881,9 +3086,9 @@ cmp_by_obj(purc_variant_t l, purc_variant_t r,
             return diff;
     }
 
-    if (lnode)
+    if (lit.curr)
         return 1;
-    else if (rnode)
+    else if (rit.curr)
         return -1;
     else
         return 0;
@@ -2901,23 +3106,10 @@ cmp_by_arr(purc_variant_t l, purc_variant_t r,
     PC_ASSERT(ld);
     PC_ASSERT(rd);
 
-    struct pcutils_array_list *la = &ld->al;
-    struct pcutils_array_list *ra = &rd->al;
-
-    struct pcutils_array_list_node *lnode = pcutils_array_list_get_first(la);
-    struct pcutils_array_list_node *rnode = pcutils_array_list_get_first(ra);
-
-    for (;
-        lnode && rnode;
-        lnode = pcutils_array_list_get(la, lnode->idx + 1),
-        rnode = pcutils_array_list_get(ra, rnode->idx + 1))
-    {
-        struct arr_node *lo, *ro;
-        lo = container_of(lnode, struct arr_node, node);
-        ro = container_of(rnode, struct arr_node, node);
-
-        purc_variant_t lv = lo->val;
-        purc_variant_t rv = ro->val;
+    size_t i;
+    for (i = 0; i < ld->nr && i < rd->nr; i++) {
+        purc_variant_t lv = ld->vals[i];
+        purc_variant_t rv = rd->vals[i];
         PC_ASSERT(lv != PURC_VARIANT_INVALID);
         PC_ASSERT(rv != PURC_VARIANT_INVALID);
 
@@ -2926,9 +3118,9 @@ cmp_by_arr(purc_variant_t l, purc_variant_t r,
             return diff;
     }
 
-    if (lnode)
+    if (i < ld->nr)
         return 1;
-    else if (rnode)
+    else if (i < rd->nr)
         return -1;
     else
         return 0;
@@ -3568,148 +3760,178 @@ purc_variant_linear_container_set(purc_variant_t container,
     return false;
 }
 
+/* 64-bit FNV-1a over the stringified form of a variant. The set compares
+ * its members by the stringified form (see compare_string_method), thus
+ * the hash is fed with the same byte stream, chunk by chunk, and stops at
+ * the first NUL just like strcmp() does. */
+#define HASH_FNV64_OFFSET           0xcbf29ce484222325ULL
+#define HASH_FNV64_PRIME            0x00000100000001b3ULL
+
+struct stringify_hash {
+    uint64_t        hash;
+    bool            ended;
+};
+
 static void
-do_stringify_md5(struct stringify_arg *arg, const void *src, size_t len)
+do_stringify_hash(struct stringify_arg *arg, const void *src, size_t len)
 {
-    pcutils_md5_ctxt *ud;
-    ud = (pcutils_md5_ctxt*)(arg->arg);
+    struct stringify_hash *ud;
+    ud = (struct stringify_hash*)(arg->arg);
 
-    if (len == 0)
-        len = strlen(src);
+    if (ud->ended)
+        return;
+
+    const unsigned char *p = (const unsigned char *)src;
+    const unsigned char *end = p + (len ? len : strlen(src));
+    uint64_t hash = ud->hash;
+
+    while (p < end) {
+        unsigned char c = *p++;
+        if (c == 0) {
+            ud->ended = true;
+            break;
+        }
+        hash ^= c;
+        hash *= HASH_FNV64_PRIME;
+    }
 
-    pcutils_md5_hash(ud, src, len);
+    ud->hash = hash;
 }
 
-void pcvariant_md5_ex(char *md5, purc_variant_t val, const char *salt,
-    bool caseless, unsigned int serialize_flags)
+uint64_t
+pcvariant_hash(purc_variant_t val)
 {
-    PC_ASSERT(caseless == false);
-
     PC_ASSERT(val != PURC_VARIANT_INVALID);
 
-    pcutils_md5_ctxt ud;
-
-    pcutils_md5_begin(&ud);
+    struct stringify_hash ud = { HASH_FNV64_OFFSET, false };
 
     struct stringify_arg arg;
-    arg.cb    = do_stringify_md5;
+    arg.cb    = do_stringify_hash;
     arg.arg   = &ud;
-    arg.flags = serialize_flags;
+    arg.flags = 0;
 
     variant_stringify(&arg, val);
 
-    if (salt)
-        pcutils_md5_hash(&ud, salt, strlen(salt));
-
-    unsigned char md5_digest[MD5_DIGEST_SIZE];
-    pcutils_md5_end(&ud, md5_digest);
-
-    bool uppercase = true;
-    pcutils_bin2hex(md5_digest, MD5_DIGEST_SIZE, md5, uppercase);
+    return ud.hash;
 }
 
-void
-pcvariant_md5_by_set(char *md5, purc_variant_t val, purc_variant_t set)
+uint64_t
+pcvariant_hash_by_set(purc_variant_t val, purc_variant_t set)
 {
-    PC_ASSERT(md5);
     PC_ASSERT(val != PURC_VARIANT_INVALID);
     PC_ASSERT(set != PURC_VARIANT_INVALID);
 
     variant_set_t data = pcvar_set_get_data(set);
     PC_ASSERT(data);
 
-    if (data->unique_key == NULL) {
-        pcvariant_md5(md5, val);
-        return;
-    }
-
-    purc_variant_t undefined = purc_variant_make_undefined();
-    PC_ASSERT(undefined);
-
-    if (val->type != PVT(_OBJECT)) {
-        pcvariant_md5(md5, undefined);
-        purc_variant_unref(undefined);
-        return;
-    }
-
-    pcutils_md5_ctxt ud;
+    if (data->unique_key == NULL)
+        return pcvariant_hash(val);
 
-    pcutils_md5_begin(&ud);
+    struct stringify_hash ud = { HASH_FNV64_OFFSET, false };
 
     struct stringify_arg arg;
-    arg.cb    = do_stringify_md5;
+    arg.cb    = do_stringify_hash;
     arg.arg   = &ud;
     arg.flags = 0;
 
     for (size_t i=0; i<data->nr_keynames; ++i) {
-        purc_variant_t v;
-        v = purc_variant_object_get_by_ckey(val, data->keynames[i]);
-        if (v == PURC_VARIANT_INVALID) {
-            v = undefined;
+        purc_variant_t v = PURC_VARIANT_INVALID;
+        if (val->type == PVT(_OBJECT)) {
+            v = purc_variant_object_get_by_ckey(val, data->keynames[i]);
+            if (v == PURC_VARIANT_INVALID)
+                purc_clr_error();
         }
-        stringify_kv(&arg, data->keynames[i], v);
-    }
 
-    unsigned char md5_digest[MD5_DIGEST_SIZE];
-    pcutils_md5_end(&ud, md5_digest);
+        // the unique keys are compared one by one
+        ud.ended = false;
+        if (v == PURC_VARIANT_INVALID)
+            arg.cb(&arg, "undefined", 0);
+        else
+            variant_stringify(&arg, v);
 
-    bool uppercase = true;
-    pcutils_bin2hex(md5_digest, MD5_DIGEST_SIZE, md5, uppercase);
+        ud.hash ^= 0xFF;
+        ud.hash *= HASH_FNV64_PRIME;
+    }
 
-    purc_variant_unref(undefined);
+    return ud.hash;
 }
 
-int
-pcvariant_diff_by_set(const char *md5l, purc_variant_t l,
-        const char *md5r, purc_variant_t r, purc_variant_t set)
+static inline uint64_t
+hash_fnv64(uint64_t hash, const void *bytes, size_t len)
 {
-    // TODO: https://gitlab.fmsoft.cn/hvml/hvml-docs/-/blob/master/zh/hvml-spec-v1.0-zh.md#21610-%E9%9B%86%E5%90%88%E5%8F%98%E9%87%8F
-
-    PC_ASSERT(md5l);
-    PC_ASSERT(l != PURC_VARIANT_INVALID);
-    PC_ASSERT(md5r);
-    PC_ASSERT(r != PURC_VARIANT_INVALID);
+    const unsigned char *p = (const unsigned char *)bytes;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= HASH_FNV64_PRIME;
+    }
+    return hash;
+}
 
-    PC_ASSERT(set != PURC_VARIANT_INVALID);
+uint64_t
+pcvariant_hash_equal(purc_variant_t val)
+{
+    uint64_t hash = HASH_FNV64_OFFSET;
+    const void *bytes = NULL;
+    size_t len = 0;
 
-    int diff;
+    if (val == PURC_VARIANT_INVALID)
+        return hash;
 
-    variant_set_t data = pcvar_set_get_data(set);
-    PC_ASSERT(data);
+    unsigned int type = val->type;
+    hash = hash_fnv64(hash, &type, sizeof(type));
 
-    if (data->unique_key == NULL) {
-        return pcvariant_diff(l, r);
-    }
+    /* the numbers are compared with a tolerance and the members of
+       the containers are compared recursively; the containers are
+       hashed by their types only, since they change in place while
+       hashed in the indexes of the observers and the queued events. */
+    switch (type) {
+    case PURC_VARIANT_TYPE_BOOLEAN:
+        bytes = &val->b;
+        len = sizeof(val->b);
+        break;
 
-    diff = strcmp(md5l, md5r);
-    if (diff)
-        return diff;
+    case PURC_VARIANT_TYPE_EXCEPTION:
+    case PURC_VARIANT_TYPE_ATOMSTRING:
+        bytes = purc_atom_to_string(val->atom);
+        len = strlen(bytes);
+        break;
 
-    purc_variant_t undefined = purc_variant_make_undefined();
-    PC_ASSERT(undefined);
+    case PURC_VARIANT_TYPE_LONGINT:
+        bytes = &val->i64;
+        len = sizeof(val->i64);
+        break;
 
-    for (size_t i=0; i<data->nr_keynames; ++i) {
-        purc_variant_t vl = PURC_VARIANT_INVALID;
-        purc_variant_t vr = PURC_VARIANT_INVALID;
+    case PURC_VARIANT_TYPE_ULONGINT:
+        bytes = &val->u64;
+        len = sizeof(val->u64);
+        break;
 
-        if (l->type == PVT(_OBJECT))
-            vl = purc_variant_object_get_by_ckey(l, data->keynames[i]);
-        if (r->type == PVT(_OBJECT))
-            vr = purc_variant_object_get_by_ckey(r, data->keynames[i]);
+    case PURC_VARIANT_TYPE_STRING:
+    case PURC_VARIANT_TYPE_BSEQUENCE:
+        if (val->flags & (PCVARIANT_FLAG_STRING_STATIC |
+                    PCVARIANT_FLAG_EXTRA_SIZE)) {
+            bytes = (const void *)val->sz_ptr[1];
+            len = val->sz_ptr[0];
+        }
+        else {
+            bytes = val->bytes;
+            len = val->size;
+        }
+        break;
 
-        if (vl == PURC_VARIANT_INVALID)
-            vl = undefined;
-        if (vr == PURC_VARIANT_INVALID)
-            vr = undefined;
+    case PURC_VARIANT_TYPE_DYNAMIC:
+    case PURC_VARIANT_TYPE_NATIVE:
+        bytes = val->ptr_ptr;
+        len = sizeof(void *) * 2;
+        break;
 
-        diff = pcvariant_diff(vl, vr);
-        if (diff)
-            break;
+    default:
+        break;
     }
 
-    purc_variant_unref(undefined);
-
-    return diff;
+    if (bytes)
+        return hash_fnv64(hash, bytes, len);
+    return hash_fnv64(hash, &len, sizeof(len));
 }
 
 bool pcvariant_is_scalar(purc_variant_t v)
@@ -1130,6 +1130,25 @@ purc_variant_t pcvcm_node_get_variable_to_variant(struct pcvcm_node *node,
         goto out;
     }
 
+    if(!ops->find_var) {
+        pcinst_set_error(PCVARIANT_ERROR_NOT_FOUND);
+        goto out;
+    }
+
+    /* a constant name is used as is, without making a string variant */
+    if (name_node->type == PCVCM_NODE_TYPE_STRING) {
+        const char *name = (const char*)name_node->sz_ptr[1];
+        if (name_node->sz_ptr[0] == 0) {
+            goto out;
+        }
+
+        ret = ops->find_var(ops->find_var_ctxt, name);
+        if (ret) {
+            purc_variant_ref(ret);
+        }
+        goto out;
+    }
+
     purc_variant_t name_var = pcvcm_node_to_variant(name_node, ops,
             silently);
     if (name_var == PURC_VARIANT_INVALID) {
@@ -1146,11 +1165,6 @@ purc_variant_t pcvcm_node_get_variable_to_variant(struct pcvcm_node *node,
         goto out_unref_name_var;
     }
 
-    if(!ops->find_var) {
-        pcinst_set_error(PCVARIANT_ERROR_NOT_FOUND);
-        goto out_unref_name_var;
-    }
-
     ret = ops->find_var(ops->find_var_ctxt, name);
     if (ret) {
         purc_variant_ref(ret);
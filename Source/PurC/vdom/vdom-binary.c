@@ -0,0 +1,643 @@
+/*
+ * @file vdom-binary.c
+ * @date 2026/10/16
+ * @brief The compact binary form of vDOM.
+ *
+ * Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+ *
+ * This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * The binary form is a pre-order dump of the vDOM tree, including the vCM
+ * trees of attributes and contents, so that loading it needs no tokenizing
+ * at all:
+ *
+ *  header:     "PVDM", version, sizeof(long double), byte order mark
+ *  document:   flags, [doctype name, doctype system info], children
+ *  children:   count, then each node as node type and node body
+ *  element:    tag name, flags, attributes (count, then key, operator and
+ *              an optional vCM tree for each), children
+ *  content:    vCM tree
+ *  comment:    text
+ *  vCM tree:   type, extra, closed flag, scalar value if any, count and
+ *              children
+ *
+ * Integers are encoded as LEB128; strings as the length followed by the
+ * bytes and a terminating null byte, so that they can be used in place.
+ *
+ * Both the writer and the reader recurse into the nested elements and vCM
+ * nodes, so a tree nested deeper than BIN_MAX_DEPTH is refused.
+ */
+
+#include "private/instance.h"
+#include "private/errors.h"
+#include "private/debug.h"
+#include "private/utils.h"
+#include "private/vdom.h"
+
+#include "vdom-internal.h"
+
+#define BIN_MAGIC               "PVDM"
+#define BIN_BOM                 0x0102
+
+#define DOC_FLAG_DOCTYPE        0x01
+#define DOC_FLAG_QUIRKS         0x02
+
+#define ELEM_FLAG_SELF_CLOSING  0x01
+#define ELEM_FLAG_HEAD          0x02
+#define ELEM_FLAG_BODY          0x04
+#define ELEM_FLAG_CURR_BODY     0x08
+
+#define ATTR_FLAG_VALUE         0x01
+
+/* the maximal nesting depth of the elements and vCM nodes, in total */
+#define BIN_MAX_DEPTH           1024
+
+struct bin_writer {
+    purc_rwstream_t     out;
+    int                 failed;
+};
+
+struct bin_reader {
+    const unsigned char *p;
+    const unsigned char *end;
+};
+
+static void
+put_bytes(struct bin_writer *w, const void *buf, size_t len)
+{
+    if (w->failed || len == 0)
+        return;
+
+    if (purc_rwstream_write(w->out, buf, len) != (ssize_t)len)
+        w->failed = 1;
+}
+
+static inline void
+put_byte(struct bin_writer *w, uint8_t byte)
+{
+    put_bytes(w, &byte, 1);
+}
+
+static void
+put_uint(struct bin_writer *w, uint64_t v)
+{
+    uint8_t buf[10];
+    size_t n = 0;
+
+    do {
+        buf[n] = v & 0x7F;
+        v >>= 7;
+        if (v)
+            buf[n] |= 0x80;
+        n++;
+    } while (v);
+
+    put_bytes(w, buf, n);
+}
+
+static void
+put_str(struct bin_writer *w, const char *s, size_t len)
+{
+    put_uint(w, len);
+    put_bytes(w, s, len);
+    put_byte(w, 0);
+}
+
+static void
+put_vcm(struct bin_writer *w, struct pcvcm_node *vcm, unsigned depth)
+{
+    if (depth > BIN_MAX_DEPTH) {
+        w->failed = 1;
+        return;
+    }
+
+    put_byte(w, vcm->type);
+    put_uint(w, vcm->extra);
+    put_byte(w, vcm->is_closed);
+
+    switch (vcm->type) {
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        put_byte(w, vcm->b);
+        break;
+
+    case PCVCM_NODE_TYPE_NUMBER:
+        put_bytes(w, &vcm->d, sizeof(vcm->d));
+        break;
+
+    case PCVCM_NODE_TYPE_LONG_INT:
+    case PCVCM_NODE_TYPE_ULONG_INT:
+        put_uint(w, vcm->u64);
+        break;
+
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        put_bytes(w, &vcm->ld, sizeof(vcm->ld));
+        break;
+
+    case PCVCM_NODE_TYPE_STRING:
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        put_str(w, (const char *)vcm->sz_ptr[1], vcm->sz_ptr[0]);
+        break;
+
+    default:
+        break;
+    }
+
+    put_uint(w, pctree_node_children_number(&vcm->tree_node));
+    struct pctree_node *child = pctree_node_child(&vcm->tree_node);
+    for (; child && !w->failed; child = pctree_node_next(child)) {
+        put_vcm(w, (struct pcvcm_node *)child, depth + 1);
+    }
+}
+
+struct attr_writer {
+    struct bin_writer  *w;
+    unsigned            depth;
+};
+
+static int
+put_attr(void *key, void *val, void *ctxt)
+{
+    struct pcvdom_attr *attr = (struct pcvdom_attr *)val;
+    struct attr_writer *aw = (struct attr_writer *)ctxt;
+    struct bin_writer *w = aw->w;
+    UNUSED_PARAM(key);
+
+    put_str(w, attr->key, strlen(attr->key));
+    put_byte(w, attr->op);
+    put_byte(w, attr->val ? ATTR_FLAG_VALUE : 0);
+    if (attr->val)
+        put_vcm(w, attr->val, aw->depth);
+
+    return w->failed ? -1 : 0;
+}
+
+static bool
+is_body(struct pcvdom_document *doc, struct pcvdom_element *elem)
+{
+    size_t nr = pcutils_arrlist_length(doc->bodies);
+    for (size_t i = 0; i < nr; i++) {
+        if (pcutils_arrlist_get_idx(doc->bodies, i) == elem)
+            return true;
+    }
+
+    return false;
+}
+
+static void
+put_children(struct bin_writer *w, struct pcvdom_document *doc,
+        struct pcvdom_node *node, unsigned depth);
+
+static void
+put_element(struct bin_writer *w, struct pcvdom_document *doc,
+        struct pcvdom_element *elem, unsigned depth)
+{
+    if (depth > BIN_MAX_DEPTH) {
+        w->failed = 1;
+        return;
+    }
+
+    uint8_t flags = 0;
+    if (elem->self_closing)
+        flags |= ELEM_FLAG_SELF_CLOSING;
+    if (doc->head == elem)
+        flags |= ELEM_FLAG_HEAD;
+    if (is_body(doc, elem))
+        flags |= ELEM_FLAG_BODY;
+    if (doc->body == elem)
+        flags |= ELEM_FLAG_CURR_BODY;
+
+    put_str(w, elem->tag_name, strlen(elem->tag_name));
+    put_byte(w, flags);
+
+    struct attr_writer aw = { w, depth + 1 };
+    put_uint(w, pcutils_map_get_size(elem->attrs));
+    pcutils_map_traverse(elem->attrs, &aw, put_attr);
+
+    put_children(w, doc, &elem->node, depth + 1);
+}
+
+static void
+put_children(struct bin_writer *w, struct pcvdom_document *doc,
+        struct pcvdom_node *node, unsigned depth)
+{
+    put_uint(w, pctree_node_children_number(&node->node));
+
+    struct pctree_node *child = pctree_node_child(&node->node);
+    for (; child && !w->failed; child = pctree_node_next(child)) {
+        struct pcvdom_node *vnode = (struct pcvdom_node *)child;
+        put_byte(w, vnode->type);
+
+        switch (vnode->type) {
+        case PCVDOM_NODE_ELEMENT:
+            put_element(w, doc, PCVDOM_ELEMENT_FROM_NODE(vnode), depth);
+            break;
+
+        case PCVDOM_NODE_CONTENT:
+            put_vcm(w, PCVDOM_CONTENT_FROM_NODE(vnode)->vcm, depth);
+            break;
+
+        case PCVDOM_NODE_COMMENT: {
+            const char *text = PCVDOM_COMMENT_FROM_NODE(vnode)->text;
+            put_str(w, text, strlen(text));
+            break;
+        }
+
+        default:
+            w->failed = 1;
+            break;
+        }
+    }
+}
+
+int
+pcvdom_util_document_write_binary(struct pcvdom_document *doc,
+        purc_rwstream_t out)
+{
+    struct bin_writer w = { out, 0 };
+
+    if (!doc || !out) {
+        pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+        return -1;
+    }
+
+    uint8_t header[8];
+    uint16_t bom = BIN_BOM;
+    memcpy(header, BIN_MAGIC, 4);
+    header[4] = PCVDOM_BINARY_VERSION;
+    header[5] = sizeof(long double);
+    memcpy(header + 6, &bom, sizeof(bom));
+    put_bytes(&w, header, sizeof(header));
+
+    uint8_t flags = 0;
+    if (doc->doctype.name)
+        flags |= DOC_FLAG_DOCTYPE;
+    if (doc->quirks)
+        flags |= DOC_FLAG_QUIRKS;
+    put_byte(&w, flags);
+
+    if (doc->doctype.name) {
+        const char *info = doc->doctype.system_info ?
+            doc->doctype.system_info : "";
+        put_str(&w, doc->doctype.name, strlen(doc->doctype.name));
+        put_str(&w, info, strlen(info));
+    }
+
+    put_children(&w, doc, &doc->node, 0);
+
+    if (w.failed) {
+        pcinst_set_error(PURC_ERROR_OUTPUT);
+        return -1;
+    }
+
+    return 0;
+}
+
+static bool
+get_bytes(struct bin_reader *r, const void **buf, size_t len)
+{
+    if ((size_t)(r->end - r->p) < len)
+        return false;
+
+    *buf = r->p;
+    r->p += len;
+    return true;
+}
+
+static bool
+get_byte(struct bin_reader *r, uint8_t *byte)
+{
+    if (r->p >= r->end)
+        return false;
+
+    *byte = *r->p++;
+    return true;
+}
+
+static bool
+get_uint(struct bin_reader *r, uint64_t *v)
+{
+    uint64_t result = 0;
+    unsigned shift = 0;
+
+    while (r->p < r->end && shift < 64) {
+        uint8_t byte = *r->p++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *v = result;
+            return true;
+        }
+        shift += 7;
+    }
+
+    return false;
+}
+
+static bool
+get_str(struct bin_reader *r, const char **s, size_t *len)
+{
+    uint64_t n;
+    const void *buf;
+
+    if (!get_uint(r, &n) || n >= (uint64_t)(r->end - r->p) ||
+            !get_bytes(r, &buf, n + 1))
+        return false;
+
+    *s = buf;
+    if ((*s)[n] != 0)
+        return false;
+
+    if (len)
+        *len = n;
+    return true;
+}
+
+static struct pcvcm_node *
+get_vcm(struct bin_reader *r, unsigned depth)
+{
+    uint8_t type, closed;
+    uint64_t extra, nr_children;
+    const void *buf;
+    const char *s;
+    size_t len;
+
+    if (depth > BIN_MAX_DEPTH)
+        return NULL;
+
+    if (!get_byte(r, &type) || type > PCVCM_NODE_TYPE_CJSONEE_OP_SEMICOLON ||
+            !get_uint(r, &extra) || !get_byte(r, &closed))
+        return NULL;
+
+    struct pcvcm_node *vcm = calloc(1, sizeof(*vcm));
+    if (!vcm) {
+        pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+        return NULL;
+    }
+
+    vcm->type = type;
+    vcm->extra = extra;
+    vcm->is_closed = closed;
+
+    switch (vcm->type) {
+    case PCVCM_NODE_TYPE_BOOLEAN:
+        if (!get_byte(r, &closed))
+            goto failed;
+        vcm->b = closed;
+        break;
+
+    case PCVCM_NODE_TYPE_NUMBER:
+        if (!get_bytes(r, &buf, sizeof(vcm->d)))
+            goto failed;
+        memcpy(&vcm->d, buf, sizeof(vcm->d));
+        break;
+
+    case PCVCM_NODE_TYPE_LONG_INT:
+    case PCVCM_NODE_TYPE_ULONG_INT:
+        if (!get_uint(r, &vcm->u64))
+            goto failed;
+        break;
+
+    case PCVCM_NODE_TYPE_LONG_DOUBLE:
+        if (!get_bytes(r, &buf, sizeof(vcm->ld)))
+            goto failed;
+        memcpy(&vcm->ld, buf, sizeof(vcm->ld));
+        break;
+
+    case PCVCM_NODE_TYPE_STRING:
+    case PCVCM_NODE_TYPE_BYTE_SEQUENCE:
+        if (!get_str(r, &s, &len))
+            goto failed;
+
+        /* an empty byte sequence has no buffer */
+        if (len || vcm->type == PCVCM_NODE_TYPE_STRING) {
+            char *copy = malloc(len + 1);
+            if (!copy) {
+                pcinst_set_error(PURC_ERROR_OUT_OF_MEMORY);
+                goto failed;
+            }
+            memcpy(copy, s, len + 1);
+            vcm->sz_ptr[0] = len;
+            vcm->sz_ptr[1] = (uintptr_t)copy;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (!get_uint(r, &nr_children))
+        goto failed;
+
+    for (uint64_t i = 0; i < nr_children; i++) {
+        struct pcvcm_node *child = get_vcm(r, depth + 1);
+        if (!child)
+            goto failed;
+        pctree_node_append_child(&vcm->tree_node, &child->tree_node);
+    }
+
+    return vcm;
+
+failed:
+    pcvcm_node_destroy(vcm);
+    return NULL;
+}
+
+static int
+get_children(struct bin_reader *r, struct pcvdom_document *doc,
+        struct pcvdom_node *parent, unsigned depth);
+
+static struct pcvdom_element *
+get_element(struct bin_reader *r, struct pcvdom_document *doc,
+        unsigned depth)
+{
+    const char *tag, *key;
+    uint8_t flags, op, attr_flags;
+    uint64_t nr_attrs;
+
+    if (depth > BIN_MAX_DEPTH)
+        return NULL;
+
+    if (!get_str(r, &tag, NULL) || !get_byte(r, &flags) ||
+            !get_uint(r, &nr_attrs))
+        return NULL;
+
+    struct pcvdom_element *elem = pcvdom_element_create_c(tag);
+    if (!elem)
+        return NULL;
+
+    elem->self_closing = (flags & ELEM_FLAG_SELF_CLOSING) ? 1 : 0;
+
+    for (uint64_t i = 0; i < nr_attrs; i++) {
+        struct pcvcm_node *vcm = NULL;
+
+        if (!get_str(r, &key, NULL) || !get_byte(r, &op) ||
+                !get_byte(r, &attr_flags))
+            goto failed;
+
+        if ((attr_flags & ATTR_FLAG_VALUE) &&
+                !(vcm = get_vcm(r, depth + 1)))
+            goto failed;
+
+        struct pcvdom_attr *attr = pcvdom_attr_create(key, op, vcm);
+        if (!attr) {
+            pcvcm_node_destroy(vcm);
+            goto failed;
+        }
+
+        if (pcvdom_element_append_attr(elem, attr)) {
+            pcvdom_attr_destroy(attr);
+            goto failed;
+        }
+    }
+
+    if (get_children(r, doc, &elem->node, depth + 1))
+        goto failed;
+
+    if (flags & ELEM_FLAG_BODY) {
+        size_t nr = pcutils_arrlist_length(doc->bodies);
+        if (pcutils_arrlist_put_idx(doc->bodies, nr, elem))
+            goto failed;
+    }
+    if (flags & ELEM_FLAG_HEAD)
+        doc->head = elem;
+    if (flags & ELEM_FLAG_CURR_BODY)
+        doc->body = elem;
+
+    return elem;
+
+failed:
+    pcvdom_node_destroy(&elem->node);
+    return NULL;
+}
+
+static int
+get_children(struct bin_reader *r, struct pcvdom_document *doc,
+        struct pcvdom_node *parent, unsigned depth)
+{
+    uint64_t nr_children;
+    uint8_t type;
+
+    if (!get_uint(r, &nr_children))
+        return -1;
+
+    for (uint64_t i = 0; i < nr_children; i++) {
+        struct pcvdom_node *node = NULL;
+        struct pcvcm_node *vcm;
+        const char *text;
+
+        if (!get_byte(r, &type))
+            return -1;
+
+        switch (type) {
+        case PCVDOM_NODE_ELEMENT: {
+            struct pcvdom_element *elem = get_element(r, doc, depth);
+            if (!elem)
+                return -1;
+            node = &elem->node;
+            break;
+        }
+
+        case PCVDOM_NODE_CONTENT: {
+            if (!(vcm = get_vcm(r, depth)))
+                return -1;
+
+            struct pcvdom_content *content = pcvdom_content_create(vcm);
+            if (!content) {
+                pcvcm_node_destroy(vcm);
+                return -1;
+            }
+            node = &content->node;
+            break;
+        }
+
+        case PCVDOM_NODE_COMMENT: {
+            if (!get_str(r, &text, NULL))
+                return -1;
+
+            struct pcvdom_comment *comment = pcvdom_comment_create(text);
+            if (!comment)
+                return -1;
+            node = &comment->node;
+            break;
+        }
+
+        default:
+            return -1;
+        }
+
+        if (parent->type == PCVDOM_NODE_DOCUMENT &&
+                node->type == PCVDOM_NODE_ELEMENT) {
+            if (pcvdom_document_set_root(doc, PCVDOM_ELEMENT_FROM_NODE(node))) {
+                pcvdom_node_destroy(node);
+                return -1;
+            }
+        }
+        else {
+            pctree_node_append_child(&parent->node, &node->node);
+        }
+    }
+
+    return 0;
+}
+
+struct pcvdom_document*
+pcvdom_util_document_from_binary(const void *buf, size_t len)
+{
+    struct bin_reader r = { buf, (const unsigned char *)buf + len };
+    struct pcvdom_document *doc = NULL;
+    const uint8_t *header;
+    const char *name, *info;
+    uint16_t bom = BIN_BOM;
+    uint8_t flags;
+
+    if (!buf || !get_bytes(&r, (const void **)&header, 8) ||
+            memcmp(header, BIN_MAGIC, 4) ||
+            header[4] != PCVDOM_BINARY_VERSION ||
+            header[5] != sizeof(long double) ||
+            memcmp(header + 6, &bom, sizeof(bom)))
+        goto bad;
+
+    if (!get_byte(&r, &flags))
+        goto bad;
+
+    doc = pcvdom_document_create();
+    if (!doc)
+        return NULL;
+
+    doc->quirks = (flags & DOC_FLAG_QUIRKS) ? 1 : 0;
+    if (flags & DOC_FLAG_DOCTYPE) {
+        if (!get_str(&r, &name, NULL) || !get_str(&r, &info, NULL))
+            goto bad;
+
+        if (pcvdom_document_set_doctype(doc, name, info))
+            goto failed;
+    }
+
+    if (get_children(&r, doc, &doc->node, 0) || r.p != r.end)
+        goto bad;
+
+    return doc;
+
+bad:
+    pcinst_set_error(PURC_ERROR_INVALID_VALUE);
+
+failed:
+    if (doc)
+        pcvdom_document_unref(doc);
+    return NULL;
+}
@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <time.h>
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -347,3 +348,52 @@ std::vector<ejson_test_data> read_ejson_test_data()
 INSTANTIATE_TEST_SUITE_P(ejson, ejson_parser_vcm_eval,
         testing::ValuesIn(read_ejson_test_data()));
 
+
+TEST(ejson_tokenizer, perf)
+{
+    PurCInstance purc(false);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1;
+    }
+
+    /* about 2 MB JSON content */
+    const char *piece =
+        "{\"id\":12345,\"name\":\"The quick brown fox\",\"price\":3.1415926,"
+        "\"tags\":[\"\xe4\xb8\xad\xe6\x96\x87\",\"json\",true,false,null],"
+        "\"nested\":{\"a\":-1.5e10,\"b\":\"line\\nbreak\"}}";
+    std::string json = "[";
+    while (json.size() < 2 * 1024 * 1024) {
+        json += piece;
+        json += ",";
+    }
+    json += piece;
+    json += "]";
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < nr_loops; i++) {
+        // read end of string as eof
+        purc_rwstream_t rws = purc_rwstream_new_from_mem(
+                (void*)json.c_str(), json.size() + 1);
+
+        struct pcvcm_node* root = NULL;
+        struct pcejson* parser = NULL;
+        pcejson_parse (&root, &parser, rws, 32);
+        ASSERT_EQ(purc_get_last_error(), PCEJSON_SUCCESS);
+        ASSERT_NE(root, nullptr);
+
+        purc_rwstream_destroy(rws);
+        pcvcm_node_destroy (root);
+        pcejson_destroy(parser);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double secs = (end.tv_sec - start.tv_sec) +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    double mbytes = json.size() * nr_loops / 1024.0 / 1024.0;
+    fprintf(stderr, "eJSON tokenizer: %.2f MB, %.3f s, %.2f MB/s\n",
+            mbytes, secs, mbytes / secs);
+}
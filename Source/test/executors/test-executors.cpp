@@ -864,3 +864,88 @@ TEST(executors, utf8_wchar)
 {
 }
 
+static bool
+iterate_once(purc_exec_ops_t ops, purc_variant_t input, const char *rule)
+{
+    purc_exec_inst_t inst = ops->create(PURC_EXEC_TYPE_ITERATE, input, true);
+    if (!inst)
+        return false;
+
+    purc_exec_iter_t it = ops->it_begin(inst, rule);
+    ops->destroy(inst);
+
+    return it != NULL;
+}
+
+TEST(executors, rule_cache)
+{
+    purc_instance_extra_info info = {};
+    int r = purc_init_ex(PURC_MODULE_HVML, "cn.fmsoft.hvml.test", "executors",
+            &info);
+    ASSERT_EQ(r, PURC_ERROR_OK);
+
+    const struct pcexec_rule_cache_stat *stat;
+    stat = pcexecutor_rule_cache_stat();
+    ASSERT_NE(stat, nullptr);
+    ASSERT_GT(stat->capacity, 0);
+
+    purc_exec_ops_t ops = NULL;
+    ASSERT_TRUE(purc_get_executor("RANGE", &ops));
+
+    purc_variant_t input = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    for (int i = 0; i < 10; ++i) {
+        purc_variant_t v = purc_variant_make_number(i);
+        purc_variant_array_append(input, v);
+        purc_variant_unref(v);
+    }
+
+    size_t nr_hits = stat->nr_hits;
+    size_t nr_misses = stat->nr_misses;
+
+    // the same rule is compiled once, and shared by the later instances
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_TRUE(iterate_once(ops, input, "RANGE: FROM 0 TO 5"));
+    }
+    ASSERT_EQ(stat->nr_misses, nr_misses + 1);
+    ASSERT_EQ(stat->nr_hits, nr_hits + 99);
+
+    // two live instances share one compiled rule
+    purc_exec_inst_t a = ops->create(PURC_EXEC_TYPE_ITERATE, input, true);
+    purc_exec_inst_t b = ops->create(PURC_EXEC_TYPE_ITERATE, input, true);
+    ASSERT_NE(ops->it_begin(a, "RANGE: FROM 1"), nullptr);
+    ASSERT_NE(ops->it_begin(b, "RANGE: FROM 1"), nullptr);
+    ASSERT_EQ(stat->nr_misses, nr_misses + 2);
+
+    // a rule with bad syntax is never cached
+    nr_misses = stat->nr_misses;
+    size_t nr_entries = stat->nr_entries;
+    ASSERT_FALSE(iterate_once(ops, input, "RANGE: FROM"));
+    ASSERT_FALSE(iterate_once(ops, input, "RANGE: FROM"));
+    ASSERT_EQ(stat->nr_misses, nr_misses + 2);
+    ASSERT_EQ(stat->nr_entries, nr_entries);
+
+    // the least recently used rules are evicted when full,
+    // even if they are still used by live instances
+    char rule[64];
+    for (size_t i = 0; i < stat->capacity + 10; ++i) {
+        snprintf(rule, sizeof(rule), "RANGE: FROM 0 TO %zu", i + 6);
+        ASSERT_TRUE(iterate_once(ops, input, rule));
+    }
+    ASSERT_EQ(stat->nr_entries, stat->capacity);
+    ASSERT_GE(stat->nr_evictions, 10);
+
+    purc_exec_iter_t it = ops->it_begin(a, "RANGE: FROM 0 TO 5");
+    ASSERT_NE(it, nullptr);
+    ASSERT_NE(ops->it_begin(b, "RANGE: FROM 1"), nullptr);
+    ops->destroy(b);
+
+    purc_variant_t v = ops->it_value(a, it);
+    ASSERT_NE(v, PURC_VARIANT_INVALID);
+    ops->destroy(a);
+
+    purc_variant_unref(input);
+
+    bool ok = purc_cleanup ();
+    ASSERT_TRUE(ok);
+}
+
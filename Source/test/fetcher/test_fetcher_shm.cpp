@@ -0,0 +1,255 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include "purc.h"
+#include "purc-rwstream.h"
+
+#include "../helpers.h"
+
+#include <gtest/gtest.h>
+
+#if ENABLE(REMOTE_FETCHER)
+
+#include "fetcher-process.h"
+#include "fetcher-request.h"
+#include "fetcher-messages.h"
+
+#include "NetworkLoadMetrics.h"
+#include "ResourceResponse.h"
+#include "SharedBuffer.h"
+#include "SharedBufferDataReference.h"
+#include "SharedMemory.h"
+
+#include <wtf/URL.h>
+#include <wtf/Vector.h>
+#include <wtf/WorkQueue.h>
+
+using namespace PurCFetcher;
+
+#define CHUNK_SIZE      (64 * 1024)
+
+enum send_mode {
+    SEND_IN_CHUNKS,
+    SEND_IN_SHARED_MEMORY,
+    // the first half in shared memory, the rest in chunks
+    SEND_IN_BOTH,
+    // a segment smaller than the size announced with it
+    SEND_TRUNCATED,
+};
+
+/* Stands in for the fetcher process: answers every resource load with
+ * the given payload, either in chunks (as the fetcher streams the bodies
+ * it downloads) or in a single shared memory segment. */
+class StandInServer : public IPC::Connection::Client {
+public:
+    StandInServer(IPC::Connection::Identifier identifier, WorkQueue* queue,
+            const Vector<uint8_t>& payload, enum send_mode mode)
+        : m_payload(payload)
+        , m_mode(mode)
+        , m_connection(IPC::Connection::createServerConnection(identifier,
+                    *this, queue))
+    {
+        m_connection->open();
+    }
+
+    ~StandInServer()
+    {
+        m_connection->invalidate();
+    }
+
+    void didReceiveMessage(IPC::Connection&, IPC::Decoder& decoder) override
+    {
+        if (decoder.messageName() !=
+                IPC::MessageName::NetworkConnectionToWebProcess_ScheduleResourceLoad)
+            return;
+
+        ResourceResponse response(URL(URL(), "http://localhost/payload"),
+                "application/octet-stream", m_payload.size(), String());
+        response.setHTTPStatusCode(200);
+        m_connection->send(
+                Messages::WebResourceLoader::DidReceiveResponse(response,
+                    false), 0);
+
+        switch (m_mode) {
+        case SEND_IN_CHUNKS:
+            sendInChunks(0);
+            break;
+        case SEND_IN_SHARED_MEMORY:
+            sendInSharedMemory(m_payload.size(), m_payload.size());
+            break;
+        case SEND_IN_BOTH:
+            sendInSharedMemory(m_payload.size() / 2, m_payload.size() / 2);
+            sendInChunks(m_payload.size() / 2);
+            break;
+        case SEND_TRUNCATED:
+            sendInSharedMemory(m_payload.size() / 2, m_payload.size());
+            break;
+        }
+
+        m_connection->send(
+                Messages::WebResourceLoader::DidFinishResourceLoad(
+                    NetworkLoadMetrics()), 0);
+    }
+
+    void didClose(IPC::Connection&) override { }
+    void didReceiveInvalidMessage(IPC::Connection&, IPC::MessageName) override { }
+    const char* connectionName(void) override { return "StandInServer"; }
+
+private:
+    void sendInChunks(size_t start)
+    {
+        for (size_t off = start; off < m_payload.size(); off += CHUNK_SIZE) {
+            size_t len = std::min((size_t)CHUNK_SIZE, m_payload.size() - off);
+            IPC::SharedBufferDataReference data(
+                    SharedBuffer::create(m_payload.data() + off, len));
+            m_connection->send(
+                    Messages::WebResourceLoader::DidReceiveSharedBuffer(data,
+                        len), 0);
+        }
+    }
+
+    void sendInSharedMemory(size_t sz_memory, size_t sz_announced)
+    {
+        auto memory = SharedMemory::allocate(sz_memory);
+        ASSERT_TRUE(memory);
+        memcpy(memory->data(), m_payload.data(), sz_memory);
+
+        SharedMemory::Handle handle;
+        ASSERT_TRUE(memory->createHandle(handle,
+                    SharedMemory::Protection::ReadOnly));
+        m_connection->send(
+                Messages::WebResourceLoader::DidReceiveResource(handle,
+                    sz_announced), 0);
+    }
+
+    const Vector<uint8_t>& m_payload;
+    enum send_mode m_mode;
+    RefPtr<IPC::Connection> m_connection;
+};
+
+static Vector<uint8_t> make_payload(size_t size)
+{
+    Vector<uint8_t> payload(size);
+    for (size_t i = 0; i < size; i++)
+        payload[i] = (uint8_t)(i * 131 + (i >> 12));
+    return payload;
+}
+
+/* fetches the payload once and checks it; returns the elapsed time */
+static double fetch_payload(PcFetcherProcess& process,
+        const Vector<uint8_t>& payload, enum send_mode mode)
+{
+    auto serverQueue = WorkQueue::create("StandInServer");
+    auto clientQueue = WorkQueue::create("StandInClient");
+    auto sockets = IPC::Connection::createPlatformConnection();
+    StandInServer server(sockets.server, serverQueue.ptr(), payload, mode);
+
+    double start = now_ms();
+    PcFetcherRequest* request = new PcFetcherRequest(1, sockets.client,
+            clientQueue.ptr(), &process);
+
+    struct pcfetcher_resp_header header = {};
+    purc_rwstream_t rws = request->requestSync("http://localhost/",
+            "payload", PCFETCHER_REQUEST_METHOD_GET, NULL, 30, &header);
+
+    size_t sz = 0;
+    const uint8_t* data = rws ?
+        (const uint8_t*)purc_rwstream_get_mem_buffer(rws, &sz) : NULL;
+    double elapsed = now_ms() - start;
+
+    if (mode == SEND_TRUNCATED) {
+        EXPECT_EQ(header.ret_code, RESP_CODE_BAD_RESOURCE);
+        EXPECT_EQ(header.sz_resp, 0);
+        EXPECT_EQ(sz, 0);
+    }
+    else {
+        EXPECT_EQ(header.ret_code, 200);
+        EXPECT_EQ(header.sz_resp, payload.size());
+        EXPECT_EQ(sz, payload.size());
+        EXPECT_TRUE(data &&
+                memcmp(data, payload.data(), payload.size()) == 0);
+    }
+
+    if (rws)
+        purc_rwstream_destroy(rws);
+    if (header.mime_type)
+        free(header.mime_type);
+    return elapsed;
+}
+
+TEST(fetcher_shm, resource)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    PcFetcherProcess process(NULL);
+    Vector<uint8_t> payload = make_payload(PCFETCHER_SHM_BODY_THRESHOLD + 1);
+    fetch_payload(process, payload, SEND_IN_SHARED_MEMORY);
+    fetch_payload(process, payload, SEND_IN_CHUNKS);
+}
+
+// the chunks following a mapped segment are appended to it
+TEST(fetcher_shm, resource_and_chunks)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    PcFetcherProcess process(NULL);
+    Vector<uint8_t> payload =
+        make_payload(PCFETCHER_SHM_BODY_THRESHOLD * 2 + 1);
+    fetch_payload(process, payload, SEND_IN_BOTH);
+}
+
+// a segment smaller than its announced size fails the request
+TEST(fetcher_shm, truncated_resource)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    PcFetcherProcess process(NULL);
+    Vector<uint8_t> payload =
+        make_payload(PCFETCHER_SHM_BODY_THRESHOLD * 2 + 1);
+    fetch_payload(process, payload, SEND_TRUNCATED);
+}
+
+TEST(fetcher_shm, benchmark)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    PcFetcherProcess process(NULL);
+    static const size_t sizes_mb[] = { 1, 10, 100 };
+    for (size_t mb : sizes_mb) {
+        Vector<uint8_t> payload = make_payload(mb * 1024 * 1024);
+        int nr_loops = mb >= 100 ? 2 : 5;
+
+        double chunks = 0, shm = 0;
+        for (int n = 0; n < nr_loops; n++) {
+            chunks += fetch_payload(process, payload, SEND_IN_CHUNKS);
+            shm += fetch_payload(process, payload, SEND_IN_SHARED_MEMORY);
+        }
+
+        fprintf(stderr, "%4zu MB: chunks %10.3f ms, shared memory %10.3f ms\n",
+                mb, chunks / nr_loops, shm / nr_loops);
+    }
+}
+
+#endif /* ENABLE(REMOTE_FETCHER) */
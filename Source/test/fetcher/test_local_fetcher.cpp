@@ -24,6 +24,8 @@
 #include "private/fetcher.h"
 #include "config.h"
 
+#include "../helpers.h"
+
 #include <libgen.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -34,6 +36,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
 
 #if OS(LINUX) || OS(UNIX)
 // get path from env or __FILE__/../<rel> otherwise
@@ -171,3 +176,138 @@ TEST(local_fetcher, async)
     purc_cleanup();
 #endif                        /* } */
 }
+
+static void write_file(const char *path, const char *content)
+{
+    FILE *fp = fopen(path, "w");
+    ASSERT_NE(fp, nullptr);
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static std::string fetch_sync(const char *url, int *ret_code)
+{
+    std::string content;
+    struct pcfetcher_resp_header resp_header = {};
+    purc_rwstream_t resp = pcfetcher_request_sync(url,
+            PCFETCHER_REQUEST_METHOD_GET, NULL, 10, &resp_header);
+    *ret_code = resp_header.ret_code;
+    if (resp) {
+        size_t sz = 0;
+        const char *buf = (const char *)purc_rwstream_get_mem_buffer(resp,
+                &sz);
+        EXPECT_NE(buf, nullptr);
+        EXPECT_EQ(sz, resp_header.sz_resp);
+        if (buf)
+            content.assign(buf, sz);
+        purc_rwstream_destroy(resp);
+    }
+    if (resp_header.mime_type)
+        free(resp_header.mime_type);
+    return content;
+}
+
+TEST(local_fetcher, cache)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    char dir[] = "/tmp/test_local_fetcher.XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    char base_uri[PATH_MAX + 16];
+    snprintf(base_uri, sizeof(base_uri), "file://%s/", dir);
+    pcfetcher_set_base_url(base_uri);
+
+    char path[PATH_MAX + 16];
+    snprintf(path, sizeof(path), "%s/data.json", dir);
+    write_file(path, "[1, 2, 3]");
+
+    int ret_code = 0;
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(fetch_sync("data.json", &ret_code), "[1, 2, 3]");
+        ASSERT_EQ(ret_code, 200);
+    }
+
+    /* the cached response must not survive a change of the file */
+    write_file(path, "[1, 2, 3, 4]");
+    ASSERT_EQ(fetch_sync("data.json", &ret_code), "[1, 2, 3, 4]");
+    ASSERT_EQ(ret_code, 200);
+
+    unlink(path);
+    ASSERT_EQ(fetch_sync("data.json", &ret_code), "");
+    ASSERT_EQ(ret_code, 404);
+
+    rmdir(dir);
+}
+
+struct async_ctxt {
+    int nr_pending;
+    int nr_ok;
+    int nr_not_found;
+};
+
+static void count_response_handler(
+        purc_variant_t request_id, void* ctxt,
+        const struct pcfetcher_resp_header *resp_header,
+        purc_rwstream_t resp)
+{
+    struct async_ctxt *ac = (struct async_ctxt *)ctxt;
+    if (resp_header->ret_code == 200) {
+        size_t sz = 0;
+        const char *buf = (const char *)purc_rwstream_get_mem_buffer(resp,
+                &sz);
+        if (buf && sz == resp_header->sz_resp &&
+                strncmp(buf, "[1, 2, 3]", sz) == 0)
+            ac->nr_ok++;
+    }
+    else if (resp_header->ret_code == 404) {
+        ac->nr_not_found++;
+    }
+
+    if (resp)
+        purc_rwstream_destroy(resp);
+    purc_variant_unref(request_id);
+
+    if (--ac->nr_pending == 0)
+        RunLoop::current().stop();
+}
+
+TEST(local_fetcher, async_pool)
+{
+    PurCInstance purc(false);
+    ASSERT_TRUE(purc);
+
+    char dir[] = "/tmp/test_local_fetcher.XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+
+    char base_uri[PATH_MAX + 16];
+    snprintf(base_uri, sizeof(base_uri), "file://%s/", dir);
+    pcfetcher_set_base_url(base_uri);
+
+    char path[PATH_MAX + 16];
+    snprintf(path, sizeof(path), "%s/data.json", dir);
+    write_file(path, "[1, 2, 3]");
+
+    const int nr_requests = 64;
+    struct async_ctxt ac = { 0, 0, 0 };
+    for (int i = 0; i < nr_requests; i++) {
+        purc_variant_t req_id = pcfetcher_request_async(
+                (i % 4) ? "data.json" : "none.json",
+                PCFETCHER_REQUEST_METHOD_GET, NULL, 10,
+                count_response_handler, &ac);
+        ASSERT_NE(req_id, PURC_VARIANT_INVALID);
+        ac.nr_pending++;
+    }
+
+    /* responses are delivered by the run loop of the requesting thread */
+    ASSERT_EQ(ac.nr_ok + ac.nr_not_found, 0);
+    RunLoop::current().run();
+
+    ASSERT_EQ(ac.nr_pending, 0);
+    ASSERT_EQ(ac.nr_ok, nr_requests / 4 * 3);
+    ASSERT_EQ(ac.nr_not_found, nr_requests / 4);
+
+    unlink(path);
+    rmdir(dir);
+}
@@ -24,6 +24,7 @@
 #include "config.h"
 
 #include <libgen.h>
+#include <time.h>
 #include <vector>
 #include <iostream>
 
@@ -76,6 +77,14 @@ do {                                                                    \
 
 #endif // OS(LINUX) || OS(UNIX)
 
+// the monotonic time in milliseconds, for the benchmarks
+static inline double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
 // Workaround: gtest, INSTANTIATE_TEST_SUITE_P, valgrind
 class MemCollector
 {
@@ -0,0 +1,342 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc.h"
+#include "private/document.h"
+
+#include "../helpers.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <gtest/gtest.h>
+
+static const char *sample_html =
+    "<html><head><title>t</title></head><body>"
+    "<div id=\"main\" class=\"box wide\">"
+    "<ul class=\"list\">"
+    "<li class=\"item first\">one</li>"
+    "<li class=\"item\">two</li>"
+    "<li class=\"item\" lang=\"en-US\"><a href=\"/x.pdf\">three</a></li>"
+    "<li></li>"
+    "</ul>"
+    "<p>para<span>s1</span></p>"
+    "<p class=\"note\"><span><em>deep</em></span></p>"
+    "<form><input type=\"checkbox\" checked><input type=\"text\" disabled>"
+    "<button>ok</button></form>"
+    "</div></body></html>";
+
+static const struct {
+    const char *selector;
+    size_t      count;
+} sample_cases[] = {
+    { "li",                         4 },
+    { "LI",                         4 },
+    { ".item",                      3 },
+    { "li.item.first",              1 },
+    { "#main",                      1 },
+    { "#main.box.wide",             1 },
+    { "#nothing",                   0 },
+    { "ul > li",                    4 },
+    { "div li",                     4 },
+    { "body > li",                  0 },
+    { "li + li",                    3 },
+    { "li ~ li",                    3 },
+    { "p + p",                      1 },
+    { "ul ~ p",                     2 },
+    { "li:first-child",             1 },
+    { "li:last-child",              1 },
+    { "li:nth-child(odd)",          2 },
+    { "li:nth-child(2n)",           2 },
+    { "li:nth-child(-n+3)",         3 },
+    { "li:nth-last-child(1)",       1 },
+    { "li:empty",                   1 },
+    { "li:not(.item)",              1 },
+    { "span:only-child",            2 },
+    { "p:first-of-type",            1 },
+    { "p:last-of-type.note",        1 },
+    { "a[href$='.pdf']",            1 },
+    { "a[href^=\"/\"]",             1 },
+    { "[href*=x]",                  1 },
+    { "[lang|=en]",                 1 },
+    { "[class~=wide]",              1 },
+    { "[lang]",                     1 },
+    { "input:checked",              1 },
+    { "input:disabled",             1 },
+    { "input:enabled",              1 },
+    { "p span, p em",               3 },
+    { "p > em",                     0 },
+    { "p em",                       1 },
+    { "#main > ul > li.item > a",   1 },
+};
+
+static size_t count_of(purc_document_t doc, const char *selector)
+{
+    pcdoc_elem_coll_t coll = pcdoc_elem_coll_new_from_document(doc, selector);
+    if (coll == NULL)
+        return (size_t)-1;
+
+    size_t n = pcutils_arrlist_length(coll->elems);
+    pcdoc_elem_coll_delete(doc, coll);
+    return n;
+}
+
+TEST(html_selector, match)
+{
+    PurCInstance purc((unsigned int)PURC_MODULE_HTML);
+    ASSERT_TRUE(purc);
+
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            sample_html, 0);
+    ASSERT_NE(doc, nullptr);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(sample_cases); i++) {
+        EXPECT_EQ(count_of(doc, sample_cases[i].selector),
+                sample_cases[i].count) << sample_cases[i].selector;
+    }
+
+    pcdoc_element_t elem = pcdoc_find_element_in_document(doc, "li:last-child");
+    ASSERT_NE(elem, nullptr);
+    size_t nr_elems = 1, nr_text_nodes = 1, nr_data_nodes = 1;
+    EXPECT_EQ(pcdoc_element_children_count(doc, elem,
+                &nr_elems, &nr_text_nodes, &nr_data_nodes), 0);
+    EXPECT_EQ(nr_elems, 0u);
+    EXPECT_EQ(nr_text_nodes, 0u);
+
+    elem = pcdoc_find_element_in_document(doc, "#main");
+    ASSERT_NE(elem, nullptr);
+    const char *val;
+    size_t len;
+    ASSERT_EQ(pcdoc_element_get_attribute(doc, elem, "class", &val, &len), 0);
+    EXPECT_EQ(std::string(val, len), "box wide");
+
+    pcdoc_elem_coll_t coll = pcdoc_elem_coll_new_from_document(doc, "li");
+    ASSERT_NE(coll, nullptr);
+    pcdoc_elem_coll_t sub = pcdoc_elem_coll_select(doc, coll, ".item:not(.first)");
+    ASSERT_NE(sub, nullptr);
+    EXPECT_EQ(pcutils_arrlist_length(sub->elems), 2u);
+    pcdoc_elem_coll_delete(doc, sub);
+    pcdoc_elem_coll_delete(doc, coll);
+
+    purc_document_delete(doc);
+}
+
+TEST(html_selector, invalid)
+{
+    static const char *bad_selectors[] = {
+        "",
+        "li >",
+        "> li",
+        "li,",
+        "li::before",
+        "li[",
+        "li[href=]",
+        "li:nth-child(n+)",
+        "li:not(:not(a))",
+        "li:hover",
+        "ns|li",
+        "#",
+        ".",
+    };
+
+    PurCInstance purc((unsigned int)PURC_MODULE_HTML);
+    ASSERT_TRUE(purc);
+
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            sample_html, 0);
+    ASSERT_NE(doc, nullptr);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(bad_selectors); i++) {
+        pcdoc_selector_t selector = pcdoc_selector_new(bad_selectors[i]);
+        EXPECT_EQ(selector, nullptr) << bad_selectors[i];
+        if (selector)
+            pcdoc_selector_delete(selector);
+
+        EXPECT_EQ(count_of(doc, bad_selectors[i]), (size_t)-1)
+            << bad_selectors[i];
+    }
+
+    purc_document_delete(doc);
+}
+
+/* the index is used for `.item`, but not for `[class~=item]` */
+static void expect_class_indexed(purc_document_t doc, const char *klass,
+        size_t count)
+{
+    std::string by_class = std::string(".") + klass;
+    std::string by_attr = std::string("[class~=") + klass + "]";
+
+    pcdoc_elem_coll_t a = pcdoc_elem_coll_new_from_document(doc,
+            by_class.c_str());
+    pcdoc_elem_coll_t b = pcdoc_elem_coll_new_from_document(doc,
+            by_attr.c_str());
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+
+    size_t n = pcutils_arrlist_length(a->elems);
+    EXPECT_EQ(n, count) << klass;
+    ASSERT_EQ(pcutils_arrlist_length(b->elems), n) << klass;
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_EQ(pcutils_arrlist_get_idx(a->elems, i),
+                pcutils_arrlist_get_idx(b->elems, i)) << klass << i;
+    }
+
+    pcdoc_elem_coll_delete(doc, a);
+    pcdoc_elem_coll_delete(doc, b);
+}
+
+TEST(html_selector, index)
+{
+    PurCInstance purc((unsigned int)PURC_MODULE_HTML);
+    ASSERT_TRUE(purc);
+
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            sample_html, 0);
+    ASSERT_NE(doc, nullptr);
+
+    /* builds the indexes */
+    EXPECT_EQ(count_of(doc, "#main"), 1u);
+    expect_class_indexed(doc, "item", 3);
+
+    pcdoc_element_t ul = pcdoc_find_element_in_document(doc, "ul");
+    pcdoc_element_t li = pcdoc_find_element_in_document(doc, "li.first");
+    ASSERT_NE(ul, nullptr);
+    ASSERT_NE(li, nullptr);
+
+    /* attributes */
+    pcdoc_element_set_attribute(doc, li, PCDOC_OP_DISPLACE, "id", "x", 0);
+    EXPECT_EQ(count_of(doc, "#x"), 1u);
+    EXPECT_EQ(pcdoc_find_element_in_document(doc, "li#x"), li);
+    pcdoc_element_set_attribute(doc, li, PCDOC_OP_DISPLACE, "id", "y", 0);
+    EXPECT_EQ(count_of(doc, "#x"), 0u);
+    EXPECT_EQ(count_of(doc, "#y"), 1u);
+    pcdoc_element_set_attribute(doc, li, PCDOC_OP_ERASE, "id", NULL, 0);
+    EXPECT_EQ(count_of(doc, "#y"), 0u);
+
+    pcdoc_element_set_attribute(doc, li, PCDOC_OP_DISPLACE,
+            "class", "first  item other", 0);
+    expect_class_indexed(doc, "item", 3);
+    expect_class_indexed(doc, "other", 1);
+    pcdoc_element_set_attribute(doc, li, PCDOC_OP_CLEAR, "class", NULL, 0);
+    expect_class_indexed(doc, "item", 2);
+    expect_class_indexed(doc, "first", 0);
+    pcdoc_element_set_attribute(doc, li, PCDOC_OP_DISPLACE,
+            "class", "item first", 0);
+    expect_class_indexed(doc, "item", 3);
+
+    /* new elements and contents */
+    pcdoc_element_t last = pcdoc_element_new_element(doc, ul,
+            PCDOC_OP_APPEND, "li", false);
+    ASSERT_NE(last, nullptr);
+    pcdoc_element_set_attribute(doc, last, PCDOC_OP_DISPLACE,
+            "class", "item", 0);
+    expect_class_indexed(doc, "item", 4);
+
+    pcdoc_element_new_content(doc, ul, PCDOC_OP_PREPEND,
+            "<li class=\"item\" id=\"pre\"><b class=\"item\">b</b></li>", 0);
+    EXPECT_EQ(count_of(doc, "#pre"), 1u);
+    expect_class_indexed(doc, "item", 6);
+    EXPECT_EQ(pcdoc_find_element_in_document(doc, ".item"),
+            pcdoc_find_element_in_document(doc, "#pre"));
+
+    pcdoc_element_t p = pcdoc_find_element_in_document(doc, "p.note");
+    ASSERT_NE(p, nullptr);
+    pcdoc_element_new_content(doc, p, PCDOC_OP_DISPLACE,
+            "<i class=\"item\">i</i>", 0);
+    expect_class_indexed(doc, "item", 7);
+    pcdoc_element_new_text_content(doc, p, PCDOC_OP_DISPLACE, "text", 0);
+    expect_class_indexed(doc, "item", 6);
+
+    /* removals */
+    pcdoc_element_clear(doc, ul);
+    EXPECT_EQ(count_of(doc, "#pre"), 0u);
+    expect_class_indexed(doc, "item", 0);
+    EXPECT_EQ(count_of(doc, ".list"), 1u);
+
+    pcdoc_element_t main = pcdoc_find_element_in_document(doc, "#main");
+    ASSERT_NE(main, nullptr);
+    pcdoc_element_erase(doc, main);
+    EXPECT_EQ(count_of(doc, "#main"), 0u);
+    EXPECT_EQ(count_of(doc, ".list"), 0u);
+    EXPECT_EQ(count_of(doc, ".note"), 0u);
+
+    purc_document_delete(doc);
+}
+
+#define NR_ROWS     5000
+
+static std::string make_large_html(void)
+{
+    std::string html = "<html><head></head><body>";
+    char buf[256];
+
+    /* 10 elements per row */
+    for (int i = 0; i < NR_ROWS; i++) {
+        snprintf(buf, sizeof(buf),
+                "<div class=\"row r%d\" id=\"row%d\"><ul>", i % 10, i);
+        html += buf;
+        for (int j = 0; j < 4; j++) {
+            snprintf(buf, sizeof(buf),
+                    "<li class=\"item\"><a href=\"/%d/%d.%s\">%d</a></li>",
+                    i, j, j == 2 ? "pdf" : "html", j);
+            html += buf;
+        }
+        html += "</ul></div>";
+    }
+
+    html += "</body></html>";
+    return html;
+}
+
+TEST(html_selector, benchmark)
+{
+    static const struct {
+        const char *selector;
+        size_t      count;
+    } cases[] = {
+        { "#row4999",                           1 },
+        { ".r3",                                NR_ROWS / 10 },
+        { ".r3 li:nth-child(2) a",              NR_ROWS / 10 },
+        { "div.row > ul > li.item:last-child",  NR_ROWS },
+        { "a[href$='.pdf']",                    NR_ROWS },
+        { "li:not(:first-child) > a",           NR_ROWS * 3 },
+    };
+
+    PurCInstance purc((unsigned int)PURC_MODULE_HTML);
+    ASSERT_TRUE(purc);
+
+    std::string html = make_large_html();
+    purc_document_t doc = purc_document_load(PCDOC_K_TYPE_HTML,
+            html.c_str(), html.length());
+    ASSERT_NE(doc, nullptr);
+
+    const int nr_loops = 10;
+    for (size_t i = 0; i < PCA_TABLESIZE(cases); i++) {
+        double start = now_ms();
+        for (int n = 0; n < nr_loops; n++) {
+            ASSERT_EQ(count_of(doc, cases[i].selector), cases[i].count)
+                << cases[i].selector;
+        }
+        double elapsed = (now_ms() - start) / nr_loops;
+        fprintf(stderr, "%-40s %8zu matches %10.3f ms/query\n",
+                cases[i].selector, cases[i].count, elapsed);
+    }
+
+    purc_document_delete(doc);
+}
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
+#include <time.h>
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -363,3 +364,57 @@ std::vector<hvml_token_test_data> read_hvml_token_test_data()
 INSTANTIATE_TEST_SUITE_P(hvml_token, hvml_parser_next_token,
         testing::ValuesIn(read_hvml_token_test_data()));
 
+
+TEST(hvml_tokenizer, perf)
+{
+    PurCInstance purc(false);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1;
+    }
+
+    /* about 2 MB HVML content */
+    const char *piece =
+        "<div class=\"item\" id=\"item-$?\">"
+        "<span>The quick brown fox jumps over the lazy dog. "
+        "\xe4\xb8\xad\xe6\x96\x87</span>"
+        "<update on=\"$@\" at=\"textContent\" with=\"$DATETIME.time\" />"
+        "</div>\n";
+    std::string hvml = "<hvml target=\"html\"><body>\n";
+    while (hvml.size() < 2 * 1024 * 1024) {
+        hvml += piece;
+    }
+    hvml += "</body></hvml>\n";
+
+    size_t nr_tokens = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < nr_loops; i++) {
+        struct pchvml_parser* parser = pchvml_create(0, 32);
+        purc_rwstream_t rws = purc_rwstream_new_from_mem(
+                (void*)hvml.c_str(), hvml.size());
+
+        struct pchvml_token* token = NULL;
+        while((token = pchvml_next_token(parser, rws)) != NULL) {
+            enum pchvml_token_type type = pchvml_token_get_type(token);
+            pchvml_token_destroy(token);
+            nr_tokens++;
+            if (type == PCHVML_TOKEN_EOF) {
+                break;
+            }
+        }
+
+        ASSERT_EQ(purc_get_last_error(), PCHVML_SUCCESS);
+        purc_rwstream_destroy(rws);
+        pchvml_destroy(parser);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double secs = (end.tv_sec - start.tv_sec) +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    double mbytes = hvml.size() * nr_loops / 1024.0 / 1024.0;
+    fprintf(stderr, "HVML tokenizer: %.2f MB, %lu tokens, %.3f s, %.2f MB/s\n",
+            mbytes, (unsigned long)nr_tokens, secs, mbytes / secs);
+}
@@ -0,0 +1,254 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc.h"
+#include "private/instance.h"
+
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <gtest/gtest.h>
+
+// private/msg-queue.h uses the C11 atomic types
+extern "C" {
+struct pcinst_msg_queue;
+
+struct pcinst_msg_queue *pcinst_msg_queue_create(void);
+ssize_t pcinst_msg_queue_destroy(struct pcinst_msg_queue *queue);
+int pcinst_msg_queue_append(struct pcinst_msg_queue *queue, pcrdr_msg *msg);
+pcrdr_msg *pcinst_msg_queue_get_msg(struct pcinst_msg_queue *queue);
+size_t pcinst_msg_queue_count(struct pcinst_msg_queue *queue);
+}
+
+static pcrdr_msg *
+make_event(pcrdr_msg_event_reduce_opt reduce_opt, uint64_t target_value,
+        const char *event_name, purc_variant_t element, int64_t data)
+{
+    pcrdr_msg *msg = pcinst_get_message();
+    if (msg == NULL)
+        return NULL;
+
+    msg->type = PCRDR_MSG_TYPE_EVENT;
+    msg->target = PCRDR_MSG_TARGET_COROUTINE;
+    msg->targetValue = target_value;
+    msg->reduceOpt = reduce_opt;
+
+    msg->eventName = purc_variant_make_string(event_name, false);
+    msg->elementType = PCRDR_MSG_ELEMENT_TYPE_VARIANT;
+    msg->elementValue = purc_variant_ref(element);
+    msg->dataType = PCRDR_MSG_DATA_TYPE_JSON;
+    msg->data = purc_variant_make_longint(data);
+    return msg;
+}
+
+static int64_t
+event_data(pcrdr_msg *msg)
+{
+    int64_t data = -1;
+    purc_variant_cast_to_longint(msg->data, &data, false);
+    return data;
+}
+
+// to test that the events with the same key are coalesced
+TEST(msg_queue, coalesce)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "msg_queue", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    struct pcinst_msg_queue *queue = pcinst_msg_queue_create();
+    ASSERT_NE(queue, nullptr);
+
+    purc_variant_t element = purc_variant_make_string("#foo", false);
+
+    // the later data overlays the data of the queued event
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 1, "click",
+                element, 1));
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 1, "click",
+                element, 2));
+    // the data is ignored
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_IGNORE, 1, "click",
+                element, 3));
+    // different keys
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 2, "click",
+                element, 4));
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 1, "change",
+                element, 5));
+    // the kept event is queued after the coalesced one
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, 1, "click",
+                element, 6));
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 4);
+
+    static const int64_t expected[] = { 2, 4, 5, 6 };
+    for (size_t i = 0; i < PCA_TABLESIZE(expected); i++) {
+        pcrdr_msg *msg = pcinst_msg_queue_get_msg(queue);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(event_data(msg), expected[i]);
+        pcrdr_release_message(msg);
+    }
+    ASSERT_EQ(pcinst_msg_queue_get_msg(queue), nullptr);
+
+    // the key is free again once the queued event is taken
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 1, "click",
+                element, 7));
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 1, "click",
+                element, 8));
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 1);
+
+    pcrdr_msg *msg = pcinst_msg_queue_get_msg(queue);
+    ASSERT_NE(msg, nullptr);
+    ASSERT_EQ(event_data(msg), 8);
+    pcrdr_release_message(msg);
+
+    purc_variant_unref(element);
+    ASSERT_EQ(pcinst_msg_queue_destroy(queue), 0);
+    purc_cleanup();
+}
+
+// to test the events keyed by containers changed while they are queued
+TEST(msg_queue, mutable_element)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "msg_queue", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    struct pcinst_msg_queue *queue = pcinst_msg_queue_create();
+    ASSERT_NE(queue, nullptr);
+
+    // two equal arrays share a key
+    purc_variant_t first = purc_variant_make_array_0();
+    purc_variant_t second = purc_variant_make_array_0();
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, 1, "change",
+                first, 0));
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, 1, "change",
+                second, 1));
+
+    // now the queued events have different keys
+    purc_variant_t item = purc_variant_make_longint(0);
+    purc_variant_array_append(first, item);
+    purc_variant_unref(item);
+
+    pcinst_msg_queue_append(queue,
+            make_event(PCRDR_MSG_EVENT_REDUCE_OPT_OVERLAY, 1, "change",
+                second, 2));
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 3);
+
+    for (int64_t i = 0; i < 3; i++) {
+        pcrdr_msg *msg = pcinst_msg_queue_get_msg(queue);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(event_data(msg), i);
+        pcrdr_release_message(msg);
+    }
+    ASSERT_EQ(pcinst_msg_queue_get_msg(queue), nullptr);
+
+    purc_variant_unref(first);
+    purc_variant_unref(second);
+    ASSERT_EQ(pcinst_msg_queue_destroy(queue), 0);
+    purc_cleanup();
+}
+
+#define NR_PRODUCED     10000
+
+struct producer_arg {
+    struct pcinst_msg_queue    *queue;
+    pcrdr_msg                 **msgs;
+};
+
+static void *producer(void *data)
+{
+    struct producer_arg *arg = (struct producer_arg *)data;
+
+    for (size_t i = 0; i < NR_PRODUCED; i++) {
+        pcinst_msg_queue_append(arg->queue, arg->msgs[i]);
+    }
+
+    return NULL;
+}
+
+// to test the events and the other messages queued by different threads
+TEST(msg_queue, split_locks)
+{
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "msg_queue", NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    struct pcinst_msg_queue *queue = pcinst_msg_queue_create();
+    ASSERT_NE(queue, nullptr);
+
+    // the messages are made and released by this thread
+    static pcrdr_msg *events[NR_PRODUCED], *requests[NR_PRODUCED];
+    purc_variant_t element = purc_variant_make_string("#foo", false);
+    for (int64_t i = 0; i < NR_PRODUCED; i++) {
+        events[i] = make_event(PCRDR_MSG_EVENT_REDUCE_OPT_KEEP, 1, "tick",
+                element, i);
+        ASSERT_NE(events[i], nullptr);
+
+        requests[i] = pcinst_get_message();
+        ASSERT_NE(requests[i], nullptr);
+        requests[i]->type = PCRDR_MSG_TYPE_REQUEST;
+        requests[i]->dataType = PCRDR_MSG_DATA_TYPE_JSON;
+        requests[i]->data = purc_variant_make_longint(i);
+    }
+    purc_variant_unref(element);
+
+    pthread_t threads[2];
+    struct producer_arg args[2] = { { queue, events }, { queue, requests } };
+    for (size_t i = 0; i < 2; i++) {
+        ASSERT_EQ(pthread_create(&threads[i], NULL, producer, &args[i]), 0);
+    }
+
+    // the messages of each kind are taken in the order they are queued
+    int64_t next_event = 0, next_request = 0;
+    while (next_event < NR_PRODUCED || next_request < NR_PRODUCED) {
+        pcrdr_msg *msg = pcinst_msg_queue_get_msg(queue);
+        if (msg == NULL) {
+            sched_yield();
+            continue;
+        }
+
+        if (msg->type == PCRDR_MSG_TYPE_EVENT) {
+            ASSERT_EQ(event_data(msg), next_event);
+            next_event++;
+        }
+        else {
+            ASSERT_EQ(msg->type, PCRDR_MSG_TYPE_REQUEST);
+            ASSERT_EQ(event_data(msg), next_request);
+            next_request++;
+        }
+        pcrdr_release_message(msg);
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    ASSERT_EQ(pcinst_msg_queue_count(queue), 0);
+    ASSERT_EQ(pcinst_msg_queue_destroy(queue), 0);
+    purc_cleanup();
+}
@@ -26,6 +26,8 @@
 #include <semaphore.h>
 #include <unistd.h>
 #include <fcntl.h>           /* For O_* constants */
+#include <sched.h>
+#include <time.h>
 #include <gtest/gtest.h>
 #include <wtf/Compiler.h>
 
@@ -288,3 +290,126 @@ TEST(instance, threads)
     purc_cleanup();
 }
 
+
+#define NR_PERF_SENDERS     16
+
+struct perf_arg {
+    int     nr;
+    size_t  nr_msgs;
+};
+
+static void* perf_sender_entry(void* arg)
+{
+    struct perf_arg *my_arg = (struct perf_arg *)arg;
+    char runner_name[32];
+
+    sprintf(runner_name, "sender%d", my_arg->nr);
+
+    int ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.purc.test",
+            runner_name, NULL);
+    assert(ret == PURC_ERROR_OK);
+    (void)ret;
+
+    /* the string is also referenced by the sender after moving */
+    purc_variant_t name = purc_variant_make_string(
+            "a string shared by all messages sent by this runner", false);
+
+    for (size_t i = 0; i < my_arg->nr_msgs; i++) {
+        pcrdr_msg *msg = pcrdr_make_event_message(
+                PCRDR_MSG_TARGET_INSTANCE, my_arg->nr,
+                "perf", NULL,
+                PCRDR_MSG_ELEMENT_TYPE_VOID, NULL, NULL,
+                PCRDR_MSG_DATA_TYPE_VOID, NULL, 0);
+
+        purc_variant_t seq = purc_variant_make_ulongint(i);
+        msg->dataType = PCRDR_MSG_DATA_TYPE_JSON;
+        msg->data = purc_variant_make_array(2, name, seq);
+        purc_variant_unref(seq);
+
+        while (purc_inst_move_message(main_inst, msg) == 0) {
+            sched_yield();
+        }
+        pcrdr_release_message(msg);
+    }
+
+    purc_variant_unref(name);
+    purc_cleanup();
+    return NULL;
+}
+
+TEST(instance, threads_perf)
+{
+    int ret;
+
+    ret = purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.purc.test", "perf",
+            NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 10000;
+    }
+
+    main_inst = purc_inst_create_move_buffer(0, 1024);
+    ASSERT_NE(main_inst, 0);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    struct perf_arg args[NR_PERF_SENDERS];
+    pthread_t senders[NR_PERF_SENDERS];
+    for (int i = 0; i < NR_PERF_SENDERS; i++) {
+        args[i].nr = i;
+        args[i].nr_msgs = nr_loops;
+        ret = pthread_create(&senders[i], NULL, perf_sender_entry, &args[i]);
+        ASSERT_EQ(ret, 0);
+    }
+
+    size_t nr_got = 0;
+    size_t nr_total = nr_loops * NR_PERF_SENDERS;
+    while (nr_got < nr_total) {
+        size_t n;
+        ret = purc_inst_holding_messages_count(&n);
+        ASSERT_EQ(ret, 0);
+
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+
+        pcrdr_msg *msg = purc_inst_take_away_message(0);
+        ASSERT_NE(msg, nullptr);
+        ASSERT_EQ(purc_variant_array_get_size(msg->data), 2);
+
+        purc_variant_t name = purc_variant_array_get(msg->data, 0);
+        ASSERT_STREQ(purc_variant_get_string_const(name),
+                "a string shared by all messages sent by this runner");
+
+        pcrdr_release_message(msg);
+        nr_got++;
+    }
+
+    for (int i = 0; i < NR_PERF_SENDERS; i++) {
+        pthread_join(senders[i], NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double secs = end.tv_sec - start.tv_sec +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    fprintf(stderr, "%d runners moved %zu messages in %.3f s "
+            "(%.0f messages per second)\n",
+            NR_PERF_SENDERS, nr_total, secs, nr_total / secs);
+
+    size_t depth, nr_moved, nr_dropped;
+    ret = purc_inst_move_buffer_stats(main_inst, &depth, &nr_moved,
+            &nr_dropped);
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(depth, 0);
+    ASSERT_EQ(nr_moved, nr_total);
+    fprintf(stderr, "%zu messages dropped because the buffer was full\n",
+            nr_dropped);
+
+    purc_inst_destroy_move_buffer();
+    purc_cleanup();
+}
@@ -21,6 +21,9 @@
 #include "purc.h"
 
 #include "private/vdom.h"
+#include "private/interpreter.h"
+
+#include <time.h>
 #include <gtest/gtest.h>
 
 TEST(observe, basic)
@@ -93,3 +96,172 @@ TEST(observe, basic)
     ASSERT_EQ (cleanup, true);
 }
 
+
+#define NR_PERF_OBSERVERS   10000
+#define NR_PERF_EVENTS      100000
+#define NR_LINEAR_EVENTS    1000
+
+static double
+elapsed_secs(const struct timespec *from, const struct timespec *to)
+{
+    return (to->tv_sec - from->tv_sec) +
+        (to->tv_nsec - from->tv_nsec) / 1000000000.0;
+}
+
+static size_t
+dispatch_by_index(struct pcintr_observer_index *index,
+        purc_variant_t observed, purc_atom_t type, const char *sub_type)
+{
+    struct pcintr_observer_iterator it;
+    struct pcintr_observer *observer;
+    size_t nr = 0;
+
+    pcintr_observer_index_begin(index, &it, observed, type);
+    while ((observer = pcintr_observer_index_next(&it))) {
+        if (pcintr_is_observer_match(observer, NULL, observed, type,
+                    sub_type))
+            nr++;
+    }
+    pcintr_observer_index_end(&it);
+    return nr;
+}
+
+TEST(observe, dispatch_perf)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "test_observe", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const purc_atom_t types[] = {
+        purc_atom_from_static_string_ex(PURC_ATOM_BUCKET_USER, "change"),
+        purc_atom_from_static_string_ex(PURC_ATOM_BUCKET_USER, "expired"),
+    };
+    const char *patterns[] = { NULL, "foo", "^ba.$" };
+    const char *sub_types[] = { NULL, "foobar", "bar", "baz" };
+
+    purc_variant_t observed[NR_PERF_OBSERVERS];
+    struct pcintr_observer *observers[NR_PERF_OBSERVERS];
+    struct pcintr_observer_index index;
+    pcintr_observer_index_init(&index);
+
+    for (size_t i = 0; i < NR_PERF_OBSERVERS; i++) {
+        observed[i] = purc_variant_make_ulongint(i);
+
+        struct pcintr_observer *observer = (struct pcintr_observer *)
+            calloc(1, sizeof(*observer));
+        ASSERT_NE(observer, nullptr);
+
+        observer->observed = observed[i];
+        observer->msg_type_atom = types[i % 2];
+        const char *pattern = patterns[i % PCA_TABLESIZE(patterns)];
+        observer->sub_type = pattern ? strdup(pattern) : NULL;
+        ASSERT_EQ(pcintr_observer_index_add(&index, observer), 0);
+        observers[i] = observer;
+    }
+
+    struct timespec t0, t1;
+    size_t nr_matched = 0, nr_linear = 0, nr_indexed = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t n = 0; n < NR_LINEAR_EVENTS; n++) {
+        purc_variant_t v = observed[(n * 7) % NR_PERF_OBSERVERS];
+        purc_atom_t type = types[n % 2];
+        const char *sub_type = sub_types[n % PCA_TABLESIZE(sub_types)];
+
+        for (size_t i = 0; i < NR_PERF_OBSERVERS; i++) {
+            if (pcintr_is_observer_match(observers[i], NULL, v, type,
+                        sub_type))
+                nr_linear++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double linear_secs = elapsed_secs(&t0, &t1);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (size_t n = 0; n < NR_PERF_EVENTS; n++) {
+        purc_variant_t v = observed[(n * 7) % NR_PERF_OBSERVERS];
+        purc_atom_t type = types[n % 2];
+        const char *sub_type = sub_types[n % PCA_TABLESIZE(sub_types)];
+
+        size_t nr = dispatch_by_index(&index, v, type, sub_type);
+        if (n < NR_LINEAR_EVENTS)
+            nr_indexed += nr;
+        nr_matched += nr;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double indexed_secs = elapsed_secs(&t0, &t1);
+
+    ASSERT_EQ(nr_indexed, nr_linear);
+    ASSERT_GT(nr_matched, 0);
+
+    /* an observer on a native entity is dispatched exactly once */
+    static int entity;
+    purc_variant_t native = purc_variant_make_native(&entity, NULL);
+    ASSERT_NE(native, PURC_VARIANT_INVALID);
+    struct pcintr_observer *native_observer = (struct pcintr_observer *)
+        calloc(1, sizeof(*native_observer));
+    ASSERT_NE(native_observer, nullptr);
+    native_observer->observed = native;
+    native_observer->msg_type_atom = types[0];
+    ASSERT_EQ(pcintr_observer_index_add(&index, native_observer), 0);
+    ASSERT_EQ(dispatch_by_index(&index, native, types[0], NULL), 1);
+    pcintr_observer_index_remove(native_observer);
+    free(native_observer);
+    purc_variant_unref(native);
+
+    fprintf(stderr, "%d observers: linear scan %.0f events/s, "
+            "index %.0f events/s (%zu matched)\n", NR_PERF_OBSERVERS,
+            NR_LINEAR_EVENTS / linear_secs, NR_PERF_EVENTS / indexed_secs,
+            nr_matched);
+
+    for (size_t i = 0; i < NR_PERF_OBSERVERS; i++) {
+        pcintr_observer_index_remove(observers[i]);
+        free(observers[i]->sub_type);
+        free(observers[i]);
+        purc_variant_unref(observed[i]);
+    }
+    pcintr_observer_index_cleanup(&index);
+
+    purc_cleanup();
+}
+
+TEST(observe, mutated_container)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex(PURC_MODULE_EJSON, "cn.fmsoft.hybridos.test",
+            "test_observe", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    purc_atom_t grow = purc_atom_from_static_string_ex(PURC_ATOM_BUCKET_USER,
+            "grow");
+
+    struct pcintr_observer_index index;
+    pcintr_observer_index_init(&index);
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+
+    struct pcintr_observer *observer = (struct pcintr_observer *)
+        calloc(1, sizeof(*observer));
+    ASSERT_NE(observer, nullptr);
+    observer->observed = arr;
+    observer->msg_type_atom = grow;
+    ASSERT_EQ(pcintr_observer_index_add(&index, observer), 0);
+
+    /* the event is dispatched after the array grew */
+    for (int i = 0; i < 3; i++) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+
+        ASSERT_EQ(dispatch_by_index(&index, arr, grow, NULL), 1);
+    }
+
+    pcintr_observer_index_remove(observer);
+    free(observer);
+    purc_variant_unref(arr);
+    pcintr_observer_index_cleanup(&index);
+
+    purc_cleanup();
+}
@@ -0,0 +1,187 @@
+/*
+** Copyright (C) 2022 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc.h"
+#include "private/instance.h"
+#include "private/interpreter.h"
+#include "interpreter/internal.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+
+#define LOG_FILE    "/tmp/purc-test-rdr-batch-msg.log"
+
+struct rdr_batch_instance {
+    bool ok;
+
+    rdr_batch_instance() {
+        unlink(LOG_FILE);
+
+        struct purc_instance_extra_info info = { };
+        info.renderer_prot = PURC_RDRPROT_HEADLESS;
+        info.renderer_uri = "file://" LOG_FILE;
+        ok = purc_init_ex(PURC_MODULE_HVML | PURC_MODULE_PCRDR,
+                "cn.fmsoft.hybridos.test", "rdr_batch",
+                &info) == PURC_ERROR_OK;
+    }
+
+    ~rdr_batch_instance() {
+        if (ok)
+            purc_cleanup();
+        unlink(LOG_FILE);
+    }
+};
+
+// a fake element: the queue only uses the handle of an element
+#define ELEMENT(n)  ((pcdoc_element_t)(uintptr_t)(n))
+
+static bool
+queue(struct pcintr_heap *heap, pcdoc_operation op, uintptr_t element,
+        const char *property, pcrdr_msg_data_type data_type,
+        const char *data)
+{
+    return pcintr_rdr_queue_dom_req(heap, 1, op, ELEMENT(element),
+            property, data_type, purc_variant_make_string(data, false));
+}
+
+static struct pcintr_rdr_dom_req *
+nth_req(struct pcintr_heap *heap, size_t n)
+{
+    struct pcintr_rdr_dom_req *req;
+    list_for_each_entry(req, &heap->rdr_dom_reqs, ln) {
+        if (n-- == 0)
+            return req;
+    }
+    return NULL;
+}
+
+static size_t
+count_requests(void)
+{
+    size_t nr = 0;
+    char line[1024];
+
+    // the renderer writes the log through a buffered stream
+    fflush(NULL);
+    FILE *fp = fopen(LOG_FILE, "r");
+    if (fp == NULL)
+        return 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (strcmp(line, ">>>\n") == 0)
+            nr++;
+    }
+    fclose(fp);
+    return nr;
+}
+
+// to test how the queued DOM operations are coalesced
+TEST(rdr_batch, coalesce)
+{
+    rdr_batch_instance purc;
+    ASSERT_TRUE(purc.ok);
+
+    struct pcintr_heap *heap = pcinst_current()->intr_heap;
+    ASSERT_NE(heap, nullptr);
+
+    // the plain texts appended to the same target are concatenated
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 1, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, "foo"));
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 1, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, "bar"));
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 1);
+    ASSERT_STREQ(purc_variant_get_string_const(nth_req(heap, 0)->data),
+            "foobar");
+
+    // but not the HTML fragments
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 2, NULL,
+                PCRDR_MSG_DATA_TYPE_HTML, "<b>"));
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 2, NULL,
+                PCRDR_MSG_DATA_TYPE_HTML, "bold</b>"));
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 3);
+    ASSERT_STREQ(purc_variant_get_string_const(nth_req(heap, 2)->data),
+            "bold</b>");
+
+    // nor the texts of different types or targets
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 2, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, "text"));
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 3, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, "text"));
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 5);
+
+    // a displacement supersedes the operations right before it
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 3, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, "more"));
+    ASSERT_TRUE(queue(heap, PCDOC_OP_DISPLACE, 3, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, "new"));
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 5);
+    ASSERT_STREQ(nth_req(heap, 4)->operation, PCRDR_OPERATION_DISPLACE);
+
+    // and the texts appended after it are concatenated onto it
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 3, NULL,
+                PCRDR_MSG_DATA_TYPE_PLAIN, " text"));
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 5);
+    ASSERT_STREQ(nth_req(heap, 4)->operation, PCRDR_OPERATION_DISPLACE);
+    ASSERT_STREQ(purc_variant_get_string_const(nth_req(heap, 4)->data),
+            "new text");
+
+    // the properties other than textContent are never concatenated
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 3, "attr.class",
+                PCRDR_MSG_DATA_TYPE_PLAIN, "a"));
+    ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, 3, "attr.class",
+                PCRDR_MSG_DATA_TYPE_PLAIN, " b"));
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 7);
+
+    pcintr_rdr_discard_dom_batch(pcinst_current());
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 0);
+    ASSERT_TRUE(list_empty(&heap->rdr_dom_reqs));
+}
+
+// to test that a batch is sent as pipelined requests
+TEST(rdr_batch, flush)
+{
+    rdr_batch_instance purc;
+    ASSERT_TRUE(purc.ok);
+
+    struct pcinst *inst = pcinst_current();
+    struct pcintr_heap *heap = inst->intr_heap;
+    ASSERT_NE(heap, nullptr);
+    ASSERT_NE(inst->conn_to_rdr, nullptr);
+
+    static const size_t nr_reqs = 5;
+    for (size_t i = 0; i < nr_reqs; i++) {
+        ASSERT_TRUE(queue(heap, PCDOC_OP_APPEND, i + 1, NULL,
+                    PCRDR_MSG_DATA_TYPE_PLAIN, "text"));
+    }
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, nr_reqs);
+
+    size_t nr_before = count_requests();
+
+    // the fake document is unknown to the renderer, so every operation
+    // fails, but all of them are sent and all responses are collected
+    ASSERT_EQ(pcintr_rdr_flush_dom_batch(inst), -1);
+    ASSERT_EQ(heap->nr_rdr_dom_reqs, 0);
+    ASSERT_EQ(heap->nr_rdr_dom_pending, 0);
+    ASSERT_EQ(heap->nr_rdr_dom_failed, nr_reqs);
+    ASSERT_EQ(count_requests() - nr_before, nr_reqs);
+
+    // nothing to send
+    ASSERT_EQ(pcintr_rdr_flush_dom_batch(inst), 0);
+}
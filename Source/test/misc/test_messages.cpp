@@ -20,7 +20,9 @@
 #include "purc.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
+#include <time.h>
 #include <gtest/gtest.h>
 
 #define ATOM_BITS_NR        (sizeof(purc_atom_t) << 3)
@@ -93,3 +95,70 @@ TEST(instance, messages)
     purc_cleanup();
 }
 
+
+TEST(instance, messages_perf)
+{
+    int ret = purc_init_ex(PURC_MODULE_EJSON, NULL, NULL, NULL);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1000000;
+    }
+
+    static const char *event_names[] = {
+        "click", "change", "mouseover", "keydown:enter",
+    };
+
+    static const char data[] = "{\"x\":10,\"y\":20}";
+
+    pcrdr_msg *msgs[PCA_TABLESIZE(event_names)];
+    for (size_t i = 0; i < PCA_TABLESIZE(event_names); i++) {
+        msgs[i] = pcrdr_make_event_message(PCRDR_MSG_TARGET_DOM,
+                0x1234 + i, event_names[i], "edpt://localhost/app/runner",
+                PCRDR_MSG_ELEMENT_TYPE_CSS, "a[href='/index.html']", NULL,
+                PCRDR_MSG_DATA_TYPE_JSON, data, sizeof(data) - 1);
+        ASSERT_NE(msgs[i], nullptr);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (size_t n = 0; n < nr_loops; n++) {
+        pcrdr_msg *msg = msgs[n % PCA_TABLESIZE(event_names)];
+        pcrdr_msg *msg_parsed;
+        struct buff_info info = { buffer_a, sizeof (buffer_a), 0 };
+
+        pcrdr_serialize_message(msg, write_to_buf, &info);
+        buffer_a[info.pos] = '\0';
+
+        ret = pcrdr_parse_packet(buffer_a, info.pos + 1, &msg_parsed);
+        ASSERT_EQ(ret, 0);
+
+        if (n < PCA_TABLESIZE(event_names)) {
+            ASSERT_EQ(msg_parsed->type, PCRDR_MSG_TYPE_EVENT);
+            ASSERT_EQ(msg_parsed->targetValue, msg->targetValue);
+            ASSERT_STREQ(purc_variant_get_string_const(msg_parsed->eventName),
+                    event_names[n]);
+            ASSERT_STREQ(
+                    purc_variant_get_string_const(msg_parsed->elementValue),
+                    purc_variant_get_string_const(msg->elementValue));
+            ASSERT_TRUE(purc_variant_is_equal_to(msg_parsed->data, msg->data));
+        }
+
+        pcrdr_release_message(msg_parsed);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double secs = end.tv_sec - start.tv_sec +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    fprintf(stderr, "round trip of %zu event messages: %.3f s\n",
+            nr_loops, secs);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(event_names); i++) {
+        pcrdr_release_message(msgs[i]);
+    }
+
+    purc_cleanup();
+}
@@ -30,6 +30,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 
 void create_temp_file(const char* file, const char* buf, size_t buf_len)
@@ -1166,6 +1167,131 @@ TEST(gio_rwstream, seek_read)
 
     remove_temp_file(tmp_file);
 }
+
+TEST(gio_rwstream, read_ahead)
+{
+    char tmp_file[] = "/tmp/rwstream.txt";
+    char buf[] = "This这 is 测。";
+    size_t buf_len = strlen(buf);
+    create_temp_file(tmp_file, buf, buf_len);
+
+    int fd = open(tmp_file, O_RDWR, S_IRGRP | S_IWGRP | S_IRUSR
+            | S_IWUSR | S_IROTH);
+
+    purc_rwstream_t rws = purc_rwstream_new_from_unix_fd (fd);
+
+    char read_buf[100] = {0};
+    uint32_t wc = 0;
+    int read_len = 0;
+
+    // the whole file is read ahead, but the position is the logical one
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 1);
+    ASSERT_EQ(purc_rwstream_tell (rws), 1);
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read (rws, read_buf, 3);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_STREQ(read_buf, "his");
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_EQ(wc, 0x8FD9);
+    ASSERT_EQ(purc_rwstream_tell (rws), 7);
+
+    off_t pos = purc_rwstream_seek (rws, 1, SEEK_CUR);
+    ASSERT_EQ(pos, 8);
+
+    // write where the reader stopped
+    ssize_t write_len = purc_rwstream_write (rws, "IS", 2);
+    ASSERT_EQ(write_len, 2);
+    ASSERT_EQ(purc_rwstream_tell (rws), 10);
+
+    pos = purc_rwstream_seek (rws, 7, SEEK_SET);
+    ASSERT_EQ(pos, 7);
+
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read (rws, read_buf, sizeof(read_buf));
+    ASSERT_STREQ(read_buf, " IS 测。");
+
+    int ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    // a character split across two writes of a pipe
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    rws = purc_rwstream_new_from_unix_fd (fds[0]);
+
+    ASSERT_EQ(write(fds[1], "T\xe8", 2), 2);
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 1);
+    ASSERT_STREQ(read_buf, "T");
+
+    ASSERT_EQ(write(fds[1], "\xbf\x99", 2), 2);
+    close(fds[1]);
+    memset(read_buf, 0, sizeof(read_buf));
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 3);
+    ASSERT_EQ(wc, 0x8FD9);
+    ASSERT_STREQ(read_buf, "这");
+
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 0);
+
+    ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+    close(fds[0]);
+
+    // a pipe is not read ahead: the bytes after the character stay in it
+    ASSERT_EQ(pipe(fds), 0);
+    rws = purc_rwstream_new_from_unix_fd (fds[0]);
+
+    ASSERT_EQ(write(fds[1], "Tail", 4), 4);
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 1);
+    ASSERT_EQ(wc, 'T');
+
+    ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+
+    memset(read_buf, 0, sizeof(read_buf));
+    ASSERT_EQ(read(fds[0], read_buf, sizeof(read_buf)), 3);
+    ASSERT_STREQ(read_buf, "ail");
+    close(fds[1]);
+    close(fds[0]);
+
+    // a read longer than the window gets the bytes read ahead first,
+    // then the rest from the file
+    static const size_t big_len = 10000;
+    char *big = (char *)malloc(big_len);
+    for (size_t i = 0; i < big_len; i++)
+        big[i] = 'a' + i % 26;
+    create_temp_file(tmp_file, big, big_len);
+
+    fd = open(tmp_file, O_RDONLY);
+    rws = purc_rwstream_new_from_unix_fd (fd);
+
+    read_len = purc_rwstream_read_utf8_char (rws, read_buf, &wc);
+    ASSERT_EQ(read_len, 1);
+    ASSERT_EQ(wc, 'a');
+
+    char *big_read = (char *)malloc(big_len);
+    ssize_t nr_read = purc_rwstream_read (rws, big_read, big_len - 1);
+    ASSERT_EQ(nr_read, (ssize_t)(big_len - 1));
+    ASSERT_EQ(memcmp(big_read, big + 1, big_len - 1), 0);
+    ASSERT_EQ(purc_rwstream_tell (rws), (off_t)big_len);
+    ASSERT_EQ(purc_rwstream_read (rws, big_read, 1), 0);
+
+    ret = purc_rwstream_destroy (rws);
+    ASSERT_EQ(ret, 0);
+    close(fd);
+    free(big_read);
+    free(big);
+
+    remove_temp_file(tmp_file);
+}
 #endif
 
 
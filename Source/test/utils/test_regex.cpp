@@ -147,3 +147,41 @@ TEST(regex, match_info)
     pcregex_destroy(regex);
 }
 
+
+TEST(regex, lookup)
+{
+    const enum pcregex_compile_flags none = (enum pcregex_compile_flags)0;
+    const enum pcregex_match_flags mnone = (enum pcregex_match_flags)0;
+
+    struct pcregex *first = pcregex_lookup("[0-9]+", none, mnone);
+    ASSERT_NE(first, nullptr);
+
+    /* the same pattern is served from the cache */
+    struct pcregex *second = pcregex_lookup("[0-9]+", none, mnone);
+    ASSERT_EQ(first, second);
+
+    /* but not with other compile options */
+    struct pcregex *caseless = pcregex_lookup("[0-9]+", PCREGEX_CASELESS, mnone);
+    ASSERT_NE(caseless, nullptr);
+    ASSERT_NE(first, caseless);
+
+    ASSERT_EQ(pcregex_match(first, "ab12", NULL), true);
+    ASSERT_EQ(pcregex_match(second, "abc", NULL), false);
+
+    pcregex_destroy(second);
+    pcregex_destroy(caseless);
+
+    /* evict everything; the reference held here stays usable */
+    char pattern[32];
+    for (int i = 0; i < 100; i++) {
+        snprintf(pattern, sizeof(pattern), "x%dy", i);
+        ASSERT_EQ(pcregex_is_match(pattern, pattern), true);
+    }
+    ASSERT_EQ(pcregex_match(first, "99", NULL), true);
+    pcregex_destroy(first);
+
+    ASSERT_EQ(pcregex_lookup("(", none, mnone), nullptr);
+    ASSERT_EQ(pcregex_is_match("(", "("), false);
+
+    pcregex_cache_cleanup();
+}
@@ -34,6 +34,9 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <atomic>
 #include <gtest/gtest.h>
 
 #define ATOM_BUCKET     1
@@ -131,6 +134,13 @@ TEST(utils, atom_basic)
     purc_atom_t new_atom = purc_atom_from_string("displace");
     ASSERT_GT(new_atom, old_atom);
 
+    // only the first bytes of a longer string are looked up
+    static const char rule[] = "displace: more";
+    ASSERT_EQ(purc_atom_try_string_len(0, rule, 8), new_atom);
+    ASSERT_EQ(purc_atom_try_string_len(0, rule, 7), 0);
+    ASSERT_EQ(purc_atom_try_string_len(0, rule, 9), 0);
+    ASSERT_EQ(purc_atom_try_string_len(0, NULL, 0), 0);
+
     purc_cleanup ();
 }
 
@@ -353,6 +363,181 @@ TEST(utils, atom_buckets)
     purc_cleanup ();
 }
 
+struct atom_thread_arg {
+    size_t          nr_loops;
+    size_t          nr_found;
+    purc_atom_t     created[sizeof(my_atoms)/sizeof(my_atoms[0])];
+};
+
+static void *atom_thread(void *data)
+{
+    struct atom_thread_arg *arg = (struct atom_thread_arg *)data;
+    size_t nr_atoms = sizeof(my_atoms)/sizeof(my_atoms[0]);
+
+    // all threads create the same atoms at the same time
+    for (size_t i = 0; i < nr_atoms; i++) {
+        arg->created[i] = purc_atom_from_string_ex(PURC_ATOM_BUCKET_USER,
+                my_atoms[i].string);
+    }
+
+    for (size_t n = 0; n < arg->nr_loops; n++) {
+        for (size_t i = 0; i < nr_atoms; i++) {
+            if (purc_atom_try_string_ex(PURC_ATOM_BUCKET_USER,
+                        my_atoms[i].string))
+                arg->nr_found++;
+        }
+    }
+
+    return NULL;
+}
+
+TEST(utils, atom_perf)
+{
+    int ret = purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hybridos.test",
+            "utils", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1000;
+    }
+
+    size_t nr_atoms = sizeof(my_atoms)/sizeof(my_atoms[0]);
+    static const size_t nr_threads[] = { 8, 16, 32 };
+    for (size_t t = 0; t < sizeof(nr_threads)/sizeof(nr_threads[0]); t++) {
+        pthread_t threads[32];
+        struct atom_thread_arg args[32] = { };
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (size_t i = 0; i < nr_threads[t]; i++) {
+            args[i].nr_loops = nr_loops;
+            ASSERT_EQ(pthread_create(&threads[i], NULL, atom_thread,
+                        &args[i]), 0);
+        }
+        for (size_t i = 0; i < nr_threads[t]; i++) {
+            pthread_join(threads[i], NULL);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        for (size_t i = 0; i < nr_threads[t]; i++) {
+            ASSERT_EQ(args[i].nr_found, nr_loops * nr_atoms);
+            for (size_t j = 0; j < nr_atoms; j++) {
+                ASSERT_EQ(args[i].created[j], args[0].created[j]);
+                ASSERT_STREQ(purc_atom_to_string(args[i].created[j]),
+                        my_atoms[j].string);
+            }
+        }
+
+        double secs = (end.tv_sec - start.tv_sec) +
+            (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+        double nr_lookups = (double)nr_threads[t] * nr_loops * nr_atoms;
+        fprintf(stderr, "atom lookups with %2u threads: %.0f, %.3f s, "
+                "%.2f M/s\n", (unsigned)nr_threads[t], nr_lookups, secs,
+                nr_lookups / secs / 1000000.0);
+    }
+
+    purc_cleanup ();
+}
+
+static std::atomic<bool> atom_readers_stop;
+
+static double heap_in_use(void)
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    // the large blocks are allocated with mmap()
+    struct mallinfo2 info = mallinfo2();
+    return (double)(info.uordblks + info.hblkhd);
+#else
+    return 0;
+#endif
+}
+
+struct atom_reader_arg {
+    purc_atom_t     stable;
+    size_t          nr_bad;
+};
+
+static void *atom_reader_thread(void *data)
+{
+    struct atom_reader_arg *arg = (struct atom_reader_arg *)data;
+    size_t nr_atoms = sizeof(my_atoms)/sizeof(my_atoms[0]);
+
+    while (!atom_readers_stop.load()) {
+        for (size_t i = 0; i < nr_atoms; i++) {
+            purc_atom_try_string_ex(PURC_ATOM_BUCKET_USER,
+                    my_atoms[i].string);
+        }
+
+        const char *string = purc_atom_to_string(arg->stable);
+        if (string == NULL || strcmp(string, "stable"))
+            arg->nr_bad++;
+    }
+
+    return NULL;
+}
+
+// to test that the memory of removed atoms is freed while others read
+TEST(utils, atom_reclaim)
+{
+    int ret = purc_init_ex(PURC_MODULE_UTILS, "cn.fmsoft.hybridos.test",
+            "utils", NULL);
+    ASSERT_EQ (ret, PURC_ERROR_OK);
+
+    static const size_t nr_readers = 4;
+    static const size_t nr_cycles = 100000;
+    size_t nr_atoms = sizeof(my_atoms)/sizeof(my_atoms[0]);
+    for (size_t i = 0; i < nr_atoms; i++) {
+        purc_atom_from_static_string_ex(PURC_ATOM_BUCKET_USER,
+                my_atoms[i].string);
+    }
+
+    pthread_t threads[nr_readers];
+    struct atom_reader_arg args[nr_readers] = { };
+    purc_atom_t stable = purc_atom_from_static_string_ex(
+            PURC_ATOM_BUCKET_USER, "stable");
+    atom_readers_stop = false;
+    for (size_t i = 0; i < nr_readers; i++) {
+        args[i].stable = stable;
+        ASSERT_EQ(pthread_create(&threads[i], NULL, atom_reader_thread,
+                    &args[i]), 0);
+    }
+
+    // a long string makes a leaked entry easy to tell from the growth of
+    // the array mapping the ever-increasing sequence numbers to strings
+    char name[160];
+    memset(name, 'x', sizeof(name) - 16);
+    double heap_before = 0;
+    for (size_t n = 0; n < nr_cycles; n++) {
+        if (n == nr_cycles / 10)
+            heap_before = heap_in_use();
+
+        snprintf(name + sizeof(name) - 16, 16, "%zu", n % 1000);
+        purc_atom_t atom = purc_atom_from_string_ex(PURC_ATOM_BUCKET_USER,
+                name);
+        ASSERT_NE(atom, 0);
+        ASSERT_STREQ(purc_atom_to_string(atom), name);
+        ASSERT_EQ(purc_atom_remove_string_ex(PURC_ATOM_BUCKET_USER, name),
+                true);
+        ASSERT_EQ(purc_atom_try_string_ex(PURC_ATOM_BUCKET_USER, name), 0);
+        ASSERT_EQ(purc_atom_to_string(atom), nullptr);
+    }
+
+    double growth = (heap_in_use() - heap_before) /
+        (nr_cycles - nr_cycles / 10);
+    fprintf(stderr, "heap growth per removed atom: %.1f bytes\n", growth);
+    ASSERT_LT(growth, 64.0);
+
+    atom_readers_stop = true;
+    for (size_t i = 0; i < nr_readers; i++) {
+        pthread_join(threads[i], NULL);
+        ASSERT_EQ(args[i].nr_bad, 0);
+    }
+
+    purc_cleanup ();
+}
+
 // to test sorted array
 static int sortv[10] = { 1, 8, 7, 5, 4, 6, 9, 0, 2, 3 };
 
@@ -26,6 +26,7 @@
 #include "../helpers.h"
 
 #include <stdio.h>
+#include <time.h>
 #include <gtest/gtest.h>
 
 using namespace std;
@@ -271,3 +272,77 @@ std::vector<ejson_test_data> read_ejson_test_data()
 INSTANTIATE_TEST_SUITE_P(ejson, variant_load_from_json,
         testing::ValuesIn(read_ejson_test_data()));
 
+
+static double
+parse_json_loops(const std::string &json, size_t nr_loops, bool fast)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < nr_loops; i++) {
+        purc_variant_t v;
+        if (fast) {
+            v = purc_variant_make_from_json_string(json.c_str(), json.size());
+        }
+        else {
+            struct purc_ejson_parse_tree *ptree;
+            ptree = purc_variant_ejson_parse_string(json.c_str(), json.size());
+            v = purc_variant_ejson_parse_tree_evalute(ptree, NULL, NULL,
+                    false);
+            purc_variant_ejson_parse_tree_destroy(ptree);
+        }
+        EXPECT_NE(v, PURC_VARIANT_INVALID);
+        if (v)
+            purc_variant_unref(v);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start.tv_sec) +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+}
+
+TEST(load_from_json, perf)
+{
+    PurCInstance purc(false);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1;
+    }
+
+    /* about 2 MB JSON content */
+    const char *piece =
+        "{\"id\":12345,\"name\":\"The quick brown fox\",\"price\":3.1415926,"
+        "\"tags\":[\"\xe4\xb8\xad\xe6\x96\x87\",\"json\",true,false,null],"
+        "\"nested\":{\"a\":-1.5e10,\"b\":\"line\\nbreak\",\"c\":\"\\/\"}}";
+    std::string json = "[";
+    while (json.size() < 2 * 1024 * 1024) {
+        json += piece;
+        json += ",";
+    }
+    json += piece;
+    json += "]";
+
+    // both paths must give the same result
+    purc_variant_t fast = purc_variant_make_from_json_string(json.c_str(),
+            json.size());
+    struct purc_ejson_parse_tree *ptree;
+    ptree = purc_variant_ejson_parse_string(json.c_str(), json.size());
+    purc_variant_t slow = purc_variant_ejson_parse_tree_evalute(ptree,
+            NULL, NULL, false);
+    purc_variant_ejson_parse_tree_destroy(ptree);
+    ASSERT_NE(fast, PURC_VARIANT_INVALID);
+    ASSERT_NE(slow, PURC_VARIANT_INVALID);
+    ASSERT_TRUE(purc_variant_is_equal_to(fast, slow));
+    purc_variant_unref(fast);
+    purc_variant_unref(slow);
+
+    double mbytes = json.size() * nr_loops / 1024.0 / 1024.0;
+    double secs = parse_json_loops(json, nr_loops, false);
+    fprintf(stderr, "eJSON and VCM: %.2f MB, %.3f s, %.2f MB/s\n",
+            mbytes, secs, mbytes / secs);
+
+    secs = parse_json_loops(json, nr_loops, true);
+    fprintf(stderr, "plain JSON:    %.2f MB, %.3f s, %.2f MB/s\n",
+            mbytes, secs, mbytes / secs);
+}
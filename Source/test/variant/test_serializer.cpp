@@ -21,8 +21,11 @@
 
 #include "private/variant.h"
 
+#include "../helpers.h"
+
 #include <stdio.h>
 #include <errno.h>
+#include <string>
 #include <gtest/gtest.h>
 
 static inline int my_puts(const char* str)
@@ -994,3 +997,151 @@ TEST(variant, serialize_object_with_empty_key2)
 
     purc_cleanup ();
 }
+
+static std::string serialize_to_string(purc_variant_t v, unsigned int flags)
+{
+    purc_rwstream_t rws = purc_rwstream_new_buffer(1024, 0);
+    size_t len_expected = 0;
+    ssize_t n = purc_variant_serialize(v, rws, 0, flags, &len_expected);
+    EXPECT_GT(n, 0);
+    EXPECT_EQ((size_t)n, len_expected);
+
+    size_t sz = 0;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(rws, &sz);
+    std::string result(buf, sz);
+    purc_rwstream_destroy(rws);
+    return result;
+}
+
+// to test: serialize doubles in the shortest round-trip form
+TEST(variant, serialize_shortest_double)
+{
+    static const struct {
+        double      d;
+        const char *expected;
+    } cases[] = {
+        { 0.1,                      "0.1" },
+        { -0.1,                     "-0.1" },
+        { 0.3,                      "0.3" },
+        { 0.1 + 0.2,                "0.30000000000000004" },
+        { 123.456,                  "123.456" },
+        { 1e-5,                     "1e-05" },
+        { 0.0001,                   "0.0001" },
+        { 5e-324,                   "5e-324" },
+        { 1.7976931348623157e308,   "1.7976931348623157e+308" },
+        { 1e200,                    "1e+200" },
+        { 1e22,                     "10000000000000000000000" },
+        { -0.0,                     "-0" },
+        { 42.0,                     "42" },
+    };
+
+    PurCInstance purc((unsigned int)PURC_MODULE_VARIANT);
+    ASSERT_TRUE(purc);
+
+    for (size_t i = 0; i < PCA_TABLESIZE(cases); i++) {
+        purc_variant_t v = purc_variant_make_number(cases[i].d);
+        std::string s = serialize_to_string(v, PCVARIANT_SERIALIZE_OPT_PLAIN);
+        ASSERT_EQ(s, cases[i].expected);
+        ASSERT_EQ(strtod(s.c_str(), NULL), cases[i].d);
+        purc_variant_unref(v);
+    }
+}
+
+// to test: escape long strings around the boundaries of the vector scan
+TEST(variant, serialize_string_escapes)
+{
+    PurCInstance purc((unsigned int)PURC_MODULE_VARIANT);
+    ASSERT_TRUE(purc);
+
+    for (size_t len = 1; len < 70; len++) {
+        for (size_t pos = 0; pos < len; pos++) {
+            std::string str(len, 'a');
+            str[pos] = (pos % 3 == 0) ? '"' : ((pos % 3 == 1) ? '\x01' : '/');
+
+            std::string expected = "\"" + str.substr(0, pos);
+            if (pos % 3 == 0)
+                expected += "\\\"";
+            else if (pos % 3 == 1)
+                expected += "\\u0001";
+            else
+                expected += "\\/";
+            expected += str.substr(pos + 1) + "\"";
+
+            purc_variant_t v = purc_variant_make_string(str.c_str(), false);
+            ASSERT_EQ(serialize_to_string(v, PCVARIANT_SERIALIZE_OPT_PLAIN),
+                    expected);
+            purc_variant_unref(v);
+        }
+    }
+
+    purc_variant_t v = purc_variant_make_string("/a/b/c\xe4\xb8\xad", false);
+    ASSERT_EQ(serialize_to_string(v, PCVARIANT_SERIALIZE_OPT_NOSLASHESCAPE),
+            "\"/a/b/c\xe4\xb8\xad\"");
+    purc_variant_unref(v);
+}
+
+static purc_variant_t make_large_variant(size_t nr_rows)
+{
+    purc_variant_t rows = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+
+    for (size_t i = 0; i < nr_rows; i++) {
+        char name[64];
+        snprintf(name, sizeof(name), "row #%zu: \"quoted\"\tand/slashed", i);
+
+        purc_variant_t id = purc_variant_make_ulongint(i);
+        purc_variant_t score = purc_variant_make_number(i * 0.1);
+        purc_variant_t title = purc_variant_make_string(name, false);
+        purc_variant_t text = purc_variant_make_string(
+                "Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+                "sed do eiusmod tempor incididunt ut labore et dolore.", false);
+        purc_variant_t tags = purc_variant_make_array(3, score, id, title);
+        purc_variant_t row = purc_variant_make_object_by_static_ckey(5,
+                "id", id, "score", score, "title", title, "text", text,
+                "tags", tags);
+
+        purc_variant_array_append(rows, row);
+        purc_variant_unref(row);
+        purc_variant_unref(tags);
+        purc_variant_unref(text);
+        purc_variant_unref(title);
+        purc_variant_unref(score);
+        purc_variant_unref(id);
+    }
+
+    return rows;
+}
+
+// to test: the performance of serializing large nested data
+TEST(variant, serialize_benchmark)
+{
+    PurCInstance purc((unsigned int)PURC_MODULE_VARIANT);
+    ASSERT_TRUE(purc);
+
+    purc_variant_t rows = make_large_variant(20000);
+    ASSERT_NE(rows, PURC_VARIANT_INVALID);
+
+    static const unsigned int flagsets[] = {
+        PCVARIANT_SERIALIZE_OPT_PLAIN,
+        PCVARIANT_SERIALIZE_OPT_PRETTY,
+    };
+
+    const int nr_loops = 10;
+    for (size_t i = 0; i < PCA_TABLESIZE(flagsets); i++) {
+        size_t sz = 0;
+        double start = now_ms();
+        for (int n = 0; n < nr_loops; n++) {
+            purc_rwstream_t rws = purc_rwstream_new_buffer(1024 * 1024, 0);
+            size_t len_expected = 0;
+            ssize_t written = purc_variant_serialize(rows, rws, 0,
+                    flagsets[i], &len_expected);
+            ASSERT_GT(written, 0);
+            sz = written;
+            purc_rwstream_destroy(rws);
+        }
+        double elapsed = (now_ms() - start) / nr_loops;
+        fprintf(stderr, "flags 0x%02x: %8zu bytes %10.3f ms %8.1f MB/s\n",
+                flagsets[i], sz, elapsed, sz / elapsed / 1000.0);
+    }
+
+    purc_variant_unref(rows);
+}
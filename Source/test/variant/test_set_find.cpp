@@ -115,3 +115,76 @@ TEST(set, unique_key_find)
     ASSERT_EQ (cleanup, true);
 }
 
+
+TEST(set, generic_find)
+{
+    purc_instance_extra_info info = {};
+    int ret = 0;
+    bool cleanup = false;
+
+    ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const int nr = 1000;
+    purc_variant_t set = purc_variant_make_set_by_ckey(0, NULL,
+            PURC_VARIANT_INVALID);
+    ASSERT_NE(set, PURC_VARIANT_INVALID);
+
+    for (int i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_set_add(set, v, false));
+        purc_variant_unref(v);
+    }
+
+    // members are compared by their stringified forms
+    for (int i = 0; i < nr; i++) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%d", i);
+        purc_variant_t v = purc_variant_make_string(buf, false);
+        ASSERT_TRUE(pcvariant_is_in_set(set, v));
+        purc_variant_unref(v);
+    }
+
+    // remove the odd ones, and check the left ones are still reachable
+    for (int i = 1; i < nr; i += 2) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_set_remove(set, v, false));
+        purc_variant_unref(v);
+    }
+
+    size_t sz = 0;
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, (size_t)nr / 2);
+
+    for (int i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_EQ(pcvariant_is_in_set(set, v), (i % 2) == 0);
+        purc_variant_unref(v);
+    }
+
+    // xor with [0, nr): the odd ones only
+    purc_variant_t arr = purc_variant_make_array(0, PURC_VARIANT_INVALID);
+    for (int i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        purc_variant_array_append(arr, v);
+        purc_variant_unref(v);
+    }
+    ASSERT_TRUE(purc_variant_set_xor(set, arr, true));
+
+    for (int i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_EQ(pcvariant_is_in_set(set, v), (i % 2) == 1);
+        purc_variant_unref(v);
+    }
+
+    ASSERT_TRUE(purc_variant_set_subtract(set, arr, true));
+    ASSERT_TRUE(purc_variant_set_size(set, &sz));
+    ASSERT_EQ(sz, (size_t)0);
+
+    purc_variant_unref(arr);
+    purc_variant_unref(set);
+
+    cleanup = purc_cleanup ();
+    ASSERT_EQ (cleanup, true);
+}
@@ -0,0 +1,275 @@
+/*
+** Copyright (C) 2026 FMSoft <https://www.fmsoft.cn>
+**
+** This file is a part of PurC (short for Purring Cat), an HVML interpreter.
+**
+** This program is free software: you can redistribute it and/or modify
+** it under the terms of the GNU Lesser General Public License as published by
+** the Free Software Foundation, either version 3 of the License, or
+** (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU Lesser General Public License for more details.
+**
+** You should have received a copy of the GNU Lesser General Public License
+** along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "purc.h"
+#include "private/variant.h"
+
+#include "../helpers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#define NR_OBJS         1000
+
+static int init_instance(void)
+{
+    purc_instance_extra_info info = {};
+    return purc_init_ex(PURC_MODULE_VARIANT, "cn.fmsoft.hvml.test",
+            "variant_slab", &info);
+}
+
+static const struct purc_variant_slab_stat *slab_stat(size_t size)
+{
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    return stat->slab + (size - 1) / 16;
+}
+
+/* the resident set size in KiB */
+static long rss_kb(void)
+{
+    long pages = 0, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (fp) {
+        if (fscanf(fp, "%ld %ld", &pages, &resident) != 2)
+            resident = 0;
+        fclose(fp);
+    }
+
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+TEST(variant_slab, stat)
+{
+    ASSERT_EQ(init_instance(), PURC_ERROR_OK);
+
+    size_t used = slab_stat(sizeof(purc_variant))->nr_used -
+        purc_variant_usage_stat()->nr_reserved;
+
+    purc_variant_t arr = purc_variant_make_array_0();
+    for (int i = 0; i < NR_OBJS; i++) {
+        purc_variant_t v = purc_variant_make_number(i);
+        purc_variant_array_append(arr, v);
+        purc_variant_unref(v);
+    }
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    const struct purc_variant_slab_stat *s = slab_stat(sizeof(purc_variant));
+    ASSERT_EQ(s->sz_obj, (sizeof(purc_variant) + 15) / 16 * 16);
+    ASSERT_GE(s->nr_used, used + NR_OBJS + 1);
+
+    size_t sz_slab_mem = 0;
+    for (int i = 0; i < PURC_VARIANT_NR_SLAB_CLASSES; i++) {
+        ASSERT_EQ(stat->slab[i].sz_obj, (size_t)(i + 1) * 16);
+        sz_slab_mem += stat->slab[i].nr_pages;
+    }
+    ASSERT_GT(sz_slab_mem, 0);
+    ASSERT_EQ(stat->sz_slab_mem % sz_slab_mem, 0);
+
+    purc_variant_unref(arr);
+
+    /* the freed variants go to the reserved list first */
+    s = slab_stat(sizeof(purc_variant));
+    ASSERT_EQ(s->nr_used, used + stat->nr_reserved);
+
+    purc_cleanup();
+}
+
+struct remote_ctxt {
+    std::vector<void *> objs;
+};
+
+/* frees the objects in another instance */
+static void *free_objs(void *arg)
+{
+    struct remote_ctxt *ctxt = (struct remote_ctxt *)arg;
+
+    if (init_instance() != PURC_ERROR_OK)
+        return arg;
+
+    for (void *obj : ctxt->objs)
+        pcvariant_slab_free(obj);
+    ctxt->objs.clear();
+
+    purc_cleanup();
+    return NULL;
+}
+
+/* allocates the objects in another instance which exits at once */
+static void *alloc_objs(void *arg)
+{
+    struct remote_ctxt *ctxt = (struct remote_ctxt *)arg;
+
+    if (init_instance() != PURC_ERROR_OK)
+        return arg;
+
+    for (int i = 0; i < NR_OBJS; i++)
+        ctxt->objs.push_back(pcvariant_slab_alloc(sizeof(purc_variant)));
+
+    purc_cleanup();
+    return NULL;
+}
+
+TEST(variant_slab, remote_free)
+{
+    ASSERT_EQ(init_instance(), PURC_ERROR_OK);
+
+    size_t used = slab_stat(64)->nr_used;
+
+    struct remote_ctxt ctxt;
+    for (int i = 0; i < NR_OBJS; i++) {
+        void *obj = pcvariant_slab_alloc(64);
+        ASSERT_NE(obj, nullptr);
+        ctxt.objs.push_back(obj);
+    }
+    size_t nr_pages = slab_stat(64)->nr_pages;
+
+    pthread_t th;
+    void *ret;
+    ASSERT_EQ(pthread_create(&th, NULL, free_objs, &ctxt), 0);
+    pthread_join(th, &ret);
+    ASSERT_EQ(ret, nullptr);
+
+    /* not reclaimed until the instance runs out of free objects */
+    ASSERT_EQ(slab_stat(64)->nr_used, used + NR_OBJS);
+
+    for (int i = 0; i < NR_OBJS; i++)
+        ctxt.objs.push_back(pcvariant_slab_alloc(64));
+    ASSERT_EQ(slab_stat(64)->nr_pages, nr_pages);
+
+    for (void *obj : ctxt.objs)
+        pcvariant_slab_free(obj);
+    ctxt.objs.clear();
+    ASSERT_LE(slab_stat(64)->nr_used, used + NR_OBJS);
+
+    purc_cleanup();
+}
+
+TEST(variant_slab, orphaned)
+{
+    ASSERT_EQ(init_instance(), PURC_ERROR_OK);
+
+    /* the pages of the exited instance are freed with the last object */
+    struct remote_ctxt ctxt;
+    pthread_t th;
+    void *ret;
+    ASSERT_EQ(pthread_create(&th, NULL, alloc_objs, &ctxt), 0);
+    pthread_join(th, &ret);
+    ASSERT_EQ(ret, nullptr);
+    ASSERT_EQ(ctxt.objs.size(), (size_t)NR_OBJS);
+
+    for (void *obj : ctxt.objs)
+        pcvariant_slab_free(obj);
+
+    purc_cleanup();
+}
+
+#define NR_ROUNDS       20
+#define NR_LIVE         (100 * 1000)
+
+struct bench_result {
+    double  ms;
+    long    rss_kb;
+};
+
+/* runs the rounds in a child process to measure the RSS from scratch */
+static bool bench_alloc(bool use_slab, struct bench_result *result)
+{
+    int fds[2];
+    if (pipe(fds))
+        return false;
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::vector<void *> objs(NR_LIVE);
+        struct bench_result res;
+#ifdef __GLIBC__
+        /* drop the free memory inherited from the parent */
+        malloc_trim(0);
+#endif
+        long rss = rss_kb();
+        double start = now_ms();
+        for (int r = 0; r < NR_ROUNDS; r++) {
+            for (size_t i = 0; i < NR_LIVE; i++) {
+                if (use_slab)
+                    objs[i] = pcvariant_slab_alloc(sizeof(purc_variant));
+                else
+                    objs[i] = malloc(sizeof(purc_variant));
+            }
+            if (r == 0)
+                res.rss_kb = rss_kb() - rss;
+            for (size_t i = 0; i < NR_LIVE; i++) {
+                if (use_slab)
+                    pcvariant_slab_free(objs[i]);
+                else
+                    free(objs[i]);
+            }
+        }
+        res.ms = now_ms() - start;
+
+        ssize_t n = write(fds[1], &res, sizeof(res));
+        _exit(n == sizeof(res) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    bool ok = pid > 0 && read(fds[0], result, sizeof(*result)) ==
+        sizeof(*result);
+    close(fds[0]);
+    if (pid > 0)
+        waitpid(pid, NULL, 0);
+    return ok;
+}
+
+TEST(variant_slab, benchmark)
+{
+    ASSERT_EQ(init_instance(), PURC_ERROR_OK);
+
+    struct bench_result by_malloc, by_slab;
+    ASSERT_TRUE(bench_alloc(false, &by_malloc));
+    ASSERT_TRUE(bench_alloc(true, &by_slab));
+    fprintf(stderr, "%d x %d %zu-byte objects: malloc %.3f ms (%ld KiB), "
+            "slab %.3f ms (%ld KiB)\n", NR_ROUNDS, NR_LIVE,
+            sizeof(purc_variant), by_malloc.ms, by_malloc.rss_kb,
+            by_slab.ms, by_slab.rss_kb);
+
+    /* short-lived variants and containers */
+    double start = now_ms();
+    for (int r = 0; r < NR_ROUNDS; r++) {
+        purc_variant_t arr = purc_variant_make_array_0();
+        for (int i = 0; i < NR_LIVE / 10; i++) {
+            purc_variant_t v = purc_variant_make_longint(i);
+            purc_variant_array_append(arr, v);
+            purc_variant_unref(v);
+        }
+        purc_variant_unref(arr);
+    }
+    fprintf(stderr, "%d arrays of %d numbers: %.3f ms; slab memory %zu KiB\n",
+            NR_ROUNDS, NR_LIVE / 10, now_ms() - start,
+            purc_variant_usage_stat()->sz_slab_mem / 1024);
+
+    purc_cleanup();
+}
@@ -25,7 +25,9 @@
 #include "private/variant.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <errno.h>
+#include <time.h>
 #include <gtest/gtest.h>
 
 TEST(variant_array, init_with_1_str)
@@ -533,3 +535,242 @@ TEST(variant_array, sort)
     ASSERT_STREQ(inbuf, outbuf);
 }
 
+
+static purc_variant_t
+make_random_array(size_t nr, bool as_string)
+{
+    purc_variant_t arr = purc_variant_make_array_0();
+    if (arr == PURC_VARIANT_INVALID)
+        return PURC_VARIANT_INVALID;
+
+    srandom(1234);
+    for (size_t i = 0; i < nr; i++) {
+        char buf[32];
+        long n = random() % (nr / 2 + 1);   // keep some duplicates
+        purc_variant_t v;
+        if (as_string) {
+            snprintf(buf, sizeof(buf), "item-%08ld", n);
+            v = purc_variant_make_string(buf, false);
+        }
+        else {
+            v = purc_variant_make_longint(n);
+        }
+        purc_variant_array_append(arr, v);
+        purc_variant_unref(v);
+    }
+
+    return arr;
+}
+
+static bool
+check_sorted(purc_variant_t arr, purc_vrtcmp_opt_t opt, bool desc)
+{
+    size_t nr = purc_variant_array_get_size(arr);
+    for (size_t i = 1; i < nr; i++) {
+        purc_variant_t l = purc_variant_array_get(arr, i - 1);
+        purc_variant_t r = purc_variant_array_get(arr, i);
+        int diff = purc_variant_compare_ex(l, r, opt);
+        if (desc ? diff < 0 : diff > 0)
+            return false;
+    }
+    return true;
+}
+
+TEST(variant_array, sort_by_keys)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    // large enough to be sorted by several threads
+    const size_t sizes[] = { 2, 17, 1000, 100000 };
+    for (size_t i = 0; i < PCA_TABLESIZE(sizes); i++) {
+        purc_variant_t arr = make_random_array(sizes[i], false);
+        ASSERT_NE(arr, PURC_VARIANT_INVALID);
+
+        uintptr_t opt = PCVARIANT_SORT_ASC | PCVARIANT_COMPARE_OPT_NUMBER;
+        ASSERT_EQ(pcvariant_array_sort(arr, (void *)opt, NULL), 0);
+        ASSERT_TRUE(check_sorted(arr, PCVARIANT_COMPARE_OPT_NUMBER, false));
+
+        opt = PCVARIANT_SORT_DESC | PCVARIANT_COMPARE_OPT_NUMBER;
+        ASSERT_EQ(pcvariant_array_sort(arr, (void *)opt, NULL), 0);
+        ASSERT_TRUE(check_sorted(arr, PCVARIANT_COMPARE_OPT_NUMBER, true));
+        ASSERT_EQ(purc_variant_array_get_size(arr), sizes[i]);
+
+        purc_variant_unref(arr);
+
+        arr = make_random_array(sizes[i], true);
+        ASSERT_NE(arr, PURC_VARIANT_INVALID);
+
+        opt = PCVARIANT_SORT_ASC | PCVARIANT_COMPARE_OPT_CASELESS;
+        ASSERT_EQ(pcvariant_array_sort(arr, (void *)opt, NULL), 0);
+        ASSERT_TRUE(check_sorted(arr, PCVARIANT_COMPARE_OPT_CASELESS, false));
+
+        purc_variant_unref(arr);
+    }
+
+    ASSERT_EQ(purc_cleanup(), true);
+}
+
+static int
+cmp_case(purc_variant_t l, purc_variant_t r, void *ud)
+{
+    (void)ud;
+    return purc_variant_compare_ex(l, r, PCVARIANT_COMPARE_OPT_CASE);
+}
+
+static double
+sort_loops(size_t nr, size_t nr_loops, bool by_keys)
+{
+    double secs = 0;
+    for (size_t i = 0; i < nr_loops; i++) {
+        purc_variant_t arr = make_random_array(nr, true);
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (by_keys) {
+            uintptr_t opt = PCVARIANT_SORT_ASC | PCVARIANT_COMPARE_OPT_CASE;
+            pcvariant_array_sort(arr, (void *)opt, NULL);
+        }
+        else {
+            pcvariant_array_sort(arr, NULL, cmp_case);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        EXPECT_TRUE(check_sorted(arr, PCVARIANT_COMPARE_OPT_CASE, false));
+        purc_variant_unref(arr);
+
+        secs += (end.tv_sec - start.tv_sec) +
+            (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+    }
+
+    return secs;
+}
+
+TEST(variant_array, sort_perf)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1;
+    }
+
+    const size_t nr = 100000;
+    double t_cmp = sort_loops(nr, nr_loops, false);
+    double t_keys = sort_loops(nr, nr_loops, true);
+
+    fprintf(stderr, "sort %zu strings: %.3f s by comparing values, "
+            "%.3f s by keys\n", nr, t_cmp / nr_loops, t_keys / nr_loops);
+
+    ASSERT_EQ(purc_cleanup(), true);
+}
+
+TEST(variant_array, insert_in_middle)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    size_t sz_mem = stat->sz_mem[PVT(_ARRAY)];
+
+    // the even numbers first, then the odd ones in between
+    const int nr = 1000;
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    for (int i = 0; i < nr; i += 2) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+    for (int i = 1; i < nr; i += 2) {
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_array_insert_before(arr, i, v));
+        purc_variant_unref(v);
+    }
+    ASSERT_EQ(purc_variant_array_get_size(arr), nr);
+
+    // one pointer per member, with the capacity at most doubled
+    size_t sz_arr = stat->sz_mem[PVT(_ARRAY)] - sz_mem;
+    ASSERT_LE(sz_arr, sizeof(purc_variant) + sizeof(struct variant_arr) +
+            nr * 2 * sizeof(purc_variant_t));
+
+    purc_variant_t val;
+    size_t idx;
+    int64_t n;
+    foreach_value_in_variant_array(arr, val, idx)
+        ASSERT_TRUE(purc_variant_cast_to_longint(val, &n, false));
+        ASSERT_EQ(n, (int64_t)idx);
+    end_foreach;
+
+    int expected = nr;
+    foreach_value_in_variant_array_reverse(arr, val, idx)
+        ASSERT_TRUE(purc_variant_cast_to_longint(val, &n, false));
+        ASSERT_EQ(n, --expected);
+        ASSERT_EQ(purc_variant_array_get(arr, idx), val);
+    end_foreach;
+    ASSERT_EQ(expected, 0);
+
+    // remove the odd numbers from the end
+    foreach_value_in_variant_array_reverse_safe(arr, val, idx)
+        if (idx % 2)
+            ASSERT_TRUE(purc_variant_array_remove(arr, idx));
+    end_foreach;
+    ASSERT_EQ(purc_variant_array_get_size(arr), nr / 2);
+
+    foreach_value_in_variant_array(arr, val, idx)
+        ASSERT_TRUE(purc_variant_cast_to_longint(val, &n, false));
+        ASSERT_EQ(n, (int64_t)idx * 2);
+    end_foreach;
+
+    purc_variant_unref(arr);
+    ASSERT_EQ(stat->sz_mem[PVT(_ARRAY)], sz_mem);
+
+    ASSERT_EQ(purc_cleanup(), true);
+}
+
+TEST(variant_array, iterate_perf)
+{
+    purc_instance_extra_info info = {};
+    int ret = purc_init_ex (PURC_MODULE_VARIANT, "cn.fmsoft.hybridos.test",
+            "test_init", &info);
+    ASSERT_EQ(ret, PURC_ERROR_OK);
+
+    const size_t nr = 1000000;
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    for (size_t i = 0; i < nr; i++) {
+        purc_variant_t v = purc_variant_make_ulongint(i);
+        ASSERT_TRUE(purc_variant_array_append(arr, v));
+        purc_variant_unref(v);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    purc_variant_t val;
+    size_t idx;
+    uint64_t sum = 0;
+    foreach_value_in_variant_array(arr, val, idx)
+        (void)idx;
+        sum += val->u64;
+    end_foreach;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ASSERT_EQ(sum, (uint64_t)nr * (nr - 1) / 2);
+
+    fprintf(stderr, "iterate %zu members: %.3f ms, %zu bytes of storage\n",
+            nr, (end.tv_sec - start.tv_sec) * 1000.0 +
+            (end.tv_nsec - start.tv_nsec) / 1000000.0,
+            (size_t)arr->sz_ptr[0]);
+
+    purc_variant_unref(arr);
+    ASSERT_EQ(purc_cleanup(), true);
+}
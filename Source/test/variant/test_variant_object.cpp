@@ -25,6 +25,8 @@
 
 
 #include <stdarg.h>
+#include <malloc.h>
+#include <time.h>
 #include <stdio.h>
 #include <errno.h>
 #include <gtest/gtest.h>
@@ -466,3 +468,202 @@ TEST(object, compare)
     purc_variant_unref(obj2);
 }
 
+
+TEST(object, many_keys)
+{
+    PurCInstance purc;
+
+    const int nr_keys = 200;
+    char key[32];
+
+    purc_variant_t obj = purc_variant_make_object_0();
+    ASSERT_NE(obj, PURC_VARIANT_INVALID);
+
+    for (int i = 0; i < nr_keys; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        purc_variant_t k = purc_variant_make_string(key, false);
+        purc_variant_t v = purc_variant_make_longint(i);
+        ASSERT_TRUE(purc_variant_object_set(obj, k, v));
+        purc_variant_unref(k);
+        purc_variant_unref(v);
+    }
+    ASSERT_EQ(purc_variant_object_get_size(obj), (size_t)nr_keys);
+
+    // overwrite the even keys and remove every third key
+    for (int i = 0; i < nr_keys; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        purc_variant_t k = purc_variant_make_string(key, false);
+        purc_variant_t v = purc_variant_make_longint(-i);
+        ASSERT_TRUE(purc_variant_object_set(obj, k, v));
+        purc_variant_unref(k);
+        purc_variant_unref(v);
+    }
+    size_t nr_removed = 0;
+    for (int i = 0; i < nr_keys; i += 3) {
+        snprintf(key, sizeof(key), "key%d", i);
+        ASSERT_TRUE(purc_variant_object_remove_by_static_ckey(obj, key,
+                    false));
+        ++nr_removed;
+    }
+    ASSERT_EQ(purc_variant_object_get_size(obj), nr_keys - nr_removed);
+
+    for (int i = 0; i < nr_keys; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        purc_variant_t v = purc_variant_object_get_by_ckey(obj, key);
+        if (i % 3 == 0) {
+            ASSERT_EQ(v, PURC_VARIANT_INVALID);
+            purc_clr_error();
+            continue;
+        }
+        ASSERT_NE(v, PURC_VARIANT_INVALID);
+        int64_t i64;
+        ASSERT_TRUE(purc_variant_cast_to_longint(v, &i64, false));
+        ASSERT_EQ(i64, (i % 2) ? i : -i);
+    }
+
+    // iteration stays sorted by key
+    const char *prev = NULL;
+    purc_variant_t k, v;
+    foreach_key_value_in_variant_object(obj, k, v)
+        const char *sk = purc_variant_get_string_const(k);
+        if (prev)
+            ASSERT_LT(strcmp(prev, sk), 0);
+        prev = sk;
+        (void)v;
+    end_foreach;
+
+    purc_variant_unref(obj);
+}
+
+TEST(object, remove_while_iterating)
+{
+    PurCInstance purc;
+
+    // small objects are kept flat, large ones are hashed
+    const int sizes[] = { 8, 40 };
+    char key[32];
+
+    for (size_t n = 0; n < PCA_TABLESIZE(sizes); n++) {
+        purc_variant_t obj = purc_variant_make_object_0();
+        ASSERT_NE(obj, PURC_VARIANT_INVALID);
+
+        for (int i = 0; i < sizes[n]; i++) {
+            snprintf(key, sizeof(key), "key%02d", i);
+            purc_variant_t k = purc_variant_make_string(key, false);
+            purc_variant_t v = purc_variant_make_longint(i);
+            ASSERT_TRUE(purc_variant_object_set(obj, k, v));
+            purc_variant_unref(k);
+            purc_variant_unref(v);
+        }
+
+        // remove the odd members while walking all of them
+        int nr_visited = 0;
+        purc_variant_t k, v;
+        foreach_in_variant_object_safe_x(obj, k, v)
+            int64_t i64;
+            ASSERT_TRUE(purc_variant_cast_to_longint(v, &i64, false));
+            ASSERT_EQ(i64, nr_visited);
+            ++nr_visited;
+            if (i64 % 2) {
+                const char *sk = purc_variant_get_string_const(k);
+                ASSERT_TRUE(purc_variant_object_remove_by_static_ckey(obj,
+                            sk, false));
+            }
+        end_foreach;
+        ASSERT_EQ(nr_visited, sizes[n]);
+        ASSERT_EQ(purc_variant_object_get_size(obj), (size_t)sizes[n] / 2);
+
+        // walk backwards over the remaining even members
+        struct purc_variant_object_iterator *it;
+        it = purc_variant_object_make_iterator_end(obj);
+        ASSERT_NE(it, nullptr);
+        int64_t expected = sizes[n] - 2;
+        do {
+            int64_t i64;
+            v = purc_variant_object_iterator_get_value(it);
+            ASSERT_TRUE(purc_variant_cast_to_longint(v, &i64, false));
+            ASSERT_EQ(i64, expected);
+            expected -= 2;
+        } while (purc_variant_object_iterator_prev(it));
+        ASSERT_EQ(expected, -2);
+        purc_variant_object_release_iterator(it);
+
+        purc_variant_unref(obj);
+    }
+}
+
+static double
+elapsed(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) +
+        (end->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+TEST(object, perf)
+{
+    PurCInstance purc(false);
+
+    const char *objects = getenv("OBJECTS");
+    size_t nr_objects = objects ? atoll(objects) : 0;
+    if (nr_objects <= 0) {
+        nr_objects = 100000;
+    }
+
+    static const char *keys[] = { "id", "name", "price", "tags", "note" };
+    const size_t nr_keys = PCA_TABLESIZE(keys);
+
+    const struct purc_variant_stat *stat = purc_variant_usage_stat();
+    size_t mem_before = stat->sz_total_mem;
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    size_t heap_before = mallinfo2().uordblks;
+#else
+    size_t heap_before = 0;
+#endif
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    purc_variant_t arr = purc_variant_make_array_0();
+    ASSERT_NE(arr, PURC_VARIANT_INVALID);
+    for (size_t i = 0; i < nr_objects; i++) {
+        purc_variant_t obj = purc_variant_make_object_0();
+        for (size_t j = 0; j < nr_keys; j++) {
+            purc_variant_t v = purc_variant_make_ulongint(i + j);
+            purc_variant_object_set_by_static_ckey(obj, keys[j], v);
+            purc_variant_unref(v);
+        }
+        purc_variant_array_append(arr, obj);
+        purc_variant_unref(obj);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double t_build = elapsed(&start, &end);
+
+    stat = purc_variant_usage_stat();
+    size_t mem_used = stat->sz_total_mem - mem_before;
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    // the variant statistics do not count the overhead of malloc()
+    size_t heap_used = mallinfo2().uordblks - heap_before;
+#else
+    size_t heap_used = 0;
+#endif
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t nr_found = 0;
+    for (size_t i = 0; i < nr_objects; i++) {
+        purc_variant_t obj = purc_variant_array_get(arr, i);
+        for (size_t j = 0; j < nr_keys; j++) {
+            if (purc_variant_object_get_by_ckey(obj, keys[j]))
+                nr_found++;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double t_get = elapsed(&start, &end);
+    ASSERT_EQ(nr_found, nr_objects * nr_keys);
+
+    fprintf(stderr, "%zu objects of %zu keys: build %.3f s, "
+            "%.1f bytes/object (heap: %.1f), get_by_ckey %.1f ns/op\n",
+            nr_objects, nr_keys, t_build, (double)mem_used / nr_objects,
+            (double)heap_used / nr_objects,
+            t_get * 1000000000.0 / (nr_objects * nr_keys));
+
+    purc_variant_unref(arr);
+}
@@ -160,3 +160,267 @@ end:
     purc_cleanup ();
 }
 
+
+static int
+_append_to_string(const char *buf, size_t len, void *ctxt)
+{
+    ((std::string *)ctxt)->append(buf, len);
+    return 0;
+}
+
+static std::string
+_serialize(struct pcvdom_document *doc)
+{
+    std::string s;
+    pcvdom_util_node_serialize(pcvdom_node_from_document(doc),
+            _append_to_string, &s);
+    return s;
+}
+
+static purc_rwstream_t
+_write_binary(struct pcvdom_document *doc)
+{
+    purc_rwstream_t out = purc_rwstream_new_buffer(0, 0);
+    if (out && pcvdom_util_document_write_binary(doc, out)) {
+        purc_rwstream_destroy(out);
+        out = NULL;
+    }
+    return out;
+}
+
+static int
+_process_file_binary(const char *fn)
+{
+    if (strstr(pcutils_basename(fn), "neg.") == pcutils_basename(fn))
+        return 0;
+
+    purc_rwstream_t rin = purc_rwstream_new_from_file(fn, "r");
+    if (!rin) {
+        ADD_FAILURE() << "Failed to open [" << fn << "]" << std::endl;
+        return -1;
+    }
+
+    struct pcvdom_pos pos;
+    struct pcvdom_document *doc = pcvdom_util_document_from_stream(rin, &pos);
+    purc_rwstream_destroy(rin);
+    if (!doc) {
+        ADD_FAILURE() << "Parsing positive sample: [" << fn << "]" << std::endl;
+        return -1;
+    }
+
+    int r = -1;
+    purc_rwstream_t out = _write_binary(doc);
+    if (out) {
+        size_t len;
+        const char *buf = (const char *)purc_rwstream_get_mem_buffer(out, &len);
+        struct pcvdom_document *copy;
+        copy = pcvdom_util_document_from_binary(buf, len);
+        if (copy) {
+            EXPECT_EQ(_serialize(doc), _serialize(copy)) << fn;
+            pcvdom_document_unref(copy);
+            r = 0;
+        }
+        else {
+            ADD_FAILURE() << "Failed to load binary of [" << fn << "]"
+                << std::endl;
+        }
+
+        // truncated ones must be refused
+        EXPECT_EQ(pcvdom_util_document_from_binary(buf, len - 1), nullptr);
+        EXPECT_EQ(pcvdom_util_document_from_binary(buf, len / 2), nullptr);
+
+        purc_rwstream_destroy(out);
+    }
+    else {
+        ADD_FAILURE() << "Failed to write binary of [" << fn << "]"
+            << std::endl;
+    }
+
+    pcvdom_document_unref(doc);
+    return r;
+}
+
+TEST(vdom_gen, binary)
+{
+    PurCInstance purc(false);
+
+    int r = 0;
+    glob_t globbuf;
+    memset(&globbuf, 0, sizeof(globbuf));
+
+    char path[PATH_MAX+1];
+    test_getpath_from_env_or_rel(path, sizeof(path),
+        "SOURCE_FILES", "/data/*.hvml");
+
+    globbuf.gl_offs = 0;
+    r = glob(path, GLOB_DOOFFS | GLOB_APPEND, NULL, &globbuf);
+    ASSERT_EQ(r, 0) << "Failed to globbing @[" << path << "]" << std::endl;
+
+    for (size_t i=0; i<globbuf.gl_pathc; ++i) {
+        if (_process_file_binary(globbuf.gl_pathv[i]))
+            break;
+    }
+
+    // the loader keeps the compiled vDOM in the cache directory
+    char dir[] = "/tmp/purc-vdom-cache-XXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    setenv(PURC_ENVV_VDOM_CACHE_DIR, dir, 1);
+
+    purc_vdom_t vdom = purc_load_hvml_from_file(globbuf.gl_pathv[0]);
+    ASSERT_NE(vdom, nullptr);
+
+    unsetenv(PURC_ENVV_VDOM_CACHE_DIR);
+    globfree(&globbuf);
+
+    memset(&globbuf, 0, sizeof(globbuf));
+    std::string cached = std::string(dir) + "/*.vdom";
+    ASSERT_EQ(glob(cached.c_str(), 0, NULL, &globbuf), 0);
+    ASSERT_EQ(globbuf.gl_pathc, 1U);
+
+    size_t len;
+    char *buf = purc_load_file_contents(globbuf.gl_pathv[0], &len);
+    ASSERT_NE(buf, nullptr);
+    struct pcvdom_document *copy = pcvdom_util_document_from_binary(buf, len);
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(_serialize(vdom), _serialize(copy));
+    pcvdom_document_unref(copy);
+    free(buf);
+
+    unlink(globbuf.gl_pathv[0]);
+    globfree(&globbuf);
+    rmdir(dir);
+}
+
+static std::string
+_binary_header(void)
+{
+    std::string bin("PVDM");
+    uint16_t bom = 0x0102;
+    bin += (char)PCVDOM_BINARY_VERSION;
+    bin += (char)sizeof(long double);
+    bin.append((const char *)&bom, sizeof(bom));
+    bin += (char)0;     // no doctype
+    return bin;
+}
+
+// `depth` nested elements, the innermost holds a vCM tree of `vcm_depth`
+static std::string
+_nested_binary(size_t depth, size_t vcm_depth)
+{
+    std::string bin = _binary_header();
+    for (size_t i = 0; i < depth; i++) {
+        bin += (char)1;                     // one child
+        bin += (char)PCVDOM_NODE_ELEMENT;
+        bin.append("\3div", 5);            // tag name
+        bin += (char)0;                     // flags
+        bin += (char)0;                     // no attribute
+    }
+
+    if (vcm_depth) {
+        bin += (char)1;
+        bin += (char)PCVDOM_NODE_CONTENT;
+        for (size_t i = 0; i < vcm_depth; i++) {
+            bin += (char)PCVCM_NODE_TYPE_ARRAY;
+            bin += (char)0;                 // extra
+            bin += (char)1;                 // closed
+            bin += (char)(i + 1 < vcm_depth ? 1 : 0);
+        }
+    }
+    else {
+        bin += (char)0;
+    }
+
+    return bin;
+}
+
+TEST(vdom_gen, binary_depth)
+{
+    PurCInstance purc(false);
+
+    struct pcvdom_document *doc;
+    std::string bin = _nested_binary(100, 100);
+    doc = pcvdom_util_document_from_binary(bin.c_str(), bin.size());
+    ASSERT_NE(doc, nullptr);
+
+    // the binary written is loaded again
+    purc_rwstream_t out = _write_binary(doc);
+    ASSERT_NE(out, nullptr);
+    size_t len;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(out, &len);
+    EXPECT_EQ(std::string(buf, len), bin);
+    purc_rwstream_destroy(out);
+    pcvdom_document_unref(doc);
+
+    // too deep to be loaded, rather than to overflow the stack
+    bin = _nested_binary(1000000, 0);
+    EXPECT_EQ(pcvdom_util_document_from_binary(bin.c_str(), bin.size()),
+            nullptr);
+    bin = _nested_binary(1, 1000000);
+    EXPECT_EQ(pcvdom_util_document_from_binary(bin.c_str(), bin.size()),
+            nullptr);
+}
+
+TEST(vdom_gen, binary_perf)
+{
+    PurCInstance purc(false);
+
+    const char *loops = getenv("LOOPS");
+    size_t nr_loops = loops ? atoll(loops) : 0;
+    if (nr_loops <= 0) {
+        nr_loops = 1;
+    }
+
+    /* about 1 MB HVML program */
+    const char *piece =
+        "<div class=\"item\" id=\"item-$?\">"
+        "<init as=\"users\" with=[{\"id\":1,\"name\":\"Tom\"},"
+        "{\"id\":2,\"name\":\"Jerry\",\"score\":3.14}] />"
+        "<iterate on=\"$users\" by=\"RANGE: FROM 0\">"
+        "<span>$?.name: {{ $?.score || 0 }}</span></iterate>"
+        "<update on=\"$@\" at=\"textContent\" with=\"$DATETIME.time\" />"
+        "</div>\n";
+    std::string hvml = "<hvml target=\"html\"><body>\n";
+    while (hvml.size() < 1024 * 1024) {
+        hvml += piece;
+    }
+    hvml += "</body></hvml>\n";
+
+    struct pcvdom_pos pos;
+    struct pcvdom_document *doc = pcvdom_util_document_from_buf(
+            (const unsigned char *)hvml.c_str(), hvml.size(), &pos);
+    ASSERT_NE(doc, nullptr);
+    purc_rwstream_t out = _write_binary(doc);
+    ASSERT_NE(out, nullptr);
+    size_t len;
+    const char *buf = (const char *)purc_rwstream_get_mem_buffer(out, &len);
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < nr_loops; i++) {
+        struct pcvdom_document *d = pcvdom_util_document_from_buf(
+                (const unsigned char *)hvml.c_str(), hvml.size(), &pos);
+        ASSERT_NE(d, nullptr);
+        pcvdom_document_unref(d);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double parse = (end.tv_sec - start.tv_sec) +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < nr_loops; i++) {
+        struct pcvdom_document *d = pcvdom_util_document_from_binary(buf, len);
+        ASSERT_NE(d, nullptr);
+        pcvdom_document_unref(d);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double load = (end.tv_sec - start.tv_sec) +
+        (end.tv_nsec - start.tv_nsec) / 1000000000.0;
+
+    fprintf(stderr, "vDOM from HVML:   %.2f KB, %.3f s\n",
+            hvml.size() / 1024.0, parse);
+    fprintf(stderr, "vDOM from binary: %.2f KB, %.3f s\n",
+            len / 1024.0, load);
+
+    purc_rwstream_destroy(out);
+    pcvdom_document_unref(doc);
+}